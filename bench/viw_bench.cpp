@@ -0,0 +1,414 @@
+// =============================================================================
+//  viw_bench.cpp
+//
+//  Written in 2014 by Dairoku Sekiguchi (sekiguchi at acm dot org)
+//
+//  To the extent possible under law, the author(s) have dedicated all copyright
+//  and related and neighboring rights to this software to the public domain worldwide.
+//  This software is distributed without any warranty.
+//
+//  You should have received a copy of the CC0 Public Domain Dedication along with
+//  this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+// =============================================================================
+/*!
+	\file		viw_bench.cpp
+	\author		Dairoku Sekiguchi
+	\version	1.0.0
+	\date		2026/10/19
+	\brief		Microbenchmarks for the viw model / utils layers
+
+	Runs headless (no Win32 window code is included) and prints one line
+	per case. --json writes the same results for regression tracking.
+
+	viw_bench [--quick] [--filter <substring>] [--threads <n>]
+			  [--min-time <seconds>] [--json <file>] [--tmp <dir>]
+*/
+
+// Includes --------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include "viw/model/BitmapBuffer.hpp"
+#include "viw/utils/CpuFeatures.hpp"
+#include "viw/utils/ThreadPool.hpp"
+
+using namespace viw;
+
+// Structs ---------------------------------------------------------------------
+struct	BenchOptions
+{
+	bool			quick;
+	const char		*filter;
+	int				threadCount;
+	double			minTime;
+	const char		*jsonFileName;
+	std::string		tmpDir;
+};
+
+struct	BenchResult
+{
+	std::string		group;
+	std::string		name;
+	int				width;
+	int				height;
+	size_t			pixelCount;		// elements processed per iteration
+	size_t			byteCount;		// bytes read + written per iteration
+	int				iterations;
+	double			medianSec;
+	double			minSec;
+};
+
+// Static variables ------------------------------------------------------------
+static BenchOptions				sOptions;
+static std::vector<BenchResult>	sResults;
+
+// -----------------------------------------------------------------------------
+// getTime
+// -----------------------------------------------------------------------------
+static double	getTime()
+{
+	return std::chrono::duration<double>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+// -----------------------------------------------------------------------------
+// isSelected
+// -----------------------------------------------------------------------------
+static bool	isSelected(const std::string &inGroup, const std::string &inName)
+{
+	if (sOptions.filter == NULL)
+		return true;
+	return (inGroup + "/" + inName).find(sOptions.filter) != std::string::npos;
+}
+// -----------------------------------------------------------------------------
+// runBench
+// -----------------------------------------------------------------------------
+//	Calls inFunc once to warm up, then until sOptions.minTime has passed
+//	(at least 5 times), and records the median and the fastest iteration
+template <typename Func>
+static void	runBench(const char *inGroup, const std::string &inName, int inWidth, int inHeight,
+				size_t inPixelCount, size_t inByteCount, Func inFunc)
+{
+	if (isSelected(inGroup, inName) == false)
+		return;
+
+	inFunc();
+
+	std::vector<double>	times;
+	double	start = getTime();
+	while (times.size() < 5 || getTime() - start < sOptions.minTime)
+	{
+		double	t0 = getTime();
+		inFunc();
+		times.push_back(getTime() - t0);
+	}
+	std::sort(times.begin(), times.end());
+
+	BenchResult	result;
+	result.group = inGroup;
+	result.name = inName;
+	result.width = inWidth;
+	result.height = inHeight;
+	result.pixelCount = inPixelCount;
+	result.byteCount = inByteCount;
+	result.iterations = (int )times.size();
+	result.medianSec = times[times.size() / 2];
+	result.minSec = times[0];
+	sResults.push_back(result);
+
+	printf("%-14s %-34s %5dx%-5d %10.3f ms %9.3f ns/px %8.2f GB/s\n",
+		inGroup, inName.c_str(), inWidth, inHeight, result.medianSec * 1e3,
+		result.medianSec * 1e9 / (double )inPixelCount,
+		(double )inByteCount / result.medianSec / 1e9);
+	fflush(stdout);
+}
+// -----------------------------------------------------------------------------
+// fillTestPattern
+// -----------------------------------------------------------------------------
+//	A gradient with noise, so that neither the range scan nor the tone
+//	curves see a constant image
+template <typename ImageBufferType>
+static void	fillTestPattern(ImageBufferType *outBuffer, size_t inCount, double inMax)
+{
+	unsigned int	seed = 12345;
+	for (size_t i = 0; i < inCount; i++)
+	{
+		seed = seed * 1664525 + 1013904223;
+		double	v = (double )(i % 4099) / 4099.0 * 0.9 + (double )(seed >> 24) / 256.0 * 0.1;
+		outBuffer[i] = (ImageBufferType )(v * inMax);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// benchDisplayBuffer
+// -----------------------------------------------------------------------------
+template <typename ImageBufferType>
+static void	benchDisplayBuffer(const char *inTypeName, int inWidth, int inHeight,
+					typename model::ImageBuffer<ImageBufferType>::BufferFormat inFormat,
+					const char *inFormatName,
+					typename model::DisplayBuffer<ImageBufferType>::DisplayMapMode inMapMode,
+					const char *inMapName, double inMax)
+{
+	typedef model::DisplayBuffer<ImageBufferType>	BufferType;
+
+	std::string	name = std::string(inTypeName) + "_" + inFormatName + "_" + inMapName;
+	if (isSelected("display", name) == false)
+		return;
+
+	BufferType	buffer(true);
+	if (buffer.allocateImageBuffer(inWidth, inHeight, inFormat) == false)
+		return;
+	fillTestPattern(buffer.getImageBufferPtr(), buffer.getImageBufferPixelCount(), inMax);
+	if (buffer.setDisplayMapMode(inMapMode) == false)
+	{
+		fprintf(stderr, "display/%s: map mode not supported, skipped\n", name.c_str());
+		return;
+	}
+	if (inMapMode == BufferType::DISPLAY_MAP_PARTIAL)
+		buffer.setPartialBitShift(4);
+	if (buffer.getDisplayBufferPtr() == NULL)
+		return;
+
+	size_t	pixelCount = (size_t )inWidth * inHeight;
+	runBench("display", name, inWidth, inHeight, pixelCount,
+		buffer.getImageBufferSize() + buffer.getDisplayBufferSize(),
+		[&]() { buffer.updateDisplayBuffer(); });
+}
+// -----------------------------------------------------------------------------
+// benchDisplayBuffers
+// -----------------------------------------------------------------------------
+static void	benchDisplayBuffers(int inWidth, int inHeight)
+{
+	typedef model::ImageBuffer<unsigned char>		U8;
+	typedef model::ImageBuffer<unsigned short>		U16;
+	typedef model::ImageBuffer<float>				F32;
+	typedef model::DisplayBuffer<unsigned char>		DU8;
+	typedef model::DisplayBuffer<unsigned short>	DU16;
+	typedef model::DisplayBuffer<float>				DF32;
+
+	benchDisplayBuffer<unsigned char>("u8", inWidth, inHeight, U8::BUFFER_FORMAT_MONO, "mono",
+		DU8::DISPLAY_MAP_LINEAR, "linear", 255.0);
+	benchDisplayBuffer<unsigned char>("u8", inWidth, inHeight, U8::BUFFER_FORMAT_RGB, "rgb",
+		DU8::DISPLAY_MAP_DIRECT, "direct", 255.0);
+	benchDisplayBuffer<unsigned char>("u8", inWidth, inHeight, U8::BUFFER_FORMAT_BGR, "bgr",
+		DU8::DISPLAY_MAP_LINEAR, "linear", 255.0);
+	benchDisplayBuffer<unsigned char>("u8", inWidth, inHeight, U8::BUFFER_FORMAT_BAYER_RG, "bayer_rg",
+		DU8::DISPLAY_MAP_DIRECT, "direct", 255.0);
+	benchDisplayBuffer<unsigned short>("u16", inWidth, inHeight, U16::BUFFER_FORMAT_MONO, "mono",
+		DU16::DISPLAY_MAP_DIRECT, "direct", 65535.0);
+	benchDisplayBuffer<unsigned short>("u16", inWidth, inHeight, U16::BUFFER_FORMAT_MONO, "mono",
+		DU16::DISPLAY_MAP_LINEAR, "linear", 65535.0);
+	benchDisplayBuffer<unsigned short>("u16", inWidth, inHeight, U16::BUFFER_FORMAT_MONO, "mono",
+		DU16::DISPLAY_MAP_GAMMA, "gamma", 65535.0);
+	benchDisplayBuffer<unsigned short>("u16", inWidth, inHeight, U16::BUFFER_FORMAT_MONO, "mono",
+		DU16::DISPLAY_MAP_PARTIAL, "partial", 65535.0);
+	benchDisplayBuffer<unsigned short>("u16", inWidth, inHeight, U16::BUFFER_FORMAT_BAYER_RG, "bayer_rg",
+		DU16::DISPLAY_MAP_LINEAR, "linear", 4095.0);
+	benchDisplayBuffer<float>("f32", inWidth, inHeight, F32::BUFFER_FORMAT_MONO, "mono",
+		DF32::DISPLAY_MAP_LINEAR, "linear", 1.0);
+	benchDisplayBuffer<float>("f32", inWidth, inHeight, F32::BUFFER_FORMAT_MONO, "mono",
+		DF32::DISPLAY_MAP_LOG, "log", 1.0);
+	benchDisplayBuffer<float>("f32", inWidth, inHeight, F32::BUFFER_FORMAT_COMPLEX, "complex",
+		DF32::DISPLAY_MAP_LINEAR, "linear", 1.0);
+}
+// -----------------------------------------------------------------------------
+// benchColorMaps
+// -----------------------------------------------------------------------------
+static void	benchColorMaps()
+{
+	static const struct
+	{
+		utils::ColorMap::ColorMapIndex	index;
+		const char						*name;
+	} maps[] =
+	{
+		{utils::ColorMap::CMIndex_GrayScale,		"grayscale"},
+		{utils::ColorMap::CMIndex_Jet,				"jet"},
+		{utils::ColorMap::CMIndex_Rainbow,			"rainbow"},
+		{utils::ColorMap::CMIndex_RainbowWide,		"rainbow_wide"},
+		{utils::ColorMap::CMIndex_Spectrum,			"spectrum"},
+		{utils::ColorMap::CMIndex_SpectrumWide,		"spectrum_wide"},
+		{utils::ColorMap::CMIndex_Thermal,			"thermal"},
+		{utils::ColorMap::CMIndex_ThermalWide,		"thermal_wide"},
+		{utils::ColorMap::CMIndex_CoolWarm,			"cool_warm"},
+		{utils::ColorMap::CMIndex_PurpleOrange,		"purple_orange"},
+		{utils::ColorMap::CMIndex_GreenPurple,		"green_purple"},
+		{utils::ColorMap::CMIndex_BlueDarkYellow,	"blue_dark_yellow"},
+		{utils::ColorMap::CMIndex_GreenRed,			"green_red"}
+	};
+	const int	colorNum = 256;
+	unsigned char	rgb[colorNum * 3];
+
+	for (size_t i = 0; i < sizeof(maps) / sizeof(maps[0]); i++)
+	{
+		utils::ColorMap::ColorMapIndex	index = maps[i].index;
+		runBench("colormap", maps[i].name, colorNum, 1, colorNum, sizeof(rgb),
+			[&]() { utils::ColorMap::getColorMap(index, colorNum, rgb); });
+	}
+}
+// -----------------------------------------------------------------------------
+// benchBitmapFile
+// -----------------------------------------------------------------------------
+static void	benchBitmapFile(int inWidth, int inHeight, int inBitCount)
+{
+	char	name[64];
+	std::string	fileName = sOptions.tmpDir + "/viw_bench.bmp";
+
+	model::Bitmap	*bitmap = model::Bitmap::createBitmap(inWidth, inHeight, inBitCount, true);
+	fillTestPattern(bitmap->getBitmapBitsPtr(), bitmap->getBitmapBitsSize(), 255.0);
+	size_t	fileSize = bitmap->getBitmapBitsSize() + bitmap->getBitmapInfoSize() + sizeof(model::BITMAPFILEHEADER);
+	size_t	pixelCount = (size_t )inWidth * inHeight;
+
+	sprintf(name, "save_%dbit", inBitCount);
+	runBench("bitmap", name, inWidth, inHeight, pixelCount, fileSize,
+		[&]() { bitmap->saveToFile(fileName.c_str()); });
+
+	sprintf(name, "load_%dbit", inBitCount);
+	bitmap->saveToFile(fileName.c_str());
+	runBench("bitmap", name, inWidth, inHeight, pixelCount, fileSize,
+		[&]() { delete model::Bitmap::loadFromFile(fileName.c_str(), true); });
+
+	remove(fileName.c_str());
+	delete bitmap;
+}
+// -----------------------------------------------------------------------------
+// benchCopyIntoImageBuffer
+// -----------------------------------------------------------------------------
+template <typename ImageBufferType>
+static void	benchCopyIntoImageBuffer(const char *inName, int inWidth, int inHeight,
+					typename model::ImageBuffer<ImageBufferType>::BufferFormat inFormat)
+{
+	model::ImageBuffer<ImageBufferType>	buffer(true);
+	int	count = model::ImageBuffer<ImageBufferType>::obtainLineElementCount(inFormat, inWidth) * inHeight;
+	std::vector<ImageBufferType>	src(count);
+	fillTestPattern(&src[0], src.size(), 255.0);
+
+	runBench("copy", inName, inWidth, inHeight, (size_t )inWidth * inHeight,
+		src.size() * sizeof(ImageBufferType) * 2,
+		[&]() { buffer.copyIntoImageBuffer(inWidth, inHeight, &src[0], inFormat); });
+}
+// -----------------------------------------------------------------------------
+// writeJson
+// -----------------------------------------------------------------------------
+static bool	writeJson(const char *inFileName)
+{
+	FILE	*fp = fopen(inFileName, "w");
+	if (fp == NULL)
+	{
+		fprintf(stderr, "can't open %s\n", inFileName);
+		return false;
+	}
+
+	fprintf(fp, "{\n");
+	fprintf(fp, "  \"isa\": \"%s\",\n", utils::CpuFeatures::getIsaName(utils::CpuFeatures::getIsa()));
+	fprintf(fp, "  \"threads\": %d,\n", utils::ThreadPool::getInstance().getThreadCount());
+	fprintf(fp, "  \"min_time_s\": %g,\n", sOptions.minTime);
+	fprintf(fp, "  \"results\": [\n");
+	for (size_t i = 0; i < sResults.size(); i++)
+	{
+		const BenchResult	&r = sResults[i];
+		fprintf(fp, "    {\"group\": \"%s\", \"name\": \"%s\", \"width\": %d, \"height\": %d, "
+			"\"pixels\": %zu, \"bytes\": %zu, \"iterations\": %d, "
+			"\"median_ms\": %.6f, \"min_ms\": %.6f, \"ns_per_pixel\": %.6f, \"gb_per_s\": %.6f}%s\n",
+			r.group.c_str(), r.name.c_str(), r.width, r.height,
+			r.pixelCount, r.byteCount, r.iterations,
+			r.medianSec * 1e3, r.minSec * 1e3,
+			r.medianSec * 1e9 / (double )r.pixelCount,
+			(double )r.byteCount / r.medianSec / 1e9,
+			(i + 1 < sResults.size()) ? "," : "");
+	}
+	fprintf(fp, "  ]\n");
+	fprintf(fp, "}\n");
+	fclose(fp);
+	return true;
+}
+// -----------------------------------------------------------------------------
+// printUsage
+// -----------------------------------------------------------------------------
+static void	printUsage()
+{
+	printf("usage: viw_bench [--quick] [--filter <substring>] [--threads <n>]\n");
+	printf("                 [--min-time <seconds>] [--json <file>] [--tmp <dir>]\n");
+}
+
+// -----------------------------------------------------------------------------
+// main
+// -----------------------------------------------------------------------------
+int	main(int argc, char *argv[])
+{
+	sOptions.quick = false;
+	sOptions.filter = NULL;
+	sOptions.threadCount = 0;
+	sOptions.minTime = 0.5;
+	sOptions.jsonFileName = NULL;
+	sOptions.tmpDir = ".";
+
+	for (int i = 1; i < argc; i++)
+	{
+		bool	hasValue = (i + 1 < argc);
+		if (strcmp(argv[i], "--quick") == 0)
+			sOptions.quick = true;
+		else if (strcmp(argv[i], "--filter") == 0 && hasValue)
+			sOptions.filter = argv[++i];
+		else if (strcmp(argv[i], "--threads") == 0 && hasValue)
+			sOptions.threadCount = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--min-time") == 0 && hasValue)
+			sOptions.minTime = atof(argv[++i]);
+		else if (strcmp(argv[i], "--json") == 0 && hasValue)
+			sOptions.jsonFileName = argv[++i];
+		else if (strcmp(argv[i], "--tmp") == 0 && hasValue)
+			sOptions.tmpDir = argv[++i];
+		else
+		{
+			printUsage();
+			return (strcmp(argv[i], "--help") == 0) ? 0 : 1;
+		}
+	}
+	if (sOptions.quick)
+		sOptions.minTime = 0.1;
+
+	utils::ThreadPool::getInstance().setThreadCount(sOptions.threadCount);
+	printf("isa: %s, threads: %d\n",
+		utils::CpuFeatures::getIsaName(utils::CpuFeatures::getIsa()),
+		utils::ThreadPool::getInstance().getThreadCount());
+
+	static const int	sizes[][2] = {{640, 480}, {1920, 1080}, {4096, 3072}};
+	int	sizeBegin = sOptions.quick ? 1 : 0;
+	int	sizeEnd = sOptions.quick ? 2 : 3;
+
+	try
+	{
+		for (int i = sizeBegin; i < sizeEnd; i++)
+			benchDisplayBuffers(sizes[i][0], sizes[i][1]);
+
+		benchColorMaps();
+
+		for (int i = sizeBegin; i < sizeEnd; i++)
+		{
+			benchBitmapFile(sizes[i][0], sizes[i][1], 8);
+			benchBitmapFile(sizes[i][0], sizes[i][1], 24);
+		}
+
+		for (int i = sizeBegin; i < sizeEnd; i++)
+		{
+			benchCopyIntoImageBuffer<unsigned char>("u8_bgr", sizes[i][0], sizes[i][1],
+				model::ImageBuffer<unsigned char>::BUFFER_FORMAT_BGR);
+			benchCopyIntoImageBuffer<unsigned short>("u16_mono", sizes[i][0], sizes[i][1],
+				model::ImageBuffer<unsigned short>::BUFFER_FORMAT_MONO);
+		}
+	}
+
+	catch (ViwException &ex)
+	{
+		fprintf(stderr, "ViwException: %s\n", ex.getDescription());
+		return 1;
+	}
+
+	if (sOptions.jsonFileName != NULL && writeJson(sOptions.jsonFileName) == false)
+		return 1;
+
+	return 0;
+}
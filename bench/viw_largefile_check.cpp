@@ -0,0 +1,269 @@
+// =============================================================================
+//  viw_largefile_check.cpp
+//
+//  Written in 2014 by Dairoku Sekiguchi (sekiguchi at acm dot org)
+//
+//  To the extent possible under law, the author(s) have dedicated all copyright
+//  and related and neighboring rights to this software to the public domain worldwide.
+//  This software is distributed without any warranty.
+//
+//  You should have received a copy of the CC0 Public Domain Dedication along with
+//  this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+// =============================================================================
+/*!
+	\file		viw_largefile_check.cpp
+	\author		Dairoku Sekiguchi
+	\version	1.0.0
+	\date		2026/10/19
+	\brief		Saves and loads a BMP over 4GB (POSIX only)
+
+	The pixels live in a sparse anonymous mapping, so only the pages with
+	the marker lines take memory. The check saves them with
+	Bitmap::saveToFile() and then verifies that
+		- the file has the full size and bfSize / biSizeImage are 0,
+		- the marker lines (the first line, the lines around 4GB and the
+		  last line) are at their offsets in the file,
+		- ImageBuffer line pointers past 4GB are right,
+		- Bitmap::loadFromFile() reads the markers back.
+	The load needs the whole image in memory. When the allocation fails
+	(MEMORY_ERROR) the load part is reported as skipped, any other error
+	fails the check.
+
+	It writes about 5GB to disk, so it is only built and added to ctest
+	with -DVIW_LARGE_FILE_CHECK=ON.
+
+	viw_largefile_check [--size <w>x<h>] [--file <bmp file>]
+*/
+
+// Includes --------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <vector>
+#include "viw/model/Bitmap.hpp"
+#include "viw/model/ImageBuffer.hpp"
+
+using namespace viw;
+
+// Constatns -------------------------------------------------------------------
+const static int	MARKER_LINE_NUM	= 4;
+
+// Static Functions ------------------------------------------------------------
+// -----------------------------------------------------------------------------
+// obtainMarkerLines
+// -----------------------------------------------------------------------------
+//	The first line, the lines just below and at 4GB and the last line
+static void	obtainMarkerLines(int inWidth, int inHeight, int outLines[MARKER_LINE_NUM])
+{
+	long long	line4G = (0x100000000LL + inWidth - 1) / inWidth;
+	if (line4G > inHeight - 1)
+		line4G = inHeight - 1;
+	outLines[0] = 0;
+	outLines[1] = (int )line4G - 1;
+	outLines[2] = (int )line4G;
+	outLines[3] = inHeight - 1;
+}
+// -----------------------------------------------------------------------------
+// getMarker
+// -----------------------------------------------------------------------------
+static unsigned char	getMarker(int inLine, int inX)
+{
+	return (unsigned char )(inLine * 13 + inX * 7 + 1);
+}
+// -----------------------------------------------------------------------------
+// checkLine
+// -----------------------------------------------------------------------------
+static bool	checkLine(const unsigned char *inLinePtr, int inWidth, int inLine, const char *inWhere)
+{
+	for (int x = 0; x < inWidth; x++)
+		if (inLinePtr[x] != getMarker(inLine, x))
+		{
+			printf("%s: line %d, x %d is %d, expected %d\n",
+				inWhere, inLine, x, inLinePtr[x], getMarker(inLine, x));
+			return false;
+		}
+	return true;
+}
+// -----------------------------------------------------------------------------
+// checkFile
+// -----------------------------------------------------------------------------
+//	Reads the headers and the marker lines with plain stdio
+static bool	checkFile(const char *inFileName, int inWidth, int inHeight, size_t inBitsSize,
+					const int inLines[MARKER_LINE_NUM])
+{
+	struct stat	st;
+	if (stat(inFileName, &st) != 0)
+	{
+		printf("can't stat %s\n", inFileName);
+		return false;
+	}
+
+	FILE	*fp = fopen(inFileName, "rb");
+	if (fp == NULL)
+	{
+		printf("can't open %s\n", inFileName);
+		return false;
+	}
+
+	bool	isOK = true;
+	model::BITMAPFILEHEADER	fileHeader;
+	model::BITMAPINFOHEADER	infoHeader;
+	if (fread(&fileHeader, sizeof(fileHeader), 1, fp) != 1 ||
+		fread(&infoHeader, sizeof(infoHeader), 1, fp) != 1)
+	{
+		printf("can't read the headers\n");
+		fclose(fp);
+		return false;
+	}
+	if ((unsigned long long )st.st_size != fileHeader.bfOffBits + (unsigned long long )inBitsSize)
+	{
+		printf("file size %lld, expected %llu\n", (long long )st.st_size,
+			fileHeader.bfOffBits + (unsigned long long )inBitsSize);
+		isOK = false;
+	}
+	if (fileHeader.bfSize != 0 || infoHeader.biSizeImage != 0)
+	{
+		printf("bfSize %u, biSizeImage %u, expected 0 over 4GB\n",
+			(unsigned int )fileHeader.bfSize, (unsigned int )infoHeader.biSizeImage);
+		isOK = false;
+	}
+	if (infoHeader.biWidth != inWidth || infoHeader.biHeight != inHeight)
+	{
+		printf("header size %dx%d\n", (int )infoHeader.biWidth, (int )infoHeader.biHeight);
+		isOK = false;
+	}
+
+	std::vector<unsigned char>	line(inWidth);
+	for (int i = 0; i < MARKER_LINE_NUM && isOK; i++)
+	{
+		off_t	offset = (off_t )fileHeader.bfOffBits + (off_t )inLines[i] * inWidth;
+		if (fseeko(fp, offset, SEEK_SET) != 0 || fread(&line[0], 1, inWidth, fp) != (size_t )inWidth)
+		{
+			printf("can't read line %d at %lld\n", inLines[i], (long long )offset);
+			isOK = false;
+		}
+		else
+			isOK = checkLine(&line[0], inWidth, inLines[i], "file");
+	}
+	fclose(fp);
+	return isOK;
+}
+// -----------------------------------------------------------------------------
+// checkLoad
+// -----------------------------------------------------------------------------
+//	Returns 1 when the load matched, 0 when it was skipped, -1 on failure
+static int	checkLoad(const char *inFileName, int inWidth, size_t inBitsSize,
+					const int inLines[MARKER_LINE_NUM])
+{
+	model::Bitmap	*bitmap;
+	try
+	{
+		bitmap = model::Bitmap::loadFromFile(inFileName, true);
+	}
+
+	catch (ViwException &ex)
+	{
+		if (ex.getExceptionCode() == ViwException::MEMORY_ERROR)
+		{
+			printf("load: skipped, %llu bytes could not be allocated\n", (unsigned long long )inBitsSize);
+			return 0;
+		}
+		printf("load: ViwException: %s\n", ex.getDescription());
+		return -1;
+	}
+	if (bitmap == NULL)
+	{
+		printf("load: loadFromFile() returned NULL\n");
+		return -1;
+	}
+
+	bool	isOK = (bitmap->getBitmapBitsSize() == inBitsSize);
+	if (isOK == false)
+		printf("load: bits size %llu, expected %llu\n",
+			(unsigned long long )bitmap->getBitmapBitsSize(), (unsigned long long )inBitsSize);
+	for (int i = 0; i < MARKER_LINE_NUM && isOK; i++)
+		isOK = checkLine(bitmap->getBitmapBitsPtr() + (size_t )inLines[i] * inWidth,
+					inWidth, inLines[i], "load");
+	delete bitmap;
+	return isOK ? 1 : -1;
+}
+// -----------------------------------------------------------------------------
+// main
+// -----------------------------------------------------------------------------
+int	main(int argc, char *argv[])
+{
+	int			width = 16384;
+	int			height = 300000;	// 4.9GB at 8bpp
+	const char	*fileName = "viw_largefile_check.bmp";
+
+	for (int i = 1; i < argc; i++)
+	{
+		bool	hasValue = (i + 1 < argc);
+		if (strcmp(argv[i], "--size") == 0 && hasValue &&
+			sscanf(argv[i + 1], "%dx%d", &width, &height) == 2)
+			i++;
+		else if (strcmp(argv[i], "--file") == 0 && hasValue)
+			fileName = argv[++i];
+		else
+		{
+			printf("viw_largefile_check [--size <w>x<h>] [--file <bmp file>]\n");
+			return (strcmp(argv[i], "--help") == 0) ? 0 : 1;
+		}
+	}
+
+	// DWORD aligned lines keep the BMP stride equal to the width
+	size_t	bitsSize = (size_t )width * height;
+	if (width <= 0 || height <= 1 || (width % 4) != 0 || bitsSize <= 0xFFFFFFFFULL)
+	{
+		printf("the width must be a multiple of 4 and the image over 4GB\n");
+		return 1;
+	}
+
+	unsigned char	*bitsPtr = (unsigned char *)mmap(NULL, bitsSize, PROT_READ | PROT_WRITE,
+								MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if (bitsPtr == MAP_FAILED)
+	{
+		printf("can't map %llu bytes\n", (unsigned long long )bitsSize);
+		return 1;
+	}
+
+	int	lines[MARKER_LINE_NUM];
+	obtainMarkerLines(width, height, lines);
+	for (int i = 0; i < MARKER_LINE_NUM; i++)
+		for (int x = 0; x < width; x++)
+			bitsPtr[(size_t )lines[i] * width + x] = getMarker(lines[i], x);
+
+	bool	isOK = true;
+
+	// Line pointers past 4GB
+	model::ImageBuffer<unsigned char>	buffer;
+	if (buffer.setImageBufferPtr(width, height, bitsPtr, model::ImageBuffer<unsigned char>::BUFFER_FORMAT_MONO) == false ||
+		buffer.getImageBufferSize() != bitsSize ||
+		buffer.getImageBufferLinePtr(lines[3]) != bitsPtr + (size_t )lines[3] * width)
+	{
+		printf("ImageBuffer: wrong size or line pointer over 4GB\n");
+		isOK = false;
+	}
+
+	printf("saving %dx%d (%.2f GB) to %s\n", width, height, bitsSize / 1e9, fileName);
+	model::Bitmap	*bitmap = model::Bitmap::createBitmap(bitsPtr, bitsSize, width, height, 8);
+	if (bitmap == NULL || bitmap->saveToFile(fileName) == false)
+	{
+		printf("save: failed\n");
+		isOK = false;
+	}
+	delete bitmap;
+	munmap(bitsPtr, bitsSize);
+
+	if (isOK)
+		isOK = checkFile(fileName, width, height, bitsSize, lines);
+	if (isOK)
+		isOK = (checkLoad(fileName, width, bitsSize, lines) >= 0);
+	remove(fileName);
+
+	printf("%s\n", isOK ? "OK" : "FAILED");
+	return isOK ? 0 : 1;
+}
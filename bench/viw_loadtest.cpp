@@ -0,0 +1,803 @@
+// =============================================================================
+//  viw_loadtest.cpp
+//
+//  Written in 2014 by Dairoku Sekiguchi (sekiguchi at acm dot org)
+//
+//  To the extent possible under law, the author(s) have dedicated all copyright
+//  and related and neighboring rights to this software to the public domain worldwide.
+//  This software is distributed without any warranty.
+//
+//  You should have received a copy of the CC0 Public Domain Dedication along with
+//  this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+// =============================================================================
+/*!
+	\file		viw_loadtest.cpp
+	\author		Dairoku Sekiguchi
+	\version	1.0.0
+	\date		2026/10/19
+	\brief		End-to-end viewer load test with synthetic producers
+
+	Every viewer has a producer thread that renders a moving test pattern
+	at the requested rate and hands it to the viewer through a one frame
+	mailbox (a frame that is replaced before the viewer took it is a drop).
+	The viewer thread copies the frame into its buffer and maps it for
+	display, which is the path ImageWindow runs before it paints.
+
+	With --gui (Win32 only) the frames are shown in ImageWindow instances
+	and the latency is taken when WM_PAINT has drawn the frame.
+
+	viw_loadtest [--viewers <n>] [--size <w>x<h>] [--format <format>]
+				 [--map <mode>] [--fps <rate>] [--duration <seconds>]
+				 [--threads <n>] [--json <file>] [--trace <file>] [--gui]
+
+	<format> : u8_mono, u8_bgr, u8_bayer_rg, u16_mono, u16_bayer_rg, f32_mono
+	<mode>   : direct, linear, gamma, log
+
+	--trace writes the per-stage events as a Chrome trace and prints the
+	stage histograms, it needs a build with VIW_TRACE defined.
+
+	The CPU time per viewer is that of its producer and viewer threads.
+	The ThreadPool workers are shared, their time is reported once as
+	pool cpu.
+*/
+
+// Includes --------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+#include <string>
+#include <algorithm>
+#ifdef _WIN32
+#include "viw/ImageWindow.hpp"
+#else
+#include <time.h>
+#include "viw/model/DisplayBuffer.hpp"
+#endif
+#include "viw/utils/CpuFeatures.hpp"
+#include "viw/utils/ThreadPool.hpp"
+#include "viw/utils/Trace.hpp"
+
+using namespace viw;
+
+// Structs ---------------------------------------------------------------------
+struct	LoadTestOptions
+{
+	int				viewerNum;
+	int				width;
+	int				height;
+	const char		*formatName;
+	const char		*mapName;
+	double			fps;
+	double			duration;
+	int				threadCount;
+	const char		*jsonFileName;
+	const char		*traceFileName;
+	bool			isGuiMode;
+};
+
+struct	ViewerStats
+{
+	long long			producedCount;		// frames published by the producer
+	long long			displayedCount;		// frames that reached the pixels
+	long long			droppedCount;		// replaced before they were displayed
+	long long			overrunCount;		// producer missed its schedule
+	double				producerCpuSec;
+	double				viewerCpuSec;
+	std::vector<double>	latencies;			// publish -> pixels, seconds
+};
+
+// Static Functions ------------------------------------------------------------
+// -----------------------------------------------------------------------------
+// getTime
+// -----------------------------------------------------------------------------
+static double	getTime()
+{
+	return std::chrono::duration<double>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+// -----------------------------------------------------------------------------
+// getThreadCpuTime
+// -----------------------------------------------------------------------------
+static double	getThreadCpuTime()
+{
+#ifdef _WIN32
+	FILETIME	creationTime, exitTime, kernelTime, userTime;
+	if (::GetThreadTimes(::GetCurrentThread(), &creationTime, &exitTime, &kernelTime, &userTime) == 0)
+		return 0;
+	unsigned long long	kernel = ((unsigned long long )kernelTime.dwHighDateTime << 32) | kernelTime.dwLowDateTime;
+	unsigned long long	user = ((unsigned long long )userTime.dwHighDateTime << 32) | userTime.dwLowDateTime;
+	return (double )(kernel + user) * 1e-7;
+#else
+	struct timespec	ts;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+	return (double )ts.tv_sec + (double )ts.tv_nsec * 1e-9;
+#endif
+}
+// -----------------------------------------------------------------------------
+// getProcessCpuTime
+// -----------------------------------------------------------------------------
+static double	getProcessCpuTime()
+{
+#ifdef _WIN32
+	FILETIME	creationTime, exitTime, kernelTime, userTime;
+	if (::GetProcessTimes(::GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime) == 0)
+		return 0;
+	unsigned long long	kernel = ((unsigned long long )kernelTime.dwHighDateTime << 32) | kernelTime.dwLowDateTime;
+	unsigned long long	user = ((unsigned long long )userTime.dwHighDateTime << 32) | userTime.dwLowDateTime;
+	return (double )(kernel + user) * 1e-7;
+#else
+	struct timespec	ts;
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+	return (double )ts.tv_sec + (double )ts.tv_nsec * 1e-9;
+#endif
+}
+// -----------------------------------------------------------------------------
+// getPercentile
+// -----------------------------------------------------------------------------
+//	inSorted must be sorted
+static double	getPercentile(const std::vector<double> &inSorted, double inPercent)
+{
+	if (inSorted.empty())
+		return 0;
+	size_t	index = (size_t )(inPercent / 100.0 * (double )(inSorted.size() - 1) + 0.5);
+	return inSorted[index];
+}
+
+// -----------------------------------------------------------------------------
+// Viewer class
+// -----------------------------------------------------------------------------
+class	Viewer
+{
+public:
+	// Constructors and Destructor ---------------------------------------------
+	Viewer()
+	{
+		mIsStopRequested = false;
+	}
+	virtual ~Viewer()
+	{
+	}
+
+	// Member functions --------------------------------------------------------
+	// -------------------------------------------------------------------------
+	// start
+	// -------------------------------------------------------------------------
+	void	start(double inFps, double inStartTime)
+	{
+		mIsStopRequested = false;
+		mProducerThread = std::thread(&Viewer::producerMain, this, inFps, inStartTime);
+		mViewerThread = std::thread(&Viewer::viewerMain, this);
+	}
+	// -------------------------------------------------------------------------
+	// requestStop
+	// -------------------------------------------------------------------------
+	void	requestStop()
+	{
+		{
+			std::lock_guard<std::mutex>	lock(mMutex);
+			mIsStopRequested = true;
+		}
+		mCondition.notify_all();
+	}
+	// -------------------------------------------------------------------------
+	// waitForStop
+	// -------------------------------------------------------------------------
+	void	waitForStop()
+	{
+		mProducerThread.join();
+		mViewerThread.join();
+		finishStats(&mStats);
+	}
+	// -------------------------------------------------------------------------
+	// getStats
+	// -------------------------------------------------------------------------
+	const ViewerStats	&getStats()
+	{
+		return mStats;
+	}
+
+protected:
+	// Member variables --------------------------------------------------------
+	std::thread					mProducerThread;
+	std::thread					mViewerThread;
+	std::mutex					mMutex;
+	std::condition_variable		mCondition;
+	bool						mIsStopRequested;
+	bool						mIsMailboxFull;
+	double						mMailboxTime;
+	ViewerStats					mStats;
+
+	// Member functions --------------------------------------------------------
+	//	generateFrame() renders into the producer side buffer, swapFrame()
+	//	exchanges two sides (0 : producer, 1 : mailbox, 2 : viewer) and
+	//	displayFrame() shows the viewer side. displayFrame() returns false
+	//	when the latency is recorded later (on paint).
+	virtual void	generateFrame(long long inFrameIndex) = 0;
+	virtual void	swapFrame(int inSideA, int inSideB) = 0;
+	virtual bool	displayFrame(double inPublishTime) = 0;
+	virtual void	finishStats(ViewerStats *)
+	{
+	}
+
+	// -------------------------------------------------------------------------
+	// producerMain
+	// -------------------------------------------------------------------------
+	void	producerMain(double inFps, double inStartTime)
+	{
+		double		period = 1.0 / inFps;
+		double		nextTime = inStartTime;
+		long long	frameIndex = 0;
+
+		std::this_thread::sleep_for(std::chrono::duration<double>(nextTime - getTime()));
+		while (true)
+		{
+			generateFrame(frameIndex++);
+			{
+				std::lock_guard<std::mutex>	lock(mMutex);
+				if (mIsStopRequested)
+					break;
+				if (mIsMailboxFull)
+					mStats.droppedCount++;
+				swapFrame(0, 1);
+				mIsMailboxFull = true;
+				mMailboxTime = getTime();
+				mStats.producedCount++;
+			}
+			mCondition.notify_one();
+
+			nextTime += period;
+			double	now = getTime();
+			if (now > nextTime + period)
+			{
+				mStats.overrunCount++;
+				nextTime = now;
+			}
+			else if (nextTime > now)
+				std::this_thread::sleep_for(std::chrono::duration<double>(nextTime - now));
+		}
+		mStats.producerCpuSec = getThreadCpuTime();
+	}
+	// -------------------------------------------------------------------------
+	// viewerMain
+	// -------------------------------------------------------------------------
+	void	viewerMain()
+	{
+		while (true)
+		{
+			double	publishTime;
+			{
+				std::unique_lock<std::mutex>	lock(mMutex);
+				mCondition.wait(lock, [this]() { return mIsMailboxFull || mIsStopRequested; });
+				if (mIsMailboxFull == false)	// stopped, the last frame is drained
+					break;
+				swapFrame(1, 2);
+				mIsMailboxFull = false;
+				publishTime = mMailboxTime;
+			}
+
+			if (displayFrame(publishTime))
+			{
+				mStats.latencies.push_back(getTime() - publishTime);
+				mStats.displayedCount++;
+			}
+		}
+		mStats.viewerCpuSec = getThreadCpuTime();
+	}
+	// -------------------------------------------------------------------------
+	// resetStats
+	// -------------------------------------------------------------------------
+	void	resetStats()
+	{
+		mIsMailboxFull = false;
+		mMailboxTime = 0;
+		mStats.producedCount = 0;
+		mStats.displayedCount = 0;
+		mStats.droppedCount = 0;
+		mStats.overrunCount = 0;
+		mStats.producerCpuSec = 0;
+		mStats.viewerCpuSec = 0;
+		mStats.latencies.clear();
+	}
+};
+
+#ifdef _WIN32
+// -----------------------------------------------------------------------------
+// LoadTestWindow class
+// -----------------------------------------------------------------------------
+//	Records the latency of a submitted frame when WM_PAINT has drawn it.
+//	Frames that are replaced before a paint are counted as dropped.
+template <typename ImageBufferType> class	LoadTestWindow : public ImageWindow<ImageBufferType>
+{
+public:
+	LoadTestWindow()
+	{
+		mPendingTime = 0;
+		mDisplayedCount = 0;
+		mCoalescedCount = 0;
+	}
+
+	// -------------------------------------------------------------------------
+	// submitFrame
+	// -------------------------------------------------------------------------
+	void	submitFrame(const ImageBufferType *inFrame, int inWidth, int inHeight,
+				typename ImageWindow<ImageBufferType>::BufferFormat inFormat, double inPublishTime)
+	{
+		if (::WaitForSingleObject(this->mMutexHandle, INFINITE) != WAIT_OBJECT_0)
+			return;
+		this->copyIntoImageBuffer(inWidth, inHeight, inFrame, inFormat);
+		{
+			std::lock_guard<std::mutex>	lock(mStatsMutex);
+			if (mPendingTime != 0)
+				mCoalescedCount++;
+			mPendingTime = inPublishTime;
+		}
+		::ReleaseMutex(this->mMutexHandle);
+		this->updateImage();
+	}
+	// -------------------------------------------------------------------------
+	// takeStats
+	// -------------------------------------------------------------------------
+	void	takeStats(ViewerStats *ioStats)
+	{
+		std::lock_guard<std::mutex>	lock(mStatsMutex);
+		ioStats->latencies = mLatencies;
+		ioStats->displayedCount = mDisplayedCount;
+		ioStats->droppedCount += mCoalescedCount;
+	}
+
+protected:
+	std::mutex				mStatsMutex;
+	double					mPendingTime;
+	long long				mDisplayedCount;
+	long long				mCoalescedCount;
+	std::vector<double>		mLatencies;
+
+	// -------------------------------------------------------------------------
+	// onWM_PAINT
+	// -------------------------------------------------------------------------
+	virtual bool	onWM_PAINT(UINT inMessage, WPARAM inWParam, LPARAM inLParam, LRESULT *outResult)
+	{
+		bool	result = ImageWindow<ImageBufferType>::onWM_PAINT(inMessage, inWParam, inLParam, outResult);
+
+		std::lock_guard<std::mutex>	lock(mStatsMutex);
+		if (mPendingTime != 0)
+		{
+			mLatencies.push_back(getTime() - mPendingTime);
+			mDisplayedCount++;
+			mPendingTime = 0;
+		}
+		return result;
+	}
+};
+#endif
+
+// -----------------------------------------------------------------------------
+// ViewerImpl class
+// -----------------------------------------------------------------------------
+template <typename ImageBufferType> class	ViewerImpl : public Viewer
+{
+public:
+	typedef model::ImageBuffer<ImageBufferType>		ImageBufferBase;
+	typedef model::DisplayBuffer<ImageBufferType>	DisplayBufferType;
+
+	// Constructors and Destructor ---------------------------------------------
+	ViewerImpl(int inIndex, int inWidth, int inHeight,
+			typename ImageBufferBase::BufferFormat inFormat,
+			typename DisplayBufferType::DisplayMapMode inMapMode, double inMax, bool inIsGuiMode)
+		: mBuffer(true)
+	{
+		mIndex = inIndex;
+		mWidth = inWidth;
+		mHeight = inHeight;
+		mFormat = inFormat;
+		size_t	count = (size_t )ImageBufferBase::obtainLineElementCount(inFormat, inWidth) * inHeight;
+		for (int i = 0; i < 3; i++)
+			mFrames[i].resize(count);
+
+		size_t	lineCount = count / inHeight;
+		mRamp.resize(lineCount + 1024);
+		for (size_t i = 0; i < mRamp.size(); i++)
+			mRamp[i] = (ImageBufferType )((double )(i & 1023) * inMax / 1023.0);
+
+		mBuffer.allocateImageBuffer(inWidth, inHeight, inFormat);
+		mBuffer.setDisplayMapMode(inMapMode);
+	#ifdef _WIN32
+		mWindow = NULL;
+		if (inIsGuiMode)
+		{
+			char	name[64];
+			sprintf_s(name, 64, "viw_loadtest %d", inIndex);
+			mWindow = new LoadTestWindow<ImageBufferType>();
+			mWindow->copyIntoImageBuffer(inWidth, inHeight, &mFrames[2][0], inFormat);
+			mWindow->setDisplayMapMode(inMapMode);
+			mWindow->showWindow(name);
+		}
+	#else
+		(void )inIsGuiMode;
+	#endif
+		resetStats();
+	}
+	virtual ~ViewerImpl()
+	{
+	#ifdef _WIN32
+		if (mWindow != NULL)
+		{
+			mWindow->closeWindow();
+			mWindow->waitForWindowClose();
+			delete mWindow;
+		}
+	#endif
+	}
+
+protected:
+	// Member variables --------------------------------------------------------
+	int								mIndex;
+	int								mWidth;
+	int								mHeight;
+	typename ImageBufferBase::BufferFormat	mFormat;
+	std::vector<ImageBufferType>	mFrames[3];
+	std::vector<ImageBufferType>	mRamp;
+	DisplayBufferType				mBuffer;
+#ifdef _WIN32
+	LoadTestWindow<ImageBufferType>	*mWindow;
+#endif
+
+	// Member functions --------------------------------------------------------
+	// -------------------------------------------------------------------------
+	// generateFrame
+	// -------------------------------------------------------------------------
+	//	A diagonal ramp that moves by 4 pixels per frame. The lines are
+	//	copied from a precomputed ramp so that the producer stays cheap.
+	virtual void	generateFrame(long long inFrameIndex)
+	{
+		std::vector<ImageBufferType>	&frame = mFrames[0];
+		size_t	lineCount = frame.size() / mHeight;
+		int		offset = (int )((inFrameIndex * 4 + mIndex * 97) % 1024);
+
+		for (int y = 0; y < mHeight; y++)
+			memcpy(&frame[lineCount * y], &mRamp[(y + offset) & 1023], lineCount * sizeof(ImageBufferType));
+	}
+	// -------------------------------------------------------------------------
+	// swapFrame
+	// -------------------------------------------------------------------------
+	virtual void	swapFrame(int inSideA, int inSideB)
+	{
+		mFrames[inSideA].swap(mFrames[inSideB]);
+	}
+	// -------------------------------------------------------------------------
+	// displayFrame
+	// -------------------------------------------------------------------------
+	virtual bool	displayFrame(double inPublishTime)
+	{
+	#ifdef _WIN32
+		if (mWindow != NULL)
+		{
+			mWindow->submitFrame(&mFrames[2][0], mWidth, mHeight, mFormat, inPublishTime);
+			return false;
+		}
+	#else
+		(void )inPublishTime;
+	#endif
+		mBuffer.copyIntoImageBuffer(mWidth, mHeight, &mFrames[2][0], mFormat);
+		mBuffer.getDisplayBufferPtr();
+		return true;
+	}
+	// -------------------------------------------------------------------------
+	// finishStats
+	// -------------------------------------------------------------------------
+	virtual void	finishStats(ViewerStats *ioStats)
+	{
+	#ifdef _WIN32
+		if (mWindow != NULL)
+			mWindow->takeStats(ioStats);
+	#else
+		(void )ioStats;
+	#endif
+	}
+};
+
+// -----------------------------------------------------------------------------
+// createViewer
+// -----------------------------------------------------------------------------
+template <typename ImageBufferType>
+static Viewer	*createViewer(int inIndex, const LoadTestOptions &inOptions,
+					typename model::ImageBuffer<ImageBufferType>::BufferFormat inFormat, double inMax)
+{
+	typedef model::DisplayBuffer<ImageBufferType>	DisplayBufferType;
+	typename DisplayBufferType::DisplayMapMode	mapMode;
+
+	if (strcmp(inOptions.mapName, "direct") == 0)
+		mapMode = DisplayBufferType::DISPLAY_MAP_DIRECT;
+	else if (strcmp(inOptions.mapName, "linear") == 0)
+		mapMode = DisplayBufferType::DISPLAY_MAP_LINEAR;
+	else if (strcmp(inOptions.mapName, "gamma") == 0)
+		mapMode = DisplayBufferType::DISPLAY_MAP_GAMMA;
+	else if (strcmp(inOptions.mapName, "log") == 0)
+		mapMode = DisplayBufferType::DISPLAY_MAP_LOG;
+	else
+		return NULL;
+
+	return new ViewerImpl<ImageBufferType>(inIndex, inOptions.width, inOptions.height,
+					inFormat, mapMode, inMax, inOptions.isGuiMode);
+}
+// -----------------------------------------------------------------------------
+// createViewer
+// -----------------------------------------------------------------------------
+static Viewer	*createViewer(int inIndex, const LoadTestOptions &inOptions)
+{
+	typedef model::ImageBuffer<unsigned char>	U8;
+	typedef model::ImageBuffer<unsigned short>	U16;
+	typedef model::ImageBuffer<float>			F32;
+	const char	*format = inOptions.formatName;
+
+	if (strcmp(format, "u8_mono") == 0)
+		return createViewer<unsigned char>(inIndex, inOptions, U8::BUFFER_FORMAT_MONO, 255.0);
+	if (strcmp(format, "u8_bgr") == 0)
+		return createViewer<unsigned char>(inIndex, inOptions, U8::BUFFER_FORMAT_BGR, 255.0);
+	if (strcmp(format, "u8_bayer_rg") == 0)
+		return createViewer<unsigned char>(inIndex, inOptions, U8::BUFFER_FORMAT_BAYER_RG, 255.0);
+	if (strcmp(format, "u16_mono") == 0)
+		return createViewer<unsigned short>(inIndex, inOptions, U16::BUFFER_FORMAT_MONO, 65535.0);
+	if (strcmp(format, "u16_bayer_rg") == 0)
+		return createViewer<unsigned short>(inIndex, inOptions, U16::BUFFER_FORMAT_BAYER_RG, 4095.0);
+	if (strcmp(format, "f32_mono") == 0)
+		return createViewer<float>(inIndex, inOptions, F32::BUFFER_FORMAT_MONO, 1.0);
+	return NULL;
+}
+// -----------------------------------------------------------------------------
+// writeReport
+// -----------------------------------------------------------------------------
+static bool	writeReport(FILE *inFile, bool inIsJson, const LoadTestOptions &inOptions,
+				std::vector<Viewer *> &inViewers, double inElapsed, double inProcessCpuSec)
+{
+	std::vector<double>	allLatencies;
+	long long	produced = 0, displayed = 0, dropped = 0, overrun = 0;
+	double		threadCpuSec = 0;
+
+	if (inIsJson)
+	{
+		fprintf(inFile, "{\n");
+		fprintf(inFile, "  \"config\": {\"viewers\": %d, \"width\": %d, \"height\": %d, \"format\": \"%s\", "
+			"\"map\": \"%s\", \"fps\": %g, \"duration_s\": %g, \"gui\": %s, \"isa\": \"%s\", \"threads\": %d},\n",
+			inOptions.viewerNum, inOptions.width, inOptions.height, inOptions.formatName,
+			inOptions.mapName, inOptions.fps, inOptions.duration, inOptions.isGuiMode ? "true" : "false",
+			utils::CpuFeatures::getIsaName(utils::CpuFeatures::getIsa()),
+			utils::ThreadPool::getInstance().getThreadCount());
+		fprintf(inFile, "  \"viewers\": [\n");
+	}
+	else
+	{
+		fprintf(inFile, "%-6s %8s %9s %8s %8s %9s %9s %9s %9s %8s %8s\n",
+			"viewer", "produced", "displayed", "dropped", "overrun",
+			"p50 ms", "p90 ms", "p99 ms", "max ms", "prod %", "view %");
+	}
+
+	for (size_t i = 0; i < inViewers.size(); i++)
+	{
+		ViewerStats	stats = inViewers[i]->getStats();
+		std::sort(stats.latencies.begin(), stats.latencies.end());
+		allLatencies.insert(allLatencies.end(), stats.latencies.begin(), stats.latencies.end());
+		produced += stats.producedCount;
+		displayed += stats.displayedCount;
+		dropped += stats.droppedCount;
+		overrun += stats.overrunCount;
+		threadCpuSec += stats.producerCpuSec + stats.viewerCpuSec;
+
+		double	p50 = getPercentile(stats.latencies, 50) * 1e3;
+		double	p90 = getPercentile(stats.latencies, 90) * 1e3;
+		double	p99 = getPercentile(stats.latencies, 99) * 1e3;
+		double	pMax = stats.latencies.empty() ? 0 : stats.latencies.back() * 1e3;
+		double	prodCpu = stats.producerCpuSec / inElapsed * 100.0;
+		double	viewCpu = stats.viewerCpuSec / inElapsed * 100.0;
+		if (inIsJson)
+		{
+			fprintf(inFile, "    {\"index\": %d, \"produced\": %lld, \"displayed\": %lld, \"dropped\": %lld, "
+				"\"overrun\": %lld, \"latency_ms\": {\"p50\": %.4f, \"p90\": %.4f, \"p99\": %.4f, \"max\": %.4f}, "
+				"\"producer_cpu_pct\": %.2f, \"viewer_cpu_pct\": %.2f}%s\n",
+				(int )i, stats.producedCount, stats.displayedCount, stats.droppedCount, stats.overrunCount,
+				p50, p90, p99, pMax, prodCpu, viewCpu, (i + 1 < inViewers.size()) ? "," : "");
+		}
+		else
+		{
+			fprintf(inFile, "%-6d %8lld %9lld %8lld %8lld %9.3f %9.3f %9.3f %9.3f %8.1f %8.1f\n",
+				(int )i, stats.producedCount, stats.displayedCount, stats.droppedCount, stats.overrunCount,
+				p50, p90, p99, pMax, prodCpu, viewCpu);
+		}
+	}
+
+	// The view % covers the viewer thread only (with its own share of each
+	// parallelFor()). The ThreadPool workers serve every viewer, so their
+	// time can't be split per viewer and is reported once as what the
+	// process spent outside of the producer and viewer threads.
+	double	otherCpuSec = inProcessCpuSec - threadCpuSec;
+	if (otherCpuSec < 0)
+		otherCpuSec = 0;
+
+	std::sort(allLatencies.begin(), allLatencies.end());
+	double	dropRatio = (produced == 0) ? 0 : (double )dropped / (double )produced;
+	bool	isSustained = (dropped == 0 && overrun == 0);
+	if (inIsJson)
+	{
+		fprintf(inFile, "  ],\n");
+		fprintf(inFile, "  \"total\": {\"produced\": %lld, \"displayed\": %lld, \"dropped\": %lld, \"overrun\": %lld, "
+			"\"drop_ratio\": %.6f, \"latency_ms\": {\"p50\": %.4f, \"p90\": %.4f, \"p99\": %.4f, \"max\": %.4f}, "
+			"\"process_cpu_pct\": %.2f, \"pool_cpu_pct\": %.2f, \"elapsed_s\": %.3f, \"sustained\": %s}\n",
+			produced, displayed, dropped, overrun, dropRatio,
+			getPercentile(allLatencies, 50) * 1e3, getPercentile(allLatencies, 90) * 1e3,
+			getPercentile(allLatencies, 99) * 1e3, allLatencies.empty() ? 0 : allLatencies.back() * 1e3,
+			inProcessCpuSec / inElapsed * 100.0, otherCpuSec / inElapsed * 100.0,
+			inElapsed, isSustained ? "true" : "false");
+		fprintf(inFile, "}\n");
+	}
+	else
+	{
+		fprintf(inFile, "%-6s %8lld %9lld %8lld %8lld %9.3f %9.3f %9.3f %9.3f\n",
+			"total", produced, displayed, dropped, overrun,
+			getPercentile(allLatencies, 50) * 1e3, getPercentile(allLatencies, 90) * 1e3,
+			getPercentile(allLatencies, 99) * 1e3, allLatencies.empty() ? 0 : allLatencies.back() * 1e3);
+		fprintf(inFile, "process cpu %.1f %%, drop ratio %.4f, %s\n",
+			inProcessCpuSec / inElapsed * 100.0, dropRatio, isSustained ? "sustained" : "NOT sustained");
+		fprintf(inFile, "view %% excludes the %d ThreadPool workers, pool cpu (process - producers - viewers) %.1f %%\n",
+			utils::ThreadPool::getInstance().getThreadCount() - 1, otherCpuSec / inElapsed * 100.0);
+	}
+	return true;
+}
+// -----------------------------------------------------------------------------
+// printUsage
+// -----------------------------------------------------------------------------
+static void	printUsage()
+{
+	printf("usage: viw_loadtest [--viewers <n>] [--size <w>x<h>] [--format <format>]\n");
+	printf("                    [--map <mode>] [--fps <rate>] [--duration <seconds>]\n");
+	printf("                    [--threads <n>] [--json <file>] [--trace <file>] [--gui]\n");
+	printf("  format : u8_mono, u8_bgr, u8_bayer_rg, u16_mono, u16_bayer_rg, f32_mono\n");
+	printf("  mode   : direct, linear, gamma, log\n");
+}
+
+// -----------------------------------------------------------------------------
+// main
+// -----------------------------------------------------------------------------
+int	main(int argc, char *argv[])
+{
+	LoadTestOptions	options;
+	options.viewerNum = 4;
+	options.width = 1920;
+	options.height = 1080;
+	options.formatName = "u16_mono";
+	options.mapName = "linear";
+	options.fps = 60.0;
+	options.duration = 5.0;
+	options.threadCount = 0;
+	options.jsonFileName = NULL;
+	options.traceFileName = NULL;
+	options.isGuiMode = false;
+
+	for (int i = 1; i < argc; i++)
+	{
+		bool	hasValue = (i + 1 < argc);
+		if (strcmp(argv[i], "--viewers") == 0 && hasValue)
+			options.viewerNum = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--size") == 0 && hasValue &&
+				sscanf(argv[i + 1], "%dx%d", &options.width, &options.height) == 2)
+			i++;
+		else if (strcmp(argv[i], "--format") == 0 && hasValue)
+			options.formatName = argv[++i];
+		else if (strcmp(argv[i], "--map") == 0 && hasValue)
+			options.mapName = argv[++i];
+		else if (strcmp(argv[i], "--fps") == 0 && hasValue)
+			options.fps = atof(argv[++i]);
+		else if (strcmp(argv[i], "--duration") == 0 && hasValue)
+			options.duration = atof(argv[++i]);
+		else if (strcmp(argv[i], "--threads") == 0 && hasValue)
+			options.threadCount = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--json") == 0 && hasValue)
+			options.jsonFileName = argv[++i];
+		else if (strcmp(argv[i], "--trace") == 0 && hasValue)
+			options.traceFileName = argv[++i];
+		else if (strcmp(argv[i], "--gui") == 0)
+			options.isGuiMode = true;
+		else
+		{
+			printUsage();
+			return (strcmp(argv[i], "--help") == 0) ? 0 : 1;
+		}
+	}
+#ifndef _WIN32
+	if (options.isGuiMode)
+	{
+		fprintf(stderr, "--gui needs the Win32 ImageWindow, running headless\n");
+		options.isGuiMode = false;
+	}
+#endif
+#ifdef VIW_TRACE
+	if (options.traceFileName != NULL)
+		utils::Trace::setEnabled(true);
+#else
+	if (options.traceFileName != NULL)
+	{
+		fprintf(stderr, "--trace needs a build with VIW_TRACE defined\n");
+		options.traceFileName = NULL;
+	}
+#endif
+	if (options.viewerNum <= 0 || options.width <= 0 || options.height <= 0 ||
+		options.fps <= 0 || options.duration <= 0)
+	{
+		printUsage();
+		return 1;
+	}
+
+	utils::ThreadPool::getInstance().setThreadCount(options.threadCount);
+
+	std::vector<Viewer *>	viewers;
+	try
+	{
+		for (int i = 0; i < options.viewerNum; i++)
+		{
+			Viewer	*viewer = createViewer(i, options);
+			if (viewer == NULL)
+			{
+				fprintf(stderr, "unsupported format / map: %s / %s\n", options.formatName, options.mapName);
+				return 1;
+			}
+			viewers.push_back(viewer);
+		}
+	}
+
+	catch (ViwException &ex)
+	{
+		fprintf(stderr, "ViwException: %s\n", ex.getDescription());
+		return 1;
+	}
+
+	printf("%d viewers, %dx%d %s (%s) at %g fps for %g s, isa: %s, threads: %d%s\n",
+		options.viewerNum, options.width, options.height, options.formatName, options.mapName,
+		options.fps, options.duration,
+		utils::CpuFeatures::getIsaName(utils::CpuFeatures::getIsa()),
+		utils::ThreadPool::getInstance().getThreadCount(), options.isGuiMode ? ", gui" : "");
+
+	// producers start together, staggered by a fraction of a frame
+	double	startTime = getTime() + 0.1;
+	double	startCpu = getProcessCpuTime();
+	for (size_t i = 0; i < viewers.size(); i++)
+		viewers[i]->start(options.fps, startTime + (double )i / (options.fps * viewers.size()));
+
+	std::this_thread::sleep_for(std::chrono::duration<double>(startTime + options.duration - getTime()));
+	for (size_t i = 0; i < viewers.size(); i++)
+		viewers[i]->requestStop();
+	double	elapsed = getTime() - startTime;
+	double	processCpuSec = getProcessCpuTime() - startCpu;
+	for (size_t i = 0; i < viewers.size(); i++)
+		viewers[i]->waitForStop();
+
+	writeReport(stdout, false, options, viewers, elapsed, processCpuSec);
+	if (options.jsonFileName != NULL)
+	{
+		FILE	*fp = fopen(options.jsonFileName, "w");
+		if (fp == NULL)
+		{
+			fprintf(stderr, "can't open %s\n", options.jsonFileName);
+			return 1;
+		}
+		writeReport(fp, true, options, viewers, elapsed, processCpuSec);
+		fclose(fp);
+	}
+	if (options.traceFileName != NULL)
+	{
+		printf("\n");
+		utils::Trace::dumpHistograms(stdout);
+		if (utils::Trace::writeChromeTrace(options.traceFileName) == false)
+		{
+			fprintf(stderr, "can't write %s\n", options.traceFileName);
+			return 1;
+		}
+	}
+
+	for (size_t i = 0; i < viewers.size(); i++)
+		delete viewers[i];
+	return 0;
+}
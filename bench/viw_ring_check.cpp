@@ -0,0 +1,302 @@
+// =============================================================================
+//  viw_ring_check.cpp
+//
+//  Written in 2014 by Dairoku Sekiguchi (sekiguchi at acm dot org)
+//
+//  To the extent possible under law, the author(s) have dedicated all copyright
+//  and related and neighboring rights to this software to the public domain worldwide.
+//  This software is distributed without any warranty.
+//
+//  You should have received a copy of the CC0 Public Domain Dedication along with
+//  this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+// =============================================================================
+/*!
+	\file		viw_ring_check.cpp
+	\author		Dairoku Sekiguchi
+	\version	1.0.0
+	\date		2026/10/19
+	\brief		Two-process stress check of SharedFrameRing (POSIX only)
+
+	The process creates a ring and forks viewer processes that attach to
+	it by name. The producer then publishes frames as fast as it can, each
+	filled with a pattern derived from its frame number. Every viewer
+	checks that the frames it acquires carry the frame number of their
+	FrameInfo in every byte (a torn or overwritten slot shows up as a
+	mismatch), that the frame numbers only increase and that the frame is
+	still intact after it was held for a while. Before that it checks that
+	create() refuses the name of a stale ring unless asked to replace it.
+	Exits non-zero on the first failure.
+
+	viw_ring_check [--viewers <n>] [--frames <n>] [--size <w>x<h>]
+*/
+
+// Includes --------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "viw/utils/SharedFrameRing.hpp"
+
+using namespace viw;
+
+// Constatns -------------------------------------------------------------------
+const static double	VIEWER_TIMEOUT	= 60.0;		// seconds
+
+// Structs ---------------------------------------------------------------------
+struct	RingCheckOptions
+{
+	int				viewerNum;
+	long long		frameNum;
+	int				width;
+	int				height;
+};
+
+// Static Functions ------------------------------------------------------------
+// -----------------------------------------------------------------------------
+// getTime
+// -----------------------------------------------------------------------------
+static double	getTime()
+{
+	return std::chrono::duration<double>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+// -----------------------------------------------------------------------------
+// fillFrame
+// -----------------------------------------------------------------------------
+static void	fillFrame(unsigned char *outPtr, size_t inByteSize, long long inFrameNumber)
+{
+	::memcpy(outPtr, &inFrameNumber, sizeof(inFrameNumber));
+	for (size_t i = sizeof(inFrameNumber); i < inByteSize; i++)
+		outPtr[i] = (unsigned char )(inFrameNumber * 7 + i);
+}
+// -----------------------------------------------------------------------------
+// checkFrame
+// -----------------------------------------------------------------------------
+//	Returns the offset of the first wrong byte, -1 if the frame is intact
+static long long	checkFrame(const unsigned char *inPtr, size_t inByteSize, long long inFrameNumber)
+{
+	long long	frameNumber;
+	::memcpy(&frameNumber, inPtr, sizeof(frameNumber));
+	if (frameNumber != inFrameNumber)
+		return 0;
+	for (size_t i = sizeof(inFrameNumber); i < inByteSize; i++)
+		if (inPtr[i] != (unsigned char )(inFrameNumber * 7 + i))
+			return (long long )i;
+	return -1;
+}
+// -----------------------------------------------------------------------------
+// runViewer
+// -----------------------------------------------------------------------------
+//	Viewer process body, returns the exit code
+static int	runViewer(int inIndex, const char *inName, const RingCheckOptions &inOptions)
+{
+	utils::SharedFrameRing	ring;
+	if (ring.open(inName) == false)
+	{
+		fprintf(stderr, "viewer %d: can't open %s\n", inIndex, inName);
+		return 1;
+	}
+
+	size_t		frameByteSize = (size_t )inOptions.width * inOptions.height;
+	long long	lastFrameNumber = -1;
+	long long	checkCount = 0;
+	double		endTime = getTime() + VIEWER_TIMEOUT;
+	while (lastFrameNumber < inOptions.frameNum - 1)
+	{
+		if (getTime() > endTime)
+		{
+			fprintf(stderr, "viewer %d: timed out at frame %lld\n", inIndex, lastFrameNumber);
+			return 1;
+		}
+
+		utils::SharedFrameRing::FrameInfo	info;
+		bool	isNew;
+		const unsigned char	*ptr = (const unsigned char *)ring.acquireLatestFrame(&info, &isNew);
+		if (ptr == NULL || isNew == false)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+		if (info.frameNumber <= lastFrameNumber)
+		{
+			fprintf(stderr, "viewer %d: frame %lld after frame %lld\n",
+				inIndex, info.frameNumber, lastFrameNumber);
+			return 1;
+		}
+		lastFrameNumber = info.frameNumber;
+
+		// Check right away and again after the producer had time to reuse
+		// every other slot
+		for (int pass = 0; pass < 2; pass++)
+		{
+			long long	offset = checkFrame(ptr, frameByteSize, info.frameNumber);
+			if (offset >= 0)
+			{
+				fprintf(stderr, "viewer %d: frame %lld is broken at byte %lld (pass %d)\n",
+					inIndex, info.frameNumber, offset, pass);
+				return 1;
+			}
+			if (pass == 0 && (checkCount % 8) == (inIndex % 8))
+				std::this_thread::sleep_for(std::chrono::microseconds(200));
+		}
+		checkCount++;
+	}
+
+	printf("viewer %d: %lld frames checked, %lld skipped\n",
+		inIndex, ring.getAcquireCount(), ring.getSkipCount());
+	return 0;
+}
+// -----------------------------------------------------------------------------
+// checkNameReuse
+// -----------------------------------------------------------------------------
+//	A producer that exits without close() leaves its ring behind
+static bool	checkNameReuse(const char *inName)
+{
+	fflush(stdout);
+	pid_t	pid = fork();
+	if (pid < 0)
+	{
+		perror("fork");
+		return false;
+	}
+	if (pid == 0)
+	{
+		utils::SharedFrameRing	staleRing;
+		_exit(staleRing.create(inName, 2, 0, 16, 16, 1, 16) ? 0 : 1);
+	}
+	int	status;
+	if (waitpid(pid, &status, 0) != pid || WIFEXITED(status) == 0 || WEXITSTATUS(status) != 0)
+	{
+		fprintf(stderr, "can't create the stale ring %s\n", inName);
+		return false;
+	}
+
+	utils::SharedFrameRing	ring;
+	if (ring.create(inName, 2, 0, 16, 16, 1, 16))
+	{
+		fprintf(stderr, "create() took over the existing ring %s\n", inName);
+		return false;
+	}
+	if (ring.create(inName, 2, 0, 16, 16, 1, 16, true) == false)
+	{
+		fprintf(stderr, "create() can't replace the existing ring %s\n", inName);
+		return false;
+	}
+	return true;
+}
+// -----------------------------------------------------------------------------
+// printUsage
+// -----------------------------------------------------------------------------
+static void	printUsage()
+{
+	printf("viw_ring_check [--viewers <n>] [--frames <n>] [--size <w>x<h>]\n");
+}
+// -----------------------------------------------------------------------------
+// main
+// -----------------------------------------------------------------------------
+int	main(int argc, char *argv[])
+{
+	RingCheckOptions	options;
+	options.viewerNum = 3;
+	options.frameNum = 200000;
+	options.width = 256;
+	options.height = 64;
+
+	for (int i = 1; i < argc; i++)
+	{
+		bool	hasValue = (i + 1 < argc);
+		if (strcmp(argv[i], "--viewers") == 0 && hasValue)
+			options.viewerNum = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--frames") == 0 && hasValue)
+			options.frameNum = atoll(argv[++i]);
+		else if (strcmp(argv[i], "--size") == 0 && hasValue &&
+				sscanf(argv[i + 1], "%dx%d", &options.width, &options.height) == 2)
+			i++;
+		else
+		{
+			printUsage();
+			return (strcmp(argv[i], "--help") == 0) ? 0 : 1;
+		}
+	}
+	if (options.viewerNum <= 0 || options.frameNum <= 0 ||
+		options.width <= 0 || options.height <= 0 ||
+		(size_t )options.width * options.height < sizeof(long long))
+	{
+		printUsage();
+		return 1;
+	}
+
+	char	name[64];
+	sprintf(name, "/viw_ring_check_stale_%d", (int )getpid());
+	if (checkNameReuse(name) == false)
+	{
+		printf("FAILED\n");
+		return 1;
+	}
+	sprintf(name, "/viw_ring_check_%d", (int )getpid());
+
+	// Every viewer holds at most one slot, so viewer count + 2 slots never
+	// leave the producer without one
+	utils::SharedFrameRing	ring;
+	if (ring.create(name, options.viewerNum + 2, 0, options.width, options.height,
+					1, (size_t )options.width) == false)
+	{
+		fprintf(stderr, "can't create %s\n", name);
+		return 1;
+	}
+
+	fflush(stdout);
+	std::vector<pid_t>	pids;
+	for (int i = 0; i < options.viewerNum; i++)
+	{
+		pid_t	pid = fork();
+		if (pid < 0)
+		{
+			perror("fork");
+			break;
+		}
+		if (pid == 0)
+		{
+			// _exit() keeps the inherited producer object from unlinking the ring
+			int	result = runViewer(i, name, options);
+			fflush(stdout);
+			_exit(result);
+		}
+		pids.push_back(pid);
+	}
+
+	size_t		frameByteSize = (size_t )options.width * options.height;
+	long long	retryCount = 0;
+	double		startTime = getTime();
+	for (long long i = 0; i < options.frameNum && pids.size() == (size_t )options.viewerNum; i++)
+	{
+		unsigned char	*ptr;
+		while ((ptr = (unsigned char *)ring.beginWrite()) == NULL)
+		{
+			retryCount++;
+			std::this_thread::yield();
+		}
+		fillFrame(ptr, frameByteSize, ring.getPublishedCount());
+		ring.endWrite();
+	}
+	double	elapsed = getTime() - startTime;
+
+	bool	isOK = (pids.size() == (size_t )options.viewerNum);
+	for (size_t i = 0; i < pids.size(); i++)
+	{
+		int	status;
+		if (waitpid(pids[i], &status, 0) != pids[i] ||
+			WIFEXITED(status) == 0 || WEXITSTATUS(status) != 0)
+			isOK = false;
+	}
+
+	printf("producer: %lld frames in %.2f s, %lld slot waits (%lld dropped)\n",
+		ring.getPublishedCount(), elapsed, retryCount, ring.getProducerDropCount());
+	printf("%s\n", isOK ? "OK" : "FAILED");
+	return isOK ? 0 : 1;
+}
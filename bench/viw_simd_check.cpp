@@ -0,0 +1,485 @@
+// =============================================================================
+//  viw_simd_check.cpp
+//
+//  Written in 2014 by Dairoku Sekiguchi (sekiguchi at acm dot org)
+//
+//  To the extent possible under law, the author(s) have dedicated all copyright
+//  and related and neighboring rights to this software to the public domain worldwide.
+//  This software is distributed without any warranty.
+//
+//  You should have received a copy of the CC0 Public Domain Dedication along with
+//  this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+// =============================================================================
+/*!
+	\file		viw_simd_check.cpp
+	\author		Dairoku Sekiguchi
+	\version	1.0.0
+	\date		2026/10/19
+	\brief		Checks that every SIMD variant matches the scalar code (POSIX only)
+
+	The ISA is picked once per process from VIW_CPU_ISA, so the check runs
+	itself once per level (scalar, sse2, ssse3, avx2) with --dump. Each run
+	feeds the same pseudo random lines (odd widths, unaligned starts, so
+	every vector loop ends in a scalar tail) through the line kernels that
+	have SIMD variants and writes the results to a file. The results of
+	every level must be byte for byte equal to the scalar ones. Levels the
+	CPU doesn't have are skipped.
+
+	viw_simd_check [--dump <file>]
+*/
+
+// Includes --------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "viw/utils/CpuFeatures.hpp"
+#include "viw/utils/BitWindow.hpp"
+#include "viw/utils/Dither.hpp"
+#include "viw/utils/Swizzle.hpp"
+#include "viw/utils/PackedPixel.hpp"
+#include "viw/utils/Demosaic.hpp"
+#include "viw/utils/ToneMap.hpp"
+#include "viw/utils/Lut3D.hpp"
+
+using namespace viw;
+
+// Constatns -------------------------------------------------------------------
+const static int	LINE_WIDTHS[]	= {1, 2, 3, 5, 7, 9, 15, 17, 31, 33, 63, 65, 127, 129, 1021};
+const static int	LINE_WIDTH_NUM	= (int )(sizeof(LINE_WIDTHS) / sizeof(LINE_WIDTHS[0]));
+const static int	START_OFFSET	= 1;	// unaligned source and destination
+const static char	*ISA_NAMES[]	= {"scalar", "sse2", "ssse3", "avx2"};
+const static int	ISA_NUM			= (int )(sizeof(ISA_NAMES) / sizeof(ISA_NAMES[0]));
+
+// -----------------------------------------------------------------------------
+// CaseWriter class
+// -----------------------------------------------------------------------------
+//	Writes one record (name, byte size, bytes) per case
+class	CaseWriter
+{
+public:
+	CaseWriter(FILE *inFile)
+	{
+		mFile = inFile;
+	}
+	void	write(const std::string &inName, const void *inData, size_t inByteSize)
+	{
+		unsigned long long	byteSize = inByteSize;
+		fprintf(mFile, "%s", inName.c_str());
+		fputc(0, mFile);
+		fwrite(&byteSize, sizeof(byteSize), 1, mFile);
+		fwrite(inData, 1, inByteSize, mFile);
+	}
+
+protected:
+	FILE	*mFile;
+};
+
+// Static Functions ------------------------------------------------------------
+// -----------------------------------------------------------------------------
+// getRandom
+// -----------------------------------------------------------------------------
+//	Same sequence on every platform and in every run
+static unsigned int	getRandom()
+{
+	static unsigned long long	state = 0x2545F4914F6CDD1DULL;
+	state ^= state << 13;
+	state ^= state >> 7;
+	state ^= state << 17;
+	return (unsigned int )(state >> 32);
+}
+// -----------------------------------------------------------------------------
+// fillRandom
+// -----------------------------------------------------------------------------
+template <typename T> static void	fillRandom(std::vector<T> *outData, unsigned int inMask)
+{
+	for (size_t i = 0; i < outData->size(); i++)
+		(*outData)[i] = (T )(getRandom() & inMask);
+}
+// -----------------------------------------------------------------------------
+// fillRandomFloat
+// -----------------------------------------------------------------------------
+//	Values around [0, 1] with a few out of range ones and, if asked, NaN and
+//	infinities
+static void	fillRandomFloat(std::vector<float> *outData, bool inHasNonFinite)
+{
+	for (size_t i = 0; i < outData->size(); i++)
+	{
+		unsigned int	r = getRandom();
+		float			value = (float )(r & 0xFFFFFF) / (float )0xFFFFFF * 1.2f - 0.1f;
+		if (inHasNonFinite && (r >> 24) == 0)
+			value = NAN;
+		else if (inHasNonFinite && (r >> 24) == 1)
+			value = INFINITY;
+		else if (inHasNonFinite && (r >> 24) == 2)
+			value = -INFINITY;
+		(*outData)[i] = value;
+	}
+}
+// -----------------------------------------------------------------------------
+// getCaseName
+// -----------------------------------------------------------------------------
+static std::string	getCaseName(const char *inKernel, int inWidth, int inParam)
+{
+	char	buf[128];
+	sprintf(buf, "%s w=%d p=%d", inKernel, inWidth, inParam);
+	return buf;
+}
+// -----------------------------------------------------------------------------
+// checkBitWindow
+// -----------------------------------------------------------------------------
+static void	checkBitWindow(CaseWriter *ioWriter)
+{
+	for (int i = 0; i < LINE_WIDTH_NUM; i++)
+	{
+		int	width = LINE_WIDTHS[i];
+		std::vector<unsigned short>	src16(width + START_OFFSET);
+		std::vector<unsigned int>	src32(width + START_OFFSET);
+		std::vector<unsigned char>	dst(width + START_OFFSET);
+		fillRandom(&src16, 0xFFFF);
+		fillRandom(&src32, 0xFFFFFFFF);
+
+		for (int shift = 0; shift <= 8; shift++)
+		{
+			utils::BitWindow::extractLine(&src16[START_OFFSET], width, shift, &dst[START_OFFSET]);
+			ioWriter->write(getCaseName("bitwindow/u16", width, shift), &dst[START_OFFSET], width);
+		}
+		for (int shift = 0; shift <= 24; shift += 3)
+		{
+			utils::BitWindow::extractLine(&src32[START_OFFSET], width, shift, &dst[START_OFFSET]);
+			ioWriter->write(getCaseName("bitwindow/u32", width, shift), &dst[START_OFFSET], width);
+		}
+	}
+}
+// -----------------------------------------------------------------------------
+// checkDither
+// -----------------------------------------------------------------------------
+static void	checkDither(CaseWriter *ioWriter)
+{
+	const utils::Dither::DitherMode	modes[] = {utils::Dither::DITHER_NONE,
+		utils::Dither::DITHER_ORDERED, utils::Dither::DITHER_BLUE_NOISE};
+	float	thresholdRow[utils::Dither::THRESHOLD_ROW_SIZE];
+
+	for (int i = 0; i < LINE_WIDTH_NUM; i++)
+	{
+		int	width = LINE_WIDTHS[i];
+		std::vector<unsigned short>	src16(width + START_OFFSET);
+		std::vector<float>			srcFloat(width + START_OFFSET);
+		std::vector<unsigned char>	dst(width + START_OFFSET);
+		fillRandom(&src16, 0xFFFF);
+		fillRandomFloat(&srcFloat, false);
+
+		for (int m = 0; m < 3; m++)
+		{
+			utils::Dither::obtainThresholdRow(modes[m], i, thresholdRow);
+			utils::Dither::mapLineLinear(&src16[START_OFFSET], width, 1000.0f, 255.0f / 50000.0f,
+				thresholdRow, &dst[START_OFFSET]);
+			ioWriter->write(getCaseName("dither/u16", width, m), &dst[START_OFFSET], width);
+			utils::Dither::mapLineLinear(&srcFloat[START_OFFSET], width, 0.0f, 255.0f,
+				thresholdRow, &dst[START_OFFSET]);
+			ioWriter->write(getCaseName("dither/float", width, m), &dst[START_OFFSET], width);
+		}
+	}
+}
+// -----------------------------------------------------------------------------
+// checkSwizzle
+// -----------------------------------------------------------------------------
+static void	checkSwizzle(CaseWriter *ioWriter)
+{
+	for (int i = 0; i < LINE_WIDTH_NUM; i++)
+	{
+		int	width = LINE_WIDTHS[i];
+		for (int pixelSize = 3; pixelSize <= 4; pixelSize++)
+		{
+			std::vector<unsigned char>	src((width + START_OFFSET) * pixelSize);
+			std::vector<unsigned char>	dst((width + START_OFFSET) * pixelSize);
+			fillRandom(&src, 0xFF);
+			utils::Swizzle::swapRedBlueLine(&src[START_OFFSET], width, pixelSize, &dst[START_OFFSET]);
+			ioWriter->write(getCaseName("swizzle", width, pixelSize), &dst[START_OFFSET], width * pixelSize);
+		}
+	}
+}
+// -----------------------------------------------------------------------------
+// checkPackedPixel
+// -----------------------------------------------------------------------------
+static void	checkPackedPixel(CaseWriter *ioWriter)
+{
+	const utils::PackedPixel::PackingType	types[] = {utils::PackedPixel::PACKING_MONO10P,
+		utils::PackedPixel::PACKING_MONO12P, utils::PackedPixel::PACKING_MONO12_PACKED};
+
+	for (int i = 0; i < LINE_WIDTH_NUM; i++)
+	{
+		int	width = LINE_WIDTHS[i];
+		for (int t = 0; t < 3; t++)
+		{
+			size_t	srcByteSize = utils::PackedPixel::obtainLineByteSize(types[t], width);
+			std::vector<unsigned char>	src(srcByteSize + START_OFFSET);
+			std::vector<unsigned short>	dst(width + START_OFFSET);
+			fillRandom(&src, 0xFF);
+			utils::PackedPixel::unpackLine(types[t], &src[START_OFFSET], width, &dst[START_OFFSET]);
+			ioWriter->write(getCaseName("packedpixel", width, types[t]), &dst[START_OFFSET],
+				width * sizeof(unsigned short));
+		}
+	}
+}
+// -----------------------------------------------------------------------------
+// checkDemosaic
+// -----------------------------------------------------------------------------
+template <typename ImageBufferType>
+static void	checkDemosaic(CaseWriter *ioWriter, const char *inName, int inLutSize)
+{
+	const utils::Demosaic::BayerPattern	patterns[] = {utils::Demosaic::BAYER_PATTERN_RG,
+		utils::Demosaic::BAYER_PATTERN_GR, utils::Demosaic::BAYER_PATTERN_GB,
+		utils::Demosaic::BAYER_PATTERN_BG};
+	const utils::Demosaic::DemosaicMethod	methods[] = {utils::Demosaic::DEMOSAIC_BILINEAR,
+		utils::Demosaic::DEMOSAIC_EDGE_AWARE};
+	const int	height = 7;
+
+	std::vector<unsigned char>	lut(inLutSize * 3);
+	fillRandom(&lut, 0xFF);
+
+	for (int i = 0; i < LINE_WIDTH_NUM; i++)
+	{
+		int	width = LINE_WIDTHS[i];
+		std::vector<ImageBufferType>	src(width * height);
+		std::vector<unsigned char>		dst(width * height * 3);
+		fillRandom(&src, inLutSize - 1);
+
+		for (int p = 0; p < 4; p++)
+			for (int m = 0; m < 2; m++)
+			{
+				utils::Demosaic::demosaicToBGR(&src[0], width, height, patterns[p], methods[m],
+					&lut[0], inLutSize, &dst[0], width * 3, 0, height);
+				ioWriter->write(getCaseName(inName, width, p * 2 + m), &dst[0], dst.size());
+			}
+	}
+}
+// -----------------------------------------------------------------------------
+// checkToneMap
+// -----------------------------------------------------------------------------
+static void	checkToneMap(CaseWriter *ioWriter)
+{
+	const utils::ToneMap::ToneCurve	curves[] = {utils::ToneMap::TONE_CURVE_LINEAR,
+		utils::ToneMap::TONE_CURVE_LOG, utils::ToneMap::TONE_CURVE_SQRT,
+		utils::ToneMap::TONE_CURVE_GAMMA};
+	float	thresholdRow[utils::Dither::THRESHOLD_ROW_SIZE];
+
+	for (int i = 0; i < LINE_WIDTH_NUM; i++)
+	{
+		int	width = LINE_WIDTHS[i];
+		std::vector<float>			src(width + START_OFFSET);
+		std::vector<unsigned char>	dst(width + START_OFFSET);
+		fillRandomFloat(&src, true);
+		utils::Dither::obtainThresholdRow(utils::Dither::DITHER_BLUE_NOISE, i, thresholdRow);
+
+		for (int c = 0; c < 4; c++)
+			for (int marked = 0; marked < 2; marked++)
+			{
+				utils::ToneMap::Parameters	param = utils::ToneMap::obtainParameters(
+					curves[c], 0.0, 1.0, 2.2, marked != 0);
+				utils::ToneMap::mapLine(&src[START_OFFSET], width, param, thresholdRow, &dst[START_OFFSET]);
+				ioWriter->write(getCaseName("tonemap", width, c * 2 + marked), &dst[START_OFFSET], width);
+			}
+	}
+}
+// -----------------------------------------------------------------------------
+// checkLut3D
+// -----------------------------------------------------------------------------
+static void	checkLut3D(CaseWriter *ioWriter)
+{
+	const int	lutSize = 17;
+	const int	height = 3;
+
+	std::vector<float>	table(lutSize * lutSize * lutSize * 3);
+	fillRandomFloat(&table, false);
+	utils::Lut3D	lut;
+	lut.setTable(lutSize, &table[0]);
+
+	for (int i = 0; i < LINE_WIDTH_NUM; i++)
+	{
+		int	width = LINE_WIDTHS[i];
+		for (int pixelSize = 3; pixelSize <= 4; pixelSize++)
+		{
+			size_t	lineByteSize = (size_t )width * pixelSize + START_OFFSET;
+			std::vector<unsigned char>	src(lineByteSize * height + START_OFFSET);
+			std::vector<unsigned char>	dst(lineByteSize * height + START_OFFSET);
+			fillRandom(&src, 0xFF);
+			lut.applyToLines(&src[START_OFFSET], lineByteSize, &dst[START_OFFSET], lineByteSize,
+				width, pixelSize, 0, height);
+			for (int y = 0; y < height; y++)
+				ioWriter->write(getCaseName("lut3d", width, pixelSize * 10 + y),
+					&dst[START_OFFSET + lineByteSize * y], width * pixelSize);
+		}
+	}
+}
+// -----------------------------------------------------------------------------
+// writeDump
+// -----------------------------------------------------------------------------
+static int	writeDump(const char *inFileName)
+{
+	FILE	*fp = fopen(inFileName, "wb");
+	if (fp == NULL)
+	{
+		fprintf(stderr, "can't open %s\n", inFileName);
+		return 1;
+	}
+
+	// The first record tells the parent which level really ran
+	const char	*isaName = utils::CpuFeatures::getIsaName(utils::CpuFeatures::getIsa());
+	CaseWriter	writer(fp);
+	writer.write("isa", isaName, strlen(isaName));
+	checkBitWindow(&writer);
+	checkDither(&writer);
+	checkSwizzle(&writer);
+	checkPackedPixel(&writer);
+	checkDemosaic<unsigned char>(&writer, "demosaic/u8", 256);
+	checkDemosaic<unsigned short>(&writer, "demosaic/u16", 65536);
+	checkToneMap(&writer);
+	checkLut3D(&writer);
+	return (fclose(fp) == 0) ? 0 : 1;
+}
+// -----------------------------------------------------------------------------
+// readRecord
+// -----------------------------------------------------------------------------
+static bool	readRecord(FILE *inFile, std::string *outName, std::vector<unsigned char> *outData)
+{
+	int	c;
+	outName->clear();
+	while ((c = fgetc(inFile)) != EOF && c != 0)
+		outName->push_back((char )c);
+	if (c == EOF)
+		return false;
+
+	unsigned long long	byteSize;
+	if (fread(&byteSize, sizeof(byteSize), 1, inFile) != 1)
+		return false;
+	outData->resize((size_t )byteSize);
+	return (byteSize == 0 || fread(&(*outData)[0], 1, (size_t )byteSize, inFile) == byteSize);
+}
+// -----------------------------------------------------------------------------
+// runDump
+// -----------------------------------------------------------------------------
+//	Runs this program with VIW_CPU_ISA=inIsaName and --dump inFileName
+static bool	runDump(const char *inProgram, const char *inIsaName, const char *inFileName)
+{
+	fflush(stdout);
+	pid_t	pid = fork();
+	if (pid < 0)
+	{
+		perror("fork");
+		return false;
+	}
+	if (pid == 0)
+	{
+		setenv("VIW_CPU_ISA", inIsaName, 1);
+		execl(inProgram, inProgram, "--dump", inFileName, (char *)NULL);
+		perror("execl");
+		_exit(1);
+	}
+
+	int	status;
+	return (waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+// -----------------------------------------------------------------------------
+// compareDump
+// -----------------------------------------------------------------------------
+//	Returns the number of cases that differ from the scalar dump, -1 if the
+//	level was not available
+static int	compareDump(const char *inScalarFileName, const char *inFileName, const char *inIsaName)
+{
+	FILE	*scalarFp = fopen(inScalarFileName, "rb");
+	FILE	*fp = fopen(inFileName, "rb");
+	if (scalarFp == NULL || fp == NULL)
+	{
+		if (scalarFp != NULL)
+			fclose(scalarFp);
+		if (fp != NULL)
+			fclose(fp);
+		fprintf(stderr, "can't open the dump files\n");
+		return 1;
+	}
+
+	std::string					scalarName, name;
+	std::vector<unsigned char>	scalarData, data;
+	int	caseNum = 0;
+	int	errorNum = 0;
+	if (readRecord(fp, &name, &data) == false || name != "isa" ||
+		std::string(data.begin(), data.end()) != inIsaName)
+	{
+		printf("%-8s not available, skipped\n", inIsaName);
+		fclose(scalarFp);
+		fclose(fp);
+		return -1;
+	}
+	readRecord(scalarFp, &scalarName, &scalarData);
+
+	while (readRecord(scalarFp, &scalarName, &scalarData))
+	{
+		caseNum++;
+		if (readRecord(fp, &name, &data) == false || name != scalarName)
+		{
+			printf("%-8s %s: case missing\n", inIsaName, scalarName.c_str());
+			errorNum++;
+			break;
+		}
+		if (data == scalarData)
+			continue;
+
+		size_t	offset = 0;
+		while (offset < data.size() && offset < scalarData.size() && data[offset] == scalarData[offset])
+			offset++;
+		if (offset < data.size() && offset < scalarData.size())
+			printf("%-8s %s: byte %d is %d, scalar %d\n", inIsaName, name.c_str(),
+				(int )offset, data[offset], scalarData[offset]);
+		else
+			printf("%-8s %s: size %d, scalar %d\n", inIsaName, name.c_str(),
+				(int )data.size(), (int )scalarData.size());
+		errorNum++;
+	}
+	fclose(scalarFp);
+	fclose(fp);
+
+	printf("%-8s %d cases, %d differ from scalar\n", inIsaName, caseNum, errorNum);
+	return errorNum;
+}
+// -----------------------------------------------------------------------------
+// main
+// -----------------------------------------------------------------------------
+int	main(int argc, char *argv[])
+{
+	if (argc == 3 && strcmp(argv[1], "--dump") == 0)
+		return writeDump(argv[2]);
+	if (argc != 1)
+	{
+		printf("viw_simd_check [--dump <file>]\n");
+		return (argc == 2 && strcmp(argv[1], "--help") == 0) ? 0 : 1;
+	}
+
+	char	fileNames[ISA_NUM][64];
+	for (int i = 0; i < ISA_NUM; i++)
+	{
+		sprintf(fileNames[i], "viw_simd_check_%d_%s.bin", (int )getpid(), ISA_NAMES[i]);
+		if (runDump(argv[0], ISA_NAMES[i], fileNames[i]) == false)
+		{
+			fprintf(stderr, "the %s run failed\n", ISA_NAMES[i]);
+			for (int j = 0; j <= i; j++)
+				remove(fileNames[j]);
+			return 1;
+		}
+	}
+
+	bool	isOK = true;
+	for (int i = 1; i < ISA_NUM; i++)
+		if (compareDump(fileNames[0], fileNames[i], ISA_NAMES[i]) > 0)
+			isOK = false;
+	for (int i = 0; i < ISA_NUM; i++)
+		remove(fileNames[i]);
+
+	printf("%s\n", isOK ? "OK" : "FAILED");
+	return isOK ? 0 : 1;
+}
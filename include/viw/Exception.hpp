@@ -31,7 +31,11 @@
 #define VIW_EXCEPT_AT_STRINGIFY(x)		#x
 #define VIW_EXCEPT_AT_TOSTRING(x)		VIW_EXCEPT_AT_STRINGIFY(x)
 #define VIW_EXCEPTION_AT				__FILE__ ":" VIW_EXCEPT_AT_TOSTRING(__LINE__)
+#ifdef _MSC_VER
 #define	VIW_EXCEPTION_LOCATION_MACRO	__FUNCTION__ "  (" VIW_EXCEPTION_AT ")"
+#else	// __FUNCTION__ is not a string literal on GCC / Clang
+#define	VIW_EXCEPTION_LOCATION_MACRO	VIW_EXCEPTION_AT
+#endif
 
 
 // Namespace -------------------------------------------------------------------
@@ -27,8 +27,12 @@
 // Includes --------------------------------------------------------------------
 #include "viw/SDIWindow.hpp"
 #include "viw/model/BitmapBuffer.hpp"
+#include "viw/model/SnapshotRing.hpp"
+#include "viw/utils/FrameTiming.hpp"
+#include "viw/utils/RepaintScheduler.hpp"
 #include <math.h>
 #include <typeinfo.h>
+#include <atomic>
 
 
 // Namespace -------------------------------------------------------------------
@@ -42,6 +46,10 @@ namespace viw
 			public model::BitmapBuffer<ImageBufferType>
 	{
 	public:
+		// Typedefs ------------------------------------------------------------
+		typedef model::SnapshotRing<ImageBufferType>	SnapshotRingType;
+		typedef typename model::BitmapBuffer<ImageBufferType>::BufferFormat	BufferFormat;
+
 		// Constatns -----------------------------------------------------------
 		enum CursorMode
 		{
@@ -55,7 +63,7 @@ namespace viw
 		//	ImageWindow
 		// ---------------------------------------------------------------------
 		ImageWindow()
-			: SDIWindow()
+			: SDIWindow(), mFrameTiming(FPS_DATA_NUM), mDisplayTiming(FPS_DATA_NUM)
 		{
 			mArrowCursor			= NULL;
 			mScrollCursor			= NULL;
@@ -78,13 +86,16 @@ namespace viw
 
 			mDrawOverlayFunc		= NULL;
 			mOverlayFuncData		= NULL;
+			mPixelReadoutFunc		= NULL;
+			mPixelReadoutFuncData	= NULL;
 
-			mFPSValue				= 0;
-			::ZeroMemory(&mFPSData, sizeof(mFPSData));
-			mFPSDataCount			= 0;
+			mRefreshRate			= 0;
+			mFPSStatusTick			= 0;
+			mFrozenFrameIndex		= 0;
+			mLiveFrame.store(NULL);
 
-			mFrequency				= 0;
-			mPrevCount				= 0;
+			// drawing, mapping and dispatch are traced with the same key
+			this->setTraceContext(static_cast<SDIWindow *>(this));
 
 			mMutexHandle = ::CreateMutex(NULL, false, NULL);
 			if (mMutexHandle == NULL)
@@ -103,10 +114,49 @@ namespace viw
 		// ---------------------------------------------------------------------
 		// updateImage
 		// ---------------------------------------------------------------------
+		//	May be called for every produced frame, the window repaints at
+		//	most at the refresh rate and then shows the newest frame. While
+		//	the image is not visible nothing is mapped or painted, the newest
+		//	frame is shown when it becomes visible again.
 		void	updateImage()
 		{
-			updateFPS();
-			updateImageView();
+			if (mWindowState != WINDOW_OPEN_STATE)
+				return;
+
+			mFrameTiming.addFrame();
+			if (isImageViewVisible() == false)
+			{
+				mRepaintScheduler.markPending();
+				return;
+			}
+			if (mRepaintScheduler.submitFrame())
+				updateImageView();
+		}
+		// ---------------------------------------------------------------------
+		// isImageViewVisible
+		// ---------------------------------------------------------------------
+		bool	isImageViewVisible()
+		{
+			if (isWindowVisible() == false)
+				return false;
+			return (mImageViewSize.cx > 0 && mImageViewSize.cy > 0);
+		}
+		// ---------------------------------------------------------------------
+		// lockImageBuffer
+		// ---------------------------------------------------------------------
+		//	Held by the paint while the image is drawn. Take it to point the
+		//	window to another buffer from a thread other than the window's
+		//	(e.g. after MosaicBuffer::composeMosaic() swapped its buffers).
+		bool	lockImageBuffer()
+		{
+			return (::WaitForSingleObject(mMutexHandle, INFINITE) == WAIT_OBJECT_0);
+		}
+		// ---------------------------------------------------------------------
+		// unlockImageBuffer
+		// ---------------------------------------------------------------------
+		void	unlockImageBuffer()
+		{
+			::ReleaseMutex(mMutexHandle);
 		}
 
 		// ---------------------------------------------------------------------
@@ -246,15 +296,208 @@ namespace viw
 			mDrawOverlayFunc = inFunc;
 			mOverlayFuncData = inFuncData;
 		}
+		// ---------------------------------------------------------------------
+		// setPixelReadoutFunc
+		// ---------------------------------------------------------------------
+		//	Formats the status bar text for image position (x, y) instead of
+		//	the default readout, returns false when there is nothing to show
+		//	(e.g. MosaicBuffer::pixelReadoutFunc)
+		void	setPixelReadoutFunc(bool (*inFunc)(int, int, char *, size_t, void *), void *inFuncData)
+		{
+			mPixelReadoutFunc = inFunc;
+			mPixelReadoutFuncData = inFuncData;
+		}
+		// ---------------------------------------------------------------------
+		// getFrameTimingStats
+		// ---------------------------------------------------------------------
+		//	Rate of updateImage() calls over the last FPS_DATA_NUM frames,
+		//	may be polled from any thread
+		bool	getFrameTimingStats(utils::FrameTiming::Stats *outStats)
+		{
+			return mFrameTiming.getStats(outStats);
+		}
+		// ---------------------------------------------------------------------
+		// getDisplayTimingStats
+		// ---------------------------------------------------------------------
+		//	Rate of the repaints that showed a new frame
+		bool	getDisplayTimingStats(utils::FrameTiming::Stats *outStats)
+		{
+			return mDisplayTiming.getStats(outStats);
+		}
+		// ---------------------------------------------------------------------
+		// setRefreshRate
+		// ---------------------------------------------------------------------
+		//	Upper limit of the repaint rate, 0 : the rate of the monitor
+		void	setRefreshRate(double inRate)
+		{
+			mRefreshRate = inRate;
+			if (mWindowState == WINDOW_OPEN_STATE)
+				::PostMessage(mWindowH, WM_TIMER, (WPARAM )REFRESH_RATE_TIMER_ID, 0);
+		}
+		// ---------------------------------------------------------------------
+		// getRefreshRate
+		// ---------------------------------------------------------------------
+		double	getRefreshRate()
+		{
+			return mRepaintScheduler.getRate();
+		}
+		// ---------------------------------------------------------------------
+		// beginFrame
+		// ---------------------------------------------------------------------
+		//	Live frames given through beginFrame() and commitFrame() (written
+		//	in place) or pushFrame() (copied) are kept in the snapshot ring,
+		//	so the window can freeze and step back through them. Producer
+		//	thread only, it never waits for the paint: the newest frame is
+		//	handed over and the paint switches to it.
+		ImageBufferType	*beginFrame(int inWidth, int inHeight, BufferFormat inFormat, bool inIsBottomUp = false)
+		{
+			return mSnapshotRing.beginFrame(inWidth, inHeight, inFormat, inIsBottomUp);
+		}
+		// ---------------------------------------------------------------------
+		// commitFrame
+		// ---------------------------------------------------------------------
+		//	Shows the frame written after beginFrame(), unless frozen
+		void	commitFrame()
+		{
+			showLiveFrame(mSnapshotRing.commitFrame());
+		}
+		// ---------------------------------------------------------------------
+		// pushFrame
+		// ---------------------------------------------------------------------
+		void	pushFrame(const ImageBufferType *inImagePtr, int inWidth, int inHeight,
+						BufferFormat inFormat, bool inIsBottomUp = false)
+		{
+			showLiveFrame(mSnapshotRing.pushFrame(inImagePtr, inWidth, inHeight, inFormat, inIsBottomUp));
+		}
+		// ---------------------------------------------------------------------
+		// setSnapshotBudget
+		// ---------------------------------------------------------------------
+		//	Memory for the kept frames, SnapshotRing::DEFAULT_MEMORY_BUDGET
+		//	by default
+		void	setSnapshotBudget(size_t inByteSize)
+		{
+			mSnapshotRing.setMemoryBudget(inByteSize);
+		}
+		// ---------------------------------------------------------------------
+		// getSnapshotRing
+		// ---------------------------------------------------------------------
+		SnapshotRingType	&getSnapshotRing()
+		{
+			return mSnapshotRing;
+		}
+		// ---------------------------------------------------------------------
+		// freeze
+		// ---------------------------------------------------------------------
+		//	Stops showing new frames, the producer keeps running and its
+		//	frames are dropped until unfreeze(). Save Image As saves the
+		//	frame being shown.
+		void	freeze()
+		{
+			if (lockImageBuffer() == false)
+				return;
+			bool	isFrozenBefore = mSnapshotRing.isFrozen();
+			if (isFrozenBefore == false)
+			{
+				// the newest frame, even if it was not painted yet
+				mSnapshotRing.freeze();
+				setFrameBufferPtr(mSnapshotRing.getFrame(0));
+			}
+			unlockImageBuffer();
+			if (isFrozenBefore)
+				return;
+
+			mFrozenFrameIndex = 0;
+			if (mWindowState == WINDOW_OPEN_STATE)
+				updateImageView();
+			updateFreezeStatus();
+		}
+		// ---------------------------------------------------------------------
+		// unfreeze
+		// ---------------------------------------------------------------------
+		void	unfreeze()
+		{
+			if (lockImageBuffer() == false)
+				return;
+			bool	isFrozenBefore = mSnapshotRing.isFrozen();
+			if (isFrozenBefore)
+			{
+				// The newest frame stays valid for the next commits
+				setFrameBufferPtr(mSnapshotRing.getFrame(0));
+				mSnapshotRing.unfreeze();
+			}
+			unlockImageBuffer();
+			if (isFrozenBefore == false)
+				return;
+
+			mFrozenFrameIndex = 0;
+			if (mWindowState == WINDOW_OPEN_STATE)
+				updateImageView();
+			updateFreezeStatus();
+		}
+		// ---------------------------------------------------------------------
+		// isFrozen
+		// ---------------------------------------------------------------------
+		bool	isFrozen()
+		{
+			return mSnapshotRing.isFrozen();
+		}
+		// ---------------------------------------------------------------------
+		// showFrozenFrame
+		// ---------------------------------------------------------------------
+		//	Shows the inBack th frame before the newest one while frozen
+		bool	showFrozenFrame(int inBack)
+		{
+			if (lockImageBuffer() == false)
+				return false;
+			bool	isShown = (mSnapshotRing.isFrozen() &&
+							setFrameBufferPtr(mSnapshotRing.getFrame(inBack)));
+			unlockImageBuffer();
+			if (isShown == false)
+				return false;
+
+			mFrozenFrameIndex = inBack;
+			if (mWindowState == WINDOW_OPEN_STATE)
+			{
+				updateImageView();
+				updateFreezeStatus();
+			}
+			return true;
+		}
+		// ---------------------------------------------------------------------
+		// stepFrozenFrame
+		// ---------------------------------------------------------------------
+		//	inStep > 0 : older frames, inStep < 0 : newer frames
+		bool	stepFrozenFrame(int inStep)
+		{
+			int	index = mFrozenFrameIndex + inStep;
+			int	frameNum = mSnapshotRing.getFrameNum();
+			if (index >= frameNum)
+				index = frameNum - 1;
+			if (index < 0)
+				index = 0;
+			if (index == mFrozenFrameIndex)
+				return false;
+			return showFrozenFrame(index);
+		}
+		// ---------------------------------------------------------------------
+		// getFrozenFrameIndex
+		// ---------------------------------------------------------------------
+		int	getFrozenFrameIndex()
+		{
+			return mFrozenFrameIndex;
+		}
 
 	protected:
 		// Constatns -----------------------------------------------------------
 		const static int	IMAGE_FILE_NAME_BUF_LEN		= 256;
 		const static int	IMAGE_STR_BUF_SIZE			= 256;
-		const static int	FPS_DATA_NUM				= 25;
+		const static int	FPS_DATA_NUM				= 120;
 		const static int	IMAGE_PALLET_SIZE_8BIT		= 256;
 		const static int	IMAGE_ZOOM_STEP				= 1;
 		const static int	MOUSE_WHEEL_STEP			= 60;
+		const static int	REPAINT_TIMER_ID			= 1;
+		const static int	REFRESH_RATE_TIMER_ID		= 2;		// posted only
+		const static int	FPS_STATUS_INTERVAL_MS		= 250;
 
 		enum MenuEventSubID
 		{
@@ -298,13 +541,18 @@ namespace viw
 
 		void				(*mDrawOverlayFunc)(HDC, void *);
 		void				*mOverlayFuncData;
+		bool				(*mPixelReadoutFunc)(int, int, char *, size_t, void *);
+		void				*mPixelReadoutFuncData;
 
-		double				mFPSValue;
-		double				mFPSData[FPS_DATA_NUM];
-		int					mFPSDataCount;
+		utils::FrameTiming	mFrameTiming;			// produced frames
+		utils::FrameTiming	mDisplayTiming;			// painted frames
+		utils::RepaintScheduler	mRepaintScheduler;
+		double				mRefreshRate;
+		DWORD				mFPSStatusTick;
 
-		unsigned __int64	mFrequency;
-		unsigned __int64	mPrevCount;
+		SnapshotRingType	mSnapshotRing;
+		int					mFrozenFrameIndex;
+		std::atomic<typename SnapshotRingType::Frame *>	mLiveFrame;	// newest, not shown yet
 
 
 		// Member Functions ----------------------------------------------------
@@ -366,7 +614,11 @@ namespace viw
 		// ---------------------------------------------------------------------
 		virtual bool	onSIDM_FREEZE(UINT inMessage, WPARAM inWParam, LPARAM inLParam, LRESULT *outResult)
 		{
-			return false;
+			if (isFrozen())
+				unfreeze();
+			else
+				freeze();
+			return true;
 		}
 		// ---------------------------------------------------------------------
 		//	onSIDM_SCROLL_TOOL
@@ -448,9 +700,10 @@ namespace viw
 		// ---------------------------------------------------------------------
 		virtual bool	onWM_SIZE(UINT inMessage, WPARAM inWParam, LPARAM inLParam, LRESULT *outResult)
 		{
-			SDIWindow::onWM_SIZE(inMessage, inWParam, inLParam, outResult);
-
+			// the view rect first, a visibility change repaints with it
+			layoutBars(inMessage, inWParam, inLParam);
 			updateImageViewRect();
+			updateWindowVisibility();
 			if (::GetKeyState(VK_SHIFT) < 0)
 			{
 				fitViewScaleToWindowSize();
@@ -464,6 +717,43 @@ namespace viw
 			return true;
 		}
 		// ---------------------------------------------------------------------
+		// onWM_TIMER
+		// ---------------------------------------------------------------------
+		virtual bool	onWM_TIMER(UINT inMessage, WPARAM inWParam, LPARAM inLParam, LRESULT *outResult)
+		{
+			if (inWParam == REFRESH_RATE_TIMER_ID)
+			{
+				updateRefreshRate();
+				return true;
+			}
+			if (inWParam != REPAINT_TIMER_ID)
+				return false;
+
+			if (isImageViewVisible() && mRepaintScheduler.flushPending())
+				updateImageView();
+
+			DWORD	tick = ::GetTickCount();
+			if (tick - mFPSStatusTick >= FPS_STATUS_INTERVAL_MS)
+			{
+				mFPSStatusTick = tick;
+				updateWindowVisibility();
+				if (isWindowVisible())
+					updateFPS();
+			}
+			return true;
+		}
+		// ---------------------------------------------------------------------
+		// onWindowVisibilityChanged
+		// ---------------------------------------------------------------------
+		//	The repaint timer slows down to the visibility check while the
+		//	window is not visible
+		virtual void	onWindowVisibilityChanged(bool inIsVisible)
+		{
+			updateRefreshRate();
+			if (inIsVisible && mRepaintScheduler.isPending())
+				updateImageView();
+		}
+		// ---------------------------------------------------------------------
 		// onWM_PAINT
 		// ---------------------------------------------------------------------
 		virtual bool	onWM_PAINT(UINT inMessage, WPARAM inWParam, LPARAM inLParam, LRESULT *outResult)
@@ -475,9 +765,27 @@ namespace viw
 			if (result != WAIT_OBJECT_0)
 				return true;
 
+			// something was exposed
+			if (isWindowVisible() == false)
+				updateWindowVisibility();
+
+			// the frame is mapped by drawImage(), only if it is a new one
+			adoptLiveFrame();
+			bool	isNewFrame = isImageModified();
 			PAINTSTRUCT	paintstruct;
 			HDC	hdc = ::BeginPaint(mWindowH, &paintstruct);
-			drawImage(hdc);
+			if (isWindowVisible() || isDisplayUpdateNeeded() == false)
+			{
+				drawImage(hdc);
+				if (isNewFrame)
+					mDisplayTiming.addFrame();
+			}
+			else
+			{
+				// not mapped while it can't be seen, the buffer stays
+				// modified and is painted when the window shows again
+				mRepaintScheduler.markPending();
+			}
 			ReleaseMutex(mMutexHandle);
 			EndPaint(mWindowH, &paintstruct);
 			return true;
@@ -499,6 +807,14 @@ namespace viw
 				case VK_SHIFT:
 					updateMouseCursor();
 					break;
+				case VK_LEFT:
+					if (isFrozen())
+						stepFrozenFrame(1);
+					break;
+				case VK_RIGHT:
+					if (isFrozen())
+						stepFrozenFrame(-1);
+					break;
 			}
 			return true;
 		}
@@ -539,6 +855,9 @@ namespace viw
 				case '=':
 					setViewScale(100);
 					return true;
+				case ' ':
+					onSIDM_FREEZE(inMessage, inWParam, inLParam, outResult);
+					return true;
 			}
 
 			if (SDIWindow::onWM_CHAR(inMessage, inWParam, inLParam, outResult))
@@ -982,11 +1301,8 @@ namespace viw
 		// ---------------------------------------------------------------------
 		void	initFPS()
 		{
-			::QueryPerformanceFrequency((LARGE_INTEGER *)&mFrequency);
-			::QueryPerformanceCounter((LARGE_INTEGER *)&mPrevCount);
-
-			mFPSValue = 0;
-			mFPSDataCount = 0;
+			mFrameTiming.reset();
+			mDisplayTiming.reset();
 		}
 		// ---------------------------------------------------------------------
 		// updateFPS
@@ -996,33 +1312,84 @@ namespace viw
 			if (mWindowState != WINDOW_OPEN_STATE || getBitmapInfoPtr() == NULL)
 				return;
 		
-			unsigned __int64	currentCount;
-			::QueryPerformanceCounter((LARGE_INTEGER *)&currentCount);
-
-			mFPSValue = 1.0 * (double )mFrequency / (double )(currentCount - mPrevCount);
-			mPrevCount = currentCount;
-		
-			if (mFPSDataCount < FPS_DATA_NUM)
-				mFPSDataCount++;
-			else
-				::MoveMemory(mFPSData, &(mFPSData[1]), sizeof(double) * (FPS_DATA_NUM - 1));	
-			mFPSData[mFPSDataCount - 1] = mFPSValue;
-
-			double	averageValue = 0;
-			for (int i = 0; i < mFPSDataCount; i++)
-				averageValue += mFPSData[i];
-			averageValue /= mFPSDataCount;
+			double	fpsValue = mFrameTiming.getAverageFPS();
+			double	displayValue = mDisplayTiming.getAverageFPS();
 
 	#ifdef _UNICODE
 			wchar_t	buf[IMAGE_STR_BUF_SIZE];
 
-			swprintf_s(buf, IMAGE_STR_BUF_SIZE, TEXT("FPS: %.1f (avg.=%.1f)"), mFPSValue, averageValue);
+			swprintf_s(buf, IMAGE_STR_BUF_SIZE, TEXT("FPS: %.1f (disp.=%.1f)"), fpsValue, displayValue);
 			SendMessage(mStatusbarH, SB_SETTEXT, (WPARAM )3, (LPARAM )buf);
 	#else
 			char	buf[IMAGE_STR_BUF_SIZE];
 
-			sprintf_s(buf, IMAGE_STR_BUF_SIZE, TEXT("FPS: %.1f (avg.=%.1f)"), mFPSValue, averageValue);
+			sprintf_s(buf, IMAGE_STR_BUF_SIZE, TEXT("FPS: %.1f (disp.=%.1f)"), fpsValue, displayValue);
 			SendMessage(mStatusbarH, SB_SETTEXT, (WPARAM )3, (LPARAM )buf);
+	#endif
+		}
+		// ---------------------------------------------------------------------
+		// showLiveFrame
+		// ---------------------------------------------------------------------
+		//	Producer thread, inFrame is NULL while frozen. Hands the frame
+		//	over to the paint, which switches to it in adoptLiveFrame().
+		void	showLiveFrame(typename SnapshotRingType::Frame *inFrame)
+		{
+			if (inFrame == NULL)
+				return;
+
+			mLiveFrame.store(inFrame);
+			updateImage();
+		}
+		// ---------------------------------------------------------------------
+		// adoptLiveFrame
+		// ---------------------------------------------------------------------
+		//	Called with mMutexHandle held. A frame handed over before a
+		//	freeze() is dropped, the frozen frame stays.
+		void	adoptLiveFrame()
+		{
+			typename SnapshotRingType::Frame	*frame = mLiveFrame.exchange(NULL);
+			if (frame == NULL || mSnapshotRing.isFrozen())
+				return;
+			setFrameBufferPtr(frame);
+		}
+		// ---------------------------------------------------------------------
+		// setFrameBufferPtr
+		// ---------------------------------------------------------------------
+		//	Called with mMutexHandle held, drops any frame not shown yet
+		bool	setFrameBufferPtr(typename SnapshotRingType::Frame *inFrame)
+		{
+			mLiveFrame.store(NULL);
+			if (inFrame == NULL)
+				return false;
+			return setImageBufferPtr(inFrame->getWidth(), inFrame->getHeight(),
+				inFrame->getImageBufferPtr(), inFrame->getBufferFormat(), inFrame->isBottomUp());
+		}
+		// ---------------------------------------------------------------------
+		// updateFreezeStatus
+		// ---------------------------------------------------------------------
+		void	updateFreezeStatus()
+		{
+			if (mWindowState != WINDOW_OPEN_STATE)
+				return;
+
+			bool	isFrozenNow = isFrozen();
+			if (mMenuH != NULL)
+				::CheckMenuItem(mMenuH, SIDM_FREEZE, isFrozenNow ? MF_CHECKED : MF_UNCHECKED);
+
+	#ifdef _UNICODE
+			wchar_t	buf[IMAGE_STR_BUF_SIZE] = TEXT("");
+
+			if (isFrozenNow)
+				swprintf_s(buf, IMAGE_STR_BUF_SIZE, TEXT("Frozen: -%d/%d"),
+					mFrozenFrameIndex, mSnapshotRing.getFrameNum());
+			SendMessage(mStatusbarH, SB_SETTEXT, (WPARAM )1, (LPARAM )buf);
+	#else
+			char	buf[IMAGE_STR_BUF_SIZE] = "";
+
+			if (isFrozenNow)
+				sprintf_s(buf, IMAGE_STR_BUF_SIZE, "Frozen: -%d/%d",
+					mFrozenFrameIndex, mSnapshotRing.getFrameNum());
+			SendMessage(mStatusbarH, SB_SETTEXT, (WPARAM )1, (LPARAM )buf);
 	#endif
 		}
 		// ---------------------------------------------------------------------
@@ -1072,11 +1439,16 @@ namespace viw
 			y += mImageViewOffset.cy;
 
 			unsigned char	*pixelPtr = getPixelPointer(x, y);
+			char	readout[IMAGE_STR_BUF_SIZE];
+			bool	isReadout = (result && mPixelReadoutFunc != NULL &&
+							mPixelReadoutFunc(x, y, readout, IMAGE_STR_BUF_SIZE, mPixelReadoutFuncData));
 
 	#ifdef _UNICODE
 			wchar_t	buf[IMAGE_STR_BUF_SIZE];
 
-			if (result == false || pixelPtr == NULL)
+			if (isReadout)
+				swprintf_s(buf, IMAGE_STR_BUF_SIZE, TEXT("%hs"), readout);
+			else if (result == false || pixelPtr == NULL)
 				swprintf_s(buf, IMAGE_STR_BUF_SIZE, TEXT(""));
 			else
 			{
@@ -1091,7 +1463,9 @@ namespace viw
 	#else
 			char	buf[IMAGE_STR_BUF_SIZE];
 
-			if (result == false || pixelPtr == NULL)
+			if (isReadout)
+				sprintf_s(buf, IMAGE_STR_BUF_SIZE, TEXT("%s"), readout);
+			else if (result == false || pixelPtr == NULL)
 				sprintf_s(buf, IMAGE_STR_BUF_SIZE, TEXT(""));
 			else
 			{
@@ -1145,7 +1519,7 @@ namespace viw
 				::SendMessage(mStatusbarH, SB_SETTEXT, (WPARAM )1, (LPARAM )buf);
 			}*/
 
-			swprintf_s(buf, IMAGE_STR_BUF_SIZE, TEXT("FPS: %.1f"), mFPSValue);
+			swprintf_s(buf, IMAGE_STR_BUF_SIZE, TEXT("FPS: %.1f"), mFrameTiming.getFPS());
 			::SendMessage(mStatusbarH, SB_SETTEXT, (WPARAM )3, (LPARAM )buf);
 		#else
 			char	buf[ZO_IMAGE_STR_BUF_SIZE];
@@ -1161,7 +1535,7 @@ namespace viw
 				::SendMessage(mStatusbarH, SB_SETTEXT, (WPARAM )1, (LPARAM )buf);
 			}
 
-			sprintf_s(buf, ZO_IMAGE_STR_BUF_SIZE, TEXT("FPS: %.1f"), mFPSValue);
+			sprintf_s(buf, ZO_IMAGE_STR_BUF_SIZE, TEXT("FPS: %.1f"), mFrameTiming.getFPS());
 			::SendMessage(mStatusbarH, SB_SETTEXT, (WPARAM )3, (LPARAM )buf);
 		#endif
 		}
@@ -1171,6 +1545,8 @@ namespace viw
 		// ---------------------------------------------------------------------
 		void	drawImage(HDC inHDC)
 		{
+			VIW_TRACE_SCOPE("drawImage", static_cast<SDIWindow *>(this));
+
 			if (mImageViewScale == 100)
 			{
 				::SetDIBitsToDevice(inHDC,
@@ -1223,7 +1599,10 @@ namespace viw
 					::SelectObject(inHDC, prevFont);*/
 				}
 			if (mDrawOverlayFunc != NULL)
+			{
+				VIW_TRACE_SCOPE("drawOverlay", static_cast<SDIWindow *>(this));
 				mDrawOverlayFunc(inHDC, mOverlayFuncData);
+			}
 		}
 		// ---------------------------------------------------------------------
 		//	initBeforeCreateWindow
@@ -1254,10 +1633,50 @@ namespace viw
 				//TEXT("Courier"));
 
 			updateWindowSize();
+			updateRefreshRate();
 
 			return -1;	// success (Win32 style result)
 		}
 		// ---------------------------------------------------------------------
+		//	updateRefreshRate
+		// ---------------------------------------------------------------------
+		//	The repaint timer only flushes the last pending frame, the
+		//	frames of a running producer are repainted from updateImage()
+		void	updateRefreshRate()
+		{
+			double	rate = mRefreshRate;
+			if (rate <= 0)
+				rate = getMonitorRefreshRate();
+			mRepaintScheduler.setRate(rate);
+
+			int	periodMs = mRepaintScheduler.getPeriodMs();
+			if (periodMs < USER_TIMER_MINIMUM)
+				periodMs = USER_TIMER_MINIMUM;
+			if (isWindowVisible() == false)
+				periodMs = FPS_STATUS_INTERVAL_MS;
+			::SetTimer(mWindowH, REPAINT_TIMER_ID, periodMs, NULL);
+		}
+		// ---------------------------------------------------------------------
+		//	getMonitorRefreshRate
+		// ---------------------------------------------------------------------
+		double	getMonitorRefreshRate()
+		{
+			HMONITOR	monitor = ::MonitorFromWindow(mWindowH, MONITOR_DEFAULTTONEAREST);
+			MONITORINFOEX	info;
+			info.cbSize = sizeof(info);
+			if (::GetMonitorInfo(monitor, &info))
+			{
+				DEVMODE	mode;
+				::ZeroMemory(&mode, sizeof(mode));
+				mode.dmSize = sizeof(mode);
+				// 0 and 1 mean the hardware default
+				if (::EnumDisplaySettings(info.szDevice, ENUM_CURRENT_SETTINGS, &mode) &&
+					mode.dmDisplayFrequency > 1)
+					return (double )mode.dmDisplayFrequency;
+			}
+			return utils::RepaintScheduler::DEFAULT_RATE;
+		}
+		// ---------------------------------------------------------------------
 		//	initMenu
 		// ---------------------------------------------------------------------
 		virtual void	initMenu()
@@ -1310,7 +1729,7 @@ namespace viw
 			::AppendMenu(viewMenuH, MF_ENABLED, SIDM_FPS, TEXT("FPS"));
 			::AppendMenu(viewMenuH, MF_GRAYED, SIDM_HISTOGRAM, TEXT("Histogram"));
 			::AppendMenu(viewMenuH, MF_SEPARATOR, 0, NULL);
-			::AppendMenu(viewMenuH, MF_GRAYED, SIDM_FREEZE, TEXT("Freeze"));
+			::AppendMenu(viewMenuH, MF_ENABLED, SIDM_FREEZE, TEXT("Freeze"));
 			::AppendMenu(viewMenuH, MF_SEPARATOR, 0, NULL);
 			::AppendMenu(viewMenuH, MF_ENABLED, SIDM_SCROLL_TOOL, TEXT("Scroll Tool"));
 			::AppendMenu(viewMenuH, MF_ENABLED, SIDM_ZOOM_TOOL, TEXT("Zoom Tool"));
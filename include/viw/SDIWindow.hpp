@@ -25,6 +25,7 @@
 
 // Includes --------------------------------------------------------------------
 #include "viw/Window.hpp"
+#include "viw/utils/Trace.hpp"
 #include <commctrl.h>
 #include <process.h>	//	_beginthread, _endthread
 #include <string.h>
@@ -44,6 +45,143 @@
 // Namespace -------------------------------------------------------------------
 namespace viw
 {
+	// -------------------------------------------------------------------------
+	// SDIWindowThread class
+	// -------------------------------------------------------------------------
+	//	A UI thread shared by several SDIWindows (see
+	//	SDIWindow::setSharedThreadNum()). The windows are created on it by
+	//	a thread message and their messages are dispatched by its loop.
+	class	SDIWindowThread
+	{
+	public:
+		// Typedefs ------------------------------------------------------------
+		typedef void	(*CreateWindowFunc)(void *inArg);
+
+		// Constructors and Destructor -----------------------------------------
+		// ---------------------------------------------------------------------
+		//	SDIWindowThread
+		// ---------------------------------------------------------------------
+		SDIWindowThread()
+		{
+			mThreadHandle	= NULL;
+			mThreadId		= 0;
+			mWindowNum		= 0;
+
+			HANDLE	readyEventHandle = ::CreateEvent(NULL, false, false, NULL);
+			if (readyEventHandle == NULL)
+			{
+				printf("Error: Can't create Event object\n");
+				return;
+			}
+
+			mReadyEventHandle = readyEventHandle;
+			mThreadHandle = (HANDLE )::_beginthreadex(
+				NULL,
+				0,
+				threadFunc,
+				this,
+				0,
+				&mThreadId);
+			if (mThreadHandle == NULL)
+				printf("Error: Can't create process thread\n");
+			else
+				::WaitForSingleObject(readyEventHandle, INFINITE);
+			::CloseHandle(readyEventHandle);
+		}
+
+		// Member Functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		//	isRunning
+		// ---------------------------------------------------------------------
+		bool	isRunning()
+		{
+			return (mThreadHandle != NULL);
+		}
+		// ---------------------------------------------------------------------
+		//	getWindowNum
+		// ---------------------------------------------------------------------
+		int	getWindowNum()
+		{
+			return (int )mWindowNum;
+		}
+		// ---------------------------------------------------------------------
+		//	postCreateWindow
+		// ---------------------------------------------------------------------
+		//	inFunc is called on this thread, the window counts until
+		//	removeWindow() is called
+		bool	postCreateWindow(CreateWindowFunc inFunc, void *inArg)
+		{
+			::InterlockedIncrement(&mWindowNum);
+			if (::PostThreadMessage(mThreadId, CREATE_WINDOW_MESSAGE, (WPARAM )inFunc, (LPARAM )inArg) == 0)
+			{
+				::InterlockedDecrement(&mWindowNum);
+				return false;
+			}
+			return true;
+		}
+		// ---------------------------------------------------------------------
+		//	removeWindow
+		// ---------------------------------------------------------------------
+		void	removeWindow()
+		{
+			::InterlockedDecrement(&mWindowNum);
+		}
+
+	private:
+		// Constatns -----------------------------------------------------------
+		const static UINT	CREATE_WINDOW_MESSAGE		= WM_APP + 1;
+
+		// Member Variables ----------------------------------------------------
+		HANDLE				mThreadHandle;
+		unsigned int		mThreadId;
+		HANDLE				mReadyEventHandle;
+		volatile LONG		mWindowNum;
+
+		// Static Functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		//	threadFunc
+		// ---------------------------------------------------------------------
+		//	Runs until the process exits
+		static unsigned int _stdcall	threadFunc(void *arg)
+		{
+			SDIWindowThread	*thread = (SDIWindowThread *)arg;
+			MSG	msg;
+
+			// creates the message queue before anything is posted to it
+			::PeekMessage(&msg, NULL, WM_USER, WM_USER, PM_NOREMOVE);
+			::SetEvent(thread->mReadyEventHandle);
+
+			while (::GetMessage(&msg, NULL, 0, 0) != 0)
+			{
+				if (msg.hwnd == NULL && msg.message == CREATE_WINDOW_MESSAGE)
+				{
+					((CreateWindowFunc )msg.wParam)((void *)msg.lParam);
+					continue;
+				}
+				VIW_TRACE_SCOPE("dispatchMessage", obtainTraceContext(msg.hwnd));
+				::TranslateMessage(&msg);
+				::DispatchMessage(&msg);
+			}
+			return 0;
+		}
+		// ---------------------------------------------------------------------
+		//	obtainTraceContext
+		// ---------------------------------------------------------------------
+		//	The SDIWindow * of the top level window, the key its other
+		//	events are traced with
+		static const void	*obtainTraceContext(HWND inHWND)
+		{
+			HWND	rootH = (inHWND != NULL) ? ::GetAncestor(inHWND, GA_ROOT) : NULL;
+			if (rootH == NULL)
+				return NULL;
+		#ifdef _WIN64
+			return (const void *)::GetWindowLongPtr(rootH, GWLP_USERDATA);
+		#else
+			return (const void *)LongToPtr(GetWindowLongPtr(rootH, GWLP_USERDATA));
+		#endif
+		}
+	};
+
 	// -------------------------------------------------------------------------
 	// SDIWindow class
 	// -------------------------------------------------------------------------
@@ -55,6 +193,7 @@ namespace viw
 		const static int	WINDOW_POS_SPACE			= 20;
 		const static int	WINDOW_DEFAULT_POS			= 20;
 		const static int	WINDOW_DEFAULT_SIZE			= 320;
+		const static int	OCCLUSION_CHECK_INTERVAL_MS	= 200;
 
 		// Constructors and Destructor -----------------------------------------
 		// ---------------------------------------------------------------------
@@ -78,6 +217,8 @@ namespace viw
 			mModuleH				= ::GetModuleHandle(NULL);
 			mEventHandle			= NULL;
 			mThreadHandle			= NULL;
+			mSharedThread			= NULL;
+			mCloseEventHandle		= NULL;
 
 			mIsFullScreenMode		= false;
 			mIsMenubarEnabled		= true;
@@ -86,6 +227,12 @@ namespace viw
 
 			mMonitorNum				= 0;
 			mMonitorRect			= NULL;
+
+			mIsWindowShown			= false;
+			mIsWindowVisible		= false;
+			mIsWindowOccluded		= false;
+			mIsOcclusionChecked		= false;
+			mOcclusionCheckTick		= 0;
 		}
 		// ---------------------------------------------------------------------
 		//	~SDIWindow
@@ -95,11 +242,12 @@ namespace viw
 			if (mWindowState == WINDOW_OPEN_STATE)
 				::PostMessage(mWindowH, WM_CLOSE, 0, 0);
 
+			if (getCloseHandle() != NULL)
+				::WaitForSingleObject(getCloseHandle(), INFINITE);
 			if (mThreadHandle != NULL)
-			{
-				::WaitForSingleObject(mThreadHandle, INFINITE);
 				::CloseHandle(mThreadHandle);
-			}
+			if (mCloseEventHandle != NULL)
+				::CloseHandle(mCloseEventHandle);
 
 			if (mEventHandle != NULL)
 				::CloseHandle(mEventHandle);
@@ -120,7 +268,7 @@ namespace viw
 			static int	sPrevPosY	= 0;
 			static int	sWindowNum	= 0;
 
-			if (mWindowState != WINDOW_INIT_STATE || mThreadHandle != NULL)
+			if (mWindowState != WINDOW_INIT_STATE || mThreadHandle != NULL || mSharedThread != NULL)
 				return;
 
 			mPosX = inPosX;
@@ -178,20 +326,44 @@ namespace viw
 				return;
 			}
 
-			//	Must use _beginthreadex instead of _beginthread, CreateThread
-			mThreadHandle = (HANDLE )::_beginthreadex(
-				NULL,
-				0,
-				threadFunc,
-				this,
-				0,
-				NULL);
-			if (mThreadHandle == NULL)
+			if (getSharedThreadNum() <= 0)
 			{
-				printf("Error: Can't create process thread\n");
-				::CloseHandle(mEventHandle);
-				delete mWindowTitle;
-				return;
+				//	Must use _beginthreadex instead of _beginthread, CreateThread
+				mThreadHandle = (HANDLE )::_beginthreadex(
+					NULL,
+					0,
+					threadFunc,
+					this,
+					0,
+					NULL);
+				if (mThreadHandle == NULL)
+				{
+					printf("Error: Can't create process thread\n");
+					::CloseHandle(mEventHandle);
+					mEventHandle = NULL;
+					delete mWindowTitle;
+					mWindowTitle = NULL;
+					return;
+				}
+			}
+			else
+			{
+				mCloseEventHandle = ::CreateEvent(NULL, true, false, NULL);	// manual reset
+				mSharedThread = selectSharedThread();
+				if (mCloseEventHandle == NULL || mSharedThread == NULL ||
+					mSharedThread->postCreateWindow(createWindowFunc, this) == false)
+				{
+					printf("Error: Can't create the window on a shared thread\n");
+					if (mCloseEventHandle != NULL)
+						::CloseHandle(mCloseEventHandle);
+					mCloseEventHandle = NULL;
+					mSharedThread = NULL;
+					::CloseHandle(mEventHandle);
+					mEventHandle = NULL;
+					delete mWindowTitle;
+					mWindowTitle = NULL;
+					return;
+				}
 			}
 			::WaitForSingleObject(mEventHandle, INFINITE);
 
@@ -224,14 +396,25 @@ namespace viw
 			return false;
 		}
 		// ---------------------------------------------------------------------
+		// isWindowVisible
+		// ---------------------------------------------------------------------
+		//	false while the window is hidden, minimized or covered by other
+		//	windows (the occlusion is updated by updateWindowVisibility())
+		bool	isWindowVisible()
+		{
+			if (mWindowState != WINDOW_OPEN_STATE)
+				return false;
+			return mIsWindowVisible;
+		}
+		// ---------------------------------------------------------------------
 		// waitForWindowClose
 		// ---------------------------------------------------------------------
 		bool	waitForWindowClose(DWORD inTimeout = INFINITE)
 		{
-			if (mThreadHandle == NULL)
+			if (getCloseHandle() == NULL)
 				return false;
 
-			if (WaitForSingleObject(mThreadHandle, inTimeout) == WAIT_OBJECT_0)
+			if (WaitForSingleObject(getCloseHandle(), inTimeout) == WAIT_OBJECT_0)
 				return true;
 
 			return false;
@@ -245,8 +428,10 @@ namespace viw
 			std::vector< HANDLE >	handles;
 
 			for (int i = 0; i < inArrayLen; i++)
-				if (inWindowArray[i]->mThreadHandle != NULL)
-					handles.push_back(inWindowArray[i]->mThreadHandle);
+				if (inWindowArray[i]->getCloseHandle() != NULL)
+					handles.push_back(inWindowArray[i]->getCloseHandle());
+			if (handles.empty())
+				return true;
 
 			if (WaitForMultipleObjects((DWORD )handles.size(), &(handles[0]), inWaitAll, inTimeout) == WAIT_TIMEOUT)
 				return false;
@@ -254,6 +439,17 @@ namespace viw
 			return true;
 		}
 		// ---------------------------------------------------------------------
+		// setSharedThreadNum
+		// ---------------------------------------------------------------------
+		//	0 (default) : every window runs its own UI thread
+		//	n > 0       : the windows shown from now on are hosted on up to n
+		//	              shared UI threads, the least loaded one is used
+		//	Like showWindow(), call it from one thread only.
+		static void	setSharedThreadNum(int inThreadNum)
+		{
+			getSharedThreadNum() = (inThreadNum > 0) ? inThreadNum : 0;
+		}
+		// ---------------------------------------------------------------------
 		// isFullScreenMode
 		// ---------------------------------------------------------------------
 		bool	isFullScreenMode()
@@ -476,6 +672,8 @@ namespace viw
 		typedef BOOL		(WINAPI *WINAPI_InitCommonControlsEx)(LPINITCOMMONCONTROLSEX);
 		typedef HIMAGELIST	(WINAPI *WINAPI_ImageList_Create)(int cx, int cy, UINT flags, int cInitial, int cGrow);
 		typedef int			(WINAPI *WINAPI_ImageList_AddMasked)(HIMAGELIST himl, HBITMAP hbmImage, COLORREF crMask);
+		typedef HRESULT		(WINAPI *WINAPI_DwmGetWindowAttribute)(HWND hwnd, DWORD dwAttribute, PVOID pvAttribute, DWORD cbAttribute);
+		typedef std::vector<SDIWindowThread *>	SharedThreadList;
 
 		// Member Variables ----------------------------------------------------
 		int					mWindowState;
@@ -491,8 +689,10 @@ namespace viw
 		HICON				mAppIconH;
 
 		HINSTANCE			mModuleH;
-		HANDLE				mThreadHandle;
+		HANDLE				mThreadHandle;		// own UI thread
 		HANDLE				mEventHandle;
+		SDIWindowThread		*mSharedThread;		// or shared one
+		HANDLE				mCloseEventHandle;
 
 		bool				mIsFullScreenMode;
 		RECT				mLastWindowRect;
@@ -503,6 +703,12 @@ namespace viw
 		int					mMonitorNum;
 		RECT				*mMonitorRect;
 
+		bool				mIsWindowShown;
+		volatile bool		mIsWindowVisible;
+		bool				mIsWindowOccluded;		// by isWindowOccluded()
+		bool				mIsOcclusionChecked;
+		DWORD				mOcclusionCheckTick;
+
 		// Static Functions ----------------------------------------------------
 		// ---------------------------------------------------------------------
 		//	threadFunc
@@ -510,6 +716,42 @@ namespace viw
 		static unsigned int _stdcall	threadFunc(void *arg)
 		{
 			SDIWindow	*window = (SDIWindow *)arg;	
+
+			if (createWindow(window) == false)
+				return 1;
+
+			MSG	msg;
+			while (::GetMessage(&msg, NULL, 0, 0) != 0)
+			{
+				VIW_TRACE_SCOPE("dispatchMessage", window);
+				::TranslateMessage(&msg);
+				::DispatchMessage(&msg);
+			}
+
+			window->mWindowState = WINDOW_CLOSED_STATE;
+			return 0;
+		}
+		// ---------------------------------------------------------------------
+		//	createWindowFunc
+		// ---------------------------------------------------------------------
+		//	Called on a shared thread
+		static void	createWindowFunc(void *arg)
+		{
+			SDIWindow	*window = (SDIWindow *)arg;
+
+			if (createWindow(window) == false)
+			{
+				window->mSharedThread->removeWindow();
+				::SetEvent(window->mCloseEventHandle);
+			}
+		}
+		// ---------------------------------------------------------------------
+		//	createWindow
+		// ---------------------------------------------------------------------
+		//	Called on the UI thread of the window, mEventHandle is set in
+		//	any case so showWindow() returns
+		static bool	createWindow(SDIWindow *window)
+		{
 			LPCTSTR	windowName;
 			int	result;
 
@@ -518,7 +760,8 @@ namespace viw
 			{
 				printf("Error: initBeforeCreateWindow() failed %d\n", result);
 				window->mWindowState = WINDOW_CLOSED_STATE;
-				return 1;
+				::SetEvent(window->mEventHandle);
+				return false;
 			}
 
 		#ifdef _UNICODE
@@ -526,7 +769,7 @@ namespace viw
 			windowName = new WCHAR[wcharsize];
 			::MultiByteToWideChar(CP_ACP, 0, window->mWindowTitle, -1, (LPWSTR )windowName, wcharsize);
 		#else
-			windowName = (LPCSTR )imageDisp->mWindowTitle;
+			windowName = (LPCSTR )window->mWindowTitle;
 		#endif
 			//	Create WinDisp window
 			window->mWindowH = ::CreateWindow(
@@ -542,17 +785,18 @@ namespace viw
 					window->mModuleH,				//	handle to this module
 					NULL);							//	no lpParam
 
+		#ifdef _UNICODE
+			delete [] windowName;
+		#endif
+
 			if (window->mWindowH == NULL)
 			{
 				printf("Error: CreateWindow() failed\n");
 				window->mWindowState = WINDOW_CLOSED_STATE;
-				return 1;
+				::SetEvent(window->mEventHandle);
+				return false;
 			}
 
-		#ifdef _UNICODE
-			delete windowName;
-		#endif
-
 		#ifdef _WIN64
 			::SetWindowLongPtr(window->mWindowH, GWLP_USERDATA, (LONG_PTR )window);
 		#else
@@ -564,25 +808,52 @@ namespace viw
 			result = window->initAfterCreateWindow();
 			if (result == 0)
 			{
+				window->mWindowState = WINDOW_CLOSED_STATE;
 				::DestroyWindow(window->mWindowH);
 				window->mWindowH = NULL;
 				printf("Error: initAfterCreateWindow() failed %d\n", result);
-				window->mWindowState = WINDOW_CLOSED_STATE;
-				return 1;
+				::SetEvent(window->mEventHandle);
+				return false;
 			}
 
 			::ShowWindow(window->mWindowH, SW_SHOW);
 			::SetEvent(window->mEventHandle);
+			return true;
+		}
+		// ---------------------------------------------------------------------
+		//	getSharedThreadNum
+		// ---------------------------------------------------------------------
+		static int	&getSharedThreadNum()
+		{
+			static int	sSharedThreadNum = 0;
+			return sSharedThreadNum;
+		}
+		// ---------------------------------------------------------------------
+		//	selectSharedThread
+		// ---------------------------------------------------------------------
+		//	The shared threads are started on demand and run until the
+		//	process exits
+		static SDIWindowThread	*selectSharedThread()
+		{
+			static SharedThreadList	sSharedThreads;
 
-			MSG	msg;
-			while (::GetMessage(&msg, NULL, 0, 0) != 0)
+			SDIWindowThread	*selected = NULL;
+			for (size_t i = 0; i < sSharedThreads.size(); i++)
+				if (selected == NULL || sSharedThreads[i]->getWindowNum() < selected->getWindowNum())
+					selected = sSharedThreads[i];
+			if (selected != NULL && selected->getWindowNum() == 0)
+				return selected;
+			if ((int )sSharedThreads.size() >= getSharedThreadNum())
+				return selected;
+
+			SDIWindowThread	*thread = new SDIWindowThread();
+			if (thread->isRunning() == false)
 			{
-				::TranslateMessage(&msg);
-				::DispatchMessage(&msg);
+				delete thread;
+				return selected;
 			}
-
-			window->mWindowState = WINDOW_CLOSED_STATE;
-			return 0;
+			sSharedThreads.push_back(thread);
+			return thread;
 		}
 		// ---------------------------------------------------------------------
 		//	monitorEnumProc
@@ -664,7 +935,7 @@ namespace viw
 		// ---------------------------------------------------------------------
 		virtual bool	onIDM_CLOSE(UINT inMessage, WPARAM inWParam, LPARAM inLParam, LRESULT *outResult)
 		{
-			::PostQuitMessage(0);
+			quitWindow();
 			return true;
 		}
 		// ---------------------------------------------------------------------
@@ -672,7 +943,7 @@ namespace viw
 		// ---------------------------------------------------------------------
 		virtual bool	onIDM_EXIT(UINT inMessage, WPARAM inWParam, LPARAM inLParam, LRESULT *outResult)
 		{
-			::PostQuitMessage(0);
+			quitWindow();
 			return true;
 		}
 		// ---------------------------------------------------------------------
@@ -787,17 +1058,144 @@ namespace viw
 		// ---------------------------------------------------------------------
 		virtual bool	onWM_DESTROY(UINT inMessage, WPARAM inWParam, LPARAM inLParam, LRESULT *outResult)
 		{
-			::PostQuitMessage(0);
+			if (mSharedThread == NULL)
+			{
+				::PostQuitMessage(0);
+				return true;
+			}
+
+			// the shared thread keeps running for the other windows
+			if (mWindowState == WINDOW_OPEN_STATE)
+			{
+				mWindowState = WINDOW_CLOSED_STATE;
+				mSharedThread->removeWindow();
+				// the object may be deleted as soon as the event is set, the
+				// messages that follow (WM_NCDESTROY) must not reach it
+				::SetWindowLongPtr(mWindowH, GWLP_USERDATA, 0);
+				::SetEvent(mCloseEventHandle);
+			}
 			return true;
 		}
 		// ---------------------------------------------------------------------
 		//	onWM_SIZE
 		// ---------------------------------------------------------------------
 		virtual bool	onWM_SIZE(UINT inMessage, WPARAM inWParam, LPARAM inLParam, LRESULT *outResult)
+		{
+			layoutBars(inMessage, inWParam, inLParam);
+			updateWindowVisibility();
+			return true;
+		}
+		// ---------------------------------------------------------------------
+		//	layoutBars
+		// ---------------------------------------------------------------------
+		//	Passes WM_SIZE on to the rebar and the status bar
+		void	layoutBars(UINT inMessage, WPARAM inWParam, LPARAM inLParam)
 		{
 			SendMessage(mRebarH, inMessage, inWParam, inLParam);
 			SendMessage(mStatusbarH, inMessage, inWParam, inLParam);
-			return true;
+		}
+		// ---------------------------------------------------------------------
+		//	onWM_SHOWWINDOW
+		// ---------------------------------------------------------------------
+		virtual bool	onWM_SHOWWINDOW(UINT inMessage, WPARAM inWParam, LPARAM inLParam, LRESULT *outResult)
+		{
+			// sent before the window is shown / hidden, so IsWindowVisible()
+			// can't be used here
+			mIsWindowShown = (inWParam != FALSE);
+			updateWindowVisibility();
+			return false;
+		}
+		// ---------------------------------------------------------------------
+		//	quitWindow
+		// ---------------------------------------------------------------------
+		//	Ends the message loop of an own UI thread, a window on a shared
+		//	thread is destroyed instead
+		void	quitWindow()
+		{
+			if (mSharedThread == NULL)
+				::PostQuitMessage(0);
+			else
+				::DestroyWindow(mWindowH);
+		}
+		// ---------------------------------------------------------------------
+		//	getCloseHandle
+		// ---------------------------------------------------------------------
+		//	Signaled when the window is closed
+		HANDLE	getCloseHandle()
+		{
+			if (mSharedThread != NULL)
+				return mCloseEventHandle;
+			return mThreadHandle;
+		}
+		// ---------------------------------------------------------------------
+		//	onWindowVisibilityChanged
+		// ---------------------------------------------------------------------
+		virtual void	onWindowVisibilityChanged(bool inIsVisible)
+		{
+		}
+		// ---------------------------------------------------------------------
+		//	updateWindowVisibility
+		// ---------------------------------------------------------------------
+		//	Called on the window thread. Occlusion by other windows sends no
+		//	message, so the derived windows call this periodically. The
+		//	occlusion is only checked while the window is shown and not
+		//	minimized.
+		void	updateWindowVisibility()
+		{
+			bool	isVisible =
+						mIsWindowShown &&
+						::IsIconic(mWindowH) == FALSE &&
+						isWindowOccluded() == false;
+			if (isVisible == mIsWindowVisible)
+				return;
+
+			mIsWindowVisible = isVisible;
+			onWindowVisibilityChanged(isVisible);
+		}
+		// ---------------------------------------------------------------------
+		//	isWindowOccluded
+		// ---------------------------------------------------------------------
+		//	true if the windows above this one in the z-order cover it
+		//	entirely. Translucent (layered) and cloaked windows don't count.
+		//	The z-order walk is done at most every OCCLUSION_CHECK_INTERVAL_MS,
+		//	the paints and resizes in between get the last result.
+		bool	isWindowOccluded()
+		{
+			DWORD	tick = ::GetTickCount();
+			if (mIsOcclusionChecked && tick - mOcclusionCheckTick < (DWORD )OCCLUSION_CHECK_INTERVAL_MS)
+				return mIsWindowOccluded;
+
+			mIsWindowOccluded = checkWindowOcclusion();
+			mIsOcclusionChecked = true;
+			mOcclusionCheckTick = tick;
+			return mIsWindowOccluded;
+		}
+		// ---------------------------------------------------------------------
+		//	checkWindowOcclusion
+		// ---------------------------------------------------------------------
+		bool	checkWindowOcclusion()
+		{
+			RECT	rect;
+			if (getVisibleWindowRect(mWindowH, &rect) == false)
+				return false;
+
+			HRGN	region = ::CreateRectRgnIndirect(&rect);
+			int		regionType = SIMPLEREGION;
+			for (HWND windowH = ::GetWindow(mWindowH, GW_HWNDPREV);
+				windowH != NULL && regionType != NULLREGION && regionType != ERROR;
+				windowH = ::GetWindow(windowH, GW_HWNDPREV))
+			{
+				if (isOccludingWindow(windowH) == false ||
+					getVisibleWindowRect(windowH, &rect) == false)
+					continue;
+
+				HRGN	windowRegion = ::CreateRectRgnIndirect(&rect);
+				regionType = ::CombineRgn(region, region, windowRegion, RGN_DIFF);
+				::DeleteObject(windowRegion);
+			}
+			::DeleteObject(region);
+
+			return (regionType == NULLREGION);
 		}
 		// ---------------------------------------------------------------------
 		// onWM_CHAR
@@ -810,7 +1208,7 @@ namespace viw
 					if (isFullScreenMode())
 						disableFullScreenMode();
 					else
-						::PostQuitMessage(0);
+						quitWindow();
 					return true;
 				case 'f':
 				case 'F':
@@ -982,6 +1380,58 @@ namespace viw
 			return -1;	// success (Win32 style result)
 		}
 		// ---------------------------------------------------------------------
+		//	getDwmGetWindowAttribute
+		// ---------------------------------------------------------------------
+		//	dwmapi.dll is loaded at run time like comctl32.dll, NULL without DWM
+		static WINAPI_DwmGetWindowAttribute	getDwmGetWindowAttribute()
+		{
+			static HINSTANCE	sDwmapiH = NULL;
+			static WINAPI_DwmGetWindowAttribute	sDwmGetWindowAttribute = NULL;
+
+			if (sDwmapiH == NULL)
+			{
+				sDwmapiH = ::LoadLibrary(TEXT("dwmapi.dll"));
+				if (sDwmapiH != NULL)
+					sDwmGetWindowAttribute = (WINAPI_DwmGetWindowAttribute )::GetProcAddress(sDwmapiH, "DwmGetWindowAttribute");
+			}
+			return sDwmGetWindowAttribute;
+		}
+		// ---------------------------------------------------------------------
+		//	getVisibleWindowRect
+		// ---------------------------------------------------------------------
+		//	Without the invisible resize borders DWM adds to the window rect
+		static bool	getVisibleWindowRect(HWND inWindowH, RECT *outRect)
+		{
+			const DWORD	DWMWA_EXTENDED_FRAME_BOUNDS_ = 9;
+
+			WINAPI_DwmGetWindowAttribute	dwmGetWindowAttribute = getDwmGetWindowAttribute();
+			if (dwmGetWindowAttribute != NULL &&
+				dwmGetWindowAttribute(inWindowH, DWMWA_EXTENDED_FRAME_BOUNDS_, outRect, sizeof(RECT)) == S_OK)
+				return true;
+			return (::GetWindowRect(inWindowH, outRect) != FALSE);
+		}
+		// ---------------------------------------------------------------------
+		//	isOccludingWindow
+		// ---------------------------------------------------------------------
+		static bool	isOccludingWindow(HWND inWindowH)
+		{
+			const DWORD	DWMWA_CLOAKED_ = 14;
+
+			if (::IsWindowVisible(inWindowH) == FALSE || ::IsIconic(inWindowH) != FALSE)
+				return false;
+			if ((::GetWindowLong(inWindowH, GWL_EXSTYLE) & (WS_EX_LAYERED | WS_EX_TRANSPARENT)) != 0)
+				return false;
+
+			// e.g. the windows on the other virtual desktops
+			WINAPI_DwmGetWindowAttribute	dwmGetWindowAttribute = getDwmGetWindowAttribute();
+			DWORD	cloaked = 0;
+			if (dwmGetWindowAttribute != NULL &&
+				dwmGetWindowAttribute(inWindowH, DWMWA_CLOAKED_, &cloaked, sizeof(cloaked)) == S_OK &&
+				cloaked != 0)
+				return false;
+			return true;
+		}
+		// ---------------------------------------------------------------------
 		//	loadComctl32
 		// ---------------------------------------------------------------------
 		int	loadComctl32(WINAPI_ImageList_Create *outImageList_Create,
@@ -0,0 +1,413 @@
+// =============================================================================
+//  TiledImageWindow.hpp
+//
+//  Written in 2014 by Dairoku Sekiguchi (sekiguchi at acm dot org)
+//
+//  To the extent possible under law, the author(s) have dedicated all copyright
+//  and related and neighboring rights to this software to the public domain worldwide.
+//  This software is distributed without any warranty.
+//
+//  You should have received a copy of the CC0 Public Domain Dedication along with
+//  this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+// =============================================================================
+
+/*!
+	\file		viw/TiledImageWindow.hpp
+	\author		Dairoku Sekiguchi
+	\version	1.0.0
+	\date		2026/10/19
+	\brief		Header file for viw library types
+
+	This file defines the tiled image viewer for viw library
+*/
+
+#ifndef VIW_TILED_IMAGE_WINDOW_H
+#define VIW_TILED_IMAGE_WINDOW_H
+
+// Includes --------------------------------------------------------------------
+#include "viw/SDIWindow.hpp"
+#include "viw/model/TiledImage.hpp"
+#include <math.h>
+#include <new>
+
+
+// Namespace -------------------------------------------------------------------
+namespace viw
+{
+	// -------------------------------------------------------------------------
+	// TiledImageWindow class
+	// -------------------------------------------------------------------------
+	//	Pans (drag) and zooms (wheel) over a TiledImage. Every paint renders
+	//	only the viewport. When a tile arrives only the part of the view it
+	//	covers is invalidated and rendered again, so the view refines while
+	//	the tiles stream in.
+	template <typename ImageBufferType> class	TiledImageWindow : public SDIWindow
+	{
+	public:
+		// Typedefs ------------------------------------------------------------
+		typedef model::TiledImage<ImageBufferType>	TiledImageType;
+
+		// Constructors and Destructor -----------------------------------------
+		// ---------------------------------------------------------------------
+		//	TiledImageWindow
+		// ---------------------------------------------------------------------
+		//	inImage must outlive the window
+		TiledImageWindow(TiledImageType *inImage)
+			: SDIWindow()
+		{
+			mImage					= inImage;
+			mViewX					= 0;
+			mViewY					= 0;
+			mViewScale				= 0;		// fit to the window when shown
+			mMissingTileNum			= 0;
+			mIsMouseDragging		= false;
+			mViewXStart				= 0;
+			mViewYStart				= 0;
+			::ZeroMemory(&mImageViewRect, sizeof(mImageViewRect));
+			::ZeroMemory(&mMouseDownPos, sizeof(mMouseDownPos));
+			::ZeroMemory(&mBitmapInfo, sizeof(mBitmapInfo));
+			mViewBuffer				= NULL;
+			mViewBufferSize			= 0;
+			mIsViewBufferValid		= false;
+			mRenderedViewX			= 0;
+			mRenderedViewY			= 0;
+			mRenderedViewScale		= 0;
+			mRenderedWidth			= 0;
+			mRenderedHeight			= 0;
+
+			mImage->setTileLoadedFunc(tileLoadedFunc, this);
+		}
+		// ---------------------------------------------------------------------
+		//	~TiledImageWindow
+		// ---------------------------------------------------------------------
+		virtual ~TiledImageWindow()
+		{
+			// no tile callback and no paint may use the members below
+			mImage->setTileLoadedFunc(NULL, NULL);
+			closeWindow();
+			waitForWindowClose();
+
+			if (mViewBuffer != NULL)
+				delete [] mViewBuffer;
+		}
+
+		// Member Functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// setView
+		// ---------------------------------------------------------------------
+		//	(inX, inY) : level 0 pixel at the top left corner
+		//	inScale : view pixels per level 0 pixel
+		void	setView(double inX, double inY, double inScale)
+		{
+			if (inScale <= 0)
+				return;
+			mViewX = inX;
+			mViewY = inY;
+			mViewScale = inScale;
+			updateImageView();
+			updateStatusBar();
+		}
+		// ---------------------------------------------------------------------
+		// getViewScale
+		// ---------------------------------------------------------------------
+		double	getViewScale()
+		{
+			return mViewScale;
+		}
+		// ---------------------------------------------------------------------
+		// fitViewToWindowSize
+		// ---------------------------------------------------------------------
+		void	fitViewToWindowSize()
+		{
+			int	viewWidth = mImageViewRect.right - mImageViewRect.left;
+			int	viewHeight = mImageViewRect.bottom - mImageViewRect.top;
+			if (viewWidth <= 0 || viewHeight <= 0 || mImage->getWidth() <= 0 || mImage->getHeight() <= 0)
+				return;
+
+			double	scale = (double )viewWidth / mImage->getWidth();
+			if (scale > (double )viewHeight / mImage->getHeight())
+				scale = (double )viewHeight / mImage->getHeight();
+			setView(
+				(mImage->getWidth() - viewWidth / scale) / 2,
+				(mImage->getHeight() - viewHeight / scale) / 2,
+				scale);
+		}
+
+	protected:
+		// Constatns -----------------------------------------------------------
+		const static int	IMAGE_STR_BUF_SIZE			= 256;
+		const static int	MAX_VIEW_SCALE				= 64;
+
+		// Member Variables ----------------------------------------------------
+		TiledImageType		*mImage;
+		double				mViewX;
+		double				mViewY;
+		double				mViewScale;
+		int					mMissingTileNum;
+		RECT				mImageViewRect;
+		bool				mIsMouseDragging;
+		POINT				mMouseDownPos;
+		double				mViewXStart;
+		double				mViewYStart;
+
+		BITMAPINFO			mBitmapInfo;
+		unsigned char		*mViewBuffer;			// BGRA
+		size_t				mViewBufferSize;
+		bool				mIsViewBufferValid;		// holds the view below
+		double				mRenderedViewX;
+		double				mRenderedViewY;
+		double				mRenderedViewScale;
+		int					mRenderedWidth;
+		int					mRenderedHeight;
+
+		// Member Functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// onWM_SIZE
+		// ---------------------------------------------------------------------
+		virtual bool	onWM_SIZE(UINT inMessage, WPARAM inWParam, LPARAM inLParam, LRESULT *outResult)
+		{
+			SDIWindow::onWM_SIZE(inMessage, inWParam, inLParam, outResult);
+
+			mImageViewRect = getViewRect();
+			if (mViewScale <= 0)
+				fitViewToWindowSize();
+			updateImageView();
+			updateStatusBar();
+			return true;
+		}
+		// ---------------------------------------------------------------------
+		// onWM_PAINT
+		// ---------------------------------------------------------------------
+		virtual bool	onWM_PAINT(UINT inMessage, WPARAM inWParam, LPARAM inLParam, LRESULT *outResult)
+		{
+			PAINTSTRUCT	paintstruct;
+			HDC	hdc = ::BeginPaint(mWindowH, &paintstruct);
+			int	prevMissingTileNum = mMissingTileNum;
+			drawImage(hdc, paintstruct.rcPaint);
+			::EndPaint(mWindowH, &paintstruct);
+
+			if (mMissingTileNum != prevMissingTileNum)
+				updateStatusBar();
+			return true;
+		}
+		// ---------------------------------------------------------------------
+		// onWM_LBUTTONDOWN
+		// ---------------------------------------------------------------------
+		virtual bool	onWM_LBUTTONDOWN(UINT inMessage, WPARAM inWParam, LPARAM inLParam, LRESULT *outResult)
+		{
+			mMouseDownPos.x = (short )LOWORD(inLParam);
+			mMouseDownPos.y = (short )HIWORD(inLParam);
+			mViewXStart = mViewX;
+			mViewYStart = mViewY;
+			mIsMouseDragging = true;
+			::SetCapture(mWindowH);
+			return true;
+		}
+		// ---------------------------------------------------------------------
+		// onWM_MOUSEMOVE
+		// ---------------------------------------------------------------------
+		virtual bool	onWM_MOUSEMOVE(UINT inMessage, WPARAM inWParam, LPARAM inLParam, LRESULT *outResult)
+		{
+			if (mIsMouseDragging == false || mViewScale <= 0)
+				return false;
+
+			POINT	currentPos;
+			currentPos.x = (short )LOWORD(inLParam);
+			currentPos.y = (short )HIWORD(inLParam);
+
+			mViewX = mViewXStart - (currentPos.x - mMouseDownPos.x) / mViewScale;
+			mViewY = mViewYStart - (currentPos.y - mMouseDownPos.y) / mViewScale;
+			updateImageView();
+			return true;
+		}
+		// ---------------------------------------------------------------------
+		// onWM_LBUTTONUP
+		// ---------------------------------------------------------------------
+		virtual bool	onWM_LBUTTONUP(UINT inMessage, WPARAM inWParam, LPARAM inLParam, LRESULT *outResult)
+		{
+			if (mIsMouseDragging)
+			{
+				mIsMouseDragging = false;
+				::ReleaseCapture();
+			}
+			return true;
+		}
+		// ---------------------------------------------------------------------
+		// onWM_MOUSEWHEEL
+		// ---------------------------------------------------------------------
+		//	Half an octave per notch, around the mouse position
+		virtual bool	onWM_MOUSEWHEEL(UINT inMessage, WPARAM inWParam, LPARAM inLParam, LRESULT *outResult)
+		{
+			POINT	mousePos;
+			mousePos.x = (short )LOWORD(inLParam);
+			mousePos.y = (short )HIWORD(inLParam);
+			::ScreenToClient(mWindowH, &mousePos);
+			if (::PtInRect(&mImageViewRect, mousePos) == 0 || mViewScale <= 0)
+				return false;
+
+			mousePos.x -= mImageViewRect.left;
+			mousePos.y -= mImageViewRect.top;
+			double	x = mViewX + mousePos.x / mViewScale;
+			double	y = mViewY + mousePos.y / mViewScale;
+
+			int	zDelta = GET_WHEEL_DELTA_WPARAM(inWParam);
+			double	scale = mViewScale * pow(2.0, zDelta / (double )WHEEL_DELTA / 2.0);
+			if (scale > MAX_VIEW_SCALE)
+				scale = MAX_VIEW_SCALE;
+
+			setView(x - mousePos.x / scale, y - mousePos.y / scale, scale);
+			return true;
+		}
+		// ---------------------------------------------------------------------
+		// updateImageView
+		// ---------------------------------------------------------------------
+		void	updateImageView()
+		{
+			if (mWindowState != WINDOW_OPEN_STATE)
+				return;
+			::InvalidateRect(mWindowH, &mImageViewRect, false);
+		}
+		// ---------------------------------------------------------------------
+		// updateTileView
+		// ---------------------------------------------------------------------
+		//	On a loader thread. Invalidates the part of the view the tile
+		//	covers, a pan or zoom meanwhile invalidates the whole view anyway.
+		void	updateTileView(int inLevel, int inTileX, int inTileY)
+		{
+			if (mWindowState != WINDOW_OPEN_STATE)
+				return;
+
+			RECT	viewRect = mImageViewRect;
+			typename TiledImageType::Rect	rect;
+			if (mImage->obtainTileViewRect(inLevel, inTileX, inTileY, mViewX, mViewY, mViewScale,
+					viewRect.right - viewRect.left, viewRect.bottom - viewRect.top, &rect) == false)
+				return;
+
+			RECT	tileRect;
+			tileRect.left = viewRect.left + rect.x0;
+			tileRect.top = viewRect.top + rect.y0;
+			tileRect.right = viewRect.left + rect.x1;
+			tileRect.bottom = viewRect.top + rect.y1;
+			::InvalidateRect(mWindowH, &tileRect, false);
+		}
+		// ---------------------------------------------------------------------
+		// updateStatusBar
+		// ---------------------------------------------------------------------
+		virtual void	updateStatusBar()
+		{
+			if (mWindowState != WINDOW_OPEN_STATE)
+				return;
+
+			RECT	rect;
+			::GetClientRect(mWindowH, &rect);
+
+			int	statusbarSize[] = {100, 200, rect.right};
+			::SendMessage(mStatusbarH, SB_SETPARTS, (WPARAM )3, (LPARAM )(LPINT)statusbarSize);
+
+		#ifdef _UNICODE
+			wchar_t	buf[IMAGE_STR_BUF_SIZE];
+
+			swprintf_s(buf, IMAGE_STR_BUF_SIZE, TEXT("Zoom: %.1f%%"), mViewScale * 100);
+			::SendMessage(mStatusbarH, SB_SETTEXT, (WPARAM )0, (LPARAM )buf);
+			swprintf_s(buf, IMAGE_STR_BUF_SIZE, TEXT("Level: %d"), mImage->obtainLevel(mViewScale));
+			::SendMessage(mStatusbarH, SB_SETTEXT, (WPARAM )1, (LPARAM )buf);
+			if (mMissingTileNum > 0)
+				swprintf_s(buf, IMAGE_STR_BUF_SIZE, TEXT("Loading %d tiles"), mMissingTileNum);
+			else
+				swprintf_s(buf, IMAGE_STR_BUF_SIZE, TEXT(""));
+			::SendMessage(mStatusbarH, SB_SETTEXT, (WPARAM )2, (LPARAM )buf);
+		#else
+			char	buf[IMAGE_STR_BUF_SIZE];
+
+			sprintf_s(buf, IMAGE_STR_BUF_SIZE, TEXT("Zoom: %.1f%%"), mViewScale * 100);
+			::SendMessage(mStatusbarH, SB_SETTEXT, (WPARAM )0, (LPARAM )buf);
+			sprintf_s(buf, IMAGE_STR_BUF_SIZE, TEXT("Level: %d"), mImage->obtainLevel(mViewScale));
+			::SendMessage(mStatusbarH, SB_SETTEXT, (WPARAM )1, (LPARAM )buf);
+			if (mMissingTileNum > 0)
+				sprintf_s(buf, IMAGE_STR_BUF_SIZE, TEXT("Loading %d tiles"), mMissingTileNum);
+			else
+				sprintf_s(buf, IMAGE_STR_BUF_SIZE, TEXT(""));
+			::SendMessage(mStatusbarH, SB_SETTEXT, (WPARAM )2, (LPARAM )buf);
+		#endif
+		}
+		// ---------------------------------------------------------------------
+		// drawImage
+		// ---------------------------------------------------------------------
+		//	Renders only inPaintRect when the buffer holds the current view
+		void	drawImage(HDC inHDC, const RECT &inPaintRect)
+		{
+			VIW_TRACE_SCOPE("drawImage", static_cast<SDIWindow *>(this));
+
+			int	width = mImageViewRect.right - mImageViewRect.left;
+			int	height = mImageViewRect.bottom - mImageViewRect.top;
+			if (width <= 0 || height <= 0 || mViewScale <= 0)
+				return;
+
+			size_t	bufferSize = (size_t )width * height * 4;
+			if (bufferSize > mViewBufferSize)
+			{
+				if (mViewBuffer != NULL)
+					delete [] mViewBuffer;
+				mViewBufferSize = 0;
+				mIsViewBufferValid = false;
+				mViewBuffer = new(std::nothrow) unsigned char[bufferSize];
+				if (mViewBuffer == NULL)
+				{
+					printf("Error: Can't allocate the view buffer\n");
+					return;
+				}
+				mViewBufferSize = bufferSize;
+			}
+
+			typename TiledImageType::Rect	clip;
+			clip.x0 = 0;
+			clip.y0 = 0;
+			clip.x1 = width;
+			clip.y1 = height;
+			if (mIsViewBufferValid &&
+				mRenderedViewX == mViewX && mRenderedViewY == mViewY && mRenderedViewScale == mViewScale &&
+				mRenderedWidth == width && mRenderedHeight == height)
+			{
+				clip.x0 = inPaintRect.left - mImageViewRect.left;
+				clip.y0 = inPaintRect.top - mImageViewRect.top;
+				clip.x1 = inPaintRect.right - mImageViewRect.left;
+				clip.y1 = inPaintRect.bottom - mImageViewRect.top;
+			}
+
+			mMissingTileNum = mImage->renderViewRect(mViewX, mViewY, mViewScale,
+								width, height, mViewBuffer, (size_t )width * 4, clip);
+			mIsViewBufferValid = (mMissingTileNum >= 0);
+			mRenderedViewX = mViewX;
+			mRenderedViewY = mViewY;
+			mRenderedViewScale = mViewScale;
+			mRenderedWidth = width;
+			mRenderedHeight = height;
+
+			mBitmapInfo.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+			mBitmapInfo.bmiHeader.biWidth = width;
+			mBitmapInfo.bmiHeader.biHeight = -height;		// top-down
+			mBitmapInfo.bmiHeader.biPlanes = 1;
+			mBitmapInfo.bmiHeader.biBitCount = 32;
+			mBitmapInfo.bmiHeader.biCompression = BI_RGB;
+			::SetDIBitsToDevice(inHDC,
+				mImageViewRect.left, mImageViewRect.top,
+				width, height,
+				0, 0,
+				0, height,
+				mViewBuffer, &mBitmapInfo, DIB_RGB_COLORS);
+		}
+
+		// Static Functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// tileLoadedFunc
+		// ---------------------------------------------------------------------
+		//	On a loader thread, the repaints of a burst of tiles are merged
+		//	by the window manager
+		static void	tileLoadedFunc(int inLevel, int inTileX, int inTileY, void *inData)
+		{
+			((TiledImageWindow *)inData)->updateTileView(inLevel, inTileX, inTileY);
+		}
+	};
+};
+
+#endif	// #ifdef VIW_TILED_IMAGE_WINDOW_H
@@ -24,9 +24,14 @@
 #define VIW_UTIL_BITMAP_H
 
 // Includes --------------------------------------------------------------------
+#ifdef _WIN32
 #include <Windows.h>
+#endif
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <new>
 #include "viw/utils/ColorMap.hpp"
 #include "viw/Exception.hpp"
 
@@ -35,12 +40,69 @@ namespace viw
 {
  namespace model
  {
+#ifndef _WIN32
+	// -------------------------------------------------------------------------
+	// DIB types
+	// -------------------------------------------------------------------------
+	//	Same layout as the <Windows.h> definitions, so that the file I/O and
+	//	the DisplayBuffer / BitmapBuffer code build without Win32
+	typedef unsigned char	BYTE;
+	typedef unsigned short	WORD;
+	typedef unsigned int	DWORD;
+	typedef int				LONG;
+
+#pragma pack(push, 2)
+	typedef struct tagBITMAPFILEHEADER
+	{
+		WORD	bfType;
+		DWORD	bfSize;
+		WORD	bfReserved1;
+		WORD	bfReserved2;
+		DWORD	bfOffBits;
+	} BITMAPFILEHEADER;
+#pragma pack(pop)
+
+	typedef struct tagBITMAPINFOHEADER
+	{
+		DWORD	biSize;
+		LONG	biWidth;
+		LONG	biHeight;
+		WORD	biPlanes;
+		WORD	biBitCount;
+		DWORD	biCompression;
+		DWORD	biSizeImage;
+		LONG	biXPelsPerMeter;
+		LONG	biYPelsPerMeter;
+		DWORD	biClrUsed;
+		DWORD	biClrImportant;
+	} BITMAPINFOHEADER;
+
+	typedef struct tagRGBQUAD
+	{
+		BYTE	rgbBlue;
+		BYTE	rgbGreen;
+		BYTE	rgbRed;
+		BYTE	rgbReserved;
+	} RGBQUAD;
+
+	typedef struct tagBITMAPINFO
+	{
+		BITMAPINFOHEADER	bmiHeader;
+		RGBQUAD				bmiColors[1];
+	} BITMAPINFO;
+#endif
+
 	// -------------------------------------------------------------------------
 	// Bitmap class
 	// -------------------------------------------------------------------------
 	class	Bitmap
 	{
 	public:
+		// Constatns -----------------------------------------------------------
+		//	ReadFile() / WriteFile() take a DWORD, so the bits of a frame over
+		//	4GB go through in pieces
+		const static size_t	FILE_IO_CHUNK_SIZE	= 256 * 1024 * 1024;
+
 		// Constructors and Destructor -----------------------------------------
 		// ---------------------------------------------------------------------
 		// ~Bitmap
@@ -48,10 +110,10 @@ namespace viw
 		virtual ~Bitmap()
 		{
 			if (mAllocatedBitmapInfoPtr != NULL)
-				delete mAllocatedBitmapInfoPtr;
+				delete [] (unsigned char *)mAllocatedBitmapInfoPtr;
 
 			if (mAllocatedBitmapBitsPtr != NULL)
-				delete mAllocatedBitmapBitsPtr;
+				delete [] mAllocatedBitmapBitsPtr;
 		}
 
 		// Member functions ----------------------------------------------------
@@ -176,7 +238,7 @@ namespace viw
 				}
 
 				if (mAllocatedBitmapInfoPtr != NULL)
-					delete mAllocatedBitmapInfoPtr;
+					delete [] (unsigned char *)mAllocatedBitmapInfoPtr;
 				mAllocatedBitmapInfoPtr = NULL;
 				if (allocateBitmapInfo(colorPalletNum) == false)
 					return false;
@@ -225,7 +287,7 @@ namespace viw
 				return true;
 
 			mBitmapLineOffset = calBitmapLineOffset(mBitmapInfoPtr);
-			mBitmapBitsSize = mBitmapLineOffset * getHeight();
+			mBitmapBitsSize = mBitmapLineOffset * (size_t )getHeight();
 
 			if (inBufferSize != mBitmapBitsSize)
 			{
@@ -238,7 +300,7 @@ namespace viw
 
 			if (mAllocatedBitmapBitsPtr != NULL)
 			{
-				delete mAllocatedBitmapBitsPtr;
+				delete [] mAllocatedBitmapBitsPtr;
 				mAllocatedBitmapBitsPtr = NULL;
 			}
 
@@ -250,6 +312,7 @@ namespace viw
 		// ---------------------------------------------------------------------
 		bool	saveToFile(const char *inFileName)
 		{
+		#ifdef _WIN32
 			LPCTSTR			fileName;
 			bool			result;
 
@@ -273,69 +336,41 @@ namespace viw
 			}
 
 			return result;
+		#else
+			FileHandle	fileHandle = fopen(inFileName, "wb");
+			if (fileHandle == NULL)
+			{
+				if (mThrowsEx == false)
+					return false;
+				else
+					throw ViwException(ViwException::OS_ERROR,
+					"fopen() returned NULL", VIW_EXCEPTION_LOCATION_MACRO, getLastOSError());
+			}
+
+			return saveToFileHandle(fileHandle);
+		#endif
 		}
+	#ifdef _WIN32
 		// ---------------------------------------------------------------------
 		// saveToFile
 		// ---------------------------------------------------------------------
 		bool	saveToFile(const LPCTSTR inFileName)
 		{
 			HANDLE					fileHandle;
-			BITMAPFILEHEADER		bmpFHeader;
-			DWORD					sizeInBytes;
-			BOOL					result;
 
 			fileHandle = ::CreateFileW(inFileName, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
 			if (fileHandle == INVALID_HANDLE_VALUE)
 			{
-				if (mThrowsEx == false)
-					return NULL;
-				else
-					throw ViwException(ViwException::OS_ERROR,
-					"::CreateFileW() returned NULL", VIW_EXCEPTION_LOCATION_MACRO, ::GetLastError());
-			}
-
-			bmpFHeader.bfType		= 0x4d42;
-			bmpFHeader.bfOffBits	= (DWORD )(sizeof(BITMAPFILEHEADER) + mBitmapInfoSize);
-			bmpFHeader.bfReserved1	= 0;
-			bmpFHeader.bfReserved2	= 0;
-			bmpFHeader.bfSize		= (DWORD )(bmpFHeader.bfOffBits + mBitmapBitsSize);
-
-			result = ::WriteFile(fileHandle, &bmpFHeader, sizeof(BITMAPFILEHEADER), &sizeInBytes, NULL);
-			if (result == 0 || sizeInBytes != sizeof(BITMAPFILEHEADER))
-			{
-				::CloseHandle(fileHandle);
-				if (mThrowsEx == false)
-					return false;
-				else
-					throw ViwException(ViwException::OS_ERROR,
-					"::WriteFile() returned an error", VIW_EXCEPTION_LOCATION_MACRO, ::GetLastError());
-			}
-
-			result = ::WriteFile(fileHandle, mBitmapInfoPtr, (DWORD)mBitmapInfoSize, &sizeInBytes, NULL);
-			if (result == 0 || sizeInBytes != mBitmapInfoSize)
-			{
-				::CloseHandle(fileHandle);
 				if (mThrowsEx == false)
 					return false;
 				else
 					throw ViwException(ViwException::OS_ERROR,
-					"::WriteFile() returned an error", VIW_EXCEPTION_LOCATION_MACRO, ::GetLastError());
-			}
-
-			result = ::WriteFile(fileHandle, mBitmapBitsPtr, (DWORD)mBitmapBitsSize, &sizeInBytes, NULL);
-			if (result == 0 || sizeInBytes != mBitmapBitsSize)
-			{
-				::CloseHandle(fileHandle);
-				if (mThrowsEx == false)
-					return false;
-				else
-					throw ViwException(ViwException::OS_ERROR,
-					"::WriteFile() returned an error", VIW_EXCEPTION_LOCATION_MACRO, ::GetLastError());
+					"::CreateFileW() returned NULL", VIW_EXCEPTION_LOCATION_MACRO, ::GetLastError());
 			}
-			::CloseHandle(fileHandle);
 
-			return true;
+			return saveToFileHandle(fileHandle);
 		}
+	#endif
 		// ---------------------------------------------------------------------
 		// dump
 		// ---------------------------------------------------------------------
@@ -421,6 +456,7 @@ namespace viw
 		// ---------------------------------------------------------------------
 		static Bitmap	*loadFromFile(const char *inFileName, bool inThrowsEx = false)
 		{
+		#ifdef _WIN32
 			LPCTSTR			fileName;
 			Bitmap			*bitmap;
 
@@ -442,17 +478,27 @@ namespace viw
 			}
 
 			return bitmap;
+		#else
+			FileHandle	fileHandle = fopen(inFileName, "rb");
+			if (fileHandle == NULL)
+			{
+				if (inThrowsEx == false)
+					return NULL;
+				else
+					throw ViwException(ViwException::OS_ERROR,
+					"fopen() returned NULL", VIW_EXCEPTION_LOCATION_MACRO, getLastOSError());
+			}
+
+			return loadFromFileHandle(fileHandle, inThrowsEx);
+		#endif
 		}
+	#ifdef _WIN32
 		// ---------------------------------------------------------------------
 		// loadFromFile
 		// ---------------------------------------------------------------------
 		static Bitmap	*loadFromFile(const LPCTSTR inFileName, bool inThrowsEx = false)
 		{
 			HANDLE					fileHandle;
-			BITMAPFILEHEADER		bmpFHeader;
-			BITMAPINFOHEADER		bmpInfo;
-			DWORD					sizeInBytes;
-			BOOL					result;
 
 			fileHandle = ::CreateFileW(inFileName, GENERIC_READ, 0, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
 			if (fileHandle == INVALID_HANDLE_VALUE)
@@ -464,171 +510,22 @@ namespace viw
 					"::CreateFile() returned NULL", VIW_EXCEPTION_LOCATION_MACRO, ::GetLastError());
 			}
 
-			result = ::ReadFile(fileHandle, &bmpFHeader, sizeof(BITMAPFILEHEADER), &sizeInBytes, NULL);
-			if (result == 0 || sizeInBytes != sizeof(BITMAPFILEHEADER))
-			{
-				::CloseHandle(fileHandle);
-				if (inThrowsEx == false)
-					return NULL;
-				else
-					throw ViwException(ViwException::OS_ERROR,
-					"::ReadFile() returned an error", VIW_EXCEPTION_LOCATION_MACRO, ::GetLastError());
-			}
-			
-			// Check bmpHeader
-			if (bmpFHeader.bfType != 0x4d42 || bmpFHeader.bfReserved1 != 0 || bmpFHeader.bfReserved2 != 0)
-			{
-				dumpBITMAPFILEHEADER(&bmpFHeader);
-				::CloseHandle(fileHandle);
-				if (inThrowsEx == false)
-					return NULL;
-				else
-					throw ViwException(ViwException::FILE_FORMAT_ERROR,
-					"bmpFHeader.bfType != 0x4d42 || bmpFHeader.bfReserved1 != 0 || bmpFHeader.bfReserved2 != 0",
-					VIW_EXCEPTION_LOCATION_MACRO, ::GetLastError());
-			}
-			
-			result = ::ReadFile(fileHandle, &bmpInfo, sizeof(BITMAPINFOHEADER), &sizeInBytes, NULL);
-			if (result == 0 || sizeInBytes != sizeof(BITMAPINFOHEADER))
-			{
-				::CloseHandle(fileHandle);
-				if (inThrowsEx == false)
-					return NULL;
-				else
-					throw ViwException(ViwException::OS_ERROR,
-					"::ReadFile() returned an error", VIW_EXCEPTION_LOCATION_MACRO, ::GetLastError());
-			}
-			
-			// Check mBmpInfo (Dosen't support OS/2 type)
-			if (bmpInfo.biSize != sizeof(BITMAPINFOHEADER) ||
-				//bmpInfo.biPlanes != 1 || bmpInfo.biCompression != 0 || bmpInfo.biSizeImage != 0)
-				bmpInfo.biPlanes != 1 || bmpInfo.biCompression != 0)
-			{
-				dumpBITMAPINFOHEADER(&bmpInfo);
-				::CloseHandle(fileHandle);
-				if (inThrowsEx == false)
-					return NULL;
-				else
-					throw ViwException(ViwException::FILE_FORMAT_ERROR,
-					"bmpInfo.biSize != sizeof(BITMAPINFOHEADER) || bmpInfo.biPlanes != 1 || bmpInfo.biCompression != 0 || bmpInfo.biSizeImage != 0",
-					VIW_EXCEPTION_LOCATION_MACRO, ::GetLastError());
-			}
-			
-			int	rgbQuadNum = calColorPalletNum(&bmpInfo);			
-			DWORD	offBits = sizeof(BITMAPFILEHEADER) + sizeof(BITMAPINFOHEADER) + sizeof(RGBQUAD) * rgbQuadNum;
-			if (bmpFHeader.bfOffBits < offBits)
-			{
-				::CloseHandle(fileHandle);
-				if (inThrowsEx == false)
-					return NULL;
-				else
-					throw ViwException(ViwException::FILE_FORMAT_ERROR,
-					"bmpFHeader.bfOffBits < offBits",
-					VIW_EXCEPTION_LOCATION_MACRO, ::GetLastError());
-			}
-			Bitmap	*bitmap = new Bitmap(inThrowsEx);
-			if (bitmap == NULL)
-			{
-				::CloseHandle(fileHandle);
-				if (inThrowsEx == false)
-					return NULL;
-				else
-					throw ViwException(ViwException::MEMORY_ERROR,
-					"new Bitmap(inThrowsEx) returned NULL", VIW_EXCEPTION_LOCATION_MACRO, ::GetLastError());
-			}
-
-			try
-			{
-				if (!bitmap->allocateBitmapInfo(rgbQuadNum))
-				{
-					::CloseHandle(fileHandle);
-					delete bitmap;
-					return NULL;
-				}
-			}
-
-			catch (ViwException &ex)
-			{
-				::CloseHandle(fileHandle);
-				delete bitmap;
-				throw ex;
-			}
-
-			*bitmap->mBitmapInfoPtr = bmpInfo;
-			if (bitmap->mColorPalletNum != 0)
-			{
-				unsigned char	*colorPalletPtr = (unsigned char *)bitmap->mBitmapInfoPtr;
-				colorPalletPtr += sizeof(BITMAPINFOHEADER);
-				size_t	colorPalletSize = sizeof(RGBQUAD) * bitmap->mColorPalletNum;
-				result = ::ReadFile(fileHandle, colorPalletPtr, (DWORD)colorPalletSize, &sizeInBytes, NULL);
-				if (result == 0 || sizeInBytes != colorPalletSize)
-				{
-					::CloseHandle(fileHandle);
-					delete bitmap;
-					if (inThrowsEx == false)
-						return NULL;
-					else
-						throw ViwException(ViwException::OS_ERROR,
-						"::ReadFile() returned an error", VIW_EXCEPTION_LOCATION_MACRO, ::GetLastError());
-				}
-				if (bmpFHeader.bfOffBits != offBits)
-				{
-					printf("WARNING: bmpFHeader.bfOffBits != offBits:%d, %d\n", bmpFHeader.bfOffBits, offBits);
-					DWORD filePointer = ::SetFilePointer(fileHandle, (bmpFHeader.bfOffBits - offBits), NULL, FILE_CURRENT);
-					if (filePointer == INVALID_SET_FILE_POINTER)
-					{
-						::CloseHandle(fileHandle);
-						delete bitmap;
-						if (inThrowsEx == false)
-							return NULL;
-						else
-							throw ViwException(ViwException::OS_ERROR,
-							"::SetFilePointer() returned an error", VIW_EXCEPTION_LOCATION_MACRO, ::GetLastError());
-					}
-				}
-			}
-			bitmap->mBitmapLineOffset = calBitmapLineOffset(bitmap->mBitmapInfoPtr);
-			bitmap->mBitmapBitsSize = bitmap->mBitmapLineOffset * getAbsBitmapHeight(bitmap->mBitmapInfoPtr);
-			bitmap->mBitmapBitsPtr = new unsigned char[bitmap->mBitmapBitsSize];
-			if (bitmap->mBitmapBitsPtr == NULL)
-			{
-				::CloseHandle(fileHandle);
-				delete bitmap;
-				if (inThrowsEx == false)
-					return NULL;
-				else
-					throw ViwException(ViwException::MEMORY_ERROR,
-					"new unsigned char[bitmap->mBitmapBitsSize] returned NULL", VIW_EXCEPTION_LOCATION_MACRO, ::GetLastError());
-			}
-			
-			result = ::ReadFile(fileHandle, bitmap->mBitmapBitsPtr, (DWORD)bitmap->mBitmapBitsSize, &sizeInBytes, NULL);
-			if (result == 0 || sizeInBytes != bitmap->mBitmapBitsSize)
-			{
-				::CloseHandle(fileHandle);
-				delete bitmap;
-				if (inThrowsEx == false)
-					return NULL;
-				else
-					throw ViwException(ViwException::OS_ERROR,
-					"::ReadFile() returned an error", VIW_EXCEPTION_LOCATION_MACRO, ::GetLastError());
-			}
-			::CloseHandle(fileHandle);
-
-			return bitmap;
+			return loadFromFileHandle(fileHandle, inThrowsEx);
 		}
+	#endif
 		// ---------------------------------------------------------------------
 		// calBitmapBitsSize
 		// ---------------------------------------------------------------------
 		static size_t	calBitmapBitsSize(int inWidth, int inHeight, int inBitCount)
 		{
-			return calBitmapLineOffset(inWidth, inBitCount) * abs(inHeight);
+			return calBitmapLineOffset(inWidth, inBitCount) * (size_t )abs(inHeight);
 		}
 		// ---------------------------------------------------------------------
 		// calBitmapBitsSize
 		// ---------------------------------------------------------------------
 		static size_t	calBitmapBitsSize(const BITMAPINFOHEADER *inBmpInfo)
 		{
-			return calBitmapLineOffset(inBmpInfo) * getAbsBitmapHeight(inBmpInfo);
+			return calBitmapLineOffset(inBmpInfo) * (size_t )getAbsBitmapHeight(inBmpInfo);
 		}
 		// ---------------------------------------------------------------------
 		// calBitmapLineOffset
@@ -640,14 +537,12 @@ namespace viw
 		// ---------------------------------------------------------------------
 		// calBitmapLineOffset
 		// ---------------------------------------------------------------------
+		//	DWORD aligned, rounding the partial byte of 1 / 4bpp lines up
 		static size_t	calBitmapLineOffset(int inWidth, int inBitCount)
 		{
-			int	lineOffset;
-			lineOffset = inWidth * inBitCount;
-			lineOffset /= 8;
-			if (lineOffset % 4 != 0)
-				lineOffset = (lineOffset / 4 + 1) * 4;
-			return lineOffset;
+			if (inWidth <= 0 || inBitCount <= 0)
+				return 0;
+			return ((size_t )inWidth * inBitCount + 31) / 32 * 4;
 		}
 		// ---------------------------------------------------------------------
 		// calColorPalletNum
@@ -717,14 +612,36 @@ namespace viw
 				return;
 			}
 
-			utils::ColorMap::getColorMap(inIndex, num, (unsigned char *)inBmpInfo->bmiColors);
+			unsigned char	rgb[256 * 3];
+			utils::ColorMap::getColorMap(inIndex, num, rgb);
+			setColorPallet(inBmpInfo, rgb, num);
+		}
+		// ---------------------------------------------------------------------
+		// setColorPallet
+		// ---------------------------------------------------------------------
+		//	inRGB holds inNum R, G, B triplets (ColorMap order)
+		static void	setColorPallet(BITMAPINFO *inBmpInfo, const unsigned char *inRGB, int inNum)
+		{
+			int	num = calColorPalletNum(inBmpInfo->bmiHeader.biBitCount);
+			if (inNum < num)
+				num = inNum;
+
+			for (int i = 0; i < num; i++, inRGB += 3)
+			{
+				inBmpInfo->bmiColors[i].rgbRed = inRGB[0];
+				inBmpInfo->bmiColors[i].rgbGreen = inRGB[1];
+				inBmpInfo->bmiColors[i].rgbBlue = inRGB[2];
+				inBmpInfo->bmiColors[i].rgbReserved = 0;
+			}
 		}
 		// ---------------------------------------------------------------------
 		// setBitmapBitsSize
 		// ---------------------------------------------------------------------
 		static void	setBitmapBitsSize(BITMAPINFOHEADER *inBmpInfo)
 		{
-			inBmpInfo->biSizeImage = (DWORD)(calBitmapLineOffset(inBmpInfo) * getAbsBitmapHeight(inBmpInfo));
+			// biSizeImage may be 0 for BI_RGB, which is all we can say over 4GB
+			size_t	bitsSize = calBitmapBitsSize(inBmpInfo);
+			inBmpInfo->biSizeImage = (bitsSize > 0xFFFFFFFF) ? 0 : (DWORD )bitsSize;
 		}
 		// ---------------------------------------------------------------------
 		// getAbsBitmapHeight
@@ -772,6 +689,13 @@ namespace viw
 		}
 
 	protected:
+		// Typedefs ------------------------------------------------------------
+	#ifdef _WIN32
+		typedef HANDLE		FileHandle;
+	#else
+		typedef FILE		*FileHandle;
+	#endif
+
 		// Member variables ----------------------------------------------------
 		BITMAPINFOHEADER	*mBitmapInfoPtr;
 		BITMAPINFOHEADER	*mAllocatedBitmapInfoPtr;
@@ -801,6 +725,49 @@ namespace viw
 			mThrowsEx = inThrowsEx;
 		}
 
+		// Member functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// saveToFileHandle
+		// ---------------------------------------------------------------------
+		//	Writes the file and closes inFileHandle
+		bool	saveToFileHandle(FileHandle inFileHandle)
+		{
+			BITMAPFILEHEADER		bmpFHeader;
+
+			bmpFHeader.bfType		= 0x4d42;
+			bmpFHeader.bfOffBits	= (DWORD )(sizeof(BITMAPFILEHEADER) + mBitmapInfoSize);
+			bmpFHeader.bfReserved1	= 0;
+			bmpFHeader.bfReserved2	= 0;
+			size_t	fileSize = bmpFHeader.bfOffBits + mBitmapBitsSize;
+			bmpFHeader.bfSize		= (fileSize > 0xFFFFFFFF) ? 0 : (DWORD )fileSize;	// readers ignore it
+
+			if (writeFile(inFileHandle, &bmpFHeader, sizeof(BITMAPFILEHEADER)) == false ||
+				writeFile(inFileHandle, mBitmapInfoPtr, mBitmapInfoSize) == false ||
+				writeFile(inFileHandle, mBitmapBitsPtr, mBitmapBitsSize) == false)
+			{
+				unsigned int	error = getLastOSError();
+				closeFile(inFileHandle);
+				if (mThrowsEx == false)
+					return false;
+				else
+					throw ViwException(ViwException::OS_ERROR,
+					"writeFile() returned an error", VIW_EXCEPTION_LOCATION_MACRO, error);
+			}
+
+			if (closeFile(inFileHandle) == false)
+			{
+				if (mThrowsEx == false)
+					return false;
+				else
+					throw ViwException(ViwException::OS_ERROR,
+					"closeFile() returned an error", VIW_EXCEPTION_LOCATION_MACRO, getLastOSError());
+			}
+
+			return true;
+		}
+		// ---------------------------------------------------------------------
+		// allocateBitmapInfo
+		// ---------------------------------------------------------------------
 		bool	allocateBitmapInfo(int inColorPalletNum = 0)
 		{
 			mColorPalletNum = inColorPalletNum;
@@ -813,33 +780,280 @@ namespace viw
 					return false;
 				else
 					throw ViwException(ViwException::MEMORY_ERROR,
-					"new unsigned char[mBitmapInfoSize] returned NULL", VIW_EXCEPTION_LOCATION_MACRO, ::GetLastError());
+					"new unsigned char[mBitmapInfoSize] returned NULL", VIW_EXCEPTION_LOCATION_MACRO, 0);
 			}
 
 			mBitmapInfoPtr = mAllocatedBitmapInfoPtr;
-			::ZeroMemory(mBitmapInfoPtr, mBitmapInfoSize);
+			memset(mBitmapInfoPtr, 0, mBitmapInfoSize);
 			return true;
 		}
-
+		// ---------------------------------------------------------------------
+		// allocateImageBuffer
+		// ---------------------------------------------------------------------
 		bool	allocateImageBuffer()
 		{
 			mBitmapLineOffset = calBitmapLineOffset(mBitmapInfoPtr);
-			mBitmapBitsSize = mBitmapLineOffset * getHeight();
+			mBitmapBitsSize = mBitmapLineOffset * (size_t )getHeight();
 			
-			mAllocatedBitmapBitsPtr = new unsigned char[mBitmapBitsSize];
+			mAllocatedBitmapBitsPtr = new(std::nothrow) unsigned char[mBitmapBitsSize];
 			if (mAllocatedBitmapBitsPtr == NULL)
 			{
 				if (mThrowsEx == false)
 					return false;
 				else
 					throw ViwException(ViwException::MEMORY_ERROR,
-					"new unsigned char[mBitmapBitsSize] returned NULL", VIW_EXCEPTION_LOCATION_MACRO, ::GetLastError());
+					"new unsigned char[mBitmapBitsSize] returned NULL", VIW_EXCEPTION_LOCATION_MACRO, 0);
 			}
 
 			mBitmapBitsPtr = mAllocatedBitmapBitsPtr;
-			::ZeroMemory(mBitmapBitsPtr, mBitmapBitsSize);
+			memset(mBitmapBitsPtr, 0, mBitmapBitsSize);
 			return true;
 		}
+
+		// Static Functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// loadFromFileHandle
+		// ---------------------------------------------------------------------
+		//	Reads the file and closes inFileHandle
+		static Bitmap	*loadFromFileHandle(FileHandle inFileHandle, bool inThrowsEx)
+		{
+			BITMAPFILEHEADER		bmpFHeader;
+			BITMAPINFOHEADER		bmpInfo;
+
+			if (readFile(inFileHandle, &bmpFHeader, sizeof(BITMAPFILEHEADER)) == false)
+			{
+				unsigned int	error = getLastOSError();
+				closeFile(inFileHandle);
+				if (inThrowsEx == false)
+					return NULL;
+				else
+					throw ViwException(ViwException::OS_ERROR,
+					"readFile() returned an error", VIW_EXCEPTION_LOCATION_MACRO, error);
+			}
+			
+			// Check bmpHeader
+			if (bmpFHeader.bfType != 0x4d42 || bmpFHeader.bfReserved1 != 0 || bmpFHeader.bfReserved2 != 0)
+			{
+				dumpBITMAPFILEHEADER(&bmpFHeader);
+				closeFile(inFileHandle);
+				if (inThrowsEx == false)
+					return NULL;
+				else
+					throw ViwException(ViwException::FILE_FORMAT_ERROR,
+					"bmpFHeader.bfType != 0x4d42 || bmpFHeader.bfReserved1 != 0 || bmpFHeader.bfReserved2 != 0",
+					VIW_EXCEPTION_LOCATION_MACRO, 0);
+			}
+			
+			if (readFile(inFileHandle, &bmpInfo, sizeof(BITMAPINFOHEADER)) == false)
+			{
+				unsigned int	error = getLastOSError();
+				closeFile(inFileHandle);
+				if (inThrowsEx == false)
+					return NULL;
+				else
+					throw ViwException(ViwException::OS_ERROR,
+					"readFile() returned an error", VIW_EXCEPTION_LOCATION_MACRO, error);
+			}
+			
+			// Check mBmpInfo (Dosen't support OS/2 type)
+			if (bmpInfo.biSize != sizeof(BITMAPINFOHEADER) ||
+				//bmpInfo.biPlanes != 1 || bmpInfo.biCompression != 0 || bmpInfo.biSizeImage != 0)
+				bmpInfo.biPlanes != 1 || bmpInfo.biCompression != 0)
+			{
+				dumpBITMAPINFOHEADER(&bmpInfo);
+				closeFile(inFileHandle);
+				if (inThrowsEx == false)
+					return NULL;
+				else
+					throw ViwException(ViwException::FILE_FORMAT_ERROR,
+					"bmpInfo.biSize != sizeof(BITMAPINFOHEADER) || bmpInfo.biPlanes != 1 || bmpInfo.biCompression != 0 || bmpInfo.biSizeImage != 0",
+					VIW_EXCEPTION_LOCATION_MACRO, 0);
+			}
+			
+			int	rgbQuadNum = calColorPalletNum(&bmpInfo);			
+			DWORD	offBits = sizeof(BITMAPFILEHEADER) + sizeof(BITMAPINFOHEADER) + sizeof(RGBQUAD) * rgbQuadNum;
+			if (bmpFHeader.bfOffBits < offBits)
+			{
+				closeFile(inFileHandle);
+				if (inThrowsEx == false)
+					return NULL;
+				else
+					throw ViwException(ViwException::FILE_FORMAT_ERROR,
+					"bmpFHeader.bfOffBits < offBits",
+					VIW_EXCEPTION_LOCATION_MACRO, 0);
+			}
+			Bitmap	*bitmap = new Bitmap(inThrowsEx);
+			if (bitmap == NULL)
+			{
+				closeFile(inFileHandle);
+				if (inThrowsEx == false)
+					return NULL;
+				else
+					throw ViwException(ViwException::MEMORY_ERROR,
+					"new Bitmap(inThrowsEx) returned NULL", VIW_EXCEPTION_LOCATION_MACRO, 0);
+			}
+
+			try
+			{
+				if (!bitmap->allocateBitmapInfo(rgbQuadNum))
+				{
+					closeFile(inFileHandle);
+					delete bitmap;
+					return NULL;
+				}
+			}
+
+			catch (ViwException &ex)
+			{
+				closeFile(inFileHandle);
+				delete bitmap;
+				throw ex;
+			}
+
+			*bitmap->mBitmapInfoPtr = bmpInfo;
+			if (bitmap->mColorPalletNum != 0)
+			{
+				unsigned char	*colorPalletPtr = (unsigned char *)bitmap->mBitmapInfoPtr;
+				colorPalletPtr += sizeof(BITMAPINFOHEADER);
+				size_t	colorPalletSize = sizeof(RGBQUAD) * bitmap->mColorPalletNum;
+				if (readFile(inFileHandle, colorPalletPtr, colorPalletSize) == false)
+				{
+					unsigned int	error = getLastOSError();
+					closeFile(inFileHandle);
+					delete bitmap;
+					if (inThrowsEx == false)
+						return NULL;
+					else
+						throw ViwException(ViwException::OS_ERROR,
+						"readFile() returned an error", VIW_EXCEPTION_LOCATION_MACRO, error);
+				}
+			}
+			if (bmpFHeader.bfOffBits != offBits)
+			{
+				printf("WARNING: bmpFHeader.bfOffBits != offBits:%u, %u\n", (unsigned int )bmpFHeader.bfOffBits, (unsigned int )offBits);
+				if (skipFile(inFileHandle, bmpFHeader.bfOffBits - offBits) == false)
+				{
+					unsigned int	error = getLastOSError();
+					closeFile(inFileHandle);
+					delete bitmap;
+					if (inThrowsEx == false)
+						return NULL;
+					else
+						throw ViwException(ViwException::OS_ERROR,
+						"skipFile() returned an error", VIW_EXCEPTION_LOCATION_MACRO, error);
+				}
+			}
+			bitmap->mBitmapLineOffset = calBitmapLineOffset(bitmap->mBitmapInfoPtr);
+			bitmap->mBitmapBitsSize = calBitmapBitsSize(bitmap->mBitmapInfoPtr);
+			bitmap->mAllocatedBitmapBitsPtr = new(std::nothrow) unsigned char[bitmap->mBitmapBitsSize];
+			bitmap->mBitmapBitsPtr = bitmap->mAllocatedBitmapBitsPtr;
+			if (bitmap->mBitmapBitsPtr == NULL)
+			{
+				closeFile(inFileHandle);
+				delete bitmap;
+				if (inThrowsEx == false)
+					return NULL;
+				else
+					throw ViwException(ViwException::MEMORY_ERROR,
+					"new unsigned char[bitmap->mBitmapBitsSize] returned NULL", VIW_EXCEPTION_LOCATION_MACRO, 0);
+			}
+			
+			if (readFile(inFileHandle, bitmap->mBitmapBitsPtr, bitmap->mBitmapBitsSize) == false)
+			{
+				unsigned int	error = getLastOSError();
+				closeFile(inFileHandle);
+				delete bitmap;
+				if (inThrowsEx == false)
+					return NULL;
+				else
+					throw ViwException(ViwException::OS_ERROR,
+					"readFile() returned an error", VIW_EXCEPTION_LOCATION_MACRO, error);
+			}
+			closeFile(inFileHandle);
+
+			return bitmap;
+		}
+		// ---------------------------------------------------------------------
+		// readFile
+		// ---------------------------------------------------------------------
+		static bool	readFile(FileHandle inFileHandle, void *outBuffer, size_t inSize)
+		{
+			unsigned char	*bufferPtr = (unsigned char *)outBuffer;
+			while (inSize != 0)
+			{
+				size_t	chunkSize = (inSize < FILE_IO_CHUNK_SIZE) ? inSize : (size_t )FILE_IO_CHUNK_SIZE;
+			#ifdef _WIN32
+				DWORD	sizeInBytes;
+				BOOL	result = ::ReadFile(inFileHandle, bufferPtr, (DWORD )chunkSize, &sizeInBytes, NULL);
+				if (result == 0 || sizeInBytes != chunkSize)
+					return false;
+			#else
+				if (fread(bufferPtr, 1, chunkSize, inFileHandle) != chunkSize)
+					return false;
+			#endif
+				bufferPtr += chunkSize;
+				inSize -= chunkSize;
+			}
+			return true;
+		}
+		// ---------------------------------------------------------------------
+		// writeFile
+		// ---------------------------------------------------------------------
+		static bool	writeFile(FileHandle inFileHandle, const void *inBuffer, size_t inSize)
+		{
+			const unsigned char	*bufferPtr = (const unsigned char *)inBuffer;
+			while (inSize != 0)
+			{
+				size_t	chunkSize = (inSize < FILE_IO_CHUNK_SIZE) ? inSize : (size_t )FILE_IO_CHUNK_SIZE;
+			#ifdef _WIN32
+				DWORD	sizeInBytes;
+				BOOL	result = ::WriteFile(inFileHandle, bufferPtr, (DWORD )chunkSize, &sizeInBytes, NULL);
+				if (result == 0 || sizeInBytes != chunkSize)
+					return false;
+			#else
+				if (fwrite(bufferPtr, 1, chunkSize, inFileHandle) != chunkSize)
+					return false;
+			#endif
+				bufferPtr += chunkSize;
+				inSize -= chunkSize;
+			}
+			return true;
+		}
+		// ---------------------------------------------------------------------
+		// skipFile
+		// ---------------------------------------------------------------------
+		static bool	skipFile(FileHandle inFileHandle, DWORD inSize)
+		{
+		#ifdef _WIN32
+			LARGE_INTEGER	distance;
+			distance.QuadPart = inSize;
+			return (::SetFilePointerEx(inFileHandle, distance, NULL, FILE_CURRENT) != 0);
+		#else
+			return (fseek(inFileHandle, (long )inSize, SEEK_CUR) == 0);
+		#endif
+		}
+		// ---------------------------------------------------------------------
+		// closeFile
+		// ---------------------------------------------------------------------
+		static bool	closeFile(FileHandle inFileHandle)
+		{
+		#ifdef _WIN32
+			return (::CloseHandle(inFileHandle) != 0);
+		#else
+			return (fclose(inFileHandle) == 0);
+		#endif
+		}
+		// ---------------------------------------------------------------------
+		// getLastOSError
+		// ---------------------------------------------------------------------
+		static unsigned int	getLastOSError()
+		{
+		#ifdef _WIN32
+			return ::GetLastError();
+		#else
+			return (unsigned int )errno;
+		#endif
+		}
 	};
  };
 };
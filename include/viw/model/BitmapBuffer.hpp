@@ -24,11 +24,10 @@
 #define VIW_MODEL_BITMAPBUFFER_H
 
 // Includes --------------------------------------------------------------------
-#include <Windows.h>
 #include <stdio.h>
 #include "viw/Exception.hpp"
-#include "viw/Model/DisplayBuffer.hpp"
-#include "viw/Model/Bitmap.hpp"
+#include "viw/model/DisplayBuffer.hpp"
+#include "viw/model/Bitmap.hpp"
 
 // Namespace -------------------------------------------------------------------
 namespace viw
@@ -41,12 +40,23 @@ namespace viw
 	template <typename ImageBufferType> class	BitmapBuffer : public DisplayBuffer<ImageBufferType>
 	{
 	public:
+		// Typedefs ------------------------------------------------------------
+		typedef DisplayBuffer<ImageBufferType>			DisplayBufferBase;
+		typedef typename DisplayBufferBase::BufferFormat	BufferFormat;
+		using DisplayBufferBase::BUFFER_FORMAT_MONO;
+		using DisplayBufferBase::BUFFER_FORMAT_BGR;
+		using DisplayBufferBase::BUFFER_FORMAT_BGRA;
+		using DisplayBufferBase::allocateDisplayBuffer;
+		using DisplayBufferBase::getDisplayPalette;
+		using DisplayBufferBase::getDisplayBufferSize;
+		using DisplayBufferBase::obtainDisplayFormat;
+
 		// Constructors and Destructor -----------------------------------------
 		// ---------------------------------------------------------------------
 		// BitmapBuffer
 		// ---------------------------------------------------------------------
 		BitmapBuffer(bool inThroswEx = false)
-			: DisplayBuffer(inThroswEx)
+			: DisplayBuffer<ImageBufferType>(inThroswEx)
 		{
 			mBitmap	= NULL;
 		}
@@ -85,7 +95,7 @@ namespace viw
 		// ---------------------------------------------------------------------
 		size_t	getBitmapInfoSize()
 		{
-			BITMAPINFOHEADER	*header = getBitmapInfoHeaderPtr();
+			const BITMAPINFOHEADER	*header = getBitmapInfoHeaderPtr();
 			if (header == NULL)
 				return 0;
 
@@ -96,17 +106,19 @@ namespace viw
 		// ---------------------------------------------------------------------
 		int	getColorIndexNum()
 		{
-			BITMAPINFOHEADER	*header = getBitmapInfoHeaderPtr();
+			const BITMAPINFOHEADER	*header = getBitmapInfoHeaderPtr();
 			if (header == NULL)
 				return 0;
 
-			return mBitmap->getColorIndexNum();
+			return mBitmap->getColorPalletNum();
 		}
 		// ---------------------------------------------------------------------
 		// getBitmapImageBufPtr
 		// ---------------------------------------------------------------------
 		const unsigned char	*getBitmapImageBufPtr()
 		{
+			VIW_TRACE_SCOPE("getBitmapImageBufPtr", this->getTraceContext());
+
 			if (updateBitmapInfoPtr() == false)
 				return NULL;
 
@@ -114,6 +126,9 @@ namespace viw
 			if (imageBufferPtr == NULL)
 				return NULL;
 
+			if (mBitmap->getColorPalletNum() == 256)
+				Bitmap::setColorPallet((BITMAPINFO *)mBitmap->getBitmapInfoPtr(), getDisplayPalette(), 256);
+
 			if (mBitmap->setBitmapBits(imageBufferPtr, getDisplayBufferSize()) == false)
 				return NULL;
 			
@@ -130,6 +145,7 @@ namespace viw
 
 			return mBitmap->saveToFile(inFileName);
 		}
+	#ifdef _WIN32
 		// ---------------------------------------------------------------------
 		// saveToBitmapFile
 		// ---------------------------------------------------------------------
@@ -141,6 +157,7 @@ namespace viw
 
 			return mBitmap->saveToFile(inFileName);
 		}
+	#endif
 		// ---------------------------------------------------------------------
 		// loadFromBitmapFile
 		// ---------------------------------------------------------------------
@@ -148,6 +165,7 @@ namespace viw
 		{
 			return false;
 		}
+	#ifdef _WIN32
 		// ---------------------------------------------------------------------
 		// loadFromBitmapFile
 		// ---------------------------------------------------------------------
@@ -155,6 +173,7 @@ namespace viw
 		{
 			return false;
 		}
+	#endif
 		// ---------------------------------------------------------------------
 		// cloneBitmap
 		// ---------------------------------------------------------------------
@@ -170,7 +189,7 @@ namespace viw
 			if (mBitmap != NULL)
 				return true;
 
-			int	bitCount = obtainBitmapBitCount(mFormat);
+			int	bitCount = obtainBitmapBitCount(obtainDisplayFormat(mFormat));
 			if (bitCount == 0)
 			{
 				if (mThrowsEx == false)
@@ -207,18 +226,23 @@ namespace viw
 			{
 				case BUFFER_FORMAT_MONO:
 					return 8;
-				//case BUFFER_FORMAT_RGB:
 				case BUFFER_FORMAT_BGR:
 					return 24;
-				//case BUFFER_FORMAT_RGBA:
-				//case BUFFER_FORMAT_BGRA:
-				//	return 4;
+				case BUFFER_FORMAT_BGRA:
+					return 32;
 			}
 
 			return 0;
 		}
 
 	protected:
+		// Typedefs ------------------------------------------------------------
+		using DisplayBufferBase::mThrowsEx;
+		using DisplayBufferBase::mFormat;
+		using DisplayBufferBase::mWidth;
+		using DisplayBufferBase::mHeight;
+		using DisplayBufferBase::mIsBottomUp;
+
 		// Member variables ----------------------------------------------------
 		Bitmap				*mBitmap;
 
@@ -247,7 +271,7 @@ namespace viw
 				return true;
 			}
 
-			int	bitCount = obtainBitmapBitCount(mFormat);
+			int	bitCount = obtainBitmapBitCount(obtainDisplayFormat(mFormat));
 			int height = obtainBitmapHeight(mHeight, mIsBottomUp);
 
 			return mBitmap->setBitmapInfo(mWidth, height, bitCount);
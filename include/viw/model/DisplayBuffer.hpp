@@ -25,10 +25,23 @@
 #define VIW_MODEL_DISPLAYBUFFER_H
 
 // Includes --------------------------------------------------------------------
+#ifdef _WIN32
 #include <Windows.h>
+#endif
 #include <stdio.h>
+#include <limits>
+#include <mutex>
 #include "viw/Exception.hpp"
-#include "viw/Model/ImageBuffer.hpp"
+#include "viw/model/ImageBuffer.hpp"
+#include "viw/utils/Demosaic.hpp"
+#include "viw/utils/Dither.hpp"
+#include "viw/utils/ToneMap.hpp"
+#include "viw/utils/ColorMap.hpp"
+#include "viw/utils/Lut3D.hpp"
+#include "viw/utils/BitWindow.hpp"
+#include "viw/utils/Swizzle.hpp"
+#include "viw/utils/ThreadPool.hpp"
+#include "viw/utils/Trace.hpp"
 
 // Namespace -------------------------------------------------------------------
 namespace viw
@@ -41,6 +54,32 @@ namespace viw
 	 template <typename ImageBufferType> class	DisplayBuffer : public ImageBuffer<ImageBufferType>
 	{
 	public:
+		// Typedefs ------------------------------------------------------------
+		//	Members of the dependent base are not found by unqualified lookup
+		//	on conforming compilers (GCC, clang), so they are named here
+		typedef ImageBuffer<ImageBufferType>			ImageBufferBase;
+		typedef typename ImageBufferBase::BufferFormat	BufferFormat;
+		using ImageBufferBase::BUFFER_FORMAT_NOT_SPECIFIED;
+		using ImageBufferBase::BUFFER_FORMAT_MONO;
+		using ImageBufferBase::BUFFER_FORMAT_RGB;
+		using ImageBufferBase::BUFFER_FORMAT_RGBA;
+		using ImageBufferBase::BUFFER_FORMAT_BGR;
+		using ImageBufferBase::BUFFER_FORMAT_BGRA;
+		using ImageBufferBase::BUFFER_FORMAT_BAYER_RG;
+		using ImageBufferBase::BUFFER_FORMAT_BAYER_GR;
+		using ImageBufferBase::BUFFER_FORMAT_BAYER_GB;
+		using ImageBufferBase::BUFFER_FORMAT_BAYER_BG;
+		using ImageBufferBase::getImageBufferPtr;
+		using ImageBufferBase::getImageBufferLinePtr;
+		using ImageBufferBase::getImageBufferSize;
+		using ImageBufferBase::getLineElementCount;
+		using ImageBufferBase::isImageModified;
+		using ImageBufferBase::obtainOnePixelCount;
+		using ImageBufferBase::obtainPackingType;
+		using ImageBufferBase::isPackedFormat;
+		using ImageBufferBase::isComplexFormat;
+		using ImageBufferBase::isBayerFormat;
+
 		// Enum ----------------------------------------------------------------
 		enum DisplayMapMode
 		{
@@ -48,6 +87,10 @@ namespace viw
 			DISPLAY_MAP_ANY,
 			DISPLAY_MAP_NONE,
 			DISPLAY_MAP_DIRECT,
+			DISPLAY_MAP_LINEAR,			// display range to [0, 255]
+			DISPLAY_MAP_LOG,			// log(1 + x)
+			DISPLAY_MAP_SQRT,
+			DISPLAY_MAP_GAMMA,
 
 			DISPLAY_MAP_PARTIAL							= 1024,
 
@@ -61,7 +104,7 @@ namespace viw
 		// DisplayImageBuffer
 		// ---------------------------------------------------------------------
 		DisplayBuffer(bool inThroswEx = false)
-			: ImageBuffer(inThroswEx)
+			: ImageBuffer<ImageBufferType>(inThroswEx)
 		{
 
 			if (typeid(ImageBufferType) == typeid(unsigned char))
@@ -76,13 +119,49 @@ namespace viw
 			}
 
 			mDisplayBuffer = NULL;
+			mTraceContext = this;
 
 			mDisplayFormat = BUFFER_FORMAT_NOT_SPECIFIED;
 			mDisplayWidth = 0;
 			mDisplayHeight = 0;
 			mDisplayIsBottomUp = false;
+			mDisplayLineOffset = 0;
+			mDisplayBufferSize = 0;
+
+			obtainDefaultDisplayRange(BUFFER_FORMAT_NOT_SPECIFIED, &mDisplayRangeMin, &mDisplayRangeMax);
+			mIsDisplayRangeSpecified = false;
+			mIsAutoDisplayRange = false;
+			mAutoRangeMin = mDisplayRangeMin;
+			mAutoRangeMax = mDisplayRangeMax;
+
+			mIsNonFiniteColorEnabled = false;
+			setColor(mNonFiniteColor[0], 255, 0, 255);	// NaN
+			setColor(mNonFiniteColor[1], 255, 0, 0);	// +Inf
+			setColor(mNonFiniteColor[2], 0, 0, 255);	// -Inf
+			mColorMapIndex = utils::ColorMap::CMIndex_GrayScale;
+			mIsDisplayPaletteUpdateNeeded = true;
+
+			mDitherMode = utils::Dither::DITHER_NONE;
+			mDisplayGamma = 2.2;
+			mComplexComponent = utils::ToneMap::COMPLEX_MAGNITUDE;
+			mPartialBitShift = 0;
+
+			mDemosaicMethod = utils::Demosaic::DEMOSAIC_BILINEAR;
+			mWhiteBalanceGain[0] = 1.0;
+			mWhiteBalanceGain[1] = 1.0;
+			mWhiteBalanceGain[2] = 1.0;
+			mDisplayLut = NULL;
+			mDisplayLutSize = 0;
+			mDisplayLutChannelCount = 0;
+			mIsDisplayLutUpdateNeeded = true;
+			mPendingLut3D = NULL;
+			mActiveLut3D = NULL;
 
 			mIsBufferUpdateNeeded = false;
+			mModifiedStartY = 0;
+			mModifiedEndY = 0;
+			mMapStartY = 0;
+			mMapEndY = 0;
 		}
 		// ---------------------------------------------------------------------
 		// ~DisplayBuffer
@@ -90,7 +169,15 @@ namespace viw
 		virtual ~DisplayBuffer()
 		{
 			if (mDisplayBuffer != NULL)
-				delete mDisplayBuffer;
+				delete [] mDisplayBuffer;
+
+			if (mDisplayLut != NULL)
+				delete [] mDisplayLut;
+
+			if (mPendingLut3D != NULL)
+				delete mPendingLut3D;
+			if (mActiveLut3D != NULL)
+				delete mActiveLut3D;
 		}
 
 		// Member functions ----------------------------------------------------
@@ -99,24 +186,94 @@ namespace viw
 		// ---------------------------------------------------------------------
 		virtual void	updateDisplayBuffer()
 		{
-			if (mUseParentBuffer == true)
+			VIW_TRACE_SCOPE("updateDisplayBuffer", mTraceContext);
+
+			// Lines marked while this pass runs are mapped by the next one
+			int	modifiedStartY, modifiedEndY;
+			takeModifiedLines(&modifiedStartY, &modifiedEndY);
+
+			if (isParentBufferDisplayable())
 				return;
 
 			if (mDisplayBuffer == NULL)
 				return;
 
-			switch (mMapMode)
+			// Only a pass that has nothing but marked lines is narrowed, a
+			// direct call (pixels changed, nothing marked) maps everything
+			mMapStartY = 0;
+			mMapEndY = mDisplayHeight;
+			if (isBufferUpdateNeeded() == false && isImageModified() == false && mIsAutoDisplayRange == false &&
+				modifiedStartY < modifiedEndY)
 			{
-				case DISPLAY_MAP_DIRECT:
-				default:	// DISPLAY_MAP_DIRECT
-					displayMapDirect();
-					break;
+				// Bayer lines depend on the 2 lines above and below
+				int	margin = isBayerFormat(mFormat) ? 2 : 0;
+				mMapStartY = (modifiedStartY > margin) ? modifiedStartY - margin : 0;
+				mMapEndY = (modifiedEndY + margin < mDisplayHeight) ? modifiedEndY + margin : mDisplayHeight;
+			}
+
+			if (mIsAutoDisplayRange)
+				updateAutoDisplayRange();
+
+			if (isBayerFormat(mFormat))
+				displayMapBayer();
+			else if (isPackedFormat(mFormat))
+				displayMapPacked();
+			else if (isComplexFormat(mFormat))
+				displayMapComplex();
+			else
+			{
+				switch (mMapMode)
+				{
+					case DISPLAY_MAP_LINEAR:
+						displayMapLinear();
+						break;
+					case DISPLAY_MAP_LOG:
+					case DISPLAY_MAP_SQRT:
+					case DISPLAY_MAP_GAMMA:
+						displayMapToneCurve();
+						break;
+					case DISPLAY_MAP_PARTIAL:
+						displayMapPartial();
+						break;
+					case DISPLAY_MAP_LUT_3D:
+						if (displayMapLut3D())
+							break;
+						// fall through
+					case DISPLAY_MAP_DIRECT:
+					default:	// DISPLAY_MAP_DIRECT
+						displayMapDirect();
+						break;
+				}
 			}
 
 			clearIsImageModifiedFlag();
 			clearIsBufferUpdateNeededFlag();
 		}
 		// ---------------------------------------------------------------------
+		// markLinesAsModified
+		// ---------------------------------------------------------------------
+		//	Marks buffer lines [inStartY, inEndY) as rewritten, e.g. by a loader
+		//	that fills the image progressively from another thread. Unlike
+		//	markAsImageModified() only these lines are mapped again (unless the
+		//	display range is automatic).
+		void	markLinesAsModified(int inStartY, int inEndY)
+		{
+			if (inStartY >= inEndY)
+				return;
+
+			std::lock_guard<std::mutex>	lock(mModifiedLinesMutex);
+			if (mModifiedStartY >= mModifiedEndY)
+			{
+				mModifiedStartY = inStartY;
+				mModifiedEndY = inEndY;
+				return;
+			}
+			if (inStartY < mModifiedStartY)
+				mModifiedStartY = inStartY;
+			if (inEndY > mModifiedEndY)
+				mModifiedEndY = inEndY;
+		}
+		// ---------------------------------------------------------------------
 		// getDisplayBufferPtr
 		// ---------------------------------------------------------------------
 		const unsigned char	*getDisplayBufferPtr()
@@ -128,12 +285,225 @@ namespace viw
 		// ---------------------------------------------------------------------
 		size_t	getDisplayBufferSize()
 		{
-			if (mUseParentBuffer == true)
+			if (isParentBufferDisplayable())
 				return getImageBufferSize();
 
 			return mDisplayBufferSize;
 		}
 		// ---------------------------------------------------------------------
+		// getDisplayFormat
+		// ---------------------------------------------------------------------
+		BufferFormat	getDisplayFormat()
+		{
+			return obtainDisplayFormat(mFormat);
+		}
+		// ---------------------------------------------------------------------
+		// getDisplayLineOffset
+		// ---------------------------------------------------------------------
+		size_t	getDisplayLineOffset()
+		{
+			if (isParentBufferDisplayable())
+				return (size_t )mWidth * mOnePixelCount;
+
+			return mDisplayLineOffset;
+		}
+		// ---------------------------------------------------------------------
+		// getDisplayRange
+		// ---------------------------------------------------------------------
+		void	getDisplayRange(double *outMin, double *outMax)
+		{
+			if (mIsAutoDisplayRange)
+			{
+				*outMin = mAutoRangeMin;
+				*outMax = mAutoRangeMax;
+				return;
+			}
+			if (mIsDisplayRangeSpecified == false)
+			{
+				obtainDefaultDisplayRange(mFormat, outMin, outMax);
+				return;
+			}
+			*outMin = mDisplayRangeMin;
+			*outMax = mDisplayRangeMax;
+		}
+		// ---------------------------------------------------------------------
+		// setDisplayRange
+		// ---------------------------------------------------------------------
+		//	Source values in [inMin, inMax] are mapped to [0, 255]
+		bool	setDisplayRange(double inMin, double inMax)
+		{
+			if (inMin >= inMax)
+			{
+				if (mThrowsEx == false)
+					return false;
+				else
+					throw ViwException(ViwException::PARAM_ERROR,
+						"inMin >= inMax", VIW_EXCEPTION_LOCATION_MACRO, 0);
+			}
+
+			mDisplayRangeMin = inMin;
+			mDisplayRangeMax = inMax;
+			mIsDisplayRangeSpecified = true;
+			mIsDisplayLutUpdateNeeded = true;
+			setAsBufferUpdateNeeded();
+			return true;
+		}
+		// ---------------------------------------------------------------------
+		// resetDisplayRange
+		// ---------------------------------------------------------------------
+		//	Goes back to the full range of the buffer format
+		void	resetDisplayRange()
+		{
+			mIsDisplayRangeSpecified = false;
+			mIsDisplayLutUpdateNeeded = true;
+			setAsBufferUpdateNeeded();
+		}
+		// ---------------------------------------------------------------------
+		// isAutoDisplayRange
+		// ---------------------------------------------------------------------
+		bool	isAutoDisplayRange()
+		{
+			return mIsAutoDisplayRange;
+		}
+		// ---------------------------------------------------------------------
+		// setAutoDisplayRange
+		// ---------------------------------------------------------------------
+		//	When enabled, the display range follows the finite min / max of
+		//	every frame (NaN and Inf are ignored)
+		void	setAutoDisplayRange(bool inIsAuto)
+		{
+			mIsAutoDisplayRange = inIsAuto;
+			mIsDisplayLutUpdateNeeded = true;
+			setAsBufferUpdateNeeded();
+		}
+		// ---------------------------------------------------------------------
+		// obtainFiniteRange
+		// ---------------------------------------------------------------------
+		//	Min and max of the finite elements (false if there are none)
+		bool	obtainFiniteRange(double *outMin, double *outMax)
+		{
+			if (getImageBufferPtr() == NULL || isPackedFormat(mFormat) || isComplexFormat(mFormat))
+				return false;
+
+			return utils::ToneMap::findFiniteRange(getImageBufferPtr(),
+						mImageBufferPixelCount, outMin, outMax);
+		}
+		// ---------------------------------------------------------------------
+		// isNonFiniteColorEnabled
+		// ---------------------------------------------------------------------
+		bool	isNonFiniteColorEnabled()
+		{
+			return mIsNonFiniteColorEnabled;
+		}
+		// ---------------------------------------------------------------------
+		// setNonFiniteColorEnabled
+		// ---------------------------------------------------------------------
+		//	Floating point mono buffers only. Finite values then use 253 levels
+		//	and NaN, +Inf and -Inf are shown in the non-finite colours.
+		void	setNonFiniteColorEnabled(bool inIsEnabled)
+		{
+			mIsNonFiniteColorEnabled = inIsEnabled;
+			mIsDisplayPaletteUpdateNeeded = true;
+			setAsBufferUpdateNeeded();
+		}
+		// ---------------------------------------------------------------------
+		// setNonFiniteColors
+		// ---------------------------------------------------------------------
+		//	Each colour is R, G, B (NULL keeps the current colour)
+		void	setNonFiniteColors(const unsigned char *inNaNColor,
+								const unsigned char *inPosInfColor, const unsigned char *inNegInfColor)
+		{
+			if (inNaNColor != NULL)
+				setColor(mNonFiniteColor[0], inNaNColor[0], inNaNColor[1], inNaNColor[2]);
+			if (inPosInfColor != NULL)
+				setColor(mNonFiniteColor[1], inPosInfColor[0], inPosInfColor[1], inPosInfColor[2]);
+			if (inNegInfColor != NULL)
+				setColor(mNonFiniteColor[2], inNegInfColor[0], inNegInfColor[1], inNegInfColor[2]);
+			mIsDisplayPaletteUpdateNeeded = true;
+		}
+		// ---------------------------------------------------------------------
+		// getColorMapIndex
+		// ---------------------------------------------------------------------
+		utils::ColorMap::ColorMapIndex	getColorMapIndex()
+		{
+			return mColorMapIndex;
+		}
+		// ---------------------------------------------------------------------
+		// setColorMapIndex
+		// ---------------------------------------------------------------------
+		//	Pseudocolor for mono display buffers (applied through the palette)
+		void	setColorMapIndex(utils::ColorMap::ColorMapIndex inIndex)
+		{
+			mColorMapIndex = inIndex;
+			mIsDisplayPaletteUpdateNeeded = true;
+		}
+		// ---------------------------------------------------------------------
+		// getDisplayPalette
+		// ---------------------------------------------------------------------
+		//	256 R, G, B triplets for mono display buffers
+		const unsigned char	*getDisplayPalette()
+		{
+			if (mIsDisplayPaletteUpdateNeeded)
+			{
+				if (isNonFiniteMarkingActive())
+				{
+					utils::ColorMap::getColorMap(mColorMapIndex, utils::ToneMap::FINITE_LEVEL_MAX + 1, mDisplayPalette);
+					::memcpy(mDisplayPalette + utils::ToneMap::NAN_INDEX * 3, mNonFiniteColor[0], 3);
+					::memcpy(mDisplayPalette + utils::ToneMap::POS_INF_INDEX * 3, mNonFiniteColor[1], 3);
+					::memcpy(mDisplayPalette + utils::ToneMap::NEG_INF_INDEX * 3, mNonFiniteColor[2], 3);
+				}
+				else
+					utils::ColorMap::getColorMap(mColorMapIndex, 256, mDisplayPalette);
+				mIsDisplayPaletteUpdateNeeded = false;
+			}
+			return mDisplayPalette;
+		}
+		// ---------------------------------------------------------------------
+		// getDemosaicMethod
+		// ---------------------------------------------------------------------
+		utils::Demosaic::DemosaicMethod	getDemosaicMethod()
+		{
+			return mDemosaicMethod;
+		}
+		// ---------------------------------------------------------------------
+		// setDemosaicMethod
+		// ---------------------------------------------------------------------
+		void	setDemosaicMethod(utils::Demosaic::DemosaicMethod inMethod)
+		{
+			mDemosaicMethod = inMethod;
+			setAsBufferUpdateNeeded();
+		}
+		// ---------------------------------------------------------------------
+		// getWhiteBalanceGain
+		// ---------------------------------------------------------------------
+		void	getWhiteBalanceGain(double *outGainR, double *outGainG, double *outGainB)
+		{
+			*outGainR = mWhiteBalanceGain[0];
+			*outGainG = mWhiteBalanceGain[1];
+			*outGainB = mWhiteBalanceGain[2];
+		}
+		// ---------------------------------------------------------------------
+		// setWhiteBalanceGain
+		// ---------------------------------------------------------------------
+		bool	setWhiteBalanceGain(double inGainR, double inGainG, double inGainB)
+		{
+			if (inGainR < 0 || inGainG < 0 || inGainB < 0)
+			{
+				if (mThrowsEx == false)
+					return false;
+				else
+					throw ViwException(ViwException::PARAM_ERROR,
+						"negative gain", VIW_EXCEPTION_LOCATION_MACRO, 0);
+			}
+
+			mWhiteBalanceGain[0] = inGainR;
+			mWhiteBalanceGain[1] = inGainG;
+			mWhiteBalanceGain[2] = inGainB;
+			mIsDisplayLutUpdateNeeded = true;
+			setAsBufferUpdateNeeded();
+			return true;
+		}
+		// ---------------------------------------------------------------------
 		// getDisplayMapMode
 		// ---------------------------------------------------------------------
 		DisplayMapMode	getDisplayMapMode()
@@ -145,7 +515,199 @@ namespace viw
 		// ---------------------------------------------------------------------
 		bool	setDisplayMapMode(DisplayMapMode inMapMode)
 		{
-			return false;
+			switch (inMapMode)
+			{
+				case DISPLAY_MAP_DIRECT:
+				case DISPLAY_MAP_LINEAR:
+				case DISPLAY_MAP_LOG:
+				case DISPLAY_MAP_SQRT:
+				case DISPLAY_MAP_GAMMA:
+					break;
+				case DISPLAY_MAP_PARTIAL:
+					if (std::numeric_limits<ImageBufferType>::is_integer)
+						break;
+					// fall through
+				case DISPLAY_MAP_LUT_3D:
+					if (typeid(ImageBufferType) == typeid(unsigned char))
+						break;
+					// fall through
+				case DISPLAY_MAP_NONE:
+					if (mUseParentBuffer)
+						break;
+					// fall through
+				default:
+					if (mThrowsEx == false)
+						return false;
+					else
+						throw ViwException(ViwException::PARAM_ERROR,
+							"Unsupported DisplayMapMode", VIW_EXCEPTION_LOCATION_MACRO, 0);
+			}
+
+			mMapMode = inMapMode;
+			setAsBufferUpdateNeeded();
+			return true;
+		}
+		// ---------------------------------------------------------------------
+		// setLut3D
+		// ---------------------------------------------------------------------
+		//	Used by DISPLAY_MAP_LUT_3D (BGR / BGRA unsigned char buffers).
+		//	The LUT is copied and handed over to the next updateDisplayBuffer()
+		//	call, so this can be called from any thread without blocking
+		//	the paint thread.
+		bool	setLut3D(const utils::Lut3D &inLut)
+		{
+			if (inLut.isValid() == false)
+			{
+				if (mThrowsEx == false)
+					return false;
+				else
+					throw ViwException(ViwException::PARAM_ERROR,
+						"inLut is not valid", VIW_EXCEPTION_LOCATION_MACRO, 0);
+			}
+
+			utils::Lut3D	*lut = new(std::nothrow) utils::Lut3D(inLut);
+			if (lut == NULL)
+			{
+				if (mThrowsEx == false)
+					return false;
+				else
+					throw ViwException(ViwException::MEMORY_ERROR,
+						"lut == NULL", VIW_EXCEPTION_LOCATION_MACRO, 0);
+			}
+			if (lut->isValid() == false)	// the table copy failed
+			{
+				delete lut;
+				if (mThrowsEx == false)
+					return false;
+				else
+					throw ViwException(ViwException::MEMORY_ERROR,
+						"lut->isValid() == false", VIW_EXCEPTION_LOCATION_MACRO, 0);
+			}
+
+			postLut3D(lut);
+			return true;
+		}
+		// ---------------------------------------------------------------------
+		// loadLut3DFromCubeFile
+		// ---------------------------------------------------------------------
+		bool	loadLut3DFromCubeFile(const char *inFileName)
+		{
+			utils::Lut3D	*lut = new(std::nothrow) utils::Lut3D(mThrowsEx);
+			if (lut == NULL)
+			{
+				if (mThrowsEx == false)
+					return false;
+				else
+					throw ViwException(ViwException::MEMORY_ERROR,
+						"lut == NULL", VIW_EXCEPTION_LOCATION_MACRO, 0);
+			}
+
+			try
+			{
+				if (lut->loadCubeFile(inFileName) == false)
+				{
+					delete lut;
+					return false;
+				}
+			}
+			catch (...)
+			{
+				delete lut;
+				throw;
+			}
+
+			postLut3D(lut);
+			return true;
+		}
+		// ---------------------------------------------------------------------
+		// getDisplayGamma
+		// ---------------------------------------------------------------------
+		double	getDisplayGamma()
+		{
+			return mDisplayGamma;
+		}
+		// ---------------------------------------------------------------------
+		// setDisplayGamma
+		// ---------------------------------------------------------------------
+		//	Used by DISPLAY_MAP_GAMMA (output = input ^ (1 / gamma))
+		bool	setDisplayGamma(double inGamma)
+		{
+			if (inGamma <= 0)
+			{
+				if (mThrowsEx == false)
+					return false;
+				else
+					throw ViwException(ViwException::PARAM_ERROR,
+						"inGamma <= 0", VIW_EXCEPTION_LOCATION_MACRO, 0);
+			}
+
+			mDisplayGamma = inGamma;
+			setAsBufferUpdateNeeded();
+			return true;
+		}
+		// ---------------------------------------------------------------------
+		// getComplexComponent
+		// ---------------------------------------------------------------------
+		utils::ToneMap::ComplexComponent	getComplexComponent()
+		{
+			return mComplexComponent;
+		}
+		// ---------------------------------------------------------------------
+		// setComplexComponent
+		// ---------------------------------------------------------------------
+		//	The magnitude goes through the map mode curve, the phase is always
+		//	mapped linearly from [-pi, pi]
+		void	setComplexComponent(utils::ToneMap::ComplexComponent inComponent)
+		{
+			mComplexComponent = inComponent;
+			setAsBufferUpdateNeeded();
+		}
+		// ---------------------------------------------------------------------
+		// getDitherMode
+		// ---------------------------------------------------------------------
+		utils::Dither::DitherMode	getDitherMode()
+		{
+			return mDitherMode;
+		}
+		// ---------------------------------------------------------------------
+		// setDitherMode
+		// ---------------------------------------------------------------------
+		//	Applies to the value mapping modes (DISPLAY_MAP_LINEAR, ...)
+		void	setDitherMode(utils::Dither::DitherMode inMode)
+		{
+			mDitherMode = inMode;
+			setAsBufferUpdateNeeded();
+		}
+		// ---------------------------------------------------------------------
+		// getPartialBitShift
+		// ---------------------------------------------------------------------
+		int	getPartialBitShift()
+		{
+			return mPartialBitShift;
+		}
+		// ---------------------------------------------------------------------
+		// setPartialBitShift
+		// ---------------------------------------------------------------------
+		//	Used by DISPLAY_MAP_PARTIAL, which shows bits
+		//	[inShift, inShift + 7] of each value (0 : the raw low byte).
+		//	The display buffer is kept, only the next update is affected.
+		bool	setPartialBitShift(int inShift)
+		{
+			if (inShift < 0 || inShift > (int )sizeof(ImageBufferType) * 8 - 8)
+			{
+				if (mThrowsEx == false)
+					return false;
+				else
+					throw ViwException(ViwException::PARAM_ERROR,
+						"inShift is out of range", VIW_EXCEPTION_LOCATION_MACRO, 0);
+			}
+
+			if (mPartialBitShift == inShift)
+				return true;
+			mPartialBitShift = inShift;
+			if (mMapMode == DISPLAY_MAP_PARTIAL)
+				setAsBufferUpdateNeeded();
+			return true;
 		}
 
 		// ---------------------------------------------------------------------
@@ -171,6 +733,30 @@ namespace viw
 		{
 			return mIsBufferUpdateNeeded;
 		}
+		// ---------------------------------------------------------------------
+		// isDisplayUpdateNeeded
+		// ---------------------------------------------------------------------
+		//	true if the next getDisplayBufferPtr() maps the image again
+		bool	isDisplayUpdateNeeded()
+		{
+			return (isBufferUpdateNeeded() || isImageModified() || hasModifiedLines());
+		}
+		// ---------------------------------------------------------------------
+		// setTraceContext
+		// ---------------------------------------------------------------------
+		//	The context the mapping is traced with (this by default), a
+		//	window sets its own pointer so all of its events share one key
+		void	setTraceContext(const void *inContext)
+		{
+			mTraceContext = inContext;
+		}
+		// ---------------------------------------------------------------------
+		// getTraceContext
+		// ---------------------------------------------------------------------
+		const void	*getTraceContext()
+		{
+			return mTraceContext;
+		}
 
 		// Static Functions ----------------------------------------------------
 		// ---------------------------------------------------------------------
@@ -179,9 +765,77 @@ namespace viw
 		static BufferFormat	obtainNativeColorFormat()
 		{
 		}
+		// ---------------------------------------------------------------------
+		// obtainDisplayFormat
+		// ---------------------------------------------------------------------
+		static BufferFormat	obtainDisplayFormat(BufferFormat inFormat)
+		{
+			if (isBayerFormat(inFormat))
+				return BUFFER_FORMAT_BGR;
+			if (isPackedFormat(inFormat) || isComplexFormat(inFormat))
+				return BUFFER_FORMAT_MONO;
+			if (inFormat == BUFFER_FORMAT_RGB)		// swizzled while mapping
+				return BUFFER_FORMAT_BGR;
+			if (inFormat == BUFFER_FORMAT_RGBA)
+				return BUFFER_FORMAT_BGRA;
+			return inFormat;
+		}
+		// ---------------------------------------------------------------------
+		// obtainDisplayLineOffset
+		// ---------------------------------------------------------------------
+		//	Display lines are DWORD aligned so that they can be used as DIB bits
+		static size_t	obtainDisplayLineOffset(int inWidth, int inOnePixelCount)
+		{
+			size_t	lineOffset = (size_t )inWidth * inOnePixelCount;
+			return (lineOffset + 3) & ~((size_t )3);
+		}
+		// ---------------------------------------------------------------------
+		// obtainDefaultDisplayRange
+		// ---------------------------------------------------------------------
+		static void	obtainDefaultDisplayRange(BufferFormat inFormat, double *outMin, double *outMax)
+		{
+			int	bitCount = utils::PackedPixel::obtainBitCount(obtainPackingType(inFormat));
+			if (bitCount != 0)
+			{
+				*outMin = 0;
+				*outMax = (double )((1 << bitCount) - 1);
+				return;
+			}
+			if (std::numeric_limits<ImageBufferType>::is_integer &&
+				sizeof(ImageBufferType) <= 2)
+			{
+				*outMin = (double )std::numeric_limits<ImageBufferType>::min();
+				*outMax = (double )std::numeric_limits<ImageBufferType>::max();
+				return;
+			}
+			if (std::numeric_limits<ImageBufferType>::is_integer)
+			{
+				*outMin = 0;
+				*outMax = 65535.0;
+				return;
+			}
+			*outMin = 0;
+			*outMax = 1.0;
+		}
 
 
 	protected:
+		// Typedefs ------------------------------------------------------------
+		using ImageBufferBase::mAllocatedImageBuffer;
+		using ImageBufferBase::mExternalImageBuffer;
+		using ImageBufferBase::mThrowsEx;
+		using ImageBufferBase::mFormat;
+		using ImageBufferBase::mWidth;
+		using ImageBufferBase::mHeight;
+		using ImageBufferBase::mIsBottomUp;
+		using ImageBufferBase::mOnePixelCount;
+		using ImageBufferBase::mLineElementCount;
+		using ImageBufferBase::mImageBufferPixelCount;
+		using ImageBufferBase::clearIsImageModifiedFlag;
+
+		// Constatns -----------------------------------------------------------
+		const static int	DISPLAY_MAP_BAND_HEIGHT		= 64;
+
 		// Member variables ----------------------------------------------------
 		DisplayMapMode		mMapMode;
 
@@ -192,39 +846,95 @@ namespace viw
 		int					mDisplayWidth;
 		int					mDisplayHeight;
 		bool				mDisplayIsBottomUp;
+		size_t				mDisplayLineOffset;
 		size_t				mDisplayBufferSize;
 
+		double				mDisplayRangeMin;
+		double				mDisplayRangeMax;
+		bool				mIsDisplayRangeSpecified;
+		bool				mIsAutoDisplayRange;
+		double				mAutoRangeMin;
+		double				mAutoRangeMax;
+
+		bool				mIsNonFiniteColorEnabled;
+		unsigned char		mNonFiniteColor[3][3];	// NaN, +Inf, -Inf (R, G, B)
+		utils::ColorMap::ColorMapIndex	mColorMapIndex;
+		unsigned char		mDisplayPalette[256 * 3];
+		bool				mIsDisplayPaletteUpdateNeeded;
+		utils::Dither::DitherMode	mDitherMode;
+		double				mDisplayGamma;
+		utils::ToneMap::ComplexComponent	mComplexComponent;
+		int					mPartialBitShift;
+
+		utils::Demosaic::DemosaicMethod	mDemosaicMethod;
+		double				mWhiteBalanceGain[3];	// R, G, B
+		unsigned char		*mDisplayLut;			// B, G, R when 3 channels
+		int					mDisplayLutSize;
+		int					mDisplayLutChannelCount;
+		bool				mIsDisplayLutUpdateNeeded;
+		utils::Lut3D * volatile	mPendingLut3D;	// published by setLut3D()
+		utils::Lut3D		*mActiveLut3D;			// owned by the mapping pass
+
 		bool				mIsBufferUpdateNeeded;
+		const void			*mTraceContext;
+
+		std::mutex			mModifiedLinesMutex;
+		int					mModifiedStartY;		// by markLinesAsModified()
+		int					mModifiedEndY;
+		int					mMapStartY;				// lines of the current mapping pass
+		int					mMapEndY;
 
 		// Member functions ----------------------------------------------------
 		// ---------------------------------------------------------------------
+		// hasModifiedLines
+		// ---------------------------------------------------------------------
+		bool	hasModifiedLines()
+		{
+			std::lock_guard<std::mutex>	lock(mModifiedLinesMutex);
+			return (mModifiedStartY < mModifiedEndY);
+		}
+		// ---------------------------------------------------------------------
+		// takeModifiedLines
+		// ---------------------------------------------------------------------
+		void	takeModifiedLines(int *outStartY, int *outEndY)
+		{
+			std::lock_guard<std::mutex>	lock(mModifiedLinesMutex);
+			*outStartY = mModifiedStartY;
+			*outEndY = mModifiedEndY;
+			mModifiedStartY = 0;
+			mModifiedEndY = 0;
+		}
+		// ---------------------------------------------------------------------
 		// allocateDisplayBuffer
 		// ---------------------------------------------------------------------
 		unsigned char	*allocateDisplayBuffer()
 		{
-			if (mUseParentBuffer == true)
-				return getImageBufferPtr();
+			if (isParentBufferDisplayable())
+				return (unsigned char *)getImageBufferPtr();
 
 			if (mAllocatedImageBuffer == NULL && mExternalImageBuffer == NULL)
 				return NULL;
 
-			//if (mWidth != mDisplayWidth && mHeight != mDisplayHeight && mFormat != mDisplayFormat)
-			if (mWidth != mDisplayWidth || mHeight != mDisplayHeight || mFormat != mDisplayFormat)
+			BufferFormat	displayFormat = obtainDisplayFormat(mFormat);
+			if (mWidth != mDisplayWidth || mHeight != mDisplayHeight || displayFormat != mDisplayFormat)
 			{
 				if (mDisplayBuffer != NULL)
-					delete mDisplayBuffer;
+					delete [] mDisplayBuffer;
 
-				mMapMode = DISPLAY_MAP_DIRECT;
+				if (mMapMode == DISPLAY_MAP_NOT_SPECIFIED)
+					mMapMode = DISPLAY_MAP_DIRECT;
 				mDisplayWidth = mWidth;
 				mDisplayHeight = mHeight;
-				mDisplayFormat = mFormat;
-				mDisplayBufferSize = mImageBufferPixelCount * sizeof(unsigned char);
+				mDisplayFormat = displayFormat;
+				mDisplayLineOffset = obtainDisplayLineOffset(mDisplayWidth, obtainOnePixelCount(mDisplayFormat));
+				mDisplayBufferSize = mDisplayLineOffset * mDisplayHeight;
+				mIsDisplayPaletteUpdateNeeded = true;
 
-				mDisplayBuffer = new unsigned char[mImageBufferPixelCount];
+				mDisplayBuffer = new(std::nothrow) unsigned char[mDisplayBufferSize];
 				if (mDisplayBuffer == NULL)
 				{
 					if (mThrowsEx == false)
-						return false;
+						return NULL;
 					else
 						throw ViwException(ViwException::MEMORY_ERROR,
 						"mDisplayBuffer == NULL", VIW_EXCEPTION_LOCATION_MACRO, 0);
@@ -232,22 +942,383 @@ namespace viw
 				setAsBufferUpdateNeeded();
 			}
 
-			if (isBufferUpdateNeeded() || isImageModified())
+			if (isDisplayUpdateNeeded())
 				updateDisplayBuffer();
 
 			return mDisplayBuffer;
 		}
 		// ---------------------------------------------------------------------
+		// isParentBufferDisplayable
+		// ---------------------------------------------------------------------
+		bool	isParentBufferDisplayable()
+		{
+			if (mUseParentBuffer == false)
+				return false;
+
+			if (mMapMode != DISPLAY_MAP_NONE && mMapMode != DISPLAY_MAP_NOT_SPECIFIED)
+				return false;
+
+			// DIB lines must be DWORD aligned (always true for BGRA)
+			if ((mWidth * mOnePixelCount) % 4 != 0)
+				return false;
+
+			return (obtainDisplayFormat(mFormat) == mFormat);
+		}
+		// ---------------------------------------------------------------------
 		// displayMapDirect
 		// ---------------------------------------------------------------------
 		void	displayMapDirect()
 		{
-			ImageBufferType	*srcPtr = getImageBufferPtr();
-			unsigned char	*dstPtr = mDisplayBuffer;
+			int	lineCount = mDisplayWidth * mOnePixelCount;
+			bool	isSwapNeeded = isRedBlueSwapNeeded();
+
+			utils::ThreadPool::parallelFor("DisplayMapDirect", mMapStartY, mMapEndY, DISPLAY_MAP_BAND_HEIGHT,
+				[&](int inStartY, int inEndY)
+			{
+				for (int y = inStartY; y < inEndY; y++)
+				{
+					ImageBufferType	*srcPtr = getImageBufferLinePtr(y);
+					unsigned char	*dstPtr = mDisplayBuffer + mDisplayLineOffset * y;
+					if (isSwapNeeded)
+					{
+						utils::Swizzle::swapRedBlueLine(srcPtr, mDisplayWidth, mOnePixelCount, dstPtr);
+						continue;
+					}
+					for (int x = 0; x < lineCount; x++, dstPtr++, srcPtr++)
+						*dstPtr = utils::Swizzle::obtainDirectValue(*srcPtr);
+				}
+			});
+		}
+		// ---------------------------------------------------------------------
+		// displayMapLinear
+		// ---------------------------------------------------------------------
+		void	displayMapLinear()
+		{
+			if (isNonFiniteMarkingActive())
+			{
+				displayMapToneCurve();
+				return;
+			}
+
+			double	rangeMin, rangeMax;
+			getDisplayRange(&rangeMin, &rangeMax);
+			float	scale = (float )(255.0 / (rangeMax - rangeMin));
+			int	lineCount = mDisplayWidth * mOnePixelCount;
+
+			utils::ThreadPool::parallelFor("DisplayMapLinear", mMapStartY, mMapEndY, DISPLAY_MAP_BAND_HEIGHT,
+				[&](int inStartY, int inEndY)
+			{
+				float	thresholdRow[utils::Dither::THRESHOLD_ROW_SIZE];
+				for (int y = inStartY; y < inEndY; y++)
+				{
+					utils::Dither::obtainThresholdRow(mDitherMode, y, thresholdRow);
+					utils::Dither::mapLineLinear(getImageBufferLinePtr(y), lineCount,
+						(float )rangeMin, scale, thresholdRow, mDisplayBuffer + mDisplayLineOffset * y);
+					swizzleDisplayLine(y);
+				}
+			});
+		}
+		// ---------------------------------------------------------------------
+		// displayMapToneCurve
+		// ---------------------------------------------------------------------
+		void	displayMapToneCurve()
+		{
+			utils::ToneMap::Parameters	param = obtainToneMapParameters();
+			int	lineCount = mDisplayWidth * mOnePixelCount;
+
+			utils::ThreadPool::parallelFor("DisplayMapToneCurve", mMapStartY, mMapEndY, DISPLAY_MAP_BAND_HEIGHT,
+				[&](int inStartY, int inEndY)
+			{
+				float	thresholdRow[utils::Dither::THRESHOLD_ROW_SIZE];
+				for (int y = inStartY; y < inEndY; y++)
+				{
+					utils::Dither::obtainThresholdRow(mDitherMode, y, thresholdRow);
+					utils::ToneMap::mapLine(getImageBufferLinePtr(y), lineCount,
+						param, thresholdRow, mDisplayBuffer + mDisplayLineOffset * y);
+					swizzleDisplayLine(y);
+				}
+			});
+		}
+		// ---------------------------------------------------------------------
+		// displayMapComplex
+		// ---------------------------------------------------------------------
+		void	displayMapComplex()
+		{
+			utils::ToneMap::Parameters	param = obtainToneMapParameters();
+
+			utils::ThreadPool::parallelFor("DisplayMapComplex", mMapStartY, mMapEndY, DISPLAY_MAP_BAND_HEIGHT,
+				[&](int inStartY, int inEndY)
+			{
+				float	thresholdRow[utils::Dither::THRESHOLD_ROW_SIZE];
+				for (int y = inStartY; y < inEndY; y++)
+				{
+					utils::Dither::obtainThresholdRow(mDitherMode, y, thresholdRow);
+					utils::ToneMap::mapComplexLine(getImageBufferLinePtr(y), mDisplayWidth,
+						mComplexComponent, param, thresholdRow, mDisplayBuffer + mDisplayLineOffset * y);
+				}
+			});
+		}
+		// ---------------------------------------------------------------------
+		// obtainToneMapParameters
+		// ---------------------------------------------------------------------
+		utils::ToneMap::Parameters	obtainToneMapParameters()
+		{
+			utils::ToneMap::ToneCurve	curve;
+			switch (mMapMode)
+			{
+				case DISPLAY_MAP_LOG:
+					curve = utils::ToneMap::TONE_CURVE_LOG;
+					break;
+				case DISPLAY_MAP_SQRT:
+					curve = utils::ToneMap::TONE_CURVE_SQRT;
+					break;
+				case DISPLAY_MAP_GAMMA:
+					curve = utils::ToneMap::TONE_CURVE_GAMMA;
+					break;
+				default:
+					curve = utils::ToneMap::TONE_CURVE_LINEAR;
+					break;
+			}
+
+			double	rangeMin, rangeMax;
+			getDisplayRange(&rangeMin, &rangeMax);
+			return utils::ToneMap::obtainParameters(curve, rangeMin, rangeMax, mDisplayGamma,
+						isNonFiniteMarkingActive());
+		}
+		// ---------------------------------------------------------------------
+		// isNonFiniteMarkingActive
+		// ---------------------------------------------------------------------
+		bool	isNonFiniteMarkingActive()
+		{
+			return (mIsNonFiniteColorEnabled &&
+					std::numeric_limits<ImageBufferType>::is_integer == false &&
+					obtainDisplayFormat(mFormat) == BUFFER_FORMAT_MONO);
+		}
+		// ---------------------------------------------------------------------
+		// updateAutoDisplayRange
+		// ---------------------------------------------------------------------
+		void	updateAutoDisplayRange()
+		{
+			double	rangeMin, rangeMax;
+			if (obtainFiniteRange(&rangeMin, &rangeMax) == false)
+				return;
+			if (rangeMax <= rangeMin)
+				rangeMax = rangeMin + 1;
+
+			if (rangeMin != mAutoRangeMin || rangeMax != mAutoRangeMax)
+			{
+				mAutoRangeMin = rangeMin;
+				mAutoRangeMax = rangeMax;
+				mIsDisplayLutUpdateNeeded = true;
+			}
+		}
+		// ---------------------------------------------------------------------
+		// setColor
+		// ---------------------------------------------------------------------
+		static void	setColor(unsigned char *outColor, unsigned char inR, unsigned char inG, unsigned char inB)
+		{
+			outColor[0] = inR;
+			outColor[1] = inG;
+			outColor[2] = inB;
+		}
+		// ---------------------------------------------------------------------
+		// displayMapBayer
+		// ---------------------------------------------------------------------
+		void	displayMapBayer()
+		{
+			int	lutSize = (sizeof(ImageBufferType) == 1) ? 256 : 65536;
+			if (updateDisplayLut(lutSize, 3) == false)
+				return;
+
+			utils::Demosaic::BayerPattern	pattern;
+			switch (mFormat)
+			{
+				case BUFFER_FORMAT_BAYER_GR:
+					pattern = utils::Demosaic::BAYER_PATTERN_GR;
+					break;
+				case BUFFER_FORMAT_BAYER_GB:
+					pattern = utils::Demosaic::BAYER_PATTERN_GB;
+					break;
+				case BUFFER_FORMAT_BAYER_BG:
+					pattern = utils::Demosaic::BAYER_PATTERN_BG;
+					break;
+				case BUFFER_FORMAT_BAYER_RG:
+				default:
+					pattern = utils::Demosaic::BAYER_PATTERN_RG;
+					break;
+			}
+
+			// Process in bands of rows to keep the 5 source lines in cache
+			utils::ThreadPool::parallelFor("DisplayMapBayer", mMapStartY, mMapEndY, DISPLAY_MAP_BAND_HEIGHT,
+				[&](int inStartY, int inEndY)
+			{
+				utils::Demosaic::demosaicToBGR(getImageBufferPtr(), mDisplayWidth, mDisplayHeight,
+					pattern, mDemosaicMethod, mDisplayLut, mDisplayLutSize,
+					mDisplayBuffer, mDisplayLineOffset, inStartY, inEndY);
+			});
+		}
+		// ---------------------------------------------------------------------
+		// displayMapPacked
+		// ---------------------------------------------------------------------
+		void	displayMapPacked()
+		{
+			utils::PackedPixel::PackingType	packingType = obtainPackingType(mFormat);
+			if (updateDisplayLut(1 << utils::PackedPixel::obtainBitCount(packingType), 1) == false)
+				return;
+
+			utils::ThreadPool::parallelFor("DisplayMapPacked", mMapStartY, mMapEndY, DISPLAY_MAP_BAND_HEIGHT,
+				[&](int inStartY, int inEndY)
+			{
+				for (int y = inStartY; y < inEndY; y++)
+					utils::PackedPixel::unpackLineWithLut(packingType,
+						(const unsigned char *)getImageBufferLinePtr(y), mDisplayWidth,
+						mDisplayLut, mDisplayBuffer + mDisplayLineOffset * y);
+			});
+		}
+		// ---------------------------------------------------------------------
+		// displayMapPartial
+		// ---------------------------------------------------------------------
+		void	displayMapPartial()
+		{
+			int	lineCount = mDisplayWidth * mOnePixelCount;
+
+			utils::ThreadPool::parallelFor("DisplayMapPartial", mMapStartY, mMapEndY, DISPLAY_MAP_BAND_HEIGHT,
+				[&](int inStartY, int inEndY)
+			{
+				for (int y = inStartY; y < inEndY; y++)
+				{
+					utils::BitWindow::extractLine(getImageBufferLinePtr(y), lineCount,
+						mPartialBitShift, mDisplayBuffer + mDisplayLineOffset * y);
+					swizzleDisplayLine(y);
+				}
+			});
+		}
+		// ---------------------------------------------------------------------
+		// isRedBlueSwapNeeded
+		// ---------------------------------------------------------------------
+		bool	isRedBlueSwapNeeded()
+		{
+			return (mFormat == BUFFER_FORMAT_RGB || mFormat == BUFFER_FORMAT_RGBA);
+		}
+		// ---------------------------------------------------------------------
+		// swizzleDisplayLine
+		// ---------------------------------------------------------------------
+		//	Reorders a freshly mapped RGB / RGBA display line to BGR / BGRA.
+		//	The line is still in cache, so this adds no extra memory pass.
+		void	swizzleDisplayLine(int inY)
+		{
+			if (isRedBlueSwapNeeded() == false)
+				return;
+
+			unsigned char	*linePtr = mDisplayBuffer + mDisplayLineOffset * inY;
+			utils::Swizzle::swapRedBlueLine(linePtr, mDisplayWidth, mOnePixelCount, linePtr);
+		}
+		// ---------------------------------------------------------------------
+		// displayMapLut3D
+		// ---------------------------------------------------------------------
+		//	Returns false when no LUT has been set or the format is not
+		//	BGR / BGRA, so the caller can fall back to the direct mapping
+		bool	displayMapLut3D()
+		{
+			if (mPendingLut3D != NULL)
+			{
+				utils::Lut3D	*lut = exchangeLut3D(&mPendingLut3D, NULL);
+				if (lut != NULL)
+				{
+					if (mActiveLut3D != NULL)
+						delete mActiveLut3D;
+					mActiveLut3D = lut;
+				}
+			}
+
+			if (mActiveLut3D == NULL)
+				return false;
+			if (mFormat != BUFFER_FORMAT_BGR && mFormat != BUFFER_FORMAT_BGRA)
+				return false;
+
+			const unsigned char	*srcPtr = (const unsigned char *)getImageBufferPtr();
+			size_t	srcLineOffset = getLineElementCount();
+			utils::ThreadPool::parallelFor("DisplayMapLut3D", mMapStartY, mMapEndY, DISPLAY_MAP_BAND_HEIGHT,
+				[&](int inStartY, int inEndY)
+			{
+				mActiveLut3D->applyToLines(srcPtr, srcLineOffset, mDisplayBuffer, mDisplayLineOffset,
+					mDisplayWidth, mOnePixelCount, inStartY, inEndY);
+			});
+			return true;
+		}
+		// ---------------------------------------------------------------------
+		// postLut3D
+		// ---------------------------------------------------------------------
+		//	Publishes inLut for the next mapping pass. A LUT that was posted
+		//	earlier but not picked up yet is discarded.
+		void	postLut3D(utils::Lut3D *inLut)
+		{
+			utils::Lut3D	*oldLut = exchangeLut3D(&mPendingLut3D, inLut);
+			if (oldLut != NULL)
+				delete oldLut;
+			setAsBufferUpdateNeeded();
+		}
+		// ---------------------------------------------------------------------
+		// exchangeLut3D
+		// ---------------------------------------------------------------------
+		static utils::Lut3D	*exchangeLut3D(utils::Lut3D * volatile *ioLut, utils::Lut3D *inLut)
+		{
+		#ifdef _WIN32
+			return (utils::Lut3D *)InterlockedExchangePointer((PVOID volatile *)ioLut, inLut);
+		#else
+			return __atomic_exchange_n(ioLut, inLut, __ATOMIC_ACQ_REL);
+		#endif
+		}
+		// ---------------------------------------------------------------------
+		// updateDisplayLut
+		// ---------------------------------------------------------------------
+		//	The LUT folds the display range (and the white balance gains when
+		//	inChannelCount is 3), so the kernels can emit display values directly.
+		bool	updateDisplayLut(int inLutSize, int inChannelCount)
+		{
+			if (mDisplayLut != NULL && mDisplayLutSize == inLutSize &&
+				mDisplayLutChannelCount == inChannelCount && mIsDisplayLutUpdateNeeded == false)
+				return true;
+
+			if (mDisplayLut == NULL || mDisplayLutSize * mDisplayLutChannelCount != inLutSize * inChannelCount)
+			{
+				if (mDisplayLut != NULL)
+					delete [] mDisplayLut;
+				mDisplayLut = new(std::nothrow) unsigned char[inLutSize * inChannelCount];
+				if (mDisplayLut == NULL)
+				{
+					if (mThrowsEx == false)
+						return false;
+					else
+						throw ViwException(ViwException::MEMORY_ERROR,
+							"mDisplayLut == NULL", VIW_EXCEPTION_LOCATION_MACRO, 0);
+				}
+			}
+			mDisplayLutSize = inLutSize;
+			mDisplayLutChannelCount = inChannelCount;
+
+			double	rangeMin, rangeMax;
+			getDisplayRange(&rangeMin, &rangeMax);
+			double	scale = 255.0 / (rangeMax - rangeMin);
+			for (int c = 0; c < inChannelCount; c++)
+			{
+				unsigned char	*lut = mDisplayLut + inLutSize * c;
+				double	k = scale;
+				if (inChannelCount == 3)
+					k *= mWhiteBalanceGain[2 - c];	// B, G, R order
+				for (int i = 0; i < inLutSize; i++)
+				{
+					double	v = (i - rangeMin) * k + 0.5;
+					if (v < 0)
+						v = 0;
+					if (v > 255)
+						v = 255;
+					lut[i] = (unsigned char )v;
+				}
+			}
 
-			for (int y = 0; y < mDisplayWidth; y++)
-				for (int x = 0; x < mDisplayWidth * mOnePixelCount; x++, dstPtr++, srcPtr++)
-					*dstPtr = (unsigned char)(*srcPtr);
+			mIsDisplayLutUpdateNeeded = false;
+			return true;
 		}
 	};
  };
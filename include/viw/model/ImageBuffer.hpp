@@ -24,9 +24,12 @@
 #define VIW_MODEL_IMAGEBUFFER_H
 
 // Includes --------------------------------------------------------------------
-#include <Windows.h>
 #include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include <new>
 #include "viw/Exception.hpp"
+#include "viw/utils/PackedPixel.hpp"
 
 // Namespace -------------------------------------------------------------------
 namespace viw
@@ -52,7 +55,22 @@ namespace viw
 			BUFFER_FORMAT_RGB						= 2048,
 			BUFFER_FORMAT_RGBA,
 			BUFFER_FORMAT_BGR,
-			BUFFER_FORMAT_BGRA
+			BUFFER_FORMAT_BGRA,
+
+			// Raw Bayer mosaic (one element per pixel, 8/16bit integer buffers)
+			BUFFER_FORMAT_BAYER_RG					= 3072,
+			BUFFER_FORMAT_BAYER_GR,
+			BUFFER_FORMAT_BAYER_GB,
+			BUFFER_FORMAT_BAYER_BG,
+
+			// GenICam bit packed mono (unsigned char buffers only, lines are
+			// padded to a byte boundary)
+			BUFFER_FORMAT_MONO10P					= 4096,
+			BUFFER_FORMAT_MONO12P,
+			BUFFER_FORMAT_MONO12_PACKED,
+
+			// Interleaved (re, im) pairs
+			BUFFER_FORMAT_COMPLEX					= 5120
 		};
 
 		// Constructors and Destructor -----------------------------------------
@@ -70,9 +88,11 @@ namespace viw
 			mWidth					= 0;
 			mHeight					= 0;
 			mOnePixelCount			= 0;
+			mLineElementCount		= 0;
 			mImageBufferPixelCount	= 0;
 			mImageBufferSize		= 0;
 			mIsBottomUp				= false;
+			mIsReadOnly				= false;
 			mIsImageModified		= false;
 		}
 		// ---------------------------------------------------------------------
@@ -81,7 +101,7 @@ namespace viw
 		virtual ~ImageBuffer()
 		{
 			if (mAllocatedImageBuffer != NULL)
-				delete mAllocatedImageBuffer;
+				delete [] mAllocatedImageBuffer;
 		}
 
 		// Member functions ----------------------------------------------------
@@ -92,12 +112,14 @@ namespace viw
 		{
 			if (mAllocatedImageBuffer != NULL)
 			{
-				delete mAllocatedImageBuffer;
+				delete [] mAllocatedImageBuffer;
 				mAllocatedImageBuffer = NULL;
 			}
 
 			mExternalImageBuffer = inImagePtr;
+			mIsReadOnly = false;
 			imageBufferModified();
+			return true;
 		}
 		// ---------------------------------------------------------------------
 		// setImageBufferPtr
@@ -106,7 +128,8 @@ namespace viw
 		{
 			inFormat = checkBufferFormat(inFormat);
 			int	onePixelCount = obtainOnePixelCount(inFormat);
-			if (onePixelCount == 0)
+			int	lineElementCount = obtainLineElementCount(inFormat, inWidth);
+			if (onePixelCount == 0 || lineElementCount == 0 || inHeight < 0)
 			{
 				if (mThrowsEx == false)
 					return false;
@@ -117,7 +140,7 @@ namespace viw
 
 			if (mAllocatedImageBuffer != NULL)
 			{
-				delete mAllocatedImageBuffer;
+				delete [] mAllocatedImageBuffer;
 				mAllocatedImageBuffer = NULL;
 			}
 
@@ -126,8 +149,10 @@ namespace viw
 			mFormat = inFormat;
 			mIsBottomUp = inIsBottomUp;
 			mExternalImageBuffer = inImagePtr;
+			mIsReadOnly = false;
 			mOnePixelCount = onePixelCount;
-			mImageBufferPixelCount = mWidth * mHeight * mOnePixelCount;
+			mLineElementCount = lineElementCount;
+			mImageBufferPixelCount = (size_t )mLineElementCount * mHeight;
 			mImageBufferSize = mImageBufferPixelCount * sizeof(ImageBufferType);
 
 			parameterModified();
@@ -135,13 +160,28 @@ namespace viw
 			return true;
 		}
 		// ---------------------------------------------------------------------
+		// setReadOnlyImageBufferPtr
+		// ---------------------------------------------------------------------
+		//	For memory the caller can't write to (e.g. a PROT_READ mapping).
+		//	The buffer is used in place and isReadOnly() is true until the
+		//	next set / allocate, code that writes through getImageBufferPtr()
+		//	has to check it and copy first.
+		bool	setReadOnlyImageBufferPtr(int inWidth, int inHeight, const ImageBufferType *inImagePtr, BufferFormat inFormat, bool inIsBottomUp = false)
+		{
+			if (setImageBufferPtr(inWidth, inHeight, const_cast<ImageBufferType *>(inImagePtr), inFormat, inIsBottomUp) == false)
+				return false;
+			mIsReadOnly = true;
+			return true;
+		}
+		// ---------------------------------------------------------------------
 		// allocateImageBuffer
 		// ---------------------------------------------------------------------
 		bool	allocateImageBuffer(int inWidth, int inHeight, BufferFormat inFormat, bool inIsBottomUp = false)
 		{
 			inFormat = checkBufferFormat(inFormat);
 			int	onePixelCount = obtainOnePixelCount(inFormat);
-			if (onePixelCount == 0)
+			int	lineElementCount = obtainLineElementCount(inFormat, inWidth);
+			if (onePixelCount == 0 || lineElementCount == 0 || inHeight < 0)
 			{
 				if (mThrowsEx == false)
 					return false;
@@ -153,9 +193,12 @@ namespace viw
 			if (mAllocatedImageBuffer != NULL)
 			{
 				if (mWidth == inWidth && mHeight == inHeight && mFormat == inFormat)
+				{
+					mIsBottomUp = inIsBottomUp;
 					return true;
+				}
 
-				delete mAllocatedImageBuffer;
+				delete [] mAllocatedImageBuffer;
 				mAllocatedImageBuffer = NULL;
 			}
 
@@ -164,11 +207,14 @@ namespace viw
 			mFormat = inFormat;
 			mIsBottomUp = inIsBottomUp;
 			mOnePixelCount = onePixelCount;
-			mImageBufferPixelCount = mWidth * mHeight * mOnePixelCount;
+			mLineElementCount = lineElementCount;
+			mImageBufferPixelCount = (size_t )mLineElementCount * mHeight;
 			mImageBufferSize = mImageBufferPixelCount * sizeof(ImageBufferType);
 			mExternalImageBuffer = NULL;
+			mIsReadOnly = false;
 
-			mAllocatedImageBuffer = new ImageBufferType[mImageBufferPixelCount];
+			// nothrow : a frame too large for the memory is a normal error here
+			mAllocatedImageBuffer = new(std::nothrow) ImageBufferType[mImageBufferPixelCount];
 			if (mAllocatedImageBuffer == NULL)
 			{
 				if (mThrowsEx == false)
@@ -217,7 +263,7 @@ namespace viw
 			if (allocateImageBuffer(inWidth, inHeight, inFormat, inIsBottomUp) == false)
 				return false;
 
-			::CopyMemory(mAllocatedImageBuffer, inImagePtr, mImageBufferSize);
+			memcpy(mAllocatedImageBuffer, inImagePtr, mImageBufferSize);
 
 			parameterModified();
 			imageBufferModified();
@@ -228,6 +274,7 @@ namespace viw
 		// ---------------------------------------------------------------------
 		bool	flipImageBuffer()
 		{
+			return false;
 		}
 		// ---------------------------------------------------------------------
 		// markAsImageModified
@@ -265,9 +312,16 @@ namespace viw
 			return mOnePixelCount;
 		}
 		// ---------------------------------------------------------------------
+		// getLineElementCount
+		// ---------------------------------------------------------------------
+		int	getLineElementCount()
+		{
+			return mLineElementCount;
+		}
+		// ---------------------------------------------------------------------
 		// getImageBufferPixelCount
 		// ---------------------------------------------------------------------
-		int	getImageBufferPixelCount()
+		size_t	getImageBufferPixelCount()
 		{
 			return mImageBufferPixelCount;
 		}
@@ -286,6 +340,13 @@ namespace viw
 			return mIsBottomUp;
 		}
 		// ---------------------------------------------------------------------
+		// isReadOnly
+		// ---------------------------------------------------------------------
+		bool	isReadOnly()
+		{
+			return mIsReadOnly;
+		}
+		// ---------------------------------------------------------------------
 		// isImageModified
 		// ---------------------------------------------------------------------
 		bool	isImageModified()
@@ -308,10 +369,43 @@ namespace viw
 		{
 			ImageBufferType	*bufferPtr = getImageBufferPtr();
 
-			bufferPtr += getWidth() * getOnePixelCount() * inY;
+			bufferPtr += (size_t )getLineElementCount() * inY;
 
 			return bufferPtr;
 		}
+		// ---------------------------------------------------------------------
+		// unpackImageLine
+		// ---------------------------------------------------------------------
+		//	Unpacks one line of a packed format into 16bit values
+		//	(outDst must hold getWidth() elements)
+		bool	unpackImageLine(int inY, unsigned short *outDst)
+		{
+			utils::PackedPixel::PackingType	packingType = obtainPackingType(mFormat);
+			if (packingType == utils::PackedPixel::PACKING_NOT_SPECIFIED ||
+				getImageBufferPtr() == NULL || inY < 0 || inY >= mHeight)
+			{
+				if (mThrowsEx == false)
+					return false;
+				else
+					throw ViwException(ViwException::INVALID_OPERATION_ERROR,
+						"Not a packed image or invalid line", VIW_EXCEPTION_LOCATION_MACRO, 0);
+			}
+
+			utils::PackedPixel::unpackLine(packingType,
+				(const unsigned char *)getImageBufferLinePtr(inY), mWidth, outDst);
+			return true;
+		}
+		// ---------------------------------------------------------------------
+		// unpackImageBuffer
+		// ---------------------------------------------------------------------
+		//	Unpacks the whole image (outDst must hold getWidth() * getHeight())
+		bool	unpackImageBuffer(unsigned short *outDst)
+		{
+			for (int y = 0; y < mHeight; y++)
+				if (unpackImageLine(y, outDst + (size_t )mWidth * y) == false)
+					return false;
+			return true;
+		}
 
 		// Static Functions ----------------------------------------------------
 		// ---------------------------------------------------------------------
@@ -347,16 +441,102 @@ namespace viw
 			switch (inFormat)
 			{
 				case BUFFER_FORMAT_MONO:
+				case BUFFER_FORMAT_BAYER_RG:
+				case BUFFER_FORMAT_BAYER_GR:
+				case BUFFER_FORMAT_BAYER_GB:
+				case BUFFER_FORMAT_BAYER_BG:
+				case BUFFER_FORMAT_MONO10P:
+				case BUFFER_FORMAT_MONO12P:
+				case BUFFER_FORMAT_MONO12_PACKED:
 					return 1;
+				case BUFFER_FORMAT_COMPLEX:
+					return 2;
 				case BUFFER_FORMAT_RGB:
 				case BUFFER_FORMAT_BGR:
 					return 3;
 				case BUFFER_FORMAT_RGBA:
 				case BUFFER_FORMAT_BGRA:
 					return 4;
+				default:
+					break;
 			}
 			return 0;
 		}
+		// ---------------------------------------------------------------------
+		// obtainLineElementCount
+		// ---------------------------------------------------------------------
+		//	Returns the number of buffer elements in one line (0 if invalid).
+		//	Only the line is limited to INT_MAX elements, the whole buffer
+		//	is sized in size_t.
+		static int	obtainLineElementCount(BufferFormat inFormat, int inWidth)
+		{
+			if (inWidth <= 0)
+				return 0;
+
+			size_t	lineElementCount;
+			utils::PackedPixel::PackingType	packingType = obtainPackingType(inFormat);
+			if (packingType != utils::PackedPixel::PACKING_NOT_SPECIFIED)
+			{
+				if (sizeof(ImageBufferType) != 1)
+					return 0;
+				lineElementCount = utils::PackedPixel::obtainLineByteSize(packingType, inWidth);
+			}
+			else
+				lineElementCount = (size_t )inWidth * obtainOnePixelCount(inFormat);
+
+			if (lineElementCount > INT_MAX)
+				return 0;
+			return (int )lineElementCount;
+		}
+		// ---------------------------------------------------------------------
+		// obtainPackingType
+		// ---------------------------------------------------------------------
+		static utils::PackedPixel::PackingType	obtainPackingType(BufferFormat inFormat)
+		{
+			switch (inFormat)
+			{
+				case BUFFER_FORMAT_MONO10P:
+					return utils::PackedPixel::PACKING_MONO10P;
+				case BUFFER_FORMAT_MONO12P:
+					return utils::PackedPixel::PACKING_MONO12P;
+				case BUFFER_FORMAT_MONO12_PACKED:
+					return utils::PackedPixel::PACKING_MONO12_PACKED;
+				default:
+					break;
+			}
+			return utils::PackedPixel::PACKING_NOT_SPECIFIED;
+		}
+		// ---------------------------------------------------------------------
+		// isPackedFormat
+		// ---------------------------------------------------------------------
+		static bool	isPackedFormat(BufferFormat inFormat)
+		{
+			return (obtainPackingType(inFormat) != utils::PackedPixel::PACKING_NOT_SPECIFIED);
+		}
+		// ---------------------------------------------------------------------
+		// isComplexFormat
+		// ---------------------------------------------------------------------
+		static bool	isComplexFormat(BufferFormat inFormat)
+		{
+			return (inFormat == BUFFER_FORMAT_COMPLEX);
+		}
+		// ---------------------------------------------------------------------
+		// isBayerFormat
+		// ---------------------------------------------------------------------
+		static bool	isBayerFormat(BufferFormat inFormat)
+		{
+			switch (inFormat)
+			{
+				case BUFFER_FORMAT_BAYER_RG:
+				case BUFFER_FORMAT_BAYER_GR:
+				case BUFFER_FORMAT_BAYER_GB:
+				case BUFFER_FORMAT_BAYER_BG:
+					return true;
+				default:
+					break;
+			}
+			return false;
+		}
 
 	protected:
 		// Member variables ----------------------------------------------------
@@ -369,8 +549,10 @@ namespace viw
 		int					mWidth;
 		int					mHeight;
 		bool				mIsBottomUp;
+		bool				mIsReadOnly;		// set by setReadOnlyImageBufferPtr()
 		int					mOnePixelCount;
-		int					mImageBufferPixelCount;
+		int					mLineElementCount;
+		size_t				mImageBufferPixelCount;
 		size_t				mImageBufferSize;
 
 		// Member functions ----------------------------------------------------
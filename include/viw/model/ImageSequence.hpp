@@ -0,0 +1,916 @@
+// =============================================================================
+//  ImageSequence.hpp
+//
+//  Written in 2014 by Dairoku Sekiguchi (sekiguchi at acm dot org)
+//
+//  To the extent possible under law, the author(s) have dedicated all copyright
+//  and related and neighboring rights to this software to the public domain worldwide.
+//  This software is distributed without any warranty.
+//
+//  You should have received a copy of the CC0 Public Domain Dedication along with
+//  this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+// =============================================================================
+/*!
+	\file		viw/model/ImageSequence.h
+	\author		Dairoku Sekiguchi
+	\version	1.0.0
+	\date		2026/10/19
+	\brief		Header file for viw library types
+
+	This file defines the prefetching image sequence for viw library
+*/
+
+#ifndef VIW_MODEL_IMAGESEQUENCE_H
+#define VIW_MODEL_IMAGESEQUENCE_H
+
+// Includes --------------------------------------------------------------------
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <dirent.h>
+#include <strings.h>
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include "viw/Exception.hpp"
+#include "viw/model/ImageBuffer.hpp"
+#include "viw/model/Bitmap.hpp"
+#include "viw/model/ProgressiveBitmapLoader.hpp"
+#include "viw/utils/Trace.hpp"
+
+
+// Namespace -------------------------------------------------------------------
+namespace viw
+{
+ namespace model
+ {
+	// -------------------------------------------------------------------------
+	// ImageSequence class
+	// -------------------------------------------------------------------------
+	//	Steps through a list of image files with the frames around the
+	//	current one decoded ahead of time. The decoder threads keep the next
+	//	getPrefetchAheadNum() and the previous getPrefetchBehindNum() frames
+	//	in a fixed pool of frame buffers (a buffer is reused as is when the
+	//	next frame has the same size), nearest to the current frame first.
+	//	Moving the current frame drops the queued requests that left the
+	//	window, so holding the arrow key never piles up work.
+	//
+	//	The current frame is used in place:
+	//
+	//		Frame	*frame = sequence.acquireCurrentFrame();
+	//		window.setImageBufferPtr(frame->getWidth(), frame->getHeight(),
+	//			frame->getImageBufferPtr(), frame->getBufferFormat(), frame->isBottomUp());
+	//		window.updateImage();
+	//		sequence.releaseFrame(previousFrame);
+	//
+	//	An acquired frame stays pinned (its buffer is not reused) until it
+	//	is released. play() advances the current frame at a target rate on
+	//	its own thread and calls the frame changed function; it waits for a
+	//	frame that is not decoded yet rather than skipping it.
+	//
+	//	A request counts as a hit when its frame was already decoded as it
+	//	became the current frame, and as a miss otherwise.
+	class	ImageSequence
+	{
+	public:
+		// Typedefs ------------------------------------------------------------
+		typedef ImageBuffer<unsigned char>	Frame;
+		typedef bool	(*DecodeFunc)(const char *inFileName, Frame *outFrame, void *inData);
+		typedef void	(*FrameChangedFunc)(int inIndex, void *inData);
+
+		// Constatns -----------------------------------------------------------
+		const static int	DEFAULT_AHEAD_NUM			= 8;
+		const static int	DEFAULT_BEHIND_NUM			= 2;
+		const static int	DEFAULT_DECODER_THREAD_NUM	= 2;
+		const static int	PINNED_FRAME_NUM			= 2;	// extra buffers for acquired frames
+
+		// Structs -------------------------------------------------------------
+		struct CacheStats
+		{
+			long long	hitCount;
+			long long	missCount;
+			long long	decodeCount;
+			long long	errorCount;
+			double		averageDecodeMs;
+			int			readyNum;			// decoded frames in the pool
+			int			queuedNum;			// waiting for or being decoded
+		};
+
+		// Constructors and Destructor -----------------------------------------
+		// ---------------------------------------------------------------------
+		// ImageSequence
+		// ---------------------------------------------------------------------
+		ImageSequence(bool inThrowsEx = false)
+		{
+			mThrowsEx = inThrowsEx;
+			mDecodeFunc = decodeBitmapFile;
+			mDecodeFuncData = NULL;
+			mFrameChangedFunc = NULL;
+			mFrameChangedFuncData = NULL;
+			mAheadNum = DEFAULT_AHEAD_NUM;
+			mBehindNum = DEFAULT_BEHIND_NUM;
+			mDecoderThreadNum = DEFAULT_DECODER_THREAD_NUM;
+			mCurrentIndex = 0;
+			mIsWrapping = false;
+			mIsDecoderStopRequested = false;
+			mIsPlaying = false;
+			mIsPlayerStopRequested = false;
+			mPlayFPS = 0;
+			resetCacheStats();
+		}
+		// ---------------------------------------------------------------------
+		// ~ImageSequence
+		// ---------------------------------------------------------------------
+		virtual ~ImageSequence()
+		{
+			stop();
+			stopDecoders();
+			for (size_t i = 0; i < mSlots.size(); i++)
+				delete mSlots[i];
+		}
+
+		// Member functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// setFileList
+		// ---------------------------------------------------------------------
+		//	Replaces the sequence, the current frame becomes the first one
+		bool	setFileList(const std::vector<std::string> &inFileNames)
+		{
+			{
+				std::lock_guard<std::mutex>	lock(mMutex);
+				if (isAnyFramePinned())
+					return error(ViwException::PARAM_ERROR, "A frame is still acquired", 0);
+			}
+			stop();
+			stopDecoders();
+
+			std::unique_lock<std::mutex>	lock(mMutex);
+			if (isAnyFramePinned())
+			{
+				// Acquired while the threads were stopped, keep the old sequence
+				bool	isStartNeeded = (mFileNames.empty() == false);
+				lock.unlock();
+				if (isStartNeeded)
+					startDecoders();
+				return error(ViwException::PARAM_ERROR, "A frame is still acquired", 0);
+			}
+			mFileNames = inFileNames;
+			mCurrentIndex = 0;
+			for (size_t i = 0; i < mSlots.size(); i++)
+			{
+				mSlots[i]->index = -1;
+				mSlots[i]->state = SLOT_EMPTY;
+			}
+			if (mFileNames.empty())
+				return true;
+
+			updateWindow();
+			lock.unlock();
+			startDecoders();
+			return true;
+		}
+		// ---------------------------------------------------------------------
+		// setFilePattern
+		// ---------------------------------------------------------------------
+		//	printf style pattern with one integer, e.g. "frame_%05d.bmp"
+		bool	setFilePattern(const char *inPattern, int inFirst, int inLast)
+		{
+			std::vector<std::string>	fileNames;
+			std::vector<char>			fileName(strlen(inPattern) + 32);
+			for (int i = inFirst; i <= inLast; i++)
+			{
+				snprintf(&fileName[0], fileName.size(), inPattern, i);
+				fileNames.push_back(&fileName[0]);
+			}
+			return setFileList(fileNames);
+		}
+		// ---------------------------------------------------------------------
+		// setFolder
+		// ---------------------------------------------------------------------
+		//	All files of inFolder ending with inExtension (any case), in name order
+		bool	setFolder(const char *inFolder, const char *inExtension = ".bmp")
+		{
+			std::vector<std::string>	fileNames;
+			if (listFolder(inFolder, inExtension, &fileNames) == false)
+				return error(ViwException::OS_ERROR, "Can't list the folder", 0);
+			return setFileList(fileNames);
+		}
+		// ---------------------------------------------------------------------
+		// getFrameNum
+		// ---------------------------------------------------------------------
+		int	getFrameNum()
+		{
+			std::lock_guard<std::mutex>	lock(mMutex);
+			return (int )mFileNames.size();
+		}
+		// ---------------------------------------------------------------------
+		// getFileName
+		// ---------------------------------------------------------------------
+		std::string	getFileName(int inIndex)
+		{
+			std::lock_guard<std::mutex>	lock(mMutex);
+			if (inIndex < 0 || inIndex >= (int )mFileNames.size())
+				return std::string();
+			return mFileNames[inIndex];
+		}
+		// ---------------------------------------------------------------------
+		// setDecodeFunc
+		// ---------------------------------------------------------------------
+		//	Replaces the BMP decoder (called on the decoder threads). Set it
+		//	before the file list.
+		void	setDecodeFunc(DecodeFunc inFunc, void *inData)
+		{
+			stopDecoders();
+
+			std::unique_lock<std::mutex>	lock(mMutex);
+			mDecodeFunc = (inFunc != NULL) ? inFunc : decodeBitmapFile;
+			mDecodeFuncData = inData;
+			bool	isStartNeeded = (mFileNames.empty() == false);
+			lock.unlock();
+			if (isStartNeeded)
+				startDecoders();
+		}
+		// ---------------------------------------------------------------------
+		// setPrefetchRange
+		// ---------------------------------------------------------------------
+		void	setPrefetchRange(int inAheadNum, int inBehindNum)
+		{
+			std::lock_guard<std::mutex>	lock(mMutex);
+			mAheadNum = (inAheadNum > 0) ? inAheadNum : 0;
+			mBehindNum = (inBehindNum > 0) ? inBehindNum : 0;
+			updateWindow();
+		}
+		// ---------------------------------------------------------------------
+		// getPrefetchAheadNum
+		// ---------------------------------------------------------------------
+		int	getPrefetchAheadNum()
+		{
+			return mAheadNum;
+		}
+		// ---------------------------------------------------------------------
+		// getPrefetchBehindNum
+		// ---------------------------------------------------------------------
+		int	getPrefetchBehindNum()
+		{
+			return mBehindNum;
+		}
+		// ---------------------------------------------------------------------
+		// setDecoderThreadNum
+		// ---------------------------------------------------------------------
+		void	setDecoderThreadNum(int inNum)
+		{
+			stopDecoders();
+
+			std::unique_lock<std::mutex>	lock(mMutex);
+			mDecoderThreadNum = (inNum > 0) ? inNum : 1;
+			bool	isStartNeeded = (mFileNames.empty() == false);
+			lock.unlock();
+			if (isStartNeeded)
+				startDecoders();
+		}
+		// ---------------------------------------------------------------------
+		// setFrameChangedFunc
+		// ---------------------------------------------------------------------
+		//	Called on the player thread for each frame play() moves to. It may
+		//	call stop() and setFileList(), but not play().
+		void	setFrameChangedFunc(FrameChangedFunc inFunc, void *inData)
+		{
+			std::lock_guard<std::mutex>	lock(mMutex);
+			mFrameChangedFunc = inFunc;
+			mFrameChangedFuncData = inData;
+		}
+		// ---------------------------------------------------------------------
+		// getCurrentIndex
+		// ---------------------------------------------------------------------
+		int	getCurrentIndex()
+		{
+			std::lock_guard<std::mutex>	lock(mMutex);
+			return mCurrentIndex;
+		}
+		// ---------------------------------------------------------------------
+		// next
+		// ---------------------------------------------------------------------
+		//	false at the last frame
+		bool	next()
+		{
+			std::lock_guard<std::mutex>	lock(mMutex);
+			return moveTo(mCurrentIndex + 1);
+		}
+		// ---------------------------------------------------------------------
+		// previous
+		// ---------------------------------------------------------------------
+		bool	previous()
+		{
+			std::lock_guard<std::mutex>	lock(mMutex);
+			return moveTo(mCurrentIndex - 1);
+		}
+		// ---------------------------------------------------------------------
+		// jump
+		// ---------------------------------------------------------------------
+		bool	jump(int inIndex)
+		{
+			std::lock_guard<std::mutex>	lock(mMutex);
+			return moveTo(inIndex);
+		}
+		// ---------------------------------------------------------------------
+		// acquireCurrentFrame
+		// ---------------------------------------------------------------------
+		//	Pins and returns the current frame. Waits for its decoder when
+		//	inWait is true (following the current frame if it moves), returns
+		//	NULL if it isn't decoded yet otherwise, or if it can't be decoded.
+		Frame	*acquireCurrentFrame(bool inWait = true)
+		{
+			std::unique_lock<std::mutex>	lock(mMutex);
+			while (mFileNames.empty() == false)
+			{
+				Slot	*slot = findSlot(mCurrentIndex);
+				if (slot != NULL && slot->state == SLOT_READY)
+				{
+					slot->pinCount++;
+					return &slot->frame;
+				}
+				if ((slot != NULL && slot->state == SLOT_FAILED) || inWait == false ||
+					mDecoders.empty())
+					return NULL;
+				mCond.wait(lock);
+			}
+			return NULL;
+		}
+		// ---------------------------------------------------------------------
+		// releaseFrame
+		// ---------------------------------------------------------------------
+		void	releaseFrame(Frame *inFrame)
+		{
+			if (inFrame == NULL)
+				return;
+
+			std::lock_guard<std::mutex>	lock(mMutex);
+			for (size_t i = 0; i < mSlots.size(); i++)
+				if (&mSlots[i]->frame == inFrame && mSlots[i]->pinCount > 0)
+				{
+					mSlots[i]->pinCount--;
+					break;
+				}
+			updateWindow();
+		}
+		// ---------------------------------------------------------------------
+		// play
+		// ---------------------------------------------------------------------
+		//	Advances the current frame inFPS times a second, from the last
+		//	frame back to the first one when inIsLooping
+		bool	play(double inFPS, bool inIsLooping = true)
+		{
+			if (inFPS <= 0)
+				return error(ViwException::PARAM_ERROR, "inFPS <= 0", 0);
+			if (isPlayerThread())
+				return error(ViwException::INVALID_OPERATION_ERROR, "play() on the player thread", 0);
+
+			stop();
+			std::lock_guard<std::mutex>	lock(mMutex);
+			mPlayFPS = inFPS;
+			mIsWrapping = inIsLooping;
+			mIsPlayerStopRequested = false;
+			mIsPlaying = true;
+			updateWindow();
+			mPlayer = std::thread(&ImageSequence::playerThread, this);
+			return true;
+		}
+		// ---------------------------------------------------------------------
+		// stop
+		// ---------------------------------------------------------------------
+		//	From the frame changed function the player only gets the request,
+		//	it ends when the function returns and the next play() or stop()
+		//	joins it.
+		void	stop()
+		{
+			{
+				std::lock_guard<std::mutex>	lock(mMutex);
+				mIsPlayerStopRequested = true;
+				mCond.notify_all();
+			}
+			if (mPlayer.joinable() && isPlayerThread() == false)
+				mPlayer.join();
+
+			std::lock_guard<std::mutex>	lock(mMutex);
+			mIsPlaying = false;
+			mIsWrapping = false;
+		}
+		// ---------------------------------------------------------------------
+		// isPlaying
+		// ---------------------------------------------------------------------
+		bool	isPlaying()
+		{
+			std::lock_guard<std::mutex>	lock(mMutex);
+			return mIsPlaying;
+		}
+		// ---------------------------------------------------------------------
+		// getCacheStats
+		// ---------------------------------------------------------------------
+		CacheStats	getCacheStats()
+		{
+			std::lock_guard<std::mutex>	lock(mMutex);
+			CacheStats	stats = mStats;
+			stats.averageDecodeMs = (mStats.decodeCount != 0) ? mDecodeMsSum / mStats.decodeCount : 0;
+			stats.readyNum = 0;
+			stats.queuedNum = 0;
+			for (size_t i = 0; i < mSlots.size(); i++)
+			{
+				if (mSlots[i]->state == SLOT_READY)
+					stats.readyNum++;
+				if (mSlots[i]->state == SLOT_QUEUED || mSlots[i]->state == SLOT_DECODING)
+					stats.queuedNum++;
+			}
+			return stats;
+		}
+		// ---------------------------------------------------------------------
+		// resetCacheStats
+		// ---------------------------------------------------------------------
+		void	resetCacheStats()
+		{
+			std::lock_guard<std::mutex>	lock(mMutex);
+			memset(&mStats, 0, sizeof(mStats));
+			mDecodeMsSum = 0;
+		}
+
+		// Static Functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// decodeBitmapFile
+		// ---------------------------------------------------------------------
+		//	The default DecodeFunc: 8 (as MONO), 24 or 32bpp BMP files, in the
+		//	file's line order. outFrame keeps its buffer if the size matches.
+		static bool	decodeBitmapFile(const char *inFileName, Frame *outFrame, void *inData)
+		{
+			FILE	*file = fopen(inFileName, "rb");
+			if (file == NULL)
+				return false;
+
+			BITMAPFILEHEADER	fileHeader;
+			BITMAPINFOHEADER	infoHeader;
+			Frame::BufferFormat	format;
+			bool	result = (fread(&fileHeader, sizeof(fileHeader), 1, file) == 1 &&
+							fread(&infoHeader, sizeof(infoHeader), 1, file) == 1 &&
+							ProgressiveBitmapLoader::obtainFormat(fileHeader, infoHeader, &format) &&
+							seekFile(file, fileHeader.bfOffBits));
+			if (result)
+				result = outFrame->allocateImageBuffer(infoHeader.biWidth, Bitmap::getAbsBitmapHeight(&infoHeader),
+							format, infoHeader.biHeight > 0);
+			if (result)
+			{
+				size_t	lineByteSize = (size_t )outFrame->getLineElementCount();
+				size_t	paddingSize = Bitmap::calBitmapLineOffset(&infoHeader) - lineByteSize;
+				unsigned char	padding[4];
+				if (paddingSize == 0)
+					result = (fread(outFrame->getImageBufferPtr(), lineByteSize, (size_t )outFrame->getHeight(), file) ==
+								(size_t )outFrame->getHeight());
+				else
+					for (int y = 0; y < outFrame->getHeight() && result; y++)
+						result = (fread(outFrame->getImageBufferLinePtr(y), lineByteSize, 1, file) == 1 &&
+								fread(padding, paddingSize, 1, file) == 1);
+			}
+			fclose(file);
+			if (result)
+				outFrame->markAsImageModified();
+			return result;
+		}
+
+	protected:
+		// Constatns -----------------------------------------------------------
+		enum SlotState
+		{
+			SLOT_EMPTY		= 0,
+			SLOT_QUEUED,
+			SLOT_DECODING,
+			SLOT_READY,
+			SLOT_FAILED
+		};
+
+		// Structs -------------------------------------------------------------
+		struct	Slot
+		{
+			int			index;			// -1 when empty
+			SlotState	state;
+			int			pinCount;
+			Frame		frame;
+
+			Slot() : frame(false)
+			{
+				index = -1;
+				state = SLOT_EMPTY;
+				pinCount = 0;
+			}
+		};
+
+		// Member variables ----------------------------------------------------
+		bool				mThrowsEx;
+		std::vector<std::string>	mFileNames;
+		DecodeFunc			mDecodeFunc;
+		void				*mDecodeFuncData;
+		FrameChangedFunc	mFrameChangedFunc;
+		void				*mFrameChangedFuncData;
+		int					mAheadNum;
+		int					mBehindNum;
+		int					mDecoderThreadNum;
+		int					mCurrentIndex;
+		bool				mIsWrapping;		// the window runs past the end while playing a loop
+
+		std::mutex			mMutex;
+		std::condition_variable	mCond;		// slots, the current frame and the stop flags
+		std::vector<Slot *>	mSlots;
+		std::vector<std::thread>	mDecoders;
+		bool				mIsDecoderStopRequested;
+		std::thread			mPlayer;
+		bool				mIsPlaying;
+		bool				mIsPlayerStopRequested;
+		double				mPlayFPS;
+
+		CacheStats			mStats;
+		double				mDecodeMsSum;
+
+		// Member functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// moveTo
+		// ---------------------------------------------------------------------
+		//	Called with mMutex held
+		bool	moveTo(int inIndex)
+		{
+			if (inIndex < 0 || inIndex >= (int )mFileNames.size())
+				return false;
+
+			Slot	*slot = findSlot(inIndex);
+			if (slot != NULL && slot->state == SLOT_READY)
+				mStats.hitCount++;
+			else
+				mStats.missCount++;
+
+			mCurrentIndex = inIndex;
+			updateWindow();
+			mCond.notify_all();
+			return true;
+		}
+		// ---------------------------------------------------------------------
+		// updateWindow
+		// ---------------------------------------------------------------------
+		//	Queues the frames of the prefetch window into the pool, nearest
+		//	first, and drops the queued ones that left it. Called with mMutex
+		//	held.
+		void	updateWindow()
+		{
+			int	frameNum = (int )mFileNames.size();
+			if (frameNum == 0)
+				return;
+
+			// The pool covers the window, the pinned frames and the frames being decoded
+			size_t	slotNum = (size_t )(mAheadNum + mBehindNum + 1 + PINNED_FRAME_NUM + mDecoderThreadNum);
+			while (mSlots.size() < slotNum)
+				mSlots.push_back(new Slot());
+
+			for (size_t i = 0; i < mSlots.size(); i++)
+				if (mSlots[i]->state == SLOT_QUEUED && obtainPriority(mSlots[i]->index) < 0)
+				{
+					mSlots[i]->index = -1;
+					mSlots[i]->state = SLOT_EMPTY;
+				}
+
+			bool	isQueued = false;
+			int		windowNum = mAheadNum + mBehindNum + 1;
+			for (int priority = 0; priority < windowNum && priority < frameNum; priority++)
+			{
+				int	index = obtainIndex(priority);
+				if (index < 0 || findSlot(index) != NULL)
+					continue;
+
+				Slot	*slot = findFreeSlot();
+				if (slot == NULL)
+					break;
+				slot->index = index;
+				slot->state = SLOT_QUEUED;
+				isQueued = true;
+			}
+			if (isQueued)
+				mCond.notify_all();
+		}
+		// ---------------------------------------------------------------------
+		// obtainIndex
+		// ---------------------------------------------------------------------
+		//	Frame of the inPriority th place in the window (-1 if none): the
+		//	current one, the ahead ones and then the behind ones
+		int	obtainIndex(int inPriority)
+		{
+			int	frameNum = (int )mFileNames.size();
+			int	offset;
+			if (inPriority <= mAheadNum)
+				offset = inPriority;
+			else
+				offset = mAheadNum - inPriority;
+
+			int	index = mCurrentIndex + offset;
+			if (mIsWrapping)
+				return (index % frameNum + frameNum) % frameNum;
+			return (index >= 0 && index < frameNum) ? index : -1;
+		}
+		// ---------------------------------------------------------------------
+		// obtainPriority
+		// ---------------------------------------------------------------------
+		//	Place of inIndex in the window, -1 if outside
+		int	obtainPriority(int inIndex)
+		{
+			int	frameNum = (int )mFileNames.size();
+			int	windowNum = mAheadNum + mBehindNum + 1;
+			for (int priority = 0; priority < windowNum && priority < frameNum; priority++)
+				if (obtainIndex(priority) == inIndex)
+					return priority;
+			return -1;
+		}
+		// ---------------------------------------------------------------------
+		// findSlot
+		// ---------------------------------------------------------------------
+		Slot	*findSlot(int inIndex)
+		{
+			for (size_t i = 0; i < mSlots.size(); i++)
+				if (mSlots[i]->index == inIndex && mSlots[i]->state != SLOT_EMPTY)
+					return mSlots[i];
+			return NULL;
+		}
+		// ---------------------------------------------------------------------
+		// findFreeSlot
+		// ---------------------------------------------------------------------
+		//	An empty slot, else the unpinned decoded frame farthest from the
+		//	current one outside the window
+		Slot	*findFreeSlot()
+		{
+			Slot	*freeSlot = NULL;
+			int		maxDistance = -1;
+			for (size_t i = 0; i < mSlots.size(); i++)
+			{
+				Slot	*slot = mSlots[i];
+				if (slot->state == SLOT_EMPTY)
+					return slot;
+				if ((slot->state != SLOT_READY && slot->state != SLOT_FAILED) ||
+					slot->pinCount != 0 || obtainPriority(slot->index) >= 0)
+					continue;
+				int	distance = abs(slot->index - mCurrentIndex);
+				if (distance > maxDistance)
+				{
+					maxDistance = distance;
+					freeSlot = slot;
+				}
+			}
+			return freeSlot;
+		}
+		// ---------------------------------------------------------------------
+		// isAnyFramePinned
+		// ---------------------------------------------------------------------
+		//	Called with mMutex held
+		bool	isAnyFramePinned()
+		{
+			for (size_t i = 0; i < mSlots.size(); i++)
+				if (mSlots[i]->pinCount != 0)
+					return true;
+			return false;
+		}
+		// ---------------------------------------------------------------------
+		// isPlayerThread
+		// ---------------------------------------------------------------------
+		bool	isPlayerThread()
+		{
+			return (mPlayer.get_id() == std::this_thread::get_id());
+		}
+		// ---------------------------------------------------------------------
+		// startDecoders
+		// ---------------------------------------------------------------------
+		void	startDecoders()
+		{
+			std::lock_guard<std::mutex>	lock(mMutex);
+			if (mDecoders.empty() == false)
+				return;
+			mIsDecoderStopRequested = false;
+			for (int i = 0; i < mDecoderThreadNum; i++)
+				mDecoders.push_back(std::thread(&ImageSequence::decoderThread, this));
+		}
+		// ---------------------------------------------------------------------
+		// stopDecoders
+		// ---------------------------------------------------------------------
+		void	stopDecoders()
+		{
+			std::vector<std::thread>	decoders;
+			{
+				std::lock_guard<std::mutex>	lock(mMutex);
+				mIsDecoderStopRequested = true;
+				mCond.notify_all();
+				decoders.swap(mDecoders);
+			}
+			for (size_t i = 0; i < decoders.size(); i++)
+				decoders[i].join();
+
+			// Frames queued for the stopped decoders are queued again by the next ones
+			std::lock_guard<std::mutex>	lock(mMutex);
+			mCond.notify_all();
+		}
+		// ---------------------------------------------------------------------
+		// decoderThread
+		// ---------------------------------------------------------------------
+		void	decoderThread()
+		{
+			std::unique_lock<std::mutex>	lock(mMutex);
+			while (mIsDecoderStopRequested == false)
+			{
+				// The queued frame nearest to the current one
+				Slot	*slot = NULL;
+				int		bestPriority = 0;
+				for (size_t i = 0; i < mSlots.size(); i++)
+				{
+					if (mSlots[i]->state != SLOT_QUEUED)
+						continue;
+					int	priority = obtainPriority(mSlots[i]->index);
+					if (slot == NULL || priority < bestPriority)
+					{
+						slot = mSlots[i];
+						bestPriority = priority;
+					}
+				}
+				if (slot == NULL)
+				{
+					mCond.wait(lock);
+					continue;
+				}
+
+				slot->state = SLOT_DECODING;
+				std::string	fileName = mFileNames[slot->index];
+				lock.unlock();
+
+				bool	result;
+				std::chrono::steady_clock::time_point	startTime = std::chrono::steady_clock::now();
+				{
+					VIW_TRACE_SCOPE("ImageSequenceDecode", this);
+					try
+					{
+						result = mDecodeFunc(fileName.c_str(), &slot->frame, mDecodeFuncData);
+					}
+					catch (...)
+					{
+						result = false;
+					}
+				}
+				double	decodeMs = std::chrono::duration<double, std::milli>(
+									std::chrono::steady_clock::now() - startTime).count();
+
+				lock.lock();
+				slot->state = result ? SLOT_READY : SLOT_FAILED;
+				if (result)
+				{
+					mStats.decodeCount++;
+					mDecodeMsSum += decodeMs;
+				}
+				else
+					mStats.errorCount++;
+				updateWindow();
+				mCond.notify_all();
+			}
+		}
+		// ---------------------------------------------------------------------
+		// playerThread
+		// ---------------------------------------------------------------------
+		void	playerThread()
+		{
+			std::chrono::steady_clock::duration	period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+							std::chrono::duration<double>(1.0 / mPlayFPS));
+			std::chrono::steady_clock::time_point	deadline = std::chrono::steady_clock::now() + period;
+
+			std::unique_lock<std::mutex>	lock(mMutex);
+			while (mIsPlayerStopRequested == false)
+			{
+				if (mCond.wait_until(lock, deadline, [this] { return mIsPlayerStopRequested; }))
+					break;
+
+				int	index = mCurrentIndex + 1;
+				if (index >= (int )mFileNames.size())
+				{
+					if (mIsWrapping == false)
+						break;
+					index = 0;
+				}
+				moveTo(index);
+
+				// A frame that isn't decoded yet delays the playback
+				while (mIsPlayerStopRequested == false && mCurrentIndex == index && mDecoders.empty() == false)
+				{
+					Slot	*slot = findSlot(index);
+					if (slot != NULL && (slot->state == SLOT_READY || slot->state == SLOT_FAILED))
+						break;
+					mCond.wait(lock);
+				}
+				if (mIsPlayerStopRequested)
+					break;
+
+				FrameChangedFunc	func = mFrameChangedFunc;
+				void	*funcData = mFrameChangedFuncData;
+				int		currentIndex = mCurrentIndex;
+				lock.unlock();
+				if (func != NULL)
+					func(currentIndex, funcData);
+				lock.lock();
+
+				// Late frames restart the clock instead of catching up in a burst
+				std::chrono::steady_clock::time_point	now = std::chrono::steady_clock::now();
+				deadline += period;
+				if (deadline < now)
+					deadline = now;
+			}
+			mIsPlaying = false;
+			mIsWrapping = false;
+		}
+		// ---------------------------------------------------------------------
+		// error
+		// ---------------------------------------------------------------------
+		bool	error(int inCode, const char *inDescription, int inOSErrorCode)
+		{
+			if (mThrowsEx == false)
+				return false;
+			else
+				throw ViwException(inCode, inDescription, VIW_EXCEPTION_LOCATION_MACRO, inOSErrorCode);
+		}
+
+		// Static Functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// seekFile
+		// ---------------------------------------------------------------------
+		//	Absolute seek that isn't limited to a 32bit long
+		static bool	seekFile(FILE *inFile, unsigned long long inOffset)
+		{
+		#ifdef _WIN32
+			return (_fseeki64(inFile, (__int64 )inOffset, SEEK_SET) == 0);
+		#else
+			return (fseeko(inFile, (off_t )inOffset, SEEK_SET) == 0);
+		#endif
+		}
+		// ---------------------------------------------------------------------
+		// listFolder
+		// ---------------------------------------------------------------------
+		static bool	listFolder(const char *inFolder, const char *inExtension, std::vector<std::string> *outFileNames)
+		{
+			std::string	folder = inFolder;
+			if (folder.empty() == false && folder[folder.size() - 1] != '/' && folder[folder.size() - 1] != '\\')
+				folder += '/';
+
+			std::vector<std::string>	names;
+		#ifdef _WIN32
+			WIN32_FIND_DATAA	findData;
+			HANDLE	findHandle = FindFirstFileA((folder + "*").c_str(), &findData);
+			if (findHandle == INVALID_HANDLE_VALUE)
+				return false;
+			do
+			{
+				if ((findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0 &&
+					hasExtension(findData.cFileName, inExtension))
+					names.push_back(findData.cFileName);
+			}
+			while (FindNextFileA(findHandle, &findData));
+			FindClose(findHandle);
+		#else
+			DIR	*dir = opendir(folder.c_str());
+			if (dir == NULL)
+				return false;
+			struct dirent	*entry;
+			while ((entry = readdir(dir)) != NULL)
+				if (entry->d_name[0] != '.' && hasExtension(entry->d_name, inExtension))
+					names.push_back(entry->d_name);
+			closedir(dir);
+		#endif
+			std::sort(names.begin(), names.end());
+			outFileNames->clear();
+			for (size_t i = 0; i < names.size(); i++)
+				outFileNames->push_back(folder + names[i]);
+			return true;
+		}
+		// ---------------------------------------------------------------------
+		// hasExtension
+		// ---------------------------------------------------------------------
+		static bool	hasExtension(const char *inFileName, const char *inExtension)
+		{
+			size_t	nameLen = strlen(inFileName);
+			size_t	extensionLen = strlen(inExtension);
+			if (nameLen < extensionLen)
+				return false;
+		#ifdef _WIN32
+			return (_stricmp(inFileName + nameLen - extensionLen, inExtension) == 0);
+		#else
+			return (strcasecmp(inFileName + nameLen - extensionLen, inExtension) == 0);
+		#endif
+		}
+
+	private:
+		ImageSequence(const ImageSequence &);
+		ImageSequence	&operator=(const ImageSequence &);
+	};
+ };
+};
+
+#endif	// #ifdef VIW_MODEL_IMAGESEQUENCE_H
@@ -0,0 +1,621 @@
+// =============================================================================
+//  MosaicBuffer.hpp
+//
+//  Written in 2014 by Dairoku Sekiguchi (sekiguchi at acm dot org)
+//
+//  To the extent possible under law, the author(s) have dedicated all copyright
+//  and related and neighboring rights to this software to the public domain worldwide.
+//  This software is distributed without any warranty.
+//
+//  You should have received a copy of the CC0 Public Domain Dedication along with
+//  this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+
+// =============================================================================
+/*!
+	\file		viw/model/MosaicBuffer.h
+	\author		Dairoku Sekiguchi
+	\version	1.0.0
+	\date		2026/10/19
+	\brief		Header file for viw library types
+
+	This file defines the tile grid composition for viw library
+*/
+
+#ifndef VIW_MODEL_MOSAICBUFFER_H
+#define VIW_MODEL_MOSAICBUFFER_H
+
+// Includes --------------------------------------------------------------------
+#include <stdio.h>
+#include <string.h>
+#include <new>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include "viw/Exception.hpp"
+#include "viw/model/DisplayBuffer.hpp"
+#include "viw/utils/ThreadPool.hpp"
+#include "viw/utils/Trace.hpp"
+
+
+// Namespace -------------------------------------------------------------------
+namespace viw
+{
+ namespace model
+ {
+	// -------------------------------------------------------------------------
+	// MosaicBuffer class
+	// -------------------------------------------------------------------------
+	//	Composes several streams into one BGRA image laid out as a grid of
+	//	cells. Every stream has its own DisplayBuffer (getTile()), so the
+	//	display range, map mode, colour map, ... are set per tile. A source
+	//	larger than its cell is shrunk (nearest neighbour, aspect kept) and
+	//	centred.
+	//
+	//	composeMosaic() maps the tiles in parallel and only those whose
+	//	source or display parameters changed since the last call. It draws
+	//	into a back buffer and swaps it to the front when done, so the
+	//	front buffer can be shown in an ImageWindow<unsigned char> without a
+	//	copy while the next mosaic is composed:
+	//
+	//		window.setImageBufferPtr(mosaic.getMosaicWidth(), mosaic.getMosaicHeight(),
+	//			mosaic.getMosaicBufferPtr(), BUFFER_FORMAT_BGRA);
+	//		window.setPixelReadoutFunc(MosaicBuffer<T>::pixelReadoutFunc, &mosaic);
+	//		...
+	//		if (mosaic.composeMosaic() != 0)
+	//		{
+	//			window.lockImageBuffer();
+	//			window.updateImageBufferPtr(mosaic.getMosaicBufferPtr());
+	//			window.unlockImageBuffer();
+	//			window.updateImage();
+	//		}
+	//
+	//	The old front buffer is composed into by the next call, so the
+	//	window has to be pointed to the new one before that.
+	//
+	//	updateTile() and lockTile() may be called from any thread.
+	template <typename ImageBufferType> class	MosaicBuffer
+	{
+	public:
+		// Typedefs ------------------------------------------------------------
+		typedef DisplayBuffer<ImageBufferType>		TileBuffer;
+		typedef typename TileBuffer::BufferFormat	BufferFormat;
+
+		// Constatns -----------------------------------------------------------
+		const static int	DEFAULT_GAP				= 2;
+		const static int	MOSAIC_PIXEL_SIZE		= 4;		// BGRA
+
+		// Constructors and Destructor -----------------------------------------
+		// ---------------------------------------------------------------------
+		// MosaicBuffer
+		// ---------------------------------------------------------------------
+		MosaicBuffer(bool inThrowsEx = false)
+		{
+			mThrowsEx = inThrowsEx;
+			mColumnNum = 0;
+			mRowNum = 0;
+			mCellWidth = 0;
+			mCellHeight = 0;
+			mGap = 0;
+			mMosaicWidth = 0;
+			mMosaicHeight = 0;
+			mMosaicBuffers[0] = NULL;
+			mMosaicBuffers[1] = NULL;
+			mFrontIndex = 0;
+			setBackgroundColor(32, 32, 32);
+		}
+		// ---------------------------------------------------------------------
+		// ~MosaicBuffer
+		// ---------------------------------------------------------------------
+		virtual ~MosaicBuffer()
+		{
+			for (size_t i = 0; i < mTiles.size(); i++)
+				delete mTiles[i];
+			for (int i = 0; i < 2; i++)
+				if (mMosaicBuffers[i] != NULL)
+					delete [] mMosaicBuffers[i];
+		}
+
+		// Member functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// setLayout
+		// ---------------------------------------------------------------------
+		//	inColumnNum x inRowNum cells of inCellWidth x inCellHeight pixels,
+		//	inGap pixels apart. The tiles that exist in both layouts keep
+		//	their settings and frames. Call it while nothing else uses the
+		//	mosaic.
+		bool	setLayout(int inColumnNum, int inRowNum, int inCellWidth, int inCellHeight,
+						int inGap = DEFAULT_GAP)
+		{
+			if (inColumnNum <= 0 || inRowNum <= 0 || inCellWidth <= 0 || inCellHeight <= 0 || inGap < 0)
+			{
+				if (mThrowsEx == false)
+					return false;
+				else
+					throw ViwException(ViwException::PARAM_ERROR,
+						"Invalid mosaic layout", VIW_EXCEPTION_LOCATION_MACRO, 0);
+			}
+
+			int	mosaicWidth = inColumnNum * inCellWidth + (inColumnNum + 1) * inGap;
+			int	mosaicHeight = inRowNum * inCellHeight + (inRowNum + 1) * inGap;
+			size_t	mosaicSize = (size_t )mosaicWidth * mosaicHeight * MOSAIC_PIXEL_SIZE;
+			unsigned char	*mosaicBuffers[2];
+			mosaicBuffers[0] = new(std::nothrow) unsigned char[mosaicSize];
+			mosaicBuffers[1] = new(std::nothrow) unsigned char[mosaicSize];
+			if (mosaicBuffers[0] == NULL || mosaicBuffers[1] == NULL)
+			{
+				delete [] mosaicBuffers[0];
+				delete [] mosaicBuffers[1];
+				if (mThrowsEx == false)
+					return false;
+				else
+					throw ViwException(ViwException::MEMORY_ERROR,
+						"mosaicBuffers == NULL", VIW_EXCEPTION_LOCATION_MACRO, 0);
+			}
+
+			int	tileNum = inColumnNum * inRowNum;
+			while ((int )mTiles.size() > tileNum)
+			{
+				delete mTiles.back();
+				mTiles.pop_back();
+			}
+			while ((int )mTiles.size() < tileNum)
+				mTiles.push_back(new Tile(mThrowsEx));
+
+			for (int i = 0; i < 2; i++)
+			{
+				if (mMosaicBuffers[i] != NULL)
+					delete [] mMosaicBuffers[i];
+				mMosaicBuffers[i] = mosaicBuffers[i];
+			}
+			mFrontIndex = 0;
+			mColumnNum = inColumnNum;
+			mRowNum = inRowNum;
+			mCellWidth = inCellWidth;
+			mCellHeight = inCellHeight;
+			mGap = inGap;
+			mMosaicWidth = mosaicWidth;
+			mMosaicHeight = mosaicHeight;
+
+			fillRect(mMosaicBuffers[0], 0, 0, mMosaicWidth, mMosaicHeight);
+			fillRect(mMosaicBuffers[1], 0, 0, mMosaicWidth, mMosaicHeight);
+			for (int i = 0; i < tileNum; i++)
+			{
+				mTiles[i]->isComposeNeeded = true;
+				mTiles[i]->isBackStale = false;
+				mTiles[i]->placement.width = 0;
+			}
+			return true;
+		}
+		// ---------------------------------------------------------------------
+		// setBackgroundColor
+		// ---------------------------------------------------------------------
+		//	Used for the gaps and the empty parts of the cells from the next
+		//	setLayout() call on
+		void	setBackgroundColor(unsigned char inR, unsigned char inG, unsigned char inB)
+		{
+			mBackgroundColor[0] = inB;
+			mBackgroundColor[1] = inG;
+			mBackgroundColor[2] = inR;
+			mBackgroundColor[3] = 255;
+		}
+		// ---------------------------------------------------------------------
+		// getTileNum
+		// ---------------------------------------------------------------------
+		int	getTileNum()
+		{
+			return (int )mTiles.size();
+		}
+		// ---------------------------------------------------------------------
+		// lockTile
+		// ---------------------------------------------------------------------
+		//	Row major order. Returns the tile buffer locked against
+		//	composeMosaic() and updateTile(), so its display parameters can
+		//	be changed from any thread. Release it with unlockTile(), a frame
+		//	should be passed with updateTile().
+		TileBuffer	*lockTile(int inIndex)
+		{
+			if (inIndex < 0 || inIndex >= (int )mTiles.size())
+				return NULL;
+			mTiles[inIndex]->mutex.lock();
+			return &mTiles[inIndex]->buffer;
+		}
+		// ---------------------------------------------------------------------
+		// unlockTile
+		// ---------------------------------------------------------------------
+		void	unlockTile(int inIndex)
+		{
+			if (inIndex < 0 || inIndex >= (int )mTiles.size())
+				return;
+			mTiles[inIndex]->mutex.unlock();
+		}
+		// ---------------------------------------------------------------------
+		// updateTile
+		// ---------------------------------------------------------------------
+		bool	updateTile(int inIndex, int inWidth, int inHeight, const ImageBufferType *inImagePtr,
+						BufferFormat inFormat, bool inIsBottomUp = false)
+		{
+			if (inIndex < 0 || inIndex >= (int )mTiles.size())
+			{
+				if (mThrowsEx == false)
+					return false;
+				else
+					throw ViwException(ViwException::PARAM_ERROR,
+						"inIndex is out of range", VIW_EXCEPTION_LOCATION_MACRO, 0);
+			}
+
+			Tile	*tile = mTiles[inIndex];
+			std::lock_guard<std::mutex>	lock(tile->mutex);
+			if (tile->buffer.copyIntoImageBuffer(inWidth, inHeight, inImagePtr, inFormat, inIsBottomUp) == false)
+				return false;
+			tile->sourceGeneration++;
+			return true;
+		}
+		// ---------------------------------------------------------------------
+		// invalidateTile
+		// ---------------------------------------------------------------------
+		//	Forces the tile to be composed again by the next composeMosaic()
+		void	invalidateTile(int inIndex)
+		{
+			if (inIndex < 0 || inIndex >= (int )mTiles.size())
+				return;
+
+			Tile	*tile = mTiles[inIndex];
+			std::lock_guard<std::mutex>	lock(tile->mutex);
+			tile->isComposeNeeded = true;
+		}
+		// ---------------------------------------------------------------------
+		// composeMosaic
+		// ---------------------------------------------------------------------
+		//	Returns the number of tiles that were composed (0 : the mosaic is
+		//	unchanged and the front buffer was not swapped)
+		int	composeMosaic()
+		{
+			VIW_TRACE_SCOPE("composeMosaic", this);
+
+			if (mMosaicBuffers[0] == NULL)
+				return 0;
+
+			const unsigned char	*frontBuffer = mMosaicBuffers[mFrontIndex];
+			unsigned char	*backBuffer = mMosaicBuffers[1 - mFrontIndex];
+			std::atomic<int>	composedNum(0);
+			utils::ThreadPool::parallelFor("MosaicCompose", 0, (int )mTiles.size(), 1,
+				[&](int inStart, int inEnd)
+			{
+				for (int i = inStart; i < inEnd; i++)
+					if (composeTile(i, backBuffer, frontBuffer))
+						composedNum++;
+			});
+			if (composedNum.load() != 0)
+				mFrontIndex = 1 - mFrontIndex;
+			return composedNum.load();
+		}
+		// ---------------------------------------------------------------------
+		// getMosaicBufferPtr
+		// ---------------------------------------------------------------------
+		//	The front buffer, it changes with every composeMosaic() call that
+		//	returns non-zero
+		unsigned char	*getMosaicBufferPtr()
+		{
+			return mMosaicBuffers[mFrontIndex];
+		}
+		// ---------------------------------------------------------------------
+		// getMosaicWidth
+		// ---------------------------------------------------------------------
+		int	getMosaicWidth()
+		{
+			return mMosaicWidth;
+		}
+		// ---------------------------------------------------------------------
+		// getMosaicHeight
+		// ---------------------------------------------------------------------
+		int	getMosaicHeight()
+		{
+			return mMosaicHeight;
+		}
+		// ---------------------------------------------------------------------
+		// getMosaicLineOffset
+		// ---------------------------------------------------------------------
+		size_t	getMosaicLineOffset()
+		{
+			return (size_t )mMosaicWidth * MOSAIC_PIXEL_SIZE;
+		}
+		// ---------------------------------------------------------------------
+		// obtainSourcePosition
+		// ---------------------------------------------------------------------
+		//	Maps a mosaic pixel to the tile and the pixel of its source
+		//	(false on the gaps and the empty parts of the cells)
+		bool	obtainSourcePosition(int inX, int inY, int *outIndex, int *outX, int *outY)
+		{
+			if (mCellWidth <= 0 || mCellHeight <= 0 || inX < 0 || inY < 0)
+				return false;
+
+			int	column = inX / (mCellWidth + mGap);
+			int	row = inY / (mCellHeight + mGap);
+			if (column >= mColumnNum || row >= mRowNum)
+				return false;
+
+			int	index = row * mColumnNum + column;
+			Tile	*tile = mTiles[index];
+			std::lock_guard<std::mutex>	lock(tile->mutex);
+			const Placement	&p = tile->placement;
+			if (p.width <= 0 || inX < p.x || inX >= p.x + p.width || inY < p.y || inY >= p.y + p.height)
+				return false;
+
+			*outIndex = index;
+			*outX = (int )((long long )(inX - p.x) * p.sourceWidth / p.width);
+			*outY = (int )((long long )(inY - p.y) * p.sourceHeight / p.height);
+			return true;
+		}
+		// ---------------------------------------------------------------------
+		// formatPixelReadout
+		// ---------------------------------------------------------------------
+		//	"#<tile> (<x>,<y>) <source values>"
+		bool	formatPixelReadout(int inX, int inY, char *outBuf, size_t inBufSize)
+		{
+			int	index, x, y;
+			if (inBufSize == 0 || obtainSourcePosition(inX, inY, &index, &x, &y) == false)
+				return false;
+
+			Tile	*tile = mTiles[index];
+			std::lock_guard<std::mutex>	lock(tile->mutex);
+			TileDisplayBuffer	&buffer = tile->buffer;
+			if (x >= buffer.getWidth() || y >= buffer.getHeight())
+				return false;
+
+			int	len = snprintf(outBuf, inBufSize, "#%d (%d,%d)", index, x, y);
+			if (TileBuffer::isPackedFormat(buffer.getBufferFormat()))
+				return true;
+
+			int	lineY = buffer.isBottomUp() ? buffer.getHeight() - 1 - y : y;
+			const ImageBufferType	*pixelPtr = buffer.getImageBufferLinePtr(lineY) + (size_t )x * buffer.getOnePixelCount();
+			for (int c = 0; c < buffer.getOnePixelCount() && len > 0 && (size_t )len < inBufSize; c++)
+				len += snprintf(outBuf + len, inBufSize - len, " %g", (double )pixelPtr[c]);
+			return true;
+		}
+
+		// Static Functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// pixelReadoutFunc
+		// ---------------------------------------------------------------------
+		//	For ImageWindow::setPixelReadoutFunc(), inData is the MosaicBuffer
+		static bool	pixelReadoutFunc(int inX, int inY, char *outBuf, size_t inBufSize, void *inData)
+		{
+			return ((MosaicBuffer *)inData)->formatPixelReadout(inX, inY, outBuf, inBufSize);
+		}
+
+	protected:
+		// -------------------------------------------------------------------------
+		// TileDisplayBuffer class
+		// -------------------------------------------------------------------------
+		//	The image is shown without mapping when the parent buffer is
+		//	displayable, so the mosaic clears the flags itself
+		class	TileDisplayBuffer : public TileBuffer
+		{
+		public:
+			TileDisplayBuffer(bool inThrowsEx)
+				: TileBuffer(inThrowsEx)
+			{
+			}
+			void	clearUpdateFlags()
+			{
+				TileBuffer::clearIsImageModifiedFlag();
+				TileBuffer::clearIsBufferUpdateNeededFlag();
+			}
+		};
+
+		// Structs -------------------------------------------------------------
+		//	Where the source of a tile was drawn in the mosaic
+		struct	Placement
+		{
+			int		x, y, width, height;
+			int		sourceWidth, sourceHeight;
+		};
+		struct	Tile
+		{
+			Tile(bool inThrowsEx)
+				: buffer(inThrowsEx)
+			{
+				sourceGeneration = 0;
+				composedGeneration = 0;
+				isComposeNeeded = true;
+				isBackStale = false;
+				memset(&placement, 0, sizeof(placement));
+				memset(palette, 0, sizeof(palette));
+			}
+
+			TileDisplayBuffer	buffer;
+			std::mutex		mutex;
+			unsigned int	sourceGeneration;
+			unsigned int	composedGeneration;
+			bool			isComposeNeeded;
+			bool			isBackStale;			// the back buffer cell is behind the front
+			Placement		placement;
+			unsigned char	palette[256 * 3];		// of the last mono compose
+		};
+
+		// Member variables ----------------------------------------------------
+		bool				mThrowsEx;
+		std::vector<Tile *>	mTiles;
+
+		int					mColumnNum;
+		int					mRowNum;
+		int					mCellWidth;
+		int					mCellHeight;
+		int					mGap;
+		int					mMosaicWidth;
+		int					mMosaicHeight;
+		unsigned char		*mMosaicBuffers[2];
+		int					mFrontIndex;
+		unsigned char		mBackgroundColor[4];	// B, G, R, A
+
+		// Member functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// composeTile
+		// ---------------------------------------------------------------------
+		//	Maps the tile and draws it into its cell of outMosaicBuffer if
+		//	anything changed. The cell is brought up to date with the front
+		//	buffer first when the last compose changed it there.
+		bool	composeTile(int inIndex, unsigned char *outMosaicBuffer, const unsigned char *inFrontBuffer)
+		{
+			Tile	*tile = mTiles[inIndex];
+			std::lock_guard<std::mutex>	lock(tile->mutex);
+			TileDisplayBuffer	&buffer = tile->buffer;
+
+			int	cellX = mGap + (inIndex % mColumnNum) * (mCellWidth + mGap);
+			int	cellY = mGap + (inIndex / mColumnNum) * (mCellHeight + mGap);
+			if (tile->isBackStale)
+			{
+				copyRect(outMosaicBuffer, inFrontBuffer, cellX, cellY, mCellWidth, mCellHeight);
+				tile->isBackStale = false;
+			}
+
+			bool	isChanged = tile->isComposeNeeded ||
+								tile->sourceGeneration != tile->composedGeneration ||
+								buffer.isImageModified() || buffer.isBufferUpdateNeeded();
+
+			const unsigned char	*displayPtr = NULL;
+			if (buffer.getImageBufferPtr() != NULL)
+				displayPtr = buffer.getDisplayBufferPtr();	// maps only if needed
+			buffer.clearUpdateFlags();
+
+			const unsigned char	*palette = NULL;
+			bool	isMono = (displayPtr != NULL && buffer.getDisplayFormat() == TileBuffer::BUFFER_FORMAT_MONO);
+			if (isMono)
+			{
+				// a colour map change does not touch the image
+				palette = buffer.getDisplayPalette();
+				if (memcmp(palette, tile->palette, sizeof(tile->palette)) != 0)
+				{
+					memcpy(tile->palette, palette, sizeof(tile->palette));
+					isChanged = true;
+				}
+			}
+			if (isChanged == false)
+				return false;
+
+			Placement	placement = obtainPlacement(cellX, cellY,
+									(displayPtr != NULL) ? buffer.getWidth() : 0,
+									(displayPtr != NULL) ? buffer.getHeight() : 0);
+			if (memcmp(&placement, &tile->placement, sizeof(placement)) != 0)
+				fillRect(outMosaicBuffer, cellX, cellY, mCellWidth, mCellHeight);
+			tile->placement = placement;
+			tile->composedGeneration = tile->sourceGeneration;
+			tile->isComposeNeeded = false;
+			tile->isBackStale = true;
+			if (placement.width <= 0)
+				return true;
+
+			BufferFormat	displayFormat = buffer.getDisplayFormat();
+			int		pixelSize = (displayFormat == TileBuffer::BUFFER_FORMAT_BGRA) ? 4 : 3;
+			size_t	displayLineOffset = buffer.getDisplayLineOffset();
+			std::vector<int>	offsetX(placement.width);
+			for (int x = 0; x < placement.width; x++)
+			{
+				int	srcX = (int )((long long )x * placement.sourceWidth / placement.width);
+				offsetX[x] = isMono ? srcX : srcX * pixelSize;
+			}
+
+			for (int y = 0; y < placement.height; y++)
+			{
+				int	srcY = (int )((long long )y * placement.sourceHeight / placement.height);
+				if (buffer.isBottomUp())
+					srcY = placement.sourceHeight - 1 - srcY;
+				const unsigned char	*srcLine = displayPtr + displayLineOffset * srcY;
+				unsigned char	*dstPtr = outMosaicBuffer + getMosaicLineOffset() * (placement.y + y) +
+											(size_t )placement.x * MOSAIC_PIXEL_SIZE;
+
+				if (isMono)
+				{
+					for (int x = 0; x < placement.width; x++, dstPtr += MOSAIC_PIXEL_SIZE)
+					{
+						const unsigned char	*color = palette + srcLine[offsetX[x]] * 3;	// R, G, B
+						dstPtr[0] = color[2];
+						dstPtr[1] = color[1];
+						dstPtr[2] = color[0];
+						dstPtr[3] = 255;
+					}
+				}
+				else
+				{
+					for (int x = 0; x < placement.width; x++, dstPtr += MOSAIC_PIXEL_SIZE)
+					{
+						const unsigned char	*srcPtr = srcLine + offsetX[x];
+						dstPtr[0] = srcPtr[0];
+						dstPtr[1] = srcPtr[1];
+						dstPtr[2] = srcPtr[2];
+						dstPtr[3] = (pixelSize == 4) ? srcPtr[3] : 255;
+					}
+				}
+			}
+			return true;
+		}
+		// ---------------------------------------------------------------------
+		// obtainPlacement
+		// ---------------------------------------------------------------------
+		Placement	obtainPlacement(int inCellX, int inCellY, int inSourceWidth, int inSourceHeight)
+		{
+			Placement	placement;
+			memset(&placement, 0, sizeof(placement));
+			if (inSourceWidth <= 0 || inSourceHeight <= 0)
+				return placement;
+
+			int	width = inSourceWidth;
+			int	height = inSourceHeight;
+			if (width > mCellWidth || height > mCellHeight)
+			{
+				// shrink to the cell, keeping the aspect ratio
+				if ((long long )width * mCellHeight > (long long )height * mCellWidth)
+				{
+					height = (int )((long long )height * mCellWidth / width);
+					width = mCellWidth;
+				}
+				else
+				{
+					width = (int )((long long )width * mCellHeight / height);
+					height = mCellHeight;
+				}
+				if (width < 1)
+					width = 1;
+				if (height < 1)
+					height = 1;
+			}
+
+			placement.x = inCellX + (mCellWidth - width) / 2;
+			placement.y = inCellY + (mCellHeight - height) / 2;
+			placement.width = width;
+			placement.height = height;
+			placement.sourceWidth = inSourceWidth;
+			placement.sourceHeight = inSourceHeight;
+			return placement;
+		}
+		// ---------------------------------------------------------------------
+		// fillRect
+		// ---------------------------------------------------------------------
+		void	fillRect(unsigned char *outMosaicBuffer, int inX, int inY, int inWidth, int inHeight)
+		{
+			for (int y = inY; y < inY + inHeight; y++)
+			{
+				unsigned char	*dstPtr = outMosaicBuffer + getMosaicLineOffset() * y + (size_t )inX * MOSAIC_PIXEL_SIZE;
+				for (int x = 0; x < inWidth; x++, dstPtr += MOSAIC_PIXEL_SIZE)
+					memcpy(dstPtr, mBackgroundColor, MOSAIC_PIXEL_SIZE);
+			}
+		}
+		// ---------------------------------------------------------------------
+		// copyRect
+		// ---------------------------------------------------------------------
+		void	copyRect(unsigned char *outMosaicBuffer, const unsigned char *inMosaicBuffer,
+						int inX, int inY, int inWidth, int inHeight)
+		{
+			size_t	offset = getMosaicLineOffset() * inY + (size_t )inX * MOSAIC_PIXEL_SIZE;
+			for (int y = 0; y < inHeight; y++, offset += getMosaicLineOffset())
+				memcpy(outMosaicBuffer + offset, inMosaicBuffer + offset, (size_t )inWidth * MOSAIC_PIXEL_SIZE);
+		}
+
+	private:
+		MosaicBuffer(const MosaicBuffer &);
+		MosaicBuffer	&operator=(const MosaicBuffer &);
+	};
+ };
+};
+
+#endif	// #ifdef VIW_MODEL_MOSAICBUFFER_H
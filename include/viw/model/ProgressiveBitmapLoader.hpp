@@ -0,0 +1,361 @@
+// =============================================================================
+//  ProgressiveBitmapLoader.hpp
+//
+//  Written in 2014 by Dairoku Sekiguchi (sekiguchi at acm dot org)
+//
+//  To the extent possible under law, the author(s) have dedicated all copyright
+//  and related and neighboring rights to this software to the public domain worldwide.
+//  This software is distributed without any warranty.
+//
+//  You should have received a copy of the CC0 Public Domain Dedication along with
+//  this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+// =============================================================================
+/*!
+	\file		viw/model/ProgressiveBitmapLoader.h
+	\author		Dairoku Sekiguchi
+	\version	1.0.0
+	\date		2026/10/19
+	\brief		Header file for viw library types
+
+	This file defines the progressive bitmap file loader for viw library
+*/
+
+#ifndef VIW_MODEL_PROGRESSIVEBITMAPLOADER_H
+#define VIW_MODEL_PROGRESSIVEBITMAPLOADER_H
+
+// Includes --------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include "viw/Exception.hpp"
+#include "viw/model/Bitmap.hpp"
+#include "viw/model/DisplayBuffer.hpp"
+#include "viw/utils/Trace.hpp"
+
+
+// Namespace -------------------------------------------------------------------
+namespace viw
+{
+ namespace model
+ {
+	// -------------------------------------------------------------------------
+	// ProgressiveBitmapLoader class
+	// -------------------------------------------------------------------------
+	//	Loads a BMP file on a background thread into a DisplayBuffer (e.g. an
+	//	ImageWindow) that shows it while it fills in, instead of blocking in
+	//	Bitmap::loadFromFile() until the whole pixel array is read.
+	//
+	//	start() reads only the headers and points the buffer at zero filled
+	//	pixels in the file's line order (a bottom-up BMP becomes a bottom-up
+	//	buffer), so the lines are read straight into place and the first
+	//	ones show after one READ_CHUNK_SIZE read whatever the file size.
+	//	Each chunk is published with DisplayBuffer::markLinesAsModified(),
+	//	which maps only those lines, and then the lines loaded function is
+	//	called on the loader thread (the place to call updateImage()).
+	//
+	//	A full mapping pass (the first paint, an automatic display range)
+	//	may read a line while it is being written, like a frame shown
+	//	while its producer writes it; that line is marked and mapped again
+	//	right after.
+	//
+	//	The loader owns the pixels: keep it alive while the buffer uses
+	//	them, and don't change the buffer until the loading has ended.
+	//	8bpp files are loaded as MONO (the palette is ignored), 24 and 32bpp
+	//	files as BGR and BGRA.
+	class	ProgressiveBitmapLoader
+	{
+	public:
+		// Typedefs ------------------------------------------------------------
+		typedef DisplayBuffer<unsigned char>	TargetBuffer;
+		typedef void	(*LinesLoadedFunc)(int inStartY, int inEndY, void *inData);
+
+		// Constatns -----------------------------------------------------------
+		const static int	READ_CHUNK_SIZE		= 1024 * 1024;
+
+		enum LoadState
+		{
+			LOAD_STATE_IDLE			= 0,
+			LOAD_STATE_LOADING,
+			LOAD_STATE_DONE,
+			LOAD_STATE_CANCELED,
+			LOAD_STATE_FAILED
+		};
+
+		// Constructors and Destructor -----------------------------------------
+		// ---------------------------------------------------------------------
+		// ProgressiveBitmapLoader
+		// ---------------------------------------------------------------------
+		ProgressiveBitmapLoader(bool inThrowsEx = false)
+		{
+			mThrowsEx = inThrowsEx;
+			mFile = NULL;
+			mBuffer = NULL;
+			mPixels = NULL;
+			mHeight = 0;
+			mLineByteSize = 0;
+			mFileLineByteSize = 0;
+			mLinesLoadedFunc = NULL;
+			mLinesLoadedFuncData = NULL;
+			mState = LOAD_STATE_IDLE;
+			mLoadedLineNum = 0;
+			mIsCancelRequested = false;
+		}
+		// ---------------------------------------------------------------------
+		// ~ProgressiveBitmapLoader
+		// ---------------------------------------------------------------------
+		virtual ~ProgressiveBitmapLoader()
+		{
+			cancel();
+			wait();
+			if (mPixels != NULL)
+				free(mPixels);
+		}
+
+		// Member functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// setLinesLoadedFunc
+		// ---------------------------------------------------------------------
+		//	inStartY and inEndY are buffer lines (file order). Set it before
+		//	start().
+		void	setLinesLoadedFunc(LinesLoadedFunc inFunc, void *inData)
+		{
+			mLinesLoadedFunc = inFunc;
+			mLinesLoadedFuncData = inData;
+		}
+		// ---------------------------------------------------------------------
+		// start
+		// ---------------------------------------------------------------------
+		//	Reads the headers, sets up outBuffer and starts the loader thread
+		bool	start(const char *inFileName, TargetBuffer *outBuffer)
+		{
+			cancel();
+			wait();
+
+			mFile = fopen(inFileName, "rb");
+			if (mFile == NULL)
+				return error(ViwException::OS_ERROR, "Can't open the bitmap file", errno);
+
+			BITMAPFILEHEADER	fileHeader;
+			BITMAPINFOHEADER	infoHeader;
+			TargetBuffer::BufferFormat	format;
+			if (fread(&fileHeader, sizeof(fileHeader), 1, mFile) != 1 ||
+				fread(&infoHeader, sizeof(infoHeader), 1, mFile) != 1 ||
+				obtainFormat(fileHeader, infoHeader, &format) == false ||
+				skipBytes(fileHeader.bfOffBits - sizeof(fileHeader) - sizeof(infoHeader)) == false)
+			{
+				closeFile();
+				return error(ViwException::FILE_FORMAT_ERROR, "Unsupported bitmap file", 0);
+			}
+
+			// calloc() gets zero pages from the OS, the cost doesn't grow with the size
+			int	width = infoHeader.biWidth;
+			mHeight = Bitmap::getAbsBitmapHeight(&infoHeader);
+			mLineByteSize = (size_t )TargetBuffer::obtainLineElementCount(format, width);
+			mFileLineByteSize = Bitmap::calBitmapLineOffset(&infoHeader);
+			unsigned char	*pixels = (mLineByteSize != 0) ? (unsigned char *)calloc(mLineByteSize, (size_t )mHeight) : NULL;
+			if (pixels == NULL)
+			{
+				closeFile();
+				return error(ViwException::MEMORY_ERROR, "Can't allocate the pixels", 0);
+			}
+			if (outBuffer->setImageBufferPtr(width, mHeight, pixels, format, infoHeader.biHeight > 0) == false)
+			{
+				free(pixels);
+				closeFile();
+				return error(ViwException::PARAM_ERROR, "Can't set up the buffer", 0);
+			}
+
+			// The previous image is released only after the buffer has moved off it
+			if (mPixels != NULL)
+				free(mPixels);
+			mPixels = pixels;
+
+			mBuffer = outBuffer;
+			mLoadedLineNum = 0;
+			mIsCancelRequested = false;
+			mState = LOAD_STATE_LOADING;
+			mThread = std::thread(&ProgressiveBitmapLoader::loaderThread, this);
+			return true;
+		}
+		// ---------------------------------------------------------------------
+		// cancel
+		// ---------------------------------------------------------------------
+		//	Returns at once, the lines loaded so far stay in the buffer
+		void	cancel()
+		{
+			mIsCancelRequested = true;
+		}
+		// ---------------------------------------------------------------------
+		// wait
+		// ---------------------------------------------------------------------
+		//	true if the whole file was loaded
+		bool	wait()
+		{
+			if (mThread.joinable())
+				mThread.join();
+			return (mState == LOAD_STATE_DONE);
+		}
+		// ---------------------------------------------------------------------
+		// getState
+		// ---------------------------------------------------------------------
+		LoadState	getState()
+		{
+			return mState;
+		}
+		// ---------------------------------------------------------------------
+		// getLoadedLineNum
+		// ---------------------------------------------------------------------
+		int	getLoadedLineNum()
+		{
+			return mLoadedLineNum;
+		}
+		// ---------------------------------------------------------------------
+		// getProgress
+		// ---------------------------------------------------------------------
+		double	getProgress()
+		{
+			if (mHeight == 0)
+				return 0;
+			return (double )mLoadedLineNum / mHeight;
+		}
+
+		// Static Functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// obtainFormat
+		// ---------------------------------------------------------------------
+		//	The buffer format of a supported (uncompressed 8, 24 or 32bpp) BMP
+		static bool	obtainFormat(const BITMAPFILEHEADER &inFileHeader, const BITMAPINFOHEADER &inInfoHeader,
+						TargetBuffer::BufferFormat *outFormat)
+		{
+			if (inFileHeader.bfType != 0x4d42 || inInfoHeader.biSize != sizeof(BITMAPINFOHEADER) ||
+				inInfoHeader.biPlanes != 1 || inInfoHeader.biCompression != 0 ||
+				inInfoHeader.biWidth <= 0 || inInfoHeader.biHeight == 0 ||
+				inFileHeader.bfOffBits < sizeof(BITMAPFILEHEADER) + sizeof(BITMAPINFOHEADER))
+				return false;
+
+			switch (inInfoHeader.biBitCount)
+			{
+			case 8:
+				*outFormat = TargetBuffer::BUFFER_FORMAT_MONO;
+				return true;
+			case 24:
+				*outFormat = TargetBuffer::BUFFER_FORMAT_BGR;
+				return true;
+			case 32:
+				*outFormat = TargetBuffer::BUFFER_FORMAT_BGRA;
+				return true;
+			}
+			return false;
+		}
+
+	protected:
+		// Member variables ----------------------------------------------------
+		bool				mThrowsEx;
+		FILE				*mFile;
+		TargetBuffer		*mBuffer;
+		unsigned char		*mPixels;
+		int					mHeight;
+		size_t				mLineByteSize;
+		size_t				mFileLineByteSize;
+		LinesLoadedFunc		mLinesLoadedFunc;
+		void				*mLinesLoadedFuncData;
+		std::thread			mThread;
+		std::atomic<LoadState>	mState;
+		std::atomic<int>	mLoadedLineNum;
+		std::atomic<bool>	mIsCancelRequested;
+
+		// Member functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// loaderThread
+		// ---------------------------------------------------------------------
+		void	loaderThread()
+		{
+			VIW_TRACE_SCOPE("ProgressiveBitmapLoader", this);
+
+			// Lines without padding are read in place, the others through chunk
+			bool	isPadded = (mFileLineByteSize != mLineByteSize);
+			int		chunkLineNum = (int )(READ_CHUNK_SIZE / mFileLineByteSize);
+			if (chunkLineNum < 1)
+				chunkLineNum = 1;
+			std::vector<unsigned char>	chunk(isPadded ? mFileLineByteSize * chunkLineNum : 0);
+
+			LoadState	state = LOAD_STATE_DONE;
+			for (int y = 0; y < mHeight; y += chunkLineNum)
+			{
+				if (mIsCancelRequested)
+				{
+					state = LOAD_STATE_CANCELED;
+					break;
+				}
+
+				int				lineNum = (mHeight - y < chunkLineNum) ? mHeight - y : chunkLineNum;
+				unsigned char	*dstPtr = mPixels + mLineByteSize * y;
+				unsigned char	*readPtr = isPadded ? &chunk[0] : dstPtr;
+				if (fread(readPtr, mFileLineByteSize, (size_t )lineNum, mFile) != (size_t )lineNum)
+				{
+					state = LOAD_STATE_FAILED;
+					break;
+				}
+				if (isPadded)
+					for (int i = 0; i < lineNum; i++)
+						memcpy(dstPtr + mLineByteSize * i, readPtr + mFileLineByteSize * i, mLineByteSize);
+
+				mBuffer->markLinesAsModified(y, y + lineNum);
+				mLoadedLineNum = y + lineNum;
+				if (mLinesLoadedFunc != NULL)
+					mLinesLoadedFunc(y, y + lineNum, mLinesLoadedFuncData);
+			}
+
+			closeFile();
+			mState = state;
+		}
+		// ---------------------------------------------------------------------
+		// skipBytes
+		// ---------------------------------------------------------------------
+		//	Skips the palette and any gap before the bits without seeking
+		bool	skipBytes(size_t inSize)
+		{
+			unsigned char	buffer[1024];
+			while (inSize != 0)
+			{
+				size_t	size = (inSize < sizeof(buffer)) ? inSize : sizeof(buffer);
+				if (fread(buffer, 1, size, mFile) != size)
+					return false;
+				inSize -= size;
+			}
+			return true;
+		}
+		// ---------------------------------------------------------------------
+		// closeFile
+		// ---------------------------------------------------------------------
+		void	closeFile()
+		{
+			if (mFile == NULL)
+				return;
+			fclose(mFile);
+			mFile = NULL;
+		}
+		// ---------------------------------------------------------------------
+		// error
+		// ---------------------------------------------------------------------
+		bool	error(int inCode, const char *inDescription, int inOSErrorCode)
+		{
+			mState = LOAD_STATE_FAILED;
+			if (mThrowsEx == false)
+				return false;
+			else
+				throw ViwException(inCode, inDescription, VIW_EXCEPTION_LOCATION_MACRO, inOSErrorCode);
+		}
+
+	private:
+		ProgressiveBitmapLoader(const ProgressiveBitmapLoader &);
+		ProgressiveBitmapLoader	&operator=(const ProgressiveBitmapLoader &);
+	};
+ };
+};
+
+#endif	// #ifdef VIW_MODEL_PROGRESSIVEBITMAPLOADER_H
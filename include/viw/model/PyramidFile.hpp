@@ -0,0 +1,847 @@
+// =============================================================================
+//  PyramidFile.hpp
+//
+//  Written in 2014 by Dairoku Sekiguchi (sekiguchi at acm dot org)
+//
+//  To the extent possible under law, the author(s) have dedicated all copyright
+//  and related and neighboring rights to this software to the public domain worldwide.
+//  This software is distributed without any warranty.
+//
+//  You should have received a copy of the CC0 Public Domain Dedication along with
+//  this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+// =============================================================================
+/*!
+	\file		viw/model/PyramidFile.h
+	\author		Dairoku Sekiguchi
+	\version	1.0.0
+	\date		2026/10/19
+	\brief		Header file for viw library types
+
+	This file defines the memory mapped pyramid file for viw library
+*/
+
+#ifndef VIW_MODEL_PYRAMIDFILE_H
+#define VIW_MODEL_PYRAMIDFILE_H
+
+// Includes --------------------------------------------------------------------
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include <limits>
+#include "viw/Exception.hpp"
+#include "viw/model/ImageBuffer.hpp"
+#include "viw/model/Bitmap.hpp"
+#include "viw/model/TileSource.hpp"
+#include "viw/utils/ThreadPool.hpp"
+
+
+// Namespace -------------------------------------------------------------------
+namespace viw
+{
+ namespace model
+ {
+	// -------------------------------------------------------------------------
+	// PyramidFile class
+	// -------------------------------------------------------------------------
+	//	A TileSource stored in one memory mapped file, so a huge image opens
+	//	without reading it and a TiledImage shows the coarsest level at once.
+	//	create() writes the file once: level 0 is cut from the source image
+	//	and each following level is a 2x2 box reduction of the previous one
+	//	(Bayer mosaics keep their pattern by subsampling every other 2x2
+	//	cell, without averaging).
+	//	The tiles of a level are written in parallel straight into the
+	//	mapped file.
+	//
+	//	Layout (native byte order):
+	//		FileHeader
+	//		TileEntry[tileNum]	level 0 first, then rows of tiles top-down
+	//		tile data			ImageBuffer lines of the tile width, top-down
+	//
+	//	The magic is written last, a file whose creation was interrupted
+	//	does not open. loadTile() points the tile at the mapping instead of
+	//	copying it, so the tiles are read-only (ImageBuffer::isReadOnly())
+	//	and the file has to stay open while a TiledImage uses it.
+	template <typename ImageBufferType> class	PyramidFile : public TileSource<ImageBufferType>
+	{
+	public:
+		// Typedefs ------------------------------------------------------------
+		typedef ImageBuffer<ImageBufferType>				ImageBufferBase;
+		typedef typename ImageBufferBase::BufferFormat		BufferFormat;
+
+		// Constatns -----------------------------------------------------------
+		const static unsigned int	PYRAMID_MAGIC		= 0x52595056;	// "VPYR"
+		const static unsigned int	PYRAMID_VERSION		= 1;
+		const static int			DEFAULT_TILE_SIZE	= 256;
+		const static int			TILE_ALIGNMENT		= 64;
+		const static int			DATA_ALIGNMENT		= 4096;
+
+		// Constructors and Destructor -----------------------------------------
+		// ---------------------------------------------------------------------
+		// PyramidFile
+		// ---------------------------------------------------------------------
+		PyramidFile(bool inThrowsEx = false)
+		{
+			mThrowsEx = inThrowsEx;
+			mMappedPtr = NULL;
+			mMappedSize = 0;
+			mHeader = NULL;
+			mIndex = NULL;
+		}
+		// ---------------------------------------------------------------------
+		// ~PyramidFile
+		// ---------------------------------------------------------------------
+		virtual ~PyramidFile()
+		{
+			close();
+		}
+
+		// Member functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// open
+		// ---------------------------------------------------------------------
+		bool	open(const char *inFileName)
+		{
+			close();
+
+			int	errorCode;
+			if (mapFile(inFileName, 0, &mMappedPtr, &mMappedSize, &errorCode) == false)
+				return error(mThrowsEx, ViwException::OS_ERROR, "Can't map the pyramid file", errorCode);
+
+			if (attachLayout() == false || mHeader->magic != PYRAMID_MAGIC)
+			{
+				close();
+				return error(mThrowsEx, ViwException::FILE_FORMAT_ERROR, "Invalid pyramid file", 0);
+			}
+			return true;
+		}
+		// ---------------------------------------------------------------------
+		// openWithSidecar
+		// ---------------------------------------------------------------------
+		//	Opens "<inBitmapFileName>.vpyr", building it first when it is
+		//	missing or older than the bitmap. Only the first open of a bitmap
+		//	reads the whole image.
+		bool	openWithSidecar(const char *inBitmapFileName,
+					int inTileWidth = DEFAULT_TILE_SIZE, int inTileHeight = DEFAULT_TILE_SIZE)
+		{
+			std::vector<char>	sidecarFileName(strlen(inBitmapFileName) + 8);
+			obtainSidecarFileName(inBitmapFileName, &sidecarFileName[0], sidecarFileName.size());
+
+			long long	bitmapTime, sidecarTime;
+			if (obtainModifiedTime(inBitmapFileName, &bitmapTime) == false)
+				return error(mThrowsEx, ViwException::OS_ERROR, "Can't stat the bitmap file", errno);
+
+			if (obtainModifiedTime(&sidecarFileName[0], &sidecarTime) && sidecarTime >= bitmapTime)
+			{
+				PyramidFile	probe(false);
+				if (probe.open(&sidecarFileName[0]))
+				{
+					probe.close();
+					return open(&sidecarFileName[0]);
+				}
+			}
+
+			if (createFromBitmapFile(&sidecarFileName[0], inBitmapFileName,
+					inTileWidth, inTileHeight, mThrowsEx) == false)
+				return false;
+			return open(&sidecarFileName[0]);
+		}
+		// ---------------------------------------------------------------------
+		// close
+		// ---------------------------------------------------------------------
+		void	close()
+		{
+			if (mMappedPtr == NULL)
+				return;
+
+			unmapFile(mMappedPtr, mMappedSize);
+			mMappedPtr = NULL;
+			mMappedSize = 0;
+			mHeader = NULL;
+			mIndex = NULL;
+			mLevelTileStart.clear();
+		}
+		// ---------------------------------------------------------------------
+		// isOpened
+		// ---------------------------------------------------------------------
+		bool	isOpened()
+		{
+			return (mMappedPtr != NULL);
+		}
+		// ---------------------------------------------------------------------
+		// getWidth
+		// ---------------------------------------------------------------------
+		virtual int	getWidth()
+		{
+			return (mHeader != NULL) ? (int )mHeader->width : 0;
+		}
+		// ---------------------------------------------------------------------
+		// getHeight
+		// ---------------------------------------------------------------------
+		virtual int	getHeight()
+		{
+			return (mHeader != NULL) ? (int )mHeader->height : 0;
+		}
+		// ---------------------------------------------------------------------
+		// getLevelNum
+		// ---------------------------------------------------------------------
+		virtual int	getLevelNum()
+		{
+			return (mHeader != NULL) ? (int )mHeader->levelNum : 0;
+		}
+		// ---------------------------------------------------------------------
+		// getTileWidth
+		// ---------------------------------------------------------------------
+		virtual int	getTileWidth()
+		{
+			return (mHeader != NULL) ? (int )mHeader->tileWidth : 0;
+		}
+		// ---------------------------------------------------------------------
+		// getTileHeight
+		// ---------------------------------------------------------------------
+		virtual int	getTileHeight()
+		{
+			return (mHeader != NULL) ? (int )mHeader->tileHeight : 0;
+		}
+		// ---------------------------------------------------------------------
+		// getBufferFormat
+		// ---------------------------------------------------------------------
+		virtual BufferFormat	getBufferFormat()
+		{
+			return (mHeader != NULL) ? (BufferFormat )mHeader->format : ImageBufferBase::BUFFER_FORMAT_NOT_SPECIFIED;
+		}
+		// ---------------------------------------------------------------------
+		// loadTile
+		// ---------------------------------------------------------------------
+		virtual bool	loadTile(int inLevel, int inTileX, int inTileY,
+							ImageBuffer<ImageBufferType> *outTile)
+		{
+			const ImageBufferType	*tilePtr = getTilePtr(inLevel, inTileX, inTileY);
+			if (tilePtr == NULL)
+				return false;
+
+			return outTile->setReadOnlyImageBufferPtr(
+						obtainTileExtent(inTileX, this->getTileWidth(), this->getLevelWidth(inLevel)),
+						obtainTileExtent(inTileY, this->getTileHeight(), this->getLevelHeight(inLevel)),
+						tilePtr, getBufferFormat());
+		}
+		// ---------------------------------------------------------------------
+		// getTilePtr
+		// ---------------------------------------------------------------------
+		//	NULL if the tile doesn't exist
+		const ImageBufferType	*getTilePtr(int inLevel, int inTileX, int inTileY)
+		{
+			const TileEntry	*entry = getTileEntry(inLevel, inTileX, inTileY);
+			if (entry == NULL)
+				return NULL;
+			return (const ImageBufferType *)((const unsigned char *)mMappedPtr + entry->offset);
+		}
+
+		// Static Functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// create
+		// ---------------------------------------------------------------------
+		//	Writes the pyramid of inImage (packed formats are not supported,
+		//	the tile size must be even so that every tile starts on a Bayer
+		//	cell)
+		static bool	create(const char *inFileName, ImageBuffer<ImageBufferType> *inImage,
+						int inTileWidth = DEFAULT_TILE_SIZE, int inTileHeight = DEFAULT_TILE_SIZE,
+						bool inThrowsEx = false)
+		{
+			SourceImage	source;
+			source.ptr = (const unsigned char *)inImage->getImageBufferPtr();
+			source.lineByteSize = (size_t )inImage->getLineElementCount() * sizeof(ImageBufferType);
+			source.width = inImage->getWidth();
+			source.height = inImage->getHeight();
+			source.isBottomUp = inImage->isBottomUp();
+			source.format = inImage->getBufferFormat();
+			if (source.ptr == NULL)
+				return error(inThrowsEx, ViwException::PARAM_ERROR, "inImage has no buffer", 0);
+
+			return createFromSource(inFileName, source, inTileWidth, inTileHeight, inThrowsEx);
+		}
+		// ---------------------------------------------------------------------
+		// createFromBitmapFile
+		// ---------------------------------------------------------------------
+		//	Builds the pyramid from a mapped 8 (as MONO, the palette is
+		//	ignored), 24 or 32bpp BMP file, so the bitmap is never loaded as
+		//	a whole. Only for PyramidFile<unsigned char>.
+		static bool	createFromBitmapFile(const char *inFileName, const char *inBitmapFileName,
+						int inTileWidth = DEFAULT_TILE_SIZE, int inTileHeight = DEFAULT_TILE_SIZE,
+						bool inThrowsEx = false)
+		{
+			if (sizeof(ImageBufferType) != 1)
+				return error(inThrowsEx, ViwException::PARAM_ERROR, "Bitmap files need PyramidFile<unsigned char>", 0);
+
+			void	*bitmapPtr;
+			size_t	bitmapSize;
+			int		errorCode;
+			if (mapFile(inBitmapFileName, 0, &bitmapPtr, &bitmapSize, &errorCode) == false)
+				return error(inThrowsEx, ViwException::OS_ERROR, "Can't map the bitmap file", errorCode);
+
+			SourceImage	source;
+			bool	result = obtainBitmapSource(bitmapPtr, bitmapSize, &source);
+			if (result)
+				result = createFromSource(inFileName, source, inTileWidth, inTileHeight, false);
+			unmapFile(bitmapPtr, bitmapSize);
+
+			if (result == false)
+				return error(inThrowsEx, ViwException::FILE_FORMAT_ERROR, "Can't build the pyramid of the bitmap file", 0);
+			return true;
+		}
+		// ---------------------------------------------------------------------
+		// obtainSidecarFileName
+		// ---------------------------------------------------------------------
+		static void	obtainSidecarFileName(const char *inFileName, char *outFileName, size_t inSize)
+		{
+			snprintf(outFileName, inSize, "%s.vpyr", inFileName);
+		}
+
+	protected:
+		// Structs -------------------------------------------------------------
+		struct FileHeader
+		{
+			long long	magic;				// written last by create()
+			long long	version;
+			long long	format;
+			long long	width;
+			long long	height;
+			long long	elementSize;
+			long long	tileWidth;
+			long long	tileHeight;
+			long long	levelNum;
+			long long	tileNum;
+			long long	indexOffset;
+			long long	totalSize;
+			long long	reserved[4];
+		};
+		struct TileEntry
+		{
+			long long	offset;
+			long long	size;
+		};
+		struct SourceImage
+		{
+			const unsigned char	*ptr;
+			size_t				lineByteSize;
+			int					width;
+			int					height;
+			bool				isBottomUp;
+			BufferFormat		format;
+
+			const ImageBufferType	*getLinePtr(int inY) const
+			{
+				if (isBottomUp)
+					inY = height - 1 - inY;
+				return (const ImageBufferType *)(ptr + lineByteSize * inY);
+			}
+		};
+
+		// Member variables ----------------------------------------------------
+		bool				mThrowsEx;
+		void				*mMappedPtr;
+		size_t				mMappedSize;
+		FileHeader			*mHeader;
+		TileEntry			*mIndex;
+		std::vector<int>	mLevelTileStart;	// index of the first tile of each level
+
+		// Member functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// attachLayout
+		// ---------------------------------------------------------------------
+		//	Checks everything but the magic and sets up the index
+		bool	attachLayout()
+		{
+			if (mMappedSize < sizeof(FileHeader))
+				return false;
+
+			mHeader = (FileHeader *)mMappedPtr;
+			if (mHeader->version != PYRAMID_VERSION ||
+				mHeader->elementSize != sizeof(ImageBufferType) ||
+				mHeader->totalSize != (long long )mMappedSize ||
+				mHeader->width <= 0 || mHeader->width > INT_MAX ||
+				mHeader->height <= 0 || mHeader->height > INT_MAX ||
+				isValidTileSize(mHeader->tileWidth) == false ||
+				isValidTileSize(mHeader->tileHeight) == false ||
+				isValidFormat((BufferFormat )mHeader->format) == false ||
+				mHeader->levelNum != this->obtainLevelNum((int )mHeader->width, (int )mHeader->height,
+										(int )mHeader->tileWidth, (int )mHeader->tileHeight))
+				return false;
+
+			long long	tileNum = 0;
+			mLevelTileStart.resize((size_t )mHeader->levelNum);
+			for (int level = 0; level < mHeader->levelNum; level++)
+			{
+				mLevelTileStart[level] = (int )tileNum;
+				tileNum += (long long )this->getTileColumnNum(level) * this->getTileRowNum(level);
+			}
+			if (mHeader->tileNum != tileNum || tileNum > INT_MAX ||
+				mHeader->indexOffset != sizeof(FileHeader) ||
+				(size_t )mHeader->indexOffset + sizeof(TileEntry) * (size_t )tileNum > mMappedSize)
+				return false;
+
+			mIndex = (TileEntry *)((unsigned char *)mMappedPtr + mHeader->indexOffset);
+			for (int level = 0; level < mHeader->levelNum; level++)
+				for (int y = 0; y < this->getTileRowNum(level); y++)
+					for (int x = 0; x < this->getTileColumnNum(level); x++)
+					{
+						const TileEntry	*entry = getTileEntry(level, x, y);
+						if (entry->offset < 0 || entry->offset % TILE_ALIGNMENT != 0 ||
+							entry->size != (long long )obtainTileByteSize(level, x, y) ||
+							(unsigned long long )entry->offset + entry->size > mMappedSize)
+							return false;
+					}
+			return true;
+		}
+		// ---------------------------------------------------------------------
+		// getTileEntry
+		// ---------------------------------------------------------------------
+		TileEntry	*getTileEntry(int inLevel, int inTileX, int inTileY)
+		{
+			if (mIndex == NULL || inLevel < 0 || inLevel >= getLevelNum() ||
+				inTileX < 0 || inTileX >= this->getTileColumnNum(inLevel) ||
+				inTileY < 0 || inTileY >= this->getTileRowNum(inLevel))
+				return NULL;
+
+			return mIndex + mLevelTileStart[inLevel] + inTileY * this->getTileColumnNum(inLevel) + inTileX;
+		}
+		// ---------------------------------------------------------------------
+		// getTileLinePtr
+		// ---------------------------------------------------------------------
+		ImageBufferType	*getTileLinePtr(int inLevel, int inTileX, int inTileY, int inLineY)
+		{
+			int	tileWidth = obtainTileExtent(inTileX, getTileWidth(), this->getLevelWidth(inLevel));
+			return (ImageBufferType *)getTilePtr(inLevel, inTileX, inTileY) +
+					(size_t )ImageBufferBase::obtainLineElementCount(getBufferFormat(), tileWidth) * inLineY;
+		}
+		// ---------------------------------------------------------------------
+		// obtainTileByteSize
+		// ---------------------------------------------------------------------
+		size_t	obtainTileByteSize(int inLevel, int inTileX, int inTileY)
+		{
+			int	tileWidth = obtainTileExtent(inTileX, getTileWidth(), this->getLevelWidth(inLevel));
+			int	tileHeight = obtainTileExtent(inTileY, getTileHeight(), this->getLevelHeight(inLevel));
+			return (size_t )ImageBufferBase::obtainLineElementCount(getBufferFormat(), tileWidth) *
+					tileHeight * sizeof(ImageBufferType);
+		}
+		// ---------------------------------------------------------------------
+		// copyTile
+		// ---------------------------------------------------------------------
+		//	Cuts a level 0 tile out of the source image
+		void	copyTile(const SourceImage &inSource, int inTileX, int inTileY)
+		{
+			int		x0 = inTileX * getTileWidth();
+			int		y0 = inTileY * getTileHeight();
+			int		tileWidth = obtainTileExtent(inTileX, getTileWidth(), getWidth());
+			int		tileHeight = obtainTileExtent(inTileY, getTileHeight(), getHeight());
+			size_t	lineElementCount = ImageBufferBase::obtainLineElementCount(getBufferFormat(), tileWidth);
+			size_t	offsetX = (size_t )x0 * ImageBufferBase::obtainOnePixelCount(getBufferFormat());
+
+			for (int y = 0; y < tileHeight; y++)
+				memcpy(getTileLinePtr(0, inTileX, inTileY, y),
+					inSource.getLinePtr(y0 + y) + offsetX, lineElementCount * sizeof(ImageBufferType));
+		}
+		// ---------------------------------------------------------------------
+		// reduceTile
+		// ---------------------------------------------------------------------
+		//	Builds a tile of inLevel from the 2x2 pixels below it in the
+		//	previous level
+		void	reduceTile(int inLevel, int inTileX, int inTileY)
+		{
+			int		srcLevel = inLevel - 1;
+			int		srcWidth = this->getLevelWidth(srcLevel);
+			int		srcHeight = this->getLevelHeight(srcLevel);
+			int		x0 = inTileX * getTileWidth();
+			int		y0 = inTileY * getTileHeight();
+			int		tileWidth = obtainTileExtent(inTileX, getTileWidth(), this->getLevelWidth(inLevel));
+			int		tileHeight = obtainTileExtent(inTileY, getTileHeight(), this->getLevelHeight(inLevel));
+			bool	isBayer = ImageBufferBase::isBayerFormat(getBufferFormat());
+			int		onePixelCount = ImageBufferBase::obtainOnePixelCount(getBufferFormat());
+
+			// Source tile column and element offset of both samples of each column
+			int		firstSrcTileX = INT_MAX, lastSrcTileX = 0;
+			std::vector<int>	srcTileX(tileWidth * 2), srcOffset(tileWidth * 2);
+			for (int x = 0; x < tileWidth; x++)
+				for (int i = 0; i < 2; i++)
+				{
+					int	sx = obtainSourcePos(x0 + x, i, srcWidth, isBayer);
+					srcTileX[x * 2 + i] = sx / getTileWidth();
+					srcOffset[x * 2 + i] = (sx % getTileWidth()) * onePixelCount;
+					if (srcTileX[x * 2 + i] < firstSrcTileX)
+						firstSrcTileX = srcTileX[x * 2 + i];
+					if (srcTileX[x * 2 + i] > lastSrcTileX)
+						lastSrcTileX = srcTileX[x * 2 + i];
+				}
+
+			std::vector<const ImageBufferType *>	srcLines((lastSrcTileX - firstSrcTileX + 1) * 2);
+			for (int y = 0; y < tileHeight; y++)
+			{
+				for (int i = 0; i < 2; i++)
+				{
+					int	sy = obtainSourcePos(y0 + y, i, srcHeight, isBayer);
+					for (int tx = firstSrcTileX; tx <= lastSrcTileX; tx++)
+						srcLines[(tx - firstSrcTileX) * 2 + i] = getTileLinePtr(srcLevel, tx,
+											sy / getTileHeight(), sy % getTileHeight());
+				}
+
+				ImageBufferType	*dstPtr = getTileLinePtr(inLevel, inTileX, inTileY, y);
+				for (int x = 0; x < tileWidth; x++)
+				{
+					int	left = x * 2, right = x * 2 + 1;
+					const ImageBufferType	*p00 = srcLines[(srcTileX[left] - firstSrcTileX) * 2] + srcOffset[left];
+					const ImageBufferType	*p01 = srcLines[(srcTileX[right] - firstSrcTileX) * 2] + srcOffset[right];
+					const ImageBufferType	*p10 = srcLines[(srcTileX[left] - firstSrcTileX) * 2 + 1] + srcOffset[left];
+					const ImageBufferType	*p11 = srcLines[(srcTileX[right] - firstSrcTileX) * 2 + 1] + srcOffset[right];
+					for (int c = 0; c < onePixelCount; c++)
+						*dstPtr++ = average4(p00[c], p01[c], p10[c], p11[c]);
+				}
+			}
+		}
+
+		// Static Functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// createFromSource
+		// ---------------------------------------------------------------------
+		static bool	createFromSource(const char *inFileName, const SourceImage &inSource,
+						int inTileWidth, int inTileHeight, bool inThrowsEx)
+		{
+			if (isValidFormat(inSource.format) == false ||
+				isValidTileSize(inTileWidth) == false || isValidTileSize(inTileHeight) == false ||
+				inSource.width <= 0 || inSource.height <= 0)
+				return error(inThrowsEx, ViwException::PARAM_ERROR,
+						"Invalid format or tile size (packed formats and odd tile sizes are not supported)", 0);
+
+			// Lay out the header, the index and the tiles
+			PyramidFile	builder(false);
+			FileHeader	header;
+			memset(&header, 0, sizeof(header));
+			header.version = PYRAMID_VERSION;
+			header.format = inSource.format;
+			header.width = inSource.width;
+			header.height = inSource.height;
+			header.elementSize = sizeof(ImageBufferType);
+			header.tileWidth = inTileWidth;
+			header.tileHeight = inTileHeight;
+			header.levelNum = TileSource<ImageBufferType>::obtainLevelNum(
+								inSource.width, inSource.height, inTileWidth, inTileHeight);
+			header.indexOffset = sizeof(FileHeader);
+			builder.mHeader = &header;
+
+			std::vector<TileEntry>	index;
+			builder.mLevelTileStart.resize((size_t )header.levelNum);
+			for (int level = 0; level < header.levelNum; level++)
+			{
+				builder.mLevelTileStart[level] = (int )index.size();
+				index.resize(index.size() + (size_t )builder.getTileColumnNum(level) * builder.getTileRowNum(level));
+			}
+			header.tileNum = (long long )index.size();
+			builder.mIndex = &index[0];
+
+			size_t	offset = alignSize(sizeof(FileHeader) + sizeof(TileEntry) * index.size(), DATA_ALIGNMENT);
+			for (int level = 0; level < header.levelNum; level++)
+				for (int y = 0; y < builder.getTileRowNum(level); y++)
+					for (int x = 0; x < builder.getTileColumnNum(level); x++)
+					{
+						TileEntry	*entry = builder.getTileEntry(level, x, y);
+						entry->offset = (long long )offset;
+						entry->size = (long long )builder.obtainTileByteSize(level, x, y);
+						offset = alignSize(offset + (size_t )entry->size, TILE_ALIGNMENT);
+					}
+			header.totalSize = (long long )offset;
+
+			// Map the file and write the levels in place
+			int	errorCode;
+			if (mapFile(inFileName, offset, &builder.mMappedPtr, &builder.mMappedSize, &errorCode) == false)
+			{
+				builder.mHeader = NULL;
+				builder.mIndex = NULL;
+				return error(inThrowsEx, ViwException::OS_ERROR, "Can't create the pyramid file", errorCode);
+			}
+			memcpy(builder.mMappedPtr, &header, sizeof(FileHeader));
+			memcpy((unsigned char *)builder.mMappedPtr + header.indexOffset, &index[0], sizeof(TileEntry) * index.size());
+			builder.mHeader = (FileHeader *)builder.mMappedPtr;
+			builder.mIndex = (TileEntry *)((unsigned char *)builder.mMappedPtr + header.indexOffset);
+
+			int	columnNum = builder.getTileColumnNum(0);
+			utils::ThreadPool::parallelFor("PyramidCopy", 0, columnNum * builder.getTileRowNum(0), 1,
+				[&](int inStart, int inEnd)
+			{
+				for (int i = inStart; i < inEnd; i++)
+					builder.copyTile(inSource, i % columnNum, i / columnNum);
+			});
+			for (int level = 1; level < header.levelNum; level++)
+			{
+				int	levelColumnNum = builder.getTileColumnNum(level);
+				utils::ThreadPool::parallelFor("PyramidReduce", 0, levelColumnNum * builder.getTileRowNum(level), 1,
+					[&](int inStart, int inEnd)
+				{
+					for (int i = inStart; i < inEnd; i++)
+						builder.reduceTile(level, i % levelColumnNum, i / levelColumnNum);
+				});
+			}
+
+			// The data has to be on the disk before the magic marks the file valid
+			bool	result = flushFile(builder.mMappedPtr, builder.mMappedSize, &errorCode);
+			if (result)
+			{
+				builder.mHeader->magic = PYRAMID_MAGIC;
+				result = flushFile(builder.mMappedPtr, sizeof(FileHeader), &errorCode);
+			}
+			builder.close();
+			if (result == false)
+			{
+				remove(inFileName);
+				return error(inThrowsEx, ViwException::OS_ERROR, "Can't write the pyramid file", errorCode);
+			}
+			return true;
+		}
+		// ---------------------------------------------------------------------
+		// obtainBitmapSource
+		// ---------------------------------------------------------------------
+		static bool	obtainBitmapSource(const void *inBitmapPtr, size_t inBitmapSize, SourceImage *outSource)
+		{
+			if (inBitmapSize < sizeof(BITMAPFILEHEADER) + sizeof(BITMAPINFOHEADER))
+				return false;
+
+			BITMAPFILEHEADER	fileHeader;
+			BITMAPINFOHEADER	infoHeader;
+			memcpy(&fileHeader, inBitmapPtr, sizeof(BITMAPFILEHEADER));
+			memcpy(&infoHeader, (const unsigned char *)inBitmapPtr + sizeof(BITMAPFILEHEADER), sizeof(BITMAPINFOHEADER));
+			if (fileHeader.bfOffBits < sizeof(BITMAPFILEHEADER) + sizeof(BITMAPINFOHEADER))
+				return false;	// the pixels would overlap the headers
+			if (fileHeader.bfType != 0x4d42 || infoHeader.biCompression != 0 ||
+				infoHeader.biWidth <= 0 || infoHeader.biHeight == 0)
+				return false;
+
+			switch (infoHeader.biBitCount)
+			{
+			case 8:
+				outSource->format = ImageBufferBase::BUFFER_FORMAT_MONO;
+				break;
+			case 24:
+				outSource->format = ImageBufferBase::BUFFER_FORMAT_BGR;
+				break;
+			case 32:
+				outSource->format = ImageBufferBase::BUFFER_FORMAT_BGRA;
+				break;
+			default:
+				return false;
+			}
+			outSource->width = infoHeader.biWidth;
+			outSource->height = Bitmap::getAbsBitmapHeight(&infoHeader);
+			outSource->isBottomUp = (infoHeader.biHeight > 0);
+			outSource->lineByteSize = Bitmap::calBitmapLineOffset(&infoHeader);
+			outSource->ptr = (const unsigned char *)inBitmapPtr + fileHeader.bfOffBits;
+			return (fileHeader.bfOffBits + outSource->lineByteSize * outSource->height <= inBitmapSize);
+		}
+		// ---------------------------------------------------------------------
+		// mapFile
+		// ---------------------------------------------------------------------
+		//	Maps an existing file read-only (inCreateSize == 0) or creates a
+		//	writable file of inCreateSize bytes
+		static bool	mapFile(const char *inFileName, size_t inCreateSize,
+						void **outPtr, size_t *outSize, int *outErrorCode)
+		{
+			bool	isCreate = (inCreateSize != 0);
+		#ifdef _WIN32
+			HANDLE	fileHandle = CreateFileA(inFileName,
+								isCreate ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ, FILE_SHARE_READ,
+								NULL, isCreate ? CREATE_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+			if (fileHandle == INVALID_HANDLE_VALUE)
+			{
+				*outErrorCode = (int )GetLastError();
+				return false;
+			}
+			size_t	size = inCreateSize;
+			if (isCreate == false)
+			{
+				LARGE_INTEGER	fileSize;
+				if (GetFileSizeEx(fileHandle, &fileSize) == 0 || fileSize.QuadPart == 0)
+				{
+					*outErrorCode = (int )GetLastError();
+					CloseHandle(fileHandle);
+					return false;
+				}
+				size = (size_t )fileSize.QuadPart;
+			}
+			// The view keeps the file and the mapping open after the handles are closed
+			HANDLE	mappingHandle = CreateFileMappingA(fileHandle, NULL,
+								isCreate ? PAGE_READWRITE : PAGE_READONLY,
+								(DWORD )((unsigned long long )size >> 32), (DWORD )size, NULL);
+			void	*ptr = NULL;
+			if (mappingHandle != NULL)
+				ptr = MapViewOfFile(mappingHandle, isCreate ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, size);
+			*outErrorCode = (int )GetLastError();
+			if (mappingHandle != NULL)
+				CloseHandle(mappingHandle);
+			CloseHandle(fileHandle);
+			if (ptr == NULL)
+			{
+				if (isCreate)
+					DeleteFileA(inFileName);
+				return false;
+			}
+		#else
+			int	fd = isCreate ? ::open(inFileName, O_RDWR | O_CREAT | O_TRUNC, 0644) : ::open(inFileName, O_RDONLY);
+			if (fd < 0)
+			{
+				*outErrorCode = errno;
+				return false;
+			}
+			size_t	size = inCreateSize;
+			struct stat	st;
+			if (isCreate)
+			{
+				if (ftruncate(fd, (off_t )size) != 0)
+					size = 0;
+			}
+			else if (fstat(fd, &st) == 0)
+				size = (size_t )st.st_size;
+			void	*ptr = (size != 0) ?
+						mmap(NULL, size, isCreate ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, fd, 0) :
+						MAP_FAILED;
+			*outErrorCode = (size != 0) ? errno : EINVAL;
+			::close(fd);
+			if (ptr == MAP_FAILED)
+			{
+				if (isCreate)
+					unlink(inFileName);
+				return false;
+			}
+		#endif
+			*outPtr = ptr;
+			*outSize = size;
+			*outErrorCode = 0;
+			return true;
+		}
+		// ---------------------------------------------------------------------
+		// unmapFile
+		// ---------------------------------------------------------------------
+		static void	unmapFile(void *inPtr, size_t inSize)
+		{
+		#ifdef _WIN32
+			UnmapViewOfFile(inPtr);
+		#else
+			munmap(inPtr, inSize);
+		#endif
+		}
+		// ---------------------------------------------------------------------
+		// flushFile
+		// ---------------------------------------------------------------------
+		static bool	flushFile(void *inPtr, size_t inSize, int *outErrorCode)
+		{
+		#ifdef _WIN32
+			if (FlushViewOfFile(inPtr, inSize) == 0)
+			{
+				*outErrorCode = (int )GetLastError();
+				return false;
+			}
+		#else
+			if (msync(inPtr, inSize, MS_SYNC) != 0)
+			{
+				*outErrorCode = errno;
+				return false;
+			}
+		#endif
+			return true;
+		}
+		// ---------------------------------------------------------------------
+		// obtainModifiedTime
+		// ---------------------------------------------------------------------
+		static bool	obtainModifiedTime(const char *inFileName, long long *outTime)
+		{
+		#ifdef _WIN32
+			struct _stat64	st;
+			if (_stat64(inFileName, &st) != 0)
+				return false;
+		#else
+			struct stat	st;
+			if (stat(inFileName, &st) != 0)
+				return false;
+		#endif
+			*outTime = (long long )st.st_mtime;
+			return true;
+		}
+		// ---------------------------------------------------------------------
+		// obtainSourcePos
+		// ---------------------------------------------------------------------
+		//	Position of sample inIndex (0 or 1) of inPos in the previous level.
+		//	Bayer levels are subsampled (decimated), not averaged: both samples
+		//	are the same pixel, taken from every other 2x2 cell, so the
+		//	average of reduceTile() passes it through unchanged.
+		static int	obtainSourcePos(int inPos, int inIndex, int inSrcSize, bool inIsBayer)
+		{
+			if (inIsBayer)
+				return inPos * 2 - (inPos & 1);
+
+			int	pos = inPos * 2 + inIndex;
+			return (pos < inSrcSize) ? pos : inSrcSize - 1;
+		}
+		// ---------------------------------------------------------------------
+		// obtainTileExtent
+		// ---------------------------------------------------------------------
+		static int	obtainTileExtent(int inTileIndex, int inTileSize, int inLevelSize)
+		{
+			int	extent = inLevelSize - inTileIndex * inTileSize;
+			return (extent < inTileSize) ? extent : inTileSize;
+		}
+		// ---------------------------------------------------------------------
+		// average4
+		// ---------------------------------------------------------------------
+		static ImageBufferType	average4(ImageBufferType inA, ImageBufferType inB,
+									ImageBufferType inC, ImageBufferType inD)
+		{
+			if (std::numeric_limits<ImageBufferType>::is_integer)
+				return (ImageBufferType )(((long long )inA + inB + inC + inD + 2) / 4);
+			return (ImageBufferType )(((double )inA + inB + inC + inD) * 0.25);
+		}
+		// ---------------------------------------------------------------------
+		// isValidFormat
+		// ---------------------------------------------------------------------
+		static bool	isValidFormat(BufferFormat inFormat)
+		{
+			return (ImageBufferBase::obtainOnePixelCount(inFormat) != 0 &&
+					ImageBufferBase::isPackedFormat(inFormat) == false);
+		}
+		// ---------------------------------------------------------------------
+		// isValidTileSize
+		// ---------------------------------------------------------------------
+		static bool	isValidTileSize(long long inSize)
+		{
+			return (inSize >= 2 && inSize <= 65536 && inSize % 2 == 0);
+		}
+		// ---------------------------------------------------------------------
+		// alignSize
+		// ---------------------------------------------------------------------
+		static size_t	alignSize(size_t inSize, size_t inAlignment)
+		{
+			return (inSize + inAlignment - 1) / inAlignment * inAlignment;
+		}
+		// ---------------------------------------------------------------------
+		// error
+		// ---------------------------------------------------------------------
+		static bool	error(bool inThrowsEx, int inCode, const char *inDescription, int inOSErrorCode)
+		{
+			if (inThrowsEx == false)
+				return false;
+			else
+				throw ViwException(inCode, inDescription, VIW_EXCEPTION_LOCATION_MACRO, inOSErrorCode);
+		}
+
+	private:
+		PyramidFile(const PyramidFile &);
+		PyramidFile	&operator=(const PyramidFile &);
+	};
+ };
+};
+
+#endif	// #ifdef VIW_MODEL_PYRAMIDFILE_H
@@ -0,0 +1,329 @@
+// =============================================================================
+//  SnapshotRing.hpp
+//
+//  Written in 2014 by Dairoku Sekiguchi (sekiguchi at acm dot org)
+//
+//  To the extent possible under law, the author(s) have dedicated all copyright
+//  and related and neighboring rights to this software to the public domain worldwide.
+//  This software is distributed without any warranty.
+//
+//  You should have received a copy of the CC0 Public Domain Dedication along with
+//  this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+// =============================================================================
+/*!
+	\file		viw/model/SnapshotRing.h
+	\author		Dairoku Sekiguchi
+	\version	1.0.0
+	\date		2026/10/19
+	\brief		Header file for viw library types
+
+	This file defines the snapshot ring of live frames for viw library
+*/
+
+#ifndef VIW_MODEL_SNAPSHOTRING_H
+#define VIW_MODEL_SNAPSHOTRING_H
+
+// Includes --------------------------------------------------------------------
+#include <string.h>
+#include <vector>
+#include <algorithm>
+#include <mutex>
+#include "viw/Exception.hpp"
+#include "viw/model/ImageBuffer.hpp"
+
+
+// Namespace -------------------------------------------------------------------
+namespace viw
+{
+ namespace model
+ {
+	// -------------------------------------------------------------------------
+	// SnapshotRing class
+	// -------------------------------------------------------------------------
+	//	Keeps the last frames of a live stream so they can be looked at
+	//	after freeze(). The number of frames is the memory budget divided by
+	//	the frame size (at least MIN_FRAME_NUM).
+	//
+	//	The producer fills the write frame in place and commits it:
+	//
+	//		unsigned char	*ptr = ring.beginFrame(width, height, format);
+	//		grabber.retrieve(ptr);
+	//		Frame	*frame = ring.commitFrame();
+	//
+	//	A commit swaps the write frame with the oldest frame of the ring,
+	//	so no pixel is copied. pushFrame() copies a frame from a buffer the
+	//	producer keeps. The frame buffers are allocated as the ring fills
+	//	for the first time and are reused after that.
+	//
+	//	While the ring is frozen, commits leave it untouched and count the
+	//	frame as dropped. The producer keeps writing into the same write
+	//	frame, so it never waits and never touches the frozen frames, which
+	//	the viewer reads without locking through getFrame().
+	//
+	//	beginFrame(), commitFrame() and pushFrame() are called by a single
+	//	producer thread, the other functions by the viewer thread.
+	template <typename ImageBufferType> class	SnapshotRing
+	{
+	public:
+		// Typedefs ------------------------------------------------------------
+		typedef ImageBuffer<ImageBufferType>	Frame;
+		typedef typename Frame::BufferFormat	BufferFormat;
+
+		// Constatns -----------------------------------------------------------
+		const static int	MIN_FRAME_NUM			= 2;
+		const static size_t	DEFAULT_MEMORY_BUDGET	= 256 * 1024 * 1024;
+
+		// Constructors and Destructor -----------------------------------------
+		// ---------------------------------------------------------------------
+		// SnapshotRing
+		// ---------------------------------------------------------------------
+		SnapshotRing(bool inThrowsEx = false)
+		{
+			mThrowsEx = inThrowsEx;
+			mMemoryBudget = DEFAULT_MEMORY_BUDGET;
+			mIsResizeNeeded = true;
+			mWriteFrame = new Frame(inThrowsEx);
+			mFrameByteSize = 0;
+			mNewestPos = 0;
+			mFrameNum = 0;
+			mFrameCount = 0;
+			mDroppedFrameCount = 0;
+			mIsFrozen = false;
+		}
+		// ---------------------------------------------------------------------
+		// ~SnapshotRing
+		// ---------------------------------------------------------------------
+		virtual ~SnapshotRing()
+		{
+			delete mWriteFrame;
+			for (size_t i = 0; i < mFrames.size(); i++)
+				delete mFrames[i];
+		}
+
+		// Member functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// setMemoryBudget
+		// ---------------------------------------------------------------------
+		//	Applied at the next commit that is not frozen, the kept frames
+		//	are discarded then
+		void	setMemoryBudget(size_t inByteSize)
+		{
+			std::lock_guard<std::mutex>	lock(mMutex);
+			mMemoryBudget = inByteSize;
+			mIsResizeNeeded = true;
+		}
+		// ---------------------------------------------------------------------
+		// getMemoryBudget
+		// ---------------------------------------------------------------------
+		size_t	getMemoryBudget()
+		{
+			std::lock_guard<std::mutex>	lock(mMutex);
+			return mMemoryBudget;
+		}
+		// ---------------------------------------------------------------------
+		// getCapacity
+		// ---------------------------------------------------------------------
+		//	Number of frames the ring keeps for the current frame size
+		int	getCapacity()
+		{
+			std::lock_guard<std::mutex>	lock(mMutex);
+			return (int )mFrames.size();
+		}
+		// ---------------------------------------------------------------------
+		// beginFrame
+		// ---------------------------------------------------------------------
+		//	The buffer to write the next frame into, NULL if it can't be
+		//	allocated. Producer thread only.
+		ImageBufferType	*beginFrame(int inWidth, int inHeight, BufferFormat inFormat, bool inIsBottomUp = false)
+		{
+			if (mWriteFrame->allocateImageBuffer(inWidth, inHeight, inFormat, inIsBottomUp) == false)
+				return NULL;
+			return mWriteFrame->getImageBufferPtr();
+		}
+		// ---------------------------------------------------------------------
+		// commitFrame
+		// ---------------------------------------------------------------------
+		//	Publishes the frame written after beginFrame(). Returns the frame
+		//	(valid until getCapacity() - 1 more commits) or NULL when the
+		//	ring is frozen. Producer thread only.
+		Frame	*commitFrame()
+		{
+			std::vector<Frame *>	removedFrames;
+			Frame	*frame = NULL;
+			{
+				std::lock_guard<std::mutex>	lock(mMutex);
+				mFrameCount++;
+				if (mIsFrozen)
+				{
+					mDroppedFrameCount++;
+					return NULL;
+				}
+
+				if (mIsResizeNeeded || mWriteFrame->getImageBufferSize() != mFrameByteSize)
+					resizeRing(&removedFrames);
+
+				mNewestPos = (mNewestPos + 1) % (int )mFrames.size();
+				frame = mWriteFrame;
+				mWriteFrame = mFrames[mNewestPos];
+				mFrames[mNewestPos] = frame;
+				mFrameNumbers[mNewestPos] = mFrameCount;
+				if (mFrameNum < (int )mFrames.size())
+					mFrameNum++;
+			}
+
+			// The frames of the previous size are freed outside of the lock
+			for (size_t i = 0; i < removedFrames.size(); i++)
+				delete removedFrames[i];
+			return frame;
+		}
+		// ---------------------------------------------------------------------
+		// pushFrame
+		// ---------------------------------------------------------------------
+		//	Copies a frame from a buffer of the producer and commits it
+		Frame	*pushFrame(const ImageBufferType *inImagePtr, int inWidth, int inHeight,
+						BufferFormat inFormat, bool inIsBottomUp = false)
+		{
+			if (isFrozen())
+			{
+				std::lock_guard<std::mutex>	lock(mMutex);
+				mFrameCount++;
+				mDroppedFrameCount++;
+				return NULL;
+			}
+
+			ImageBufferType	*bufferPtr = beginFrame(inWidth, inHeight, inFormat, inIsBottomUp);
+			if (bufferPtr == NULL)
+				return NULL;
+			::memcpy(bufferPtr, inImagePtr, mWriteFrame->getImageBufferSize());
+			mWriteFrame->markAsImageModified();
+			return commitFrame();
+		}
+		// ---------------------------------------------------------------------
+		// freeze
+		// ---------------------------------------------------------------------
+		void	freeze()
+		{
+			std::lock_guard<std::mutex>	lock(mMutex);
+			mIsFrozen = true;
+		}
+		// ---------------------------------------------------------------------
+		// unfreeze
+		// ---------------------------------------------------------------------
+		void	unfreeze()
+		{
+			std::lock_guard<std::mutex>	lock(mMutex);
+			mIsFrozen = false;
+		}
+		// ---------------------------------------------------------------------
+		// isFrozen
+		// ---------------------------------------------------------------------
+		bool	isFrozen()
+		{
+			std::lock_guard<std::mutex>	lock(mMutex);
+			return mIsFrozen;
+		}
+		// ---------------------------------------------------------------------
+		// getFrameNum
+		// ---------------------------------------------------------------------
+		//	Number of kept frames
+		int	getFrameNum()
+		{
+			std::lock_guard<std::mutex>	lock(mMutex);
+			return mFrameNum;
+		}
+		// ---------------------------------------------------------------------
+		// getFrame
+		// ---------------------------------------------------------------------
+		//	The inBack th frame before the newest one (0 : newest). Only
+		//	while frozen, the frame stays valid until unfreeze().
+		Frame	*getFrame(int inBack)
+		{
+			std::lock_guard<std::mutex>	lock(mMutex);
+			if (mIsFrozen == false || inBack < 0 || inBack >= mFrameNum)
+				return NULL;
+			return mFrames[obtainPos(inBack)];
+		}
+		// ---------------------------------------------------------------------
+		// getFrameNumber
+		// ---------------------------------------------------------------------
+		//	Position of the inBack th frame in the stream (1 : first
+		//	committed frame), 0 if there is none
+		long long	getFrameNumber(int inBack)
+		{
+			std::lock_guard<std::mutex>	lock(mMutex);
+			if (inBack < 0 || inBack >= mFrameNum)
+				return 0;
+			return mFrameNumbers[obtainPos(inBack)];
+		}
+		// ---------------------------------------------------------------------
+		// getDroppedFrameNum
+		// ---------------------------------------------------------------------
+		//	Frames committed while frozen
+		long long	getDroppedFrameNum()
+		{
+			std::lock_guard<std::mutex>	lock(mMutex);
+			return mDroppedFrameCount;
+		}
+
+	protected:
+		// Member variables ----------------------------------------------------
+		bool				mThrowsEx;
+		std::mutex			mMutex;
+		size_t				mMemoryBudget;
+		bool				mIsResizeNeeded;
+		Frame				*mWriteFrame;		// owned by the producer
+		std::vector<Frame *>	mFrames;
+		std::vector<long long>	mFrameNumbers;
+		size_t				mFrameByteSize;
+		int					mNewestPos;
+		int					mFrameNum;
+		long long			mFrameCount;
+		long long			mDroppedFrameCount;
+		bool				mIsFrozen;
+
+		// Member functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// resizeRing
+		// ---------------------------------------------------------------------
+		//	Sizes the ring for the write frame and empties it. Called with
+		//	mMutex held, the frames to free are returned in outRemovedFrames.
+		void	resizeRing(std::vector<Frame *> *outRemovedFrames)
+		{
+			mFrameByteSize = mWriteFrame->getImageBufferSize();
+			size_t	frameNum = (mFrameByteSize != 0) ? mMemoryBudget / mFrameByteSize : 0;
+			if (frameNum < (size_t )MIN_FRAME_NUM)
+				frameNum = MIN_FRAME_NUM;
+
+			// The newest frame may still be shown, it is kept and reused last
+			if (mFrames.empty() == false)
+				std::swap(mFrames[0], mFrames[mNewestPos]);
+			while (mFrames.size() > frameNum)
+			{
+				outRemovedFrames->push_back(mFrames.back());
+				mFrames.pop_back();
+			}
+			while (mFrames.size() < frameNum)
+				mFrames.push_back(new Frame(mThrowsEx));
+			std::swap(mFrames[0], mFrames[frameNum - 1]);
+			mFrameNumbers.assign(frameNum, 0);
+			mNewestPos = (int )frameNum - 1;
+			mFrameNum = 0;
+			mIsResizeNeeded = false;
+		}
+		// ---------------------------------------------------------------------
+		// obtainPos
+		// ---------------------------------------------------------------------
+		int	obtainPos(int inBack)
+		{
+			int	frameNum = (int )mFrames.size();
+			return (mNewestPos - inBack % frameNum + frameNum) % frameNum;
+		}
+
+	private:
+		SnapshotRing(const SnapshotRing &);
+		SnapshotRing	&operator=(const SnapshotRing &);
+	};
+ };
+};
+
+#endif	// #ifdef VIW_MODEL_SNAPSHOTRING_H
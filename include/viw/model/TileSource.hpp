@@ -0,0 +1,129 @@
+// =============================================================================
+//  TileSource.hpp
+//
+//  Written in 2014 by Dairoku Sekiguchi (sekiguchi at acm dot org)
+//
+//  To the extent possible under law, the author(s) have dedicated all copyright
+//  and related and neighboring rights to this software to the public domain worldwide.
+//  This software is distributed without any warranty.
+//
+//  You should have received a copy of the CC0 Public Domain Dedication along with
+//  this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+// =============================================================================
+/*!
+	\file		viw/model/TileSource.h
+	\author		Dairoku Sekiguchi
+	\version	1.0.0
+	\date		2026/10/19
+	\brief		Header file for viw library types
+
+	This file defines the tiled image source interface for viw library
+*/
+
+#ifndef VIW_MODEL_TILESOURCE_H
+#define VIW_MODEL_TILESOURCE_H
+
+// Includes --------------------------------------------------------------------
+#include "viw/model/ImageBuffer.hpp"
+
+
+// Namespace -------------------------------------------------------------------
+namespace viw
+{
+ namespace model
+ {
+	// -------------------------------------------------------------------------
+	// TileSource class
+	// -------------------------------------------------------------------------
+	//	An image too large for one ImageBuffer, stored as a pyramid of
+	//	levels cut into fixed size tiles. Level 0 is the full resolution,
+	//	level n is 1/2^n of it (rounded up). The tiles of the right and
+	//	bottom edges may be smaller than getTileWidth() x getTileHeight().
+	template <typename ImageBufferType> class	TileSource
+	{
+	public:
+		// Typedefs ------------------------------------------------------------
+		typedef typename ImageBuffer<ImageBufferType>::BufferFormat	BufferFormat;
+
+		// Constructors and Destructor -----------------------------------------
+		// ---------------------------------------------------------------------
+		// ~TileSource
+		// ---------------------------------------------------------------------
+		virtual ~TileSource()
+		{
+		}
+
+		// Member functions ----------------------------------------------------
+		virtual int				getWidth() = 0;			// of level 0
+		virtual int				getHeight() = 0;
+		virtual int				getLevelNum() = 0;
+		virtual int				getTileWidth() = 0;
+		virtual int				getTileHeight() = 0;
+		virtual BufferFormat	getBufferFormat() = 0;
+		// ---------------------------------------------------------------------
+		// loadTile
+		// ---------------------------------------------------------------------
+		//	Fills outTile (e.g. copyIntoImageBuffer()) with the tile. Called
+		//	from several loader threads at once.
+		virtual bool	loadTile(int inLevel, int inTileX, int inTileY,
+							ImageBuffer<ImageBufferType> *outTile) = 0;
+		// ---------------------------------------------------------------------
+		// getLevelWidth
+		// ---------------------------------------------------------------------
+		int	getLevelWidth(int inLevel)
+		{
+			return obtainLevelSize(getWidth(), inLevel);
+		}
+		// ---------------------------------------------------------------------
+		// getLevelHeight
+		// ---------------------------------------------------------------------
+		int	getLevelHeight(int inLevel)
+		{
+			return obtainLevelSize(getHeight(), inLevel);
+		}
+		// ---------------------------------------------------------------------
+		// getTileColumnNum
+		// ---------------------------------------------------------------------
+		int	getTileColumnNum(int inLevel)
+		{
+			return (getLevelWidth(inLevel) + getTileWidth() - 1) / getTileWidth();
+		}
+		// ---------------------------------------------------------------------
+		// getTileRowNum
+		// ---------------------------------------------------------------------
+		int	getTileRowNum(int inLevel)
+		{
+			return (getLevelHeight(inLevel) + getTileHeight() - 1) / getTileHeight();
+		}
+
+		// Static Functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// obtainLevelSize
+		// ---------------------------------------------------------------------
+		static int	obtainLevelSize(int inSize, int inLevel)
+		{
+			long long	size = inSize;
+			for (int i = 0; i < inLevel; i++)
+				size = (size + 1) / 2;
+			return (int )size;
+		}
+		// ---------------------------------------------------------------------
+		// obtainLevelNum
+		// ---------------------------------------------------------------------
+		//	Levels until the whole image fits in one tile
+		static int	obtainLevelNum(int inWidth, int inHeight, int inTileWidth, int inTileHeight)
+		{
+			int	levelNum = 1;
+			while (inWidth > inTileWidth || inHeight > inTileHeight)
+			{
+				inWidth = (inWidth + 1) / 2;
+				inHeight = (inHeight + 1) / 2;
+				levelNum++;
+			}
+			return levelNum;
+		}
+	};
+ };
+};
+
+#endif	// #ifdef VIW_MODEL_TILESOURCE_H
@@ -0,0 +1,930 @@
+// =============================================================================
+//  TiledImage.hpp
+//
+//  Written in 2014 by Dairoku Sekiguchi (sekiguchi at acm dot org)
+//
+//  To the extent possible under law, the author(s) have dedicated all copyright
+//  and related and neighboring rights to this software to the public domain worldwide.
+//  This software is distributed without any warranty.
+//
+//  You should have received a copy of the CC0 Public Domain Dedication along with
+//  this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+// =============================================================================
+/*!
+	\file		viw/model/TiledImage.h
+	\author		Dairoku Sekiguchi
+	\version	1.0.0
+	\date		2026/10/19
+	\brief		Header file for viw library types
+
+	This file defines the tiled image view model for viw library
+*/
+
+#ifndef VIW_MODEL_TILEDIMAGE_H
+#define VIW_MODEL_TILEDIMAGE_H
+
+// Includes --------------------------------------------------------------------
+#include <math.h>
+#include <string.h>
+#include <vector>
+#include <list>
+#include <deque>
+#include <unordered_map>
+#include <algorithm>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include "viw/Exception.hpp"
+#include "viw/model/DisplayBuffer.hpp"
+#include "viw/model/TileSource.hpp"
+#include "viw/utils/Trace.hpp"
+
+
+// Namespace -------------------------------------------------------------------
+namespace viw
+{
+ namespace model
+ {
+	// -------------------------------------------------------------------------
+	// TiledImage class
+	// -------------------------------------------------------------------------
+	//	Shows a TileSource through a viewport. renderView() draws the tiles
+	//	of the pyramid level matching the view scale from an LRU cache and
+	//	queues the missing ones for the loader threads; until a tile
+	//	arrives the nearest coarser cached tile is stretched over its area,
+	//	so the call never waits for I/O. Tiles are mapped to display pixels
+	//	by the loader threads as well. The queue only holds the tiles of
+	//	the last view, panning away drops the requests that were not
+	//	started yet.
+	//
+	//	The cache stays within the memory budget by evicting the least
+	//	recently drawn tiles, except the ones of the current view. The
+	//	tile loaded callback (called on a loader thread) is the place to
+	//	invalidate the part of the window the tile covers
+	//	(obtainTileViewRect()), renderViewRect() then draws only that part.
+	template <typename ImageBufferType> class	TiledImage
+	{
+	public:
+		// Typedefs ------------------------------------------------------------
+		typedef TileSource<ImageBufferType>					Source;
+		typedef DisplayBuffer<ImageBufferType>				TileBuffer;
+		typedef typename TileBuffer::DisplayMapMode			DisplayMapMode;
+
+		// Constatns -----------------------------------------------------------
+		const static size_t	DEFAULT_CACHE_BUDGET		= 512 * 1024 * 1024;
+		const static int	DEFAULT_LOADER_THREAD_NUM	= 2;
+
+		// Structs -------------------------------------------------------------
+		struct	CacheStats
+		{
+			int			tileNum;		// cached, loading and queued
+			int			queuedNum;
+			size_t		cacheSize;		// bytes
+			size_t		cacheBudget;
+			long long	hitCount;		// tiles of the view level found in the cache
+			long long	missCount;
+			long long	loadCount;
+			long long	errorCount;
+			long long	evictCount;
+		};
+		struct	Rect
+		{
+			int		x0, y0, x1, y1;			// view pixels, [x0, x1) x [y0, y1)
+		};
+
+		// Constructors and Destructor -----------------------------------------
+		// ---------------------------------------------------------------------
+		// TiledImage
+		// ---------------------------------------------------------------------
+		//	inSource must outlive the object
+		TiledImage(Source *inSource, bool inThrowsEx = false)
+		{
+			mThrowsEx = inThrowsEx;
+			mSource = inSource;
+			mCacheBudget = DEFAULT_CACHE_BUDGET;
+			mLoaderThreadNum = DEFAULT_LOADER_THREAD_NUM;
+			mIsStopRequested = false;
+			mTileLoadedFunc = NULL;
+			mTileLoadedFuncData = NULL;
+			mCallingNum = 0;
+			mRenderCount = 0;
+			mCacheSize = 0;
+			mHitCount = 0;
+			mMissCount = 0;
+			mLoadCount = 0;
+			mErrorCount = 0;
+			mEvictCount = 0;
+
+			mSettings.mapMode = TileBuffer::DISPLAY_MAP_NOT_SPECIFIED;
+			mSettings.isDisplayRangeSpecified = false;
+			mSettings.displayMin = 0;
+			mSettings.displayMax = 0;
+			mSettings.colorMapIndex = utils::ColorMap::CMIndex_GrayScale;
+			mSettingsGeneration = 0;
+			setBackgroundColor(32, 32, 32);
+		}
+		// ---------------------------------------------------------------------
+		// ~TiledImage
+		// ---------------------------------------------------------------------
+		virtual ~TiledImage()
+		{
+			stopLoaders();
+			for (typename TileMap::iterator it = mTiles.begin(); it != mTiles.end(); ++it)
+				deleteTile(it->second);
+		}
+
+		// Member functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// getSource
+		// ---------------------------------------------------------------------
+		Source	*getSource()
+		{
+			return mSource;
+		}
+		// ---------------------------------------------------------------------
+		// getWidth
+		// ---------------------------------------------------------------------
+		int	getWidth()
+		{
+			return (mSource != NULL) ? mSource->getWidth() : 0;
+		}
+		// ---------------------------------------------------------------------
+		// getHeight
+		// ---------------------------------------------------------------------
+		int	getHeight()
+		{
+			return (mSource != NULL) ? mSource->getHeight() : 0;
+		}
+		// ---------------------------------------------------------------------
+		// setCacheBudget
+		// ---------------------------------------------------------------------
+		//	Bytes of the cached tiles (source + display pixels)
+		void	setCacheBudget(size_t inBytes)
+		{
+			std::lock_guard<std::mutex>	lock(mMutex);
+			mCacheBudget = inBytes;
+			evictTiles();
+		}
+		// ---------------------------------------------------------------------
+		// getCacheBudget
+		// ---------------------------------------------------------------------
+		size_t	getCacheBudget()
+		{
+			std::lock_guard<std::mutex>	lock(mMutex);
+			return mCacheBudget;
+		}
+		// ---------------------------------------------------------------------
+		// setLoaderThreadNum
+		// ---------------------------------------------------------------------
+		//	Waits for the tiles being loaded, the threads start again with the
+		//	next renderView() call
+		bool	setLoaderThreadNum(int inThreadNum)
+		{
+			if (inThreadNum <= 0)
+			{
+				if (mThrowsEx == false)
+					return false;
+				else
+					throw ViwException(ViwException::PARAM_ERROR,
+						"inThreadNum <= 0", VIW_EXCEPTION_LOCATION_MACRO, 0);
+			}
+
+			stopLoaders();
+			std::lock_guard<std::mutex>	lock(mMutex);
+			mLoaderThreadNum = inThreadNum;
+			return true;
+		}
+		// ---------------------------------------------------------------------
+		// getLoaderThreadNum
+		// ---------------------------------------------------------------------
+		int	getLoaderThreadNum()
+		{
+			std::lock_guard<std::mutex>	lock(mMutex);
+			return mLoaderThreadNum;
+		}
+		// ---------------------------------------------------------------------
+		// setTileLoadedFunc
+		// ---------------------------------------------------------------------
+		//	Called on a loader thread after every tile with the level and
+		//	the position of the tile. Returns after the calls of the
+		//	previous function have finished, so it must not be called from
+		//	the function itself.
+		void	setTileLoadedFunc(void (*inFunc)(int, int, int, void *), void *inFuncData)
+		{
+			std::unique_lock<std::mutex>	lock(mMutex);
+			mTileLoadedFunc = inFunc;
+			mTileLoadedFuncData = inFuncData;
+			while (mCallingNum > 0)
+				mCondition.wait(lock);
+		}
+		// ---------------------------------------------------------------------
+		// setBackgroundColor
+		// ---------------------------------------------------------------------
+		void	setBackgroundColor(unsigned char inR, unsigned char inG, unsigned char inB)
+		{
+			mBackgroundColor[0] = inB;
+			mBackgroundColor[1] = inG;
+			mBackgroundColor[2] = inR;
+			mBackgroundColor[3] = 255;
+		}
+		// ---------------------------------------------------------------------
+		// setDisplayMapMode
+		// ---------------------------------------------------------------------
+		//	The display settings apply to every tile, the cached ones are
+		//	mapped again when they are drawn next
+		void	setDisplayMapMode(DisplayMapMode inMapMode)
+		{
+			std::lock_guard<std::mutex>	lock(mMutex);
+			mSettings.mapMode = inMapMode;
+			mSettingsGeneration++;
+		}
+		// ---------------------------------------------------------------------
+		// setDisplayRange
+		// ---------------------------------------------------------------------
+		bool	setDisplayRange(double inMin, double inMax)
+		{
+			if (inMin >= inMax)
+			{
+				if (mThrowsEx == false)
+					return false;
+				else
+					throw ViwException(ViwException::PARAM_ERROR,
+						"inMin >= inMax", VIW_EXCEPTION_LOCATION_MACRO, 0);
+			}
+
+			std::lock_guard<std::mutex>	lock(mMutex);
+			mSettings.isDisplayRangeSpecified = true;
+			mSettings.displayMin = inMin;
+			mSettings.displayMax = inMax;
+			mSettingsGeneration++;
+			return true;
+		}
+		// ---------------------------------------------------------------------
+		// setColorMapIndex
+		// ---------------------------------------------------------------------
+		void	setColorMapIndex(utils::ColorMap::ColorMapIndex inIndex)
+		{
+			std::lock_guard<std::mutex>	lock(mMutex);
+			mSettings.colorMapIndex = inIndex;
+			mSettingsGeneration++;
+		}
+		// ---------------------------------------------------------------------
+		// obtainLevel
+		// ---------------------------------------------------------------------
+		//	The coarsest level that still has a source pixel per view pixel
+		int	obtainLevel(double inScale)
+		{
+			if (mSource == NULL)
+				return 0;
+
+			int	level = 0;
+			int	levelNum = mSource->getLevelNum();
+			while (level < levelNum - 1 && ldexp(inScale, level + 1) <= 1.0)
+				level++;
+			return level;
+		}
+		// ---------------------------------------------------------------------
+		// renderView
+		// ---------------------------------------------------------------------
+		//	Draws the view whose top left corner is (inX, inY) in level 0
+		//	pixels and that has inScale view pixels per level 0 pixel into
+		//	outBuffer (BGRA, inLineOffset bytes per line).
+		//	Returns the number of tiles still missing in the view (0 : the
+		//	view is complete) or -1 on error.
+		int	renderView(double inX, double inY, double inScale, int inWidth, int inHeight,
+					unsigned char *outBuffer, size_t inLineOffset)
+		{
+			Rect	clip;
+			clip.x0 = 0;
+			clip.y0 = 0;
+			clip.x1 = inWidth;
+			clip.y1 = inHeight;
+			return renderViewRect(inX, inY, inScale, inWidth, inHeight, outBuffer, inLineOffset, clip);
+		}
+		// ---------------------------------------------------------------------
+		// renderViewRect
+		// ---------------------------------------------------------------------
+		//	renderView() that only draws the view pixels in inClip, the rest
+		//	of outBuffer is left as it is. The tiles are requested and
+		//	counted for the whole view.
+		int	renderViewRect(double inX, double inY, double inScale, int inWidth, int inHeight,
+					unsigned char *outBuffer, size_t inLineOffset, const Rect &inClip)
+		{
+			VIW_TRACE_SCOPE("renderView", this);
+
+			if (mSource == NULL || outBuffer == NULL || inWidth <= 0 || inHeight <= 0 ||
+				inScale <= 0 || inLineOffset < (size_t )inWidth * 4)
+			{
+				if (mThrowsEx == false)
+					return -1;
+				else
+					throw ViwException(ViwException::PARAM_ERROR,
+						"Invalid view", VIW_EXCEPTION_LOCATION_MACRO, 0);
+			}
+
+			View	view;
+			view.x = inX;
+			view.y = inY;
+			view.scale = inScale;
+			view.width = inWidth;
+			view.height = inHeight;
+			view.buffer = outBuffer;
+			view.lineOffset = inLineOffset;
+			Rect	clip;
+			clip.x0 = (std::max)(inClip.x0, 0);
+			clip.y0 = (std::max)(inClip.y0, 0);
+			clip.x1 = (std::min)(inClip.x1, inWidth);
+			clip.y1 = (std::min)(inClip.y1, inHeight);
+			fillView(view, clip);
+
+			std::unique_lock<std::mutex>	lock(mMutex);
+			startLoaders();
+			mRenderCount++;
+			dropQueuedTiles();
+
+			int	level = obtainLevel(inScale);
+			int	coarsestLevel = mSource->getLevelNum() - 1;
+
+			// the coarsest level first, it backs up everything else
+			std::vector<TilePos>	tiles;
+			if (coarsestLevel != level)
+			{
+				obtainViewTiles(coarsestLevel, view, &tiles);
+				for (size_t i = 0; i < tiles.size(); i++)
+					requestTile(coarsestLevel, tiles[i].x, tiles[i].y);
+			}
+
+			int	missingNum = 0;
+			obtainViewTiles(level, view, &tiles);
+			for (size_t i = 0; i < tiles.size(); i++)
+			{
+				Tile	*tile = requestTile(level, tiles[i].x, tiles[i].y);
+				Rect	rect = intersectRect(obtainViewRect(level, tiles[i].x, tiles[i].y, view), clip);
+				if (tile->state == TILE_READY)
+				{
+					mHitCount++;
+					drawTile(tile, view, rect);
+					continue;
+				}
+				if (tile->state != TILE_FAILED)
+				{
+					mMissCount++;
+					missingNum++;
+				}
+
+				for (int l = level + 1; l <= coarsestLevel; l++)
+				{
+					Tile	*coarseTile = findTile(l, tiles[i].x >> (l - level), tiles[i].y >> (l - level));
+					if (coarseTile != NULL && coarseTile->state == TILE_READY)
+					{
+						touchTile(coarseTile);
+						drawTile(coarseTile, view, rect);
+						break;
+					}
+				}
+			}
+
+			if (mQueue.empty() == false)
+				mCondition.notify_all();
+			return missingNum;
+		}
+		// ---------------------------------------------------------------------
+		// obtainTileViewRect
+		// ---------------------------------------------------------------------
+		//	The view pixels of a tile in the view of renderView() (false if
+		//	the tile is out of the view)
+		bool	obtainTileViewRect(int inLevel, int inTileX, int inTileY,
+					double inX, double inY, double inScale, int inWidth, int inHeight, Rect *outRect)
+		{
+			if (mSource == NULL || inLevel < 0 || inLevel >= mSource->getLevelNum() || inScale <= 0)
+				return false;
+
+			View	view;
+			view.x = inX;
+			view.y = inY;
+			view.scale = inScale;
+			view.width = inWidth;
+			view.height = inHeight;
+			view.buffer = NULL;
+			view.lineOffset = 0;
+			*outRect = obtainViewRect(inLevel, inTileX, inTileY, view);
+			return (outRect->x0 < outRect->x1 && outRect->y0 < outRect->y1);
+		}
+		// ---------------------------------------------------------------------
+		// getCacheStats
+		// ---------------------------------------------------------------------
+		void	getCacheStats(CacheStats *outStats)
+		{
+			std::lock_guard<std::mutex>	lock(mMutex);
+			outStats->tileNum = (int )mTiles.size();
+			outStats->queuedNum = (int )mQueue.size();
+			outStats->cacheSize = mCacheSize;
+			outStats->cacheBudget = mCacheBudget;
+			outStats->hitCount = mHitCount;
+			outStats->missCount = mMissCount;
+			outStats->loadCount = mLoadCount;
+			outStats->errorCount = mErrorCount;
+			outStats->evictCount = mEvictCount;
+		}
+		// ---------------------------------------------------------------------
+		// clearCache
+		// ---------------------------------------------------------------------
+		//	Drops every tile that is not being loaded (failed tiles are tried
+		//	again)
+		void	clearCache()
+		{
+			std::lock_guard<std::mutex>	lock(mMutex);
+			mQueue.clear();
+			mLruList.clear();
+			for (typename TileMap::iterator it = mTiles.begin(); it != mTiles.end(); )
+			{
+				if (it->second->state == TILE_LOADING)
+				{
+					++it;
+					continue;
+				}
+				deleteTile(it->second);
+				it = mTiles.erase(it);
+			}
+			mCacheSize = 0;
+		}
+
+	protected:
+		// Constatns -----------------------------------------------------------
+		enum TileState
+		{
+			TILE_QUEUED		= 0,
+			TILE_LOADING,
+			TILE_READY,
+			TILE_FAILED
+		};
+
+		// Structs -------------------------------------------------------------
+		struct	Tile
+		{
+			int				level;
+			int				tileX;
+			int				tileY;
+			TileState		state;
+			TileBuffer		*buffer;
+			size_t			size;
+			unsigned int	settingsGeneration;
+			unsigned int	renderCount;		// of the last view that used it
+			typename std::list<Tile *>::iterator	lruPos;		// READY and FAILED tiles
+		};
+		struct	TilePos
+		{
+			int		x;
+			int		y;
+			double	distance;				// from the view center
+		};
+		struct	View
+		{
+			double			x, y, scale;
+			int				width, height;
+			unsigned char	*buffer;
+			size_t			lineOffset;
+		};
+		struct	DisplaySettings
+		{
+			DisplayMapMode					mapMode;
+			bool							isDisplayRangeSpecified;
+			double							displayMin;
+			double							displayMax;
+			utils::ColorMap::ColorMapIndex	colorMapIndex;
+		};
+
+		// Typedefs ------------------------------------------------------------
+		typedef std::unordered_map<unsigned long long, Tile *>	TileMap;
+
+		// Member variables ----------------------------------------------------
+		bool						mThrowsEx;
+		Source						*mSource;
+		std::mutex					mMutex;
+		std::condition_variable		mCondition;
+		std::vector<std::thread>	mLoaders;
+		int							mLoaderThreadNum;
+		bool						mIsStopRequested;
+		void						(*mTileLoadedFunc)(int, int, int, void *);
+		void						*mTileLoadedFuncData;
+		int							mCallingNum;		// of mTileLoadedFunc
+
+		TileMap						mTiles;
+		std::deque<Tile *>			mQueue;
+		std::list<Tile *>			mLruList;			// most recent first
+		unsigned int				mRenderCount;
+		size_t						mCacheSize;
+		size_t						mCacheBudget;
+		long long					mHitCount;
+		long long					mMissCount;
+		long long					mLoadCount;
+		long long					mErrorCount;
+		long long					mEvictCount;
+
+		DisplaySettings				mSettings;
+		unsigned int				mSettingsGeneration;
+		unsigned char				mBackgroundColor[4];	// B, G, R, A
+
+		// Member functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// findTile
+		// ---------------------------------------------------------------------
+		Tile	*findTile(int inLevel, int inTileX, int inTileY)
+		{
+			typename TileMap::iterator	it = mTiles.find(obtainTileKey(inLevel, inTileX, inTileY));
+			if (it == mTiles.end())
+				return NULL;
+			return it->second;
+		}
+		// ---------------------------------------------------------------------
+		// requestTile
+		// ---------------------------------------------------------------------
+		//	Queues the tile unless it is known already
+		Tile	*requestTile(int inLevel, int inTileX, int inTileY)
+		{
+			Tile	*tile = findTile(inLevel, inTileX, inTileY);
+			if (tile == NULL)
+			{
+				tile = new Tile();
+				tile->level = inLevel;
+				tile->tileX = inTileX;
+				tile->tileY = inTileY;
+				tile->state = TILE_QUEUED;
+				tile->buffer = NULL;
+				tile->size = 0;
+				tile->settingsGeneration = 0;
+				mTiles[obtainTileKey(inLevel, inTileX, inTileY)] = tile;
+				mQueue.push_back(tile);
+			}
+			touchTile(tile);
+			return tile;
+		}
+		// ---------------------------------------------------------------------
+		// touchTile
+		// ---------------------------------------------------------------------
+		void	touchTile(Tile *inTile)
+		{
+			inTile->renderCount = mRenderCount;
+			if (inTile->state == TILE_READY || inTile->state == TILE_FAILED)
+				mLruList.splice(mLruList.begin(), mLruList, inTile->lruPos);
+		}
+		// ---------------------------------------------------------------------
+		// dropQueuedTiles
+		// ---------------------------------------------------------------------
+		//	The tiles not started yet are requested again if still needed
+		void	dropQueuedTiles()
+		{
+			for (size_t i = 0; i < mQueue.size(); i++)
+			{
+				Tile	*tile = mQueue[i];
+				mTiles.erase(obtainTileKey(tile->level, tile->tileX, tile->tileY));
+				deleteTile(tile);
+			}
+			mQueue.clear();
+		}
+		// ---------------------------------------------------------------------
+		// evictTiles
+		// ---------------------------------------------------------------------
+		void	evictTiles()
+		{
+			typename std::list<Tile *>::iterator	it = mLruList.end();
+			while (mCacheSize > mCacheBudget && it != mLruList.begin())
+			{
+				--it;
+				Tile	*tile = *it;
+				if (tile->renderCount == mRenderCount)	// in the current view
+					continue;
+
+				it = mLruList.erase(it);
+				mTiles.erase(obtainTileKey(tile->level, tile->tileX, tile->tileY));
+				mCacheSize -= tile->size;
+				deleteTile(tile);
+				mEvictCount++;
+			}
+		}
+		// ---------------------------------------------------------------------
+		// obtainViewTiles
+		// ---------------------------------------------------------------------
+		//	The tiles of inLevel in the view, the center ones first
+		void	obtainViewTiles(int inLevel, const View &inView, std::vector<TilePos> *outTiles)
+		{
+			outTiles->clear();
+
+			double	factor = ldexp(1.0, inLevel);
+			double	tileWidth = mSource->getTileWidth() * factor;		// in level 0 pixels
+			double	tileHeight = mSource->getTileHeight() * factor;
+			double	x0 = inView.x;
+			double	y0 = inView.y;
+			double	x1 = inView.x + inView.width / inView.scale;
+			double	y1 = inView.y + inView.height / inView.scale;
+
+			int	tx0 = (std::max)(0, (int )floor(x0 / tileWidth));
+			int	ty0 = (std::max)(0, (int )floor(y0 / tileHeight));
+			int	tx1 = (std::min)(mSource->getTileColumnNum(inLevel) - 1, (int )floor(x1 / tileWidth));
+			int	ty1 = (std::min)(mSource->getTileRowNum(inLevel) - 1, (int )floor(y1 / tileHeight));
+
+			double	cx = (x0 + x1) / 2 / tileWidth - 0.5;
+			double	cy = (y0 + y1) / 2 / tileHeight - 0.5;
+			for (int ty = ty0; ty <= ty1; ty++)
+			{
+				for (int tx = tx0; tx <= tx1; tx++)
+				{
+					TilePos	pos;
+					pos.x = tx;
+					pos.y = ty;
+					pos.distance = (tx - cx) * (tx - cx) + (ty - cy) * (ty - cy);
+					outTiles->push_back(pos);
+				}
+			}
+			std::sort(outTiles->begin(), outTiles->end(), compareTilePos);
+		}
+		// ---------------------------------------------------------------------
+		// obtainViewRect
+		// ---------------------------------------------------------------------
+		//	The view pixels whose centers fall on the tile
+		Rect	obtainViewRect(int inLevel, int inTileX, int inTileY, const View &inView)
+		{
+			double	factor = ldexp(1.0, inLevel);
+			int		tileWidth = mSource->getTileWidth();
+			int		tileHeight = mSource->getTileHeight();
+			double	x0 = (double )inTileX * tileWidth * factor;
+			double	y0 = (double )inTileY * tileHeight * factor;
+			double	x1 = (std::min)((double )(inTileX + 1) * tileWidth, (double )mSource->getLevelWidth(inLevel)) * factor;
+			double	y1 = (std::min)((double )(inTileY + 1) * tileHeight, (double )mSource->getLevelHeight(inLevel)) * factor;
+
+			Rect	rect;
+			rect.x0 = (std::max)(0, (int )ceil((x0 - inView.x) * inView.scale - 0.5));
+			rect.y0 = (std::max)(0, (int )ceil((y0 - inView.y) * inView.scale - 0.5));
+			rect.x1 = (std::min)(inView.width, (int )ceil((x1 - inView.x) * inView.scale - 0.5));
+			rect.y1 = (std::min)(inView.height, (int )ceil((y1 - inView.y) * inView.scale - 0.5));
+			return rect;
+		}
+		// ---------------------------------------------------------------------
+		// drawTile
+		// ---------------------------------------------------------------------
+		//	Nearest neighbour, clipped to inClip
+		void	drawTile(Tile *inTile, const View &inView, const Rect &inClip)
+		{
+			Rect	rect = intersectRect(obtainViewRect(inTile->level, inTile->tileX, inTile->tileY, inView), inClip);
+			if (rect.x0 >= rect.x1 || rect.y0 >= rect.y1)
+				return;
+
+			TileBuffer	*buffer = inTile->buffer;
+			if (inTile->settingsGeneration != mSettingsGeneration)
+			{
+				applySettings(buffer, mSettings);
+				inTile->settingsGeneration = mSettingsGeneration;
+			}
+			const unsigned char	*displayPtr = buffer->getDisplayBufferPtr();
+			if (displayPtr == NULL)
+				return;
+
+			double	factor = ldexp(1.0, inTile->level);
+			int		width = buffer->getWidth();
+			int		height = buffer->getHeight();
+			int		originX = inTile->tileX * mSource->getTileWidth();
+			int		originY = inTile->tileY * mSource->getTileHeight();
+			bool	isMono = (buffer->getDisplayFormat() == TileBuffer::BUFFER_FORMAT_MONO);
+			int		pixelSize = isMono ? 1 : ((buffer->getDisplayFormat() == TileBuffer::BUFFER_FORMAT_BGRA) ? 4 : 3);
+			const unsigned char	*palette = isMono ? buffer->getDisplayPalette() : NULL;
+			size_t	displayLineOffset = buffer->getDisplayLineOffset();
+
+			std::vector<int>	offsetX(rect.x1 - rect.x0);
+			for (int x = rect.x0; x < rect.x1; x++)
+			{
+				int	srcX = (int )floor((inView.x + (x + 0.5) / inView.scale) / factor) - originX;
+				srcX = (std::min)((std::max)(srcX, 0), width - 1);
+				offsetX[x - rect.x0] = srcX * pixelSize;
+			}
+
+			for (int y = rect.y0; y < rect.y1; y++)
+			{
+				int	srcY = (int )floor((inView.y + (y + 0.5) / inView.scale) / factor) - originY;
+				srcY = (std::min)((std::max)(srcY, 0), height - 1);
+				if (buffer->isBottomUp())
+					srcY = height - 1 - srcY;
+				const unsigned char	*srcLine = displayPtr + displayLineOffset * srcY;
+				unsigned char	*dstPtr = inView.buffer + inView.lineOffset * y + (size_t )rect.x0 * 4;
+
+				if (isMono)
+				{
+					for (int x = 0; x < rect.x1 - rect.x0; x++, dstPtr += 4)
+					{
+						const unsigned char	*color = palette + srcLine[offsetX[x]] * 3;		// R, G, B
+						dstPtr[0] = color[2];
+						dstPtr[1] = color[1];
+						dstPtr[2] = color[0];
+						dstPtr[3] = 255;
+					}
+				}
+				else
+				{
+					for (int x = 0; x < rect.x1 - rect.x0; x++, dstPtr += 4)
+					{
+						const unsigned char	*srcPtr = srcLine + offsetX[x];
+						dstPtr[0] = srcPtr[0];
+						dstPtr[1] = srcPtr[1];
+						dstPtr[2] = srcPtr[2];
+						dstPtr[3] = (pixelSize == 4) ? srcPtr[3] : 255;
+					}
+				}
+			}
+		}
+		// ---------------------------------------------------------------------
+		// fillView
+		// ---------------------------------------------------------------------
+		void	fillView(const View &inView, const Rect &inClip)
+		{
+			for (int y = inClip.y0; y < inClip.y1; y++)
+			{
+				unsigned char	*dstPtr = inView.buffer + inView.lineOffset * y + (size_t )inClip.x0 * 4;
+				for (int x = inClip.x0; x < inClip.x1; x++, dstPtr += 4)
+					memcpy(dstPtr, mBackgroundColor, 4);
+			}
+		}
+		// ---------------------------------------------------------------------
+		// startLoaders
+		// ---------------------------------------------------------------------
+		//	Called with mMutex held
+		void	startLoaders()
+		{
+			if (mLoaders.empty() == false)
+				return;
+
+			mIsStopRequested = false;
+			for (int i = 0; i < mLoaderThreadNum; i++)
+				mLoaders.push_back(std::thread(&TiledImage::loaderMain, this));
+		}
+		// ---------------------------------------------------------------------
+		// stopLoaders
+		// ---------------------------------------------------------------------
+		void	stopLoaders()
+		{
+			std::vector<std::thread>	loaders;
+			{
+				std::lock_guard<std::mutex>	lock(mMutex);
+				mIsStopRequested = true;
+				loaders.swap(mLoaders);
+			}
+			mCondition.notify_all();
+			for (size_t i = 0; i < loaders.size(); i++)
+				loaders[i].join();
+		}
+		// ---------------------------------------------------------------------
+		// loaderMain
+		// ---------------------------------------------------------------------
+		void	loaderMain()
+		{
+			std::unique_lock<std::mutex>	lock(mMutex);
+			while (true)
+			{
+				while (mIsStopRequested == false && mQueue.empty())
+					mCondition.wait(lock);
+				if (mIsStopRequested)
+					break;
+
+				Tile	*tile = mQueue.front();
+				mQueue.pop_front();
+				tile->state = TILE_LOADING;
+				DisplaySettings	settings = mSettings;
+				unsigned int	settingsGeneration = mSettingsGeneration;
+				lock.unlock();
+
+				TileBuffer	*buffer = loadTile(tile->level, tile->tileX, tile->tileY, settings);
+
+				lock.lock();
+				mLoadCount++;
+				if (buffer != NULL)
+				{
+					tile->state = TILE_READY;
+					tile->buffer = buffer;
+					tile->size = obtainTileSize(buffer);
+				}
+				else
+				{
+					tile->state = TILE_FAILED;
+					mErrorCount++;
+				}
+				tile->settingsGeneration = settingsGeneration;
+				tile->lruPos = mLruList.insert(mLruList.begin(), tile);
+				mCacheSize += tile->size;
+				evictTiles();
+
+				void	(*func)(int, int, int, void *) = mTileLoadedFunc;
+				void	*funcData = mTileLoadedFuncData;
+				if (func != NULL)
+				{
+					int	level = tile->level;
+					int	tileX = tile->tileX;
+					int	tileY = tile->tileY;
+					mCallingNum++;
+					lock.unlock();
+					func(level, tileX, tileY, funcData);
+					lock.lock();
+					if (--mCallingNum == 0)
+						mCondition.notify_all();
+				}
+			}
+		}
+		// ---------------------------------------------------------------------
+		// loadTile
+		// ---------------------------------------------------------------------
+		//	Loads and maps a tile without holding mMutex (NULL on failure)
+		TileBuffer	*loadTile(int inLevel, int inTileX, int inTileY, const DisplaySettings &inSettings)
+		{
+			VIW_TRACE_SCOPE("loadTile", this);
+
+			TileBuffer	*buffer = new TileBuffer(false);
+			bool	result;
+			try
+			{
+				result = mSource->loadTile(inLevel, inTileX, inTileY, buffer);
+			}
+			catch (...)
+			{
+				result = false;
+			}
+			if (result)
+			{
+				applySettings(buffer, inSettings);
+				buffer->setAsBufferUpdateNeeded();
+				result = (buffer->getDisplayBufferPtr() != NULL);
+			}
+			if (result == false)
+			{
+				delete buffer;
+				return NULL;
+			}
+			return buffer;
+		}
+
+		// Static Functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// intersectRect
+		// ---------------------------------------------------------------------
+		static Rect	intersectRect(const Rect &inRect1, const Rect &inRect2)
+		{
+			Rect	rect;
+			rect.x0 = (std::max)(inRect1.x0, inRect2.x0);
+			rect.y0 = (std::max)(inRect1.y0, inRect2.y0);
+			rect.x1 = (std::min)(inRect1.x1, inRect2.x1);
+			rect.y1 = (std::min)(inRect1.y1, inRect2.y1);
+			return rect;
+		}
+		// ---------------------------------------------------------------------
+		// applySettings
+		// ---------------------------------------------------------------------
+		static void	applySettings(TileBuffer *ioBuffer, const DisplaySettings &inSettings)
+		{
+			if (inSettings.mapMode != TileBuffer::DISPLAY_MAP_NOT_SPECIFIED)
+				ioBuffer->setDisplayMapMode(inSettings.mapMode);
+			if (inSettings.isDisplayRangeSpecified)
+				ioBuffer->setDisplayRange(inSettings.displayMin, inSettings.displayMax);
+			else
+				ioBuffer->resetDisplayRange();
+			ioBuffer->setColorMapIndex(inSettings.colorMapIndex);
+		}
+		// ---------------------------------------------------------------------
+		// obtainTileSize
+		// ---------------------------------------------------------------------
+		static size_t	obtainTileSize(TileBuffer *inBuffer)
+		{
+			size_t	size = inBuffer->getImageBufferSize();
+			if (inBuffer->getDisplayBufferPtr() != (const unsigned char *)inBuffer->getImageBufferPtr())
+				size += inBuffer->getDisplayBufferSize();
+			return size;
+		}
+		// ---------------------------------------------------------------------
+		// obtainTileKey
+		// ---------------------------------------------------------------------
+		static unsigned long long	obtainTileKey(int inLevel, int inTileX, int inTileY)
+		{
+			return ((unsigned long long )inLevel << 56) |
+					((unsigned long long )(unsigned int )inTileY << 28) |
+					(unsigned long long )(unsigned int )inTileX;
+		}
+		// ---------------------------------------------------------------------
+		// compareTilePos
+		// ---------------------------------------------------------------------
+		static bool	compareTilePos(const TilePos &inA, const TilePos &inB)
+		{
+			return inA.distance < inB.distance;
+		}
+		// ---------------------------------------------------------------------
+		// deleteTile
+		// ---------------------------------------------------------------------
+		static void	deleteTile(Tile *inTile)
+		{
+			if (inTile->buffer != NULL)
+				delete inTile->buffer;
+			delete inTile;
+		}
+
+	private:
+		TiledImage(const TiledImage &);
+		TiledImage	&operator=(const TiledImage &);
+	};
+ };
+};
+
+#endif	// #ifdef VIW_MODEL_TILEDIMAGE_H
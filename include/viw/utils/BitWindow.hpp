@@ -0,0 +1,236 @@
+// =============================================================================
+//  BitWindow.hpp
+//
+//  Written in 2014 by Dairoku Sekiguchi (sekiguchi at acm dot org)
+//
+//  To the extent possible under law, the author(s) have dedicated all copyright
+//  and related and neighboring rights to this software to the public domain worldwide.
+//  This software is distributed without any warranty.
+//
+//  You should have received a copy of the CC0 Public Domain Dedication along with
+//  this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+// =============================================================================
+/*!
+	\file		viw/utils/BitWindow.h
+	\author		Dairoku Sekiguchi
+	\version	1.0.0
+	\date		2026/10/19
+	\brief		Header file for viw library types
+
+	This file defines the bit window extraction for viw library
+*/
+
+#ifndef VIW_UTIL_BITWINDOW_H
+#define VIW_UTIL_BITWINDOW_H
+
+// Includes --------------------------------------------------------------------
+#include <stdio.h>
+#include "viw/utils/CpuFeatures.hpp"
+
+// Macros ----------------------------------------------------------------------
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define	VIW_BITWINDOW_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+
+// Namespace -------------------------------------------------------------------
+namespace viw
+{
+ namespace utils
+ {
+	// -------------------------------------------------------------------------
+	// BitWindow class
+	// -------------------------------------------------------------------------
+	//	Extracts the 8 bits [inShift, inShift + 7] of every integer element,
+	//	i.e. (v >> inShift) & 0xFF. Signed values are treated as their two's
+	//	complement bit pattern.
+	class	BitWindow
+	{
+	public:
+		// Static Functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// extractLine
+		// ---------------------------------------------------------------------
+		template <typename ImageBufferType>
+		static void	extractLine(const ImageBufferType *inSrc, int inCount, int inShift,
+								unsigned char *outDst)
+		{
+			extractLineScalar(inSrc, 0, inCount, inShift, outDst);
+		}
+		// ---------------------------------------------------------------------
+		// extractLine (16bit)
+		// ---------------------------------------------------------------------
+		static void	extractLine(const unsigned short *inSrc, int inCount, int inShift,
+								unsigned char *outDst)
+		{
+			static const ExtractLine16Func	extractLineFunc = selectExtractLine16Func();
+
+			int	x = extractLineFunc(inSrc, inCount, inShift, outDst);
+			extractLineScalar(inSrc, x, inCount, inShift, outDst);
+		}
+		// ---------------------------------------------------------------------
+		// extractLine (32bit)
+		// ---------------------------------------------------------------------
+		static void	extractLine(const unsigned int *inSrc, int inCount, int inShift,
+								unsigned char *outDst)
+		{
+			static const ExtractLine32Func	extractLineFunc = selectExtractLine32Func();
+
+			int	x = extractLineFunc(inSrc, inCount, inShift, outDst);
+			extractLineScalar(inSrc, x, inCount, inShift, outDst);
+		}
+		// ---------------------------------------------------------------------
+		// extractLine (signed 16bit)
+		// ---------------------------------------------------------------------
+		static void	extractLine(const short *inSrc, int inCount, int inShift,
+								unsigned char *outDst)
+		{
+			extractLine((const unsigned short *)inSrc, inCount, inShift, outDst);
+		}
+		// ---------------------------------------------------------------------
+		// extractLine (signed 32bit)
+		// ---------------------------------------------------------------------
+		static void	extractLine(const int *inSrc, int inCount, int inShift,
+								unsigned char *outDst)
+		{
+			extractLine((const unsigned int *)inSrc, inCount, inShift, outDst);
+		}
+
+	private:
+		// Typedefs ------------------------------------------------------------
+		//	The vector variants return the first x left for the scalar loop
+		typedef int	(*ExtractLine16Func)(const unsigned short *inSrc, int inCount, int inShift,
+								unsigned char *outDst);
+		typedef int	(*ExtractLine32Func)(const unsigned int *inSrc, int inCount, int inShift,
+								unsigned char *outDst);
+
+		// Static Functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// selectExtractLine16Func
+		// ---------------------------------------------------------------------
+		static ExtractLine16Func	selectExtractLine16Func()
+		{
+		#ifdef VIW_CPU_X86_DISPATCH
+			if (CpuFeatures::isEnabled(CpuFeatures::ISA_AVX2))
+				return extractLine16AVX2;
+		#endif
+		#ifdef VIW_BITWINDOW_USE_SSE2
+			if (CpuFeatures::isEnabled(CpuFeatures::ISA_SSE2))
+				return extractLine16SSE2;
+		#endif
+			return extractLine16None;
+		}
+		// ---------------------------------------------------------------------
+		// selectExtractLine32Func
+		// ---------------------------------------------------------------------
+		static ExtractLine32Func	selectExtractLine32Func()
+		{
+		#ifdef VIW_BITWINDOW_USE_SSE2
+			if (CpuFeatures::isEnabled(CpuFeatures::ISA_SSE2))
+				return extractLine32SSE2;
+		#endif
+			return extractLine32None;
+		}
+		// ---------------------------------------------------------------------
+		// extractLine16None
+		// ---------------------------------------------------------------------
+		static int	extractLine16None(const unsigned short *, int, int, unsigned char *)
+		{
+			return 0;
+		}
+		// ---------------------------------------------------------------------
+		// extractLine32None
+		// ---------------------------------------------------------------------
+		static int	extractLine32None(const unsigned int *, int, int, unsigned char *)
+		{
+			return 0;
+		}
+		// ---------------------------------------------------------------------
+		// extractLineScalar
+		// ---------------------------------------------------------------------
+		template <typename ImageBufferType>
+		static void	extractLineScalar(const ImageBufferType *inSrc, int inStartX, int inEndX,
+								int inShift, unsigned char *outDst)
+		{
+			// the cast only matters for non integer types, which are not
+			// accepted by DISPLAY_MAP_PARTIAL but still instantiate this
+			for (int x = inStartX; x < inEndX; x++)
+				outDst[x] = (unsigned char )((long long )inSrc[x] >> inShift);
+		}
+	#ifdef VIW_BITWINDOW_USE_SSE2
+		// ---------------------------------------------------------------------
+		// extractLine16SSE2
+		// ---------------------------------------------------------------------
+		static int	extractLine16SSE2(const unsigned short *inSrc, int inCount, int inShift,
+								unsigned char *outDst)
+		{
+			const __m128i	mask = _mm_set1_epi16(0x00FF);
+			const __m128i	shift = _mm_cvtsi32_si128(inShift);
+			int	x = 0;
+
+			for (; x + 16 <= inCount; x += 16)
+			{
+				__m128i	a = _mm_loadu_si128((const __m128i *)(inSrc + x));
+				__m128i	b = _mm_loadu_si128((const __m128i *)(inSrc + x + 8));
+				a = _mm_and_si128(_mm_srl_epi16(a, shift), mask);
+				b = _mm_and_si128(_mm_srl_epi16(b, shift), mask);
+				_mm_storeu_si128((__m128i *)(outDst + x), _mm_packus_epi16(a, b));
+			}
+			return x;
+		}
+		// ---------------------------------------------------------------------
+		// extractLine32SSE2
+		// ---------------------------------------------------------------------
+		static int	extractLine32SSE2(const unsigned int *inSrc, int inCount, int inShift,
+								unsigned char *outDst)
+		{
+			const __m128i	mask = _mm_set1_epi32(0x000000FF);
+			const __m128i	shift = _mm_cvtsi32_si128(inShift);
+			int	x = 0;
+
+			for (; x + 16 <= inCount; x += 16)
+			{
+				__m128i	v[4];
+				for (int i = 0; i < 4; i++)
+				{
+					v[i] = _mm_loadu_si128((const __m128i *)(inSrc + x + i * 4));
+					v[i] = _mm_and_si128(_mm_srl_epi32(v[i], shift), mask);
+				}
+				__m128i	lo = _mm_packs_epi32(v[0], v[1]);	// values are <= 255
+				__m128i	hi = _mm_packs_epi32(v[2], v[3]);
+				_mm_storeu_si128((__m128i *)(outDst + x), _mm_packus_epi16(lo, hi));
+			}
+			return x;
+		}
+	#endif
+	#ifdef VIW_CPU_X86_DISPATCH
+		// ---------------------------------------------------------------------
+		// extractLine16AVX2
+		// ---------------------------------------------------------------------
+		VIW_TARGET_AVX2
+		static int	extractLine16AVX2(const unsigned short *inSrc, int inCount, int inShift,
+								unsigned char *outDst)
+		{
+			const __m256i	mask = _mm256_set1_epi16(0x00FF);
+			const __m128i	shift = _mm_cvtsi32_si128(inShift);
+			int	x = 0;
+
+			for (; x + 32 <= inCount; x += 32)
+			{
+				__m256i	a = _mm256_loadu_si256((const __m256i *)(inSrc + x));
+				__m256i	b = _mm256_loadu_si256((const __m256i *)(inSrc + x + 16));
+				a = _mm256_and_si256(_mm256_srl_epi16(a, shift), mask);
+				b = _mm256_and_si256(_mm256_srl_epi16(b, shift), mask);
+				// packus works per 128bit lane, restore the element order
+				__m256i	r = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8);
+				_mm256_storeu_si256((__m256i *)(outDst + x), r);
+			}
+			return x;
+		}
+	#endif
+	};
+ };
+};
+
+#endif	// #ifdef VIW_UTIL_BITWINDOW_H
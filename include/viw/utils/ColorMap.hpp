@@ -24,7 +24,6 @@
 #define VIW_UTIL_COLORMAP_H
 
 // Includes --------------------------------------------------------------------
-#include <Windows.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
@@ -0,0 +1,225 @@
+// =============================================================================
+//  CpuFeatures.hpp
+//
+//  Written in 2014 by Dairoku Sekiguchi (sekiguchi at acm dot org)
+//
+//  To the extent possible under law, the author(s) have dedicated all copyright
+//  and related and neighboring rights to this software to the public domain worldwide.
+//  This software is distributed without any warranty.
+//
+//  You should have received a copy of the CC0 Public Domain Dedication along with
+//  this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+// =============================================================================
+/*!
+	\file		viw/utils/CpuFeatures.h
+	\author		Dairoku Sekiguchi
+	\version	1.0.0
+	\date		2026/10/19
+	\brief		Header file for viw library types
+
+	This file defines the runtime CPU feature detection for viw library
+*/
+
+#ifndef VIW_UTIL_CPUFEATURES_H
+#define VIW_UTIL_CPUFEATURES_H
+
+// Includes --------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Macros ----------------------------------------------------------------------
+//	VIW_CPU_X86_DISPATCH : SSSE3 / AVX2 kernel variants are compiled in and
+//	selected at runtime. VIW_TARGET_xxx mark the functions that use them
+//	(MSVC allows any intrinsic without /arch).
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define	VIW_CPU_X86
+#if defined(_MSC_VER)
+#define	VIW_CPU_X86_DISPATCH
+#include <intrin.h>
+#include <immintrin.h>
+#define	VIW_TARGET_SSSE3
+#define	VIW_TARGET_AVX2
+#elif defined(__GNUC__) && (defined(__clang__) || __GNUC__ >= 5)
+#define	VIW_CPU_X86_DISPATCH
+#include <cpuid.h>
+#include <immintrin.h>
+#define	VIW_TARGET_SSSE3		__attribute__((target("ssse3")))
+#define	VIW_TARGET_AVX2			__attribute__((target("avx2")))
+#endif
+#endif
+#if defined(__ARM_NEON) || defined(_M_ARM64)
+#define	VIW_CPU_NEON
+#endif
+
+
+// Namespace -------------------------------------------------------------------
+namespace viw
+{
+ namespace utils
+ {
+	// -------------------------------------------------------------------------
+	// CpuFeatures class
+	// -------------------------------------------------------------------------
+	//	Detects the instruction set once. The kernels bind their variant on
+	//	first use, so VIW_CPU_ISA (scalar, sse2, ssse3, avx2, avx512, neon)
+	//	must be set before the first image is mapped. It can only lower the
+	//	level, which lets every variant be tested on one machine, e.g.
+	//	VIW_CPU_ISA=sse2 ./viw_bench
+	class	CpuFeatures
+	{
+	public:
+		// Constatns -----------------------------------------------------------
+		enum Isa
+		{
+			ISA_SCALAR		= 0,
+			ISA_SSE2,
+			ISA_SSSE3,
+			ISA_AVX2,
+			ISA_AVX512,		// AVX-512 F + BW, the kernels use their AVX2 variant
+			ISA_NEON		= 256
+		};
+
+		// Static Functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// getIsa
+		// ---------------------------------------------------------------------
+		//	The level the kernels use (detected, lowered by VIW_CPU_ISA)
+		static Isa	getIsa()
+		{
+			static const Isa	isa = obtainEffectiveIsa(detectIsa(), getenv("VIW_CPU_ISA"));
+			return isa;
+		}
+		// ---------------------------------------------------------------------
+		// isEnabled
+		// ---------------------------------------------------------------------
+		static bool	isEnabled(Isa inIsa)
+		{
+			Isa	isa = getIsa();
+			if (inIsa == ISA_NEON || isa == ISA_NEON)
+				return (isa == inIsa);
+			return (isa >= inIsa);
+		}
+		// ---------------------------------------------------------------------
+		// getIsaName
+		// ---------------------------------------------------------------------
+		static const char	*getIsaName(Isa inIsa)
+		{
+			switch (inIsa)
+			{
+				case ISA_SSE2:		return "sse2";
+				case ISA_SSSE3:		return "ssse3";
+				case ISA_AVX2:		return "avx2";
+				case ISA_AVX512:	return "avx512";
+				case ISA_NEON:		return "neon";
+				default:			return "scalar";
+			}
+		}
+		// ---------------------------------------------------------------------
+		// detectIsa
+		// ---------------------------------------------------------------------
+		static Isa	detectIsa()
+		{
+		#if defined(VIW_CPU_X86_DISPATCH)
+			// Leaf 7 stays zero (no AVX2 / AVX-512) when the CPU doesn't have it
+			unsigned int	r0[4], r1[4], r7[4] = {0, 0, 0, 0};
+			cpuid(1, 0, r1);
+			if (cpuid(0, 0, r0) >= 7)
+				cpuid(7, 0, r7);
+
+			if ((r1[3] & (1 << 26)) == 0)
+				return ISA_SCALAR;
+			if ((r1[2] & (1 << 9)) == 0)
+				return ISA_SSE2;
+
+			// AVX needs OS support for the YMM (and ZMM) state
+			bool	osxsave = (r1[2] & (1 << 27)) != 0 && (r1[2] & (1 << 28)) != 0;
+			unsigned long long	xcr0 = osxsave ? readXcr0() : 0;
+			if ((xcr0 & 0x06) != 0x06 || (r7[1] & (1 << 5)) == 0)
+				return ISA_SSSE3;
+			if ((xcr0 & 0xE6) == 0xE6 && (r7[1] & (1 << 16)) != 0 && (r7[1] & (1 << 30)) != 0)
+				return ISA_AVX512;
+			return ISA_AVX2;
+		#elif defined(VIW_CPU_X86)
+			#if defined(_M_X64) || defined(__SSE2__)
+			return ISA_SSE2;
+			#else
+			return ISA_SCALAR;
+			#endif
+		#elif defined(VIW_CPU_NEON)
+			return ISA_NEON;
+		#else
+			return ISA_SCALAR;
+		#endif
+		}
+		// ---------------------------------------------------------------------
+		// obtainEffectiveIsa
+		// ---------------------------------------------------------------------
+		static Isa	obtainEffectiveIsa(Isa inDetected, const char *inRequest)
+		{
+			if (inRequest == NULL || inRequest[0] == 0)
+				return inDetected;
+
+			Isa	request;
+			if (strcmp(inRequest, "scalar") == 0)
+				request = ISA_SCALAR;
+			else if (strcmp(inRequest, "sse2") == 0)
+				request = ISA_SSE2;
+			else if (strcmp(inRequest, "ssse3") == 0)
+				request = ISA_SSSE3;
+			else if (strcmp(inRequest, "avx2") == 0)
+				request = ISA_AVX2;
+			else if (strcmp(inRequest, "avx512") == 0)
+				request = ISA_AVX512;
+			else if (strcmp(inRequest, "neon") == 0)
+				request = ISA_NEON;
+			else
+			{
+				fprintf(stderr, "viw: unknown VIW_CPU_ISA \"%s\" ignored\n", inRequest);
+				return inDetected;
+			}
+
+			if (request == ISA_SCALAR)
+				return ISA_SCALAR;
+			if (request == ISA_NEON || inDetected == ISA_NEON)
+				return (request == inDetected) ? request : inDetected;
+			return (request < inDetected) ? request : inDetected;
+		}
+
+	private:
+	#if defined(VIW_CPU_X86_DISPATCH)
+		// ---------------------------------------------------------------------
+		// cpuid
+		// ---------------------------------------------------------------------
+		//	Returns eax
+		static unsigned int	cpuid(unsigned int inLeaf, unsigned int inSubLeaf, unsigned int *outRegs)
+		{
+		#ifdef _MSC_VER
+			int	regs[4];
+			__cpuidex(regs, (int )inLeaf, (int )inSubLeaf);
+			for (int i = 0; i < 4; i++)
+				outRegs[i] = (unsigned int )regs[i];
+		#else
+			__cpuid_count(inLeaf, inSubLeaf, outRegs[0], outRegs[1], outRegs[2], outRegs[3]);
+		#endif
+			return outRegs[0];
+		}
+		// ---------------------------------------------------------------------
+		// readXcr0
+		// ---------------------------------------------------------------------
+		static unsigned long long	readXcr0()
+		{
+		#ifdef _MSC_VER
+			return _xgetbv(0);
+		#else
+			unsigned int	eax, edx;
+			__asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+			return ((unsigned long long )edx << 32) | eax;
+		#endif
+		}
+	#endif
+	};
+ };
+};
+
+#endif	// #ifdef VIW_UTIL_CPUFEATURES_H
@@ -0,0 +1,705 @@
+// =============================================================================
+//  Demosaic.hpp
+//
+//  Written in 2014 by Dairoku Sekiguchi (sekiguchi at acm dot org)
+//
+//  To the extent possible under law, the author(s) have dedicated all copyright
+//  and related and neighboring rights to this software to the public domain worldwide.
+//  This software is distributed without any warranty.
+//
+//  You should have received a copy of the CC0 Public Domain Dedication along with
+//  this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+// =============================================================================
+/*!
+	\file		viw/utils/Demosaic.h
+	\author		Dairoku Sekiguchi
+	\version	1.0.0
+	\date		2026/10/19
+	\brief		Header file for viw library types
+
+	This file defines the Bayer demosaic kernels for viw library
+*/
+
+#ifndef VIW_UTIL_DEMOSAIC_H
+#define VIW_UTIL_DEMOSAIC_H
+
+// Includes --------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include "viw/Exception.hpp"
+#include "viw/utils/CpuFeatures.hpp"
+
+// Macros ----------------------------------------------------------------------
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define	VIW_DEMOSAIC_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+
+// Namespace -------------------------------------------------------------------
+namespace viw
+{
+ namespace utils
+ {
+	// -------------------------------------------------------------------------
+	// Demosaic class
+	// -------------------------------------------------------------------------
+	//	All kernels convert a band of rows [inStartY, inEndY) of a Bayer mosaic
+	//	into a 24bit BGR (DIB order) image. The value mapping (display range,
+	//	white balance, ...) is done through a per-channel LUT in the same pass,
+	//	so the raw data is read once and the display buffer is written once.
+	//	Bands are independent, so callers may process them in parallel.
+	class	Demosaic
+	{
+	public:
+		// Constatns -----------------------------------------------------------
+		enum BayerPattern
+		{
+			BAYER_PATTERN_RG		= 1,
+			BAYER_PATTERN_GR,
+			BAYER_PATTERN_GB,
+			BAYER_PATTERN_BG
+		};
+		enum DemosaicMethod
+		{
+			DEMOSAIC_BILINEAR		= 1,
+			DEMOSAIC_EDGE_AWARE
+		};
+
+		// Static Functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// demosaicToBGR
+		// ---------------------------------------------------------------------
+		//	inLut holds 3 * inLutSize entries in B, G, R order.
+		template <typename ImageBufferType>
+		static void	demosaicToBGR(const ImageBufferType *inSrc, int inWidth, int inHeight,
+								BayerPattern inPattern, DemosaicMethod inMethod,
+								const unsigned char *inLut, int inLutSize,
+								unsigned char *outDst, size_t inDstLineOffset,
+								int inStartY, int inEndY)
+		{
+			typedef int	(*BilinearRowFunc)(const ImageBufferType *inRows[5], int inX, int inEndX,
+								bool inIsRedRow, int inChromaParity,
+								const unsigned char *inLut, int inLutSize, unsigned char *outDst);
+			typedef BilinearRowFunc	EdgeAwareRowFunc;
+			static const BilinearRowFunc	bilinearRowFunc = selectBilinearRowFunc<BilinearRowFunc>();
+			static const EdgeAwareRowFunc	edgeAwareRowFunc = selectEdgeAwareRowFunc<EdgeAwareRowFunc>();
+
+			const ImageBufferType	*rows[5];
+			int		rPosX, rPosY, x, y, xEnd;
+			int		rgb[3];
+
+			if (inSrc == NULL || outDst == NULL || inLut == NULL)
+				return;
+			if (inStartY < 0)
+				inStartY = 0;
+			if (inEndY > inHeight)
+				inEndY = inHeight;
+
+			obtainRedPosition(inPattern, &rPosX, &rPosY);
+
+			for (y = inStartY; y < inEndY; y++)
+			{
+				for (int i = 0; i < 5; i++)
+					rows[i] = inSrc + (size_t )reflectIndex(y + i - 2, inHeight) * inWidth;
+
+				unsigned char	*dstPtr = outDst + inDstLineOffset * y;
+				bool	isRedRow = ((y & 1) == rPosY);
+				int		chromaParity = isRedRow ? rPosX : (1 - rPosX);
+
+				// Left border (two pixels), handled with reflected coordinates
+				xEnd = (inWidth < 2) ? inWidth : 2;
+				for (x = 0; x < xEnd; x++)
+				{
+					computePixelAt(rows, x, inWidth, isRedRow, (x & 1) == chromaParity,
+									inMethod, inLutSize, rgb);
+					storePixel(dstPtr + x * 3, rgb, inLut, inLutSize);
+				}
+
+				// Interior
+				xEnd = inWidth - 2;
+				if (inMethod == DEMOSAIC_BILINEAR)
+					x = bilinearRowFunc(rows, x, xEnd, isRedRow, chromaParity,
+										inLut, inLutSize, dstPtr);
+				else
+					x = edgeAwareRowFunc(rows, x, xEnd, isRedRow, chromaParity,
+										inLut, inLutSize, dstPtr);
+				for (; x < xEnd; x++)
+				{
+					const ImageBufferType	*r[5] = {rows[0] + x, rows[1] + x, rows[2] + x, rows[3] + x, rows[4] + x};
+					computePixel(r, -2, -1, 1, 2, isRedRow, (x & 1) == chromaParity,
+									inMethod, inLutSize, rgb);
+					storePixel(dstPtr + x * 3, rgb, inLut, inLutSize);
+				}
+
+				// Right border
+				for (x = (x < 2) ? 2 : x; x < inWidth; x++)
+				{
+					computePixelAt(rows, x, inWidth, isRedRow, (x & 1) == chromaParity,
+									inMethod, inLutSize, rgb);
+					storePixel(dstPtr + x * 3, rgb, inLut, inLutSize);
+				}
+			}
+		}
+		// ---------------------------------------------------------------------
+		// obtainRedPosition
+		// ---------------------------------------------------------------------
+		static void	obtainRedPosition(BayerPattern inPattern, int *outX, int *outY)
+		{
+			switch (inPattern)
+			{
+				case BAYER_PATTERN_GR:
+					*outX = 1;	*outY = 0;
+					return;
+				case BAYER_PATTERN_GB:
+					*outX = 0;	*outY = 1;
+					return;
+				case BAYER_PATTERN_BG:
+					*outX = 1;	*outY = 1;
+					return;
+				case BAYER_PATTERN_RG:
+				default:
+					*outX = 0;	*outY = 0;
+					return;
+			}
+		}
+		// ---------------------------------------------------------------------
+		// reflectIndex
+		// ---------------------------------------------------------------------
+		//	Mirror without repeating the edge pixel, which keeps the Bayer
+		//	parity of the reflected coordinate.
+		static int	reflectIndex(int inIndex, int inNum)
+		{
+			if (inIndex < 0)
+				inIndex = -inIndex;
+			if (inIndex >= inNum)
+				inIndex = 2 * (inNum - 1) - inIndex;
+			if (inIndex < 0)
+				return 0;
+			if (inIndex >= inNum)
+				return inNum - 1;
+			return inIndex;
+		}
+
+	private:
+		// Static Functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// clampValue
+		// ---------------------------------------------------------------------
+		static int	clampValue(int inValue, int inLutSize)
+		{
+			if (inValue < 0)
+				return 0;
+			if (inValue >= inLutSize)
+				return inLutSize - 1;
+			return inValue;
+		}
+		// ---------------------------------------------------------------------
+		// storePixel
+		// ---------------------------------------------------------------------
+		static void	storePixel(unsigned char *outDst, const int *inRGB,
+								const unsigned char *inLut, int inLutSize)
+		{
+			outDst[0] = inLut[inRGB[2]];
+			outDst[1] = inLut[inLutSize + inRGB[1]];
+			outDst[2] = inLut[inLutSize * 2 + inRGB[0]];
+		}
+		// ---------------------------------------------------------------------
+		// computePixelAt
+		// ---------------------------------------------------------------------
+		template <typename ImageBufferType>
+		static void	computePixelAt(const ImageBufferType *inRows[5], int inX, int inWidth,
+								bool inIsRedRow, bool inIsChromaSite,
+								DemosaicMethod inMethod, int inLutSize, int *outRGB)
+		{
+			const ImageBufferType	*r[5] = {inRows[0] + inX, inRows[1] + inX, inRows[2] + inX,
+											inRows[3] + inX, inRows[4] + inX};
+
+			computePixel(r,
+				reflectIndex(inX - 2, inWidth) - inX, reflectIndex(inX - 1, inWidth) - inX,
+				reflectIndex(inX + 1, inWidth) - inX, reflectIndex(inX + 2, inWidth) - inX,
+				inIsRedRow, inIsChromaSite, inMethod, inLutSize, outRGB);
+		}
+		// ---------------------------------------------------------------------
+		// computePixel
+		// ---------------------------------------------------------------------
+		//	inR[0..4] point to the pixel column in rows y-2..y+2, inXm2..inXp2
+		//	are the (possibly reflected) column offsets of x-2..x+2.
+		//	"C" is the chroma of the current row (R in a red row, B otherwise),
+		//	"D" is the other chroma.
+		template <typename ImageBufferType>
+		static void	computePixel(const ImageBufferType *inR[5],
+								int inXm2, int inXm1, int inXp1, int inXp2,
+								bool inIsRedRow, bool inIsChromaSite,
+								DemosaicMethod inMethod, int inLutSize, int *outRGB)
+		{
+			int	center = (int )inR[2][0];
+			int	c, g, d;
+
+			if (inIsChromaSite)
+			{
+				// C site: G on the axes, D on the diagonals
+				int	n = (int )inR[1][0];
+				int	s = (int )inR[3][0];
+				int	w = (int )inR[2][inXm1];
+				int	e = (int )inR[2][inXp1];
+				int	diag = (int )inR[1][inXm1] + (int )inR[1][inXp1] +
+							(int )inR[3][inXm1] + (int )inR[3][inXp1];
+				c = center;
+				if (inMethod == DEMOSAIC_BILINEAR)
+				{
+					g = (n + s + w + e + 2) >> 2;
+					d = (diag + 2) >> 2;
+				}
+				else
+				{
+					// Green: Hamilton-Adams direction selection
+					int	lapH = 2 * center - (int )inR[2][inXm2] - (int )inR[2][inXp2];
+					int	lapV = 2 * center - (int )inR[0][0] - (int )inR[4][0];
+					int	gradH = abs(w - e) + abs(lapH);
+					int	gradV = abs(n - s) + abs(lapV);
+					int	gH = 2 * (w + e) + lapH;	// 4 * estimate
+					int	gV = 2 * (n + s) + lapV;
+					if (gradH < gradV)
+						g = (gH + 2) >> 2;
+					else if (gradV < gradH)
+						g = (gV + 2) >> 2;
+					else
+						g = (gH + gV + 4) >> 3;
+					// Other chroma: gradient corrected (Malvar-He-Cutler)
+					int	axial2 = (int )inR[0][0] + (int )inR[4][0] +
+								(int )inR[2][inXm2] + (int )inR[2][inXp2];
+					d = (12 * center + 4 * diag - 3 * axial2 + 8) >> 4;
+				}
+			}
+			else
+			{
+				// G site: C on the horizontal axis, D on the vertical axis
+				int	w = (int )inR[2][inXm1];
+				int	e = (int )inR[2][inXp1];
+				int	n = (int )inR[1][0];
+				int	s = (int )inR[3][0];
+				g = center;
+				if (inMethod == DEMOSAIC_BILINEAR)
+				{
+					c = (w + e + 1) >> 1;
+					d = (n + s + 1) >> 1;
+				}
+				else
+				{
+					int	gH2 = (int )inR[2][inXm2] + (int )inR[2][inXp2];
+					int	gV2 = (int )inR[0][0] + (int )inR[4][0];
+					int	gDiag = (int )inR[1][inXm1] + (int )inR[1][inXp1] +
+								(int )inR[3][inXm1] + (int )inR[3][inXp1];
+					c = (10 * center + 8 * (w + e) - 2 * gH2 + gV2 - 2 * gDiag + 8) >> 4;
+					d = (10 * center + 8 * (n + s) - 2 * gV2 + gH2 - 2 * gDiag + 8) >> 4;
+				}
+			}
+
+			c = clampValue(c, inLutSize);
+			g = clampValue(g, inLutSize);
+			d = clampValue(d, inLutSize);
+			if (inIsRedRow)
+			{
+				outRGB[0] = c;
+				outRGB[2] = d;
+			}
+			else
+			{
+				outRGB[0] = d;
+				outRGB[2] = c;
+			}
+			outRGB[1] = g;
+		}
+		// ---------------------------------------------------------------------
+		// selectBilinearRowFunc
+		// ---------------------------------------------------------------------
+		//	The cast picks the overload for the buffer type of BilinearRowFunc
+		template <typename BilinearRowFunc>
+		static BilinearRowFunc	selectBilinearRowFunc()
+		{
+		#ifdef VIW_DEMOSAIC_USE_SSE2
+			if (CpuFeatures::isEnabled(CpuFeatures::ISA_SSE2))
+				return static_cast<BilinearRowFunc>(demosaicBilinearRowSSE2);
+		#endif
+			return static_cast<BilinearRowFunc>(demosaicBilinearRowNone);
+		}
+		// ---------------------------------------------------------------------
+		// selectEdgeAwareRowFunc
+		// ---------------------------------------------------------------------
+		template <typename EdgeAwareRowFunc>
+		static EdgeAwareRowFunc	selectEdgeAwareRowFunc()
+		{
+		#ifdef VIW_DEMOSAIC_USE_SSE2
+			if (CpuFeatures::isEnabled(CpuFeatures::ISA_SSE2))
+				return static_cast<EdgeAwareRowFunc>(demosaicEdgeAwareRowSSE2);
+		#endif
+			return static_cast<EdgeAwareRowFunc>(demosaicBilinearRowNone);
+		}
+		// ---------------------------------------------------------------------
+		// demosaicBilinearRowNone
+		// ---------------------------------------------------------------------
+		//	Also the edge-aware one, the caller does the whole row
+		template <typename ImageBufferType>
+		static int	demosaicBilinearRowNone(const ImageBufferType *[5], int inX, int,
+								bool, int, const unsigned char *, int, unsigned char *)
+		{
+			return inX;
+		}
+
+	#ifdef VIW_DEMOSAIC_USE_SSE2
+		// ---------------------------------------------------------------------
+		// demosaicBilinearRowSSE2
+		// ---------------------------------------------------------------------
+		//	Generic types have no SIMD path; the caller finishes the row.
+		template <typename ImageBufferType>
+		static int	demosaicBilinearRowSSE2(const ImageBufferType *[5], int inX, int,
+								bool, int, const unsigned char *, int, unsigned char *)
+		{
+			return inX;
+		}
+		// ---------------------------------------------------------------------
+		// demosaicBilinearRowSSE2 (8bit)
+		// ---------------------------------------------------------------------
+		static int	demosaicBilinearRowSSE2(const unsigned char *inRows[5], int inX, int inEndX,
+								bool inIsRedRow, int inChromaParity,
+								const unsigned char *inLut, int inLutSize, unsigned char *outDst)
+		{
+			if (inLutSize < 256)
+				return inX;
+
+			const int	LANES = 16;
+			__m128i		siteMask = (inChromaParity == (inX & 1)) ?
+										_mm_set1_epi16(0x00FF) : _mm_set1_epi16((short )0xFF00);
+			unsigned char	cBuf[LANES], gBuf[LANES], dBuf[LANES];
+			int		x = inX;
+
+			for (; x + LANES <= inEndX; x += LANES)
+			{
+				__m128i	up = _mm_loadu_si128((const __m128i *)(inRows[1] + x));
+				__m128i	upL = _mm_loadu_si128((const __m128i *)(inRows[1] + x - 1));
+				__m128i	upR = _mm_loadu_si128((const __m128i *)(inRows[1] + x + 1));
+				__m128i	cur = _mm_loadu_si128((const __m128i *)(inRows[2] + x));
+				__m128i	curL = _mm_loadu_si128((const __m128i *)(inRows[2] + x - 1));
+				__m128i	curR = _mm_loadu_si128((const __m128i *)(inRows[2] + x + 1));
+				__m128i	dn = _mm_loadu_si128((const __m128i *)(inRows[3] + x));
+				__m128i	dnL = _mm_loadu_si128((const __m128i *)(inRows[3] + x - 1));
+				__m128i	dnR = _mm_loadu_si128((const __m128i *)(inRows[3] + x + 1));
+
+				__m128i	hAvg = _mm_avg_epu8(curL, curR);
+				__m128i	vAvg = _mm_avg_epu8(up, dn);
+				__m128i	cross = average4(curL, curR, up, dn);
+				__m128i	diag = average4(upL, upR, dnL, dnR);
+
+				// chroma site: C = cur, G = cross, D = diag
+				// green site:  C = hAvg, G = cur, D = vAvg
+				storeSelected(cBuf, siteMask, cur, hAvg);
+				storeSelected(gBuf, siteMask, cross, cur);
+				storeSelected(dBuf, siteMask, diag, vAvg);
+				storeLanes(cBuf, gBuf, dBuf, LANES, inIsRedRow, inLut, inLutSize, outDst + x * 3);
+			}
+			return x;
+		}
+		// ---------------------------------------------------------------------
+		// demosaicBilinearRowSSE2 (16bit)
+		// ---------------------------------------------------------------------
+		static int	demosaicBilinearRowSSE2(const unsigned short *inRows[5], int inX, int inEndX,
+								bool inIsRedRow, int inChromaParity,
+								const unsigned char *inLut, int inLutSize, unsigned char *outDst)
+		{
+			const int	LANES = 8;
+			__m128i		siteMask = (inChromaParity == (inX & 1)) ?
+										_mm_set1_epi32(0x0000FFFF) : _mm_set1_epi32((int )0xFFFF0000);
+			unsigned short	cBuf[LANES], gBuf[LANES], dBuf[LANES];
+			int		x = inX;
+
+			if (inLutSize < 65536)	// values must index the LUT without clamping
+				return inX;
+
+			for (; x + LANES <= inEndX; x += LANES)
+			{
+				__m128i	up = _mm_loadu_si128((const __m128i *)(inRows[1] + x));
+				__m128i	upL = _mm_loadu_si128((const __m128i *)(inRows[1] + x - 1));
+				__m128i	upR = _mm_loadu_si128((const __m128i *)(inRows[1] + x + 1));
+				__m128i	cur = _mm_loadu_si128((const __m128i *)(inRows[2] + x));
+				__m128i	curL = _mm_loadu_si128((const __m128i *)(inRows[2] + x - 1));
+				__m128i	curR = _mm_loadu_si128((const __m128i *)(inRows[2] + x + 1));
+				__m128i	dn = _mm_loadu_si128((const __m128i *)(inRows[3] + x));
+				__m128i	dnL = _mm_loadu_si128((const __m128i *)(inRows[3] + x - 1));
+				__m128i	dnR = _mm_loadu_si128((const __m128i *)(inRows[3] + x + 1));
+
+				__m128i	hAvg = _mm_avg_epu16(curL, curR);
+				__m128i	vAvg = _mm_avg_epu16(up, dn);
+				__m128i	cross = average4Epu16(curL, curR, up, dn);
+				__m128i	diag = average4Epu16(upL, upR, dnL, dnR);
+
+				storeSelected(cBuf, siteMask, cur, hAvg);
+				storeSelected(gBuf, siteMask, cross, cur);
+				storeSelected(dBuf, siteMask, diag, vAvg);
+				storeLanes(cBuf, gBuf, dBuf, LANES, inIsRedRow, inLut, inLutSize, outDst + x * 3);
+			}
+			return x;
+		}
+		// ---------------------------------------------------------------------
+		// demosaicEdgeAwareRowSSE2
+		// ---------------------------------------------------------------------
+		//	Generic types have no SIMD path; the caller finishes the row.
+		template <typename ImageBufferType>
+		static int	demosaicEdgeAwareRowSSE2(const ImageBufferType *[5], int inX, int,
+								bool, int, const unsigned char *, int, unsigned char *)
+		{
+			return inX;
+		}
+		// ---------------------------------------------------------------------
+		// demosaicEdgeAwareRowSSE2 (8bit)
+		// ---------------------------------------------------------------------
+		//	computePixel() for 8 pixels at a time in 16bit lanes, the sums
+		//	stay within [-3060, 7148]. Both site kinds are computed for every
+		//	lane and the mask picks the right one.
+		static int	demosaicEdgeAwareRowSSE2(const unsigned char *inRows[5], int inX, int inEndX,
+								bool inIsRedRow, int inChromaParity,
+								const unsigned char *inLut, int inLutSize, unsigned char *outDst)
+		{
+			const int	LANES = 8;
+			__m128i		zero = _mm_setzero_si128();
+			__m128i		siteMask = (inChromaParity == (inX & 1)) ?
+										_mm_set1_epi32(0x0000FFFF) : _mm_set1_epi32((int )0xFFFF0000);
+			__m128i		maxValue = _mm_set1_epi16((short )((inLutSize - 1 < 32767) ? inLutSize - 1 : 32767));
+			short		cBuf[LANES], gBuf[LANES], dBuf[LANES];
+			int			x = inX;
+
+			for (; x + LANES <= inEndX; x += LANES)
+			{
+				__m128i	n2 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(inRows[0] + x)), zero);
+				__m128i	nw = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(inRows[1] + x - 1)), zero);
+				__m128i	n = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(inRows[1] + x)), zero);
+				__m128i	ne = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(inRows[1] + x + 1)), zero);
+				__m128i	w2 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(inRows[2] + x - 2)), zero);
+				__m128i	w = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(inRows[2] + x - 1)), zero);
+				__m128i	center = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(inRows[2] + x)), zero);
+				__m128i	e = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(inRows[2] + x + 1)), zero);
+				__m128i	e2 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(inRows[2] + x + 2)), zero);
+				__m128i	sw = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(inRows[3] + x - 1)), zero);
+				__m128i	s = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(inRows[3] + x)), zero);
+				__m128i	se = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(inRows[3] + x + 1)), zero);
+				__m128i	s2 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(inRows[4] + x)), zero);
+
+				__m128i	diag = _mm_add_epi16(_mm_add_epi16(nw, ne), _mm_add_epi16(sw, se));
+				__m128i	gH2 = _mm_add_epi16(w2, e2);
+				__m128i	gV2 = _mm_add_epi16(n2, s2);
+				__m128i	center2 = _mm_add_epi16(center, center);
+
+				// chroma site: Hamilton-Adams green, gradient corrected other chroma
+				__m128i	lapH = _mm_sub_epi16(center2, gH2);
+				__m128i	lapV = _mm_sub_epi16(center2, gV2);
+				__m128i	gradH = _mm_add_epi16(absEpi16(_mm_sub_epi16(w, e)), absEpi16(lapH));
+				__m128i	gradV = _mm_add_epi16(absEpi16(_mm_sub_epi16(n, s)), absEpi16(lapV));
+				__m128i	gH = _mm_add_epi16(_mm_slli_epi16(_mm_add_epi16(w, e), 1), lapH);
+				__m128i	gV = _mm_add_epi16(_mm_slli_epi16(_mm_add_epi16(n, s), 1), lapV);
+				__m128i	chromaG = selectLanes(_mm_cmplt_epi16(gradH, gradV),
+									_mm_srai_epi16(_mm_add_epi16(gH, _mm_set1_epi16(2)), 2),
+									selectLanes(_mm_cmplt_epi16(gradV, gradH),
+										_mm_srai_epi16(_mm_add_epi16(gV, _mm_set1_epi16(2)), 2),
+										_mm_srai_epi16(_mm_add_epi16(_mm_add_epi16(gH, gV), _mm_set1_epi16(4)), 3)));
+				__m128i	chromaD = _mm_add_epi16(_mm_mullo_epi16(center, _mm_set1_epi16(12)), _mm_slli_epi16(diag, 2));
+				chromaD = _mm_sub_epi16(chromaD, _mm_mullo_epi16(_mm_add_epi16(gH2, gV2), _mm_set1_epi16(3)));
+				chromaD = _mm_srai_epi16(_mm_add_epi16(chromaD, _mm_set1_epi16(8)), 4);
+
+				// green site
+				__m128i	base = _mm_sub_epi16(_mm_mullo_epi16(center, _mm_set1_epi16(10)), _mm_slli_epi16(diag, 1));
+				base = _mm_add_epi16(base, _mm_set1_epi16(8));
+				__m128i	greenC = _mm_add_epi16(_mm_slli_epi16(_mm_add_epi16(w, e), 3), _mm_sub_epi16(gV2, _mm_slli_epi16(gH2, 1)));
+				__m128i	greenD = _mm_add_epi16(_mm_slli_epi16(_mm_add_epi16(n, s), 3), _mm_sub_epi16(gH2, _mm_slli_epi16(gV2, 1)));
+				greenC = _mm_srai_epi16(_mm_add_epi16(base, greenC), 4);
+				greenD = _mm_srai_epi16(_mm_add_epi16(base, greenD), 4);
+
+				__m128i	c = selectLanes(siteMask, center, greenC);
+				__m128i	g = selectLanes(siteMask, chromaG, center);
+				__m128i	d = selectLanes(siteMask, chromaD, greenD);
+				_mm_storeu_si128((__m128i *)cBuf, _mm_min_epi16(_mm_max_epi16(c, zero), maxValue));
+				_mm_storeu_si128((__m128i *)gBuf, _mm_min_epi16(_mm_max_epi16(g, zero), maxValue));
+				_mm_storeu_si128((__m128i *)dBuf, _mm_min_epi16(_mm_max_epi16(d, zero), maxValue));
+				storeLanes(cBuf, gBuf, dBuf, LANES, inIsRedRow, inLut, inLutSize, outDst + x * 3);
+			}
+			return x;
+		}
+		// ---------------------------------------------------------------------
+		// demosaicEdgeAwareRowSSE2 (16bit)
+		// ---------------------------------------------------------------------
+		//	The same for 4 pixels at a time in 32bit lanes. SSE2 has no
+		//	32bit multiply, min or max, so those are done with shifts and
+		//	compares.
+		static int	demosaicEdgeAwareRowSSE2(const unsigned short *inRows[5], int inX, int inEndX,
+								bool inIsRedRow, int inChromaParity,
+								const unsigned char *inLut, int inLutSize, unsigned char *outDst)
+		{
+			const int	LANES = 4;
+			__m128i		zero = _mm_setzero_si128();
+			__m128i		siteMask = (inChromaParity == (inX & 1)) ?
+										_mm_set_epi32(0, -1, 0, -1) : _mm_set_epi32(-1, 0, -1, 0);
+			__m128i		maxValue = _mm_set1_epi32(inLutSize - 1);
+			int			cBuf[LANES], gBuf[LANES], dBuf[LANES];
+			int			x = inX;
+
+			for (; x + LANES <= inEndX; x += LANES)
+			{
+				__m128i	n2 = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *)(inRows[0] + x)), zero);
+				__m128i	nw = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *)(inRows[1] + x - 1)), zero);
+				__m128i	n = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *)(inRows[1] + x)), zero);
+				__m128i	ne = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *)(inRows[1] + x + 1)), zero);
+				__m128i	w2 = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *)(inRows[2] + x - 2)), zero);
+				__m128i	w = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *)(inRows[2] + x - 1)), zero);
+				__m128i	center = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *)(inRows[2] + x)), zero);
+				__m128i	e = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *)(inRows[2] + x + 1)), zero);
+				__m128i	e2 = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *)(inRows[2] + x + 2)), zero);
+				__m128i	sw = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *)(inRows[3] + x - 1)), zero);
+				__m128i	s = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *)(inRows[3] + x)), zero);
+				__m128i	se = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *)(inRows[3] + x + 1)), zero);
+				__m128i	s2 = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *)(inRows[4] + x)), zero);
+
+				__m128i	diag = _mm_add_epi32(_mm_add_epi32(nw, ne), _mm_add_epi32(sw, se));
+				__m128i	gH2 = _mm_add_epi32(w2, e2);
+				__m128i	gV2 = _mm_add_epi32(n2, s2);
+				__m128i	center2 = _mm_add_epi32(center, center);
+
+				// chroma site
+				__m128i	lapH = _mm_sub_epi32(center2, gH2);
+				__m128i	lapV = _mm_sub_epi32(center2, gV2);
+				__m128i	gradH = _mm_add_epi32(absEpi32(_mm_sub_epi32(w, e)), absEpi32(lapH));
+				__m128i	gradV = _mm_add_epi32(absEpi32(_mm_sub_epi32(n, s)), absEpi32(lapV));
+				__m128i	gH = _mm_add_epi32(_mm_slli_epi32(_mm_add_epi32(w, e), 1), lapH);
+				__m128i	gV = _mm_add_epi32(_mm_slli_epi32(_mm_add_epi32(n, s), 1), lapV);
+				__m128i	chromaG = selectLanes(_mm_cmplt_epi32(gradH, gradV),
+									_mm_srai_epi32(_mm_add_epi32(gH, _mm_set1_epi32(2)), 2),
+									selectLanes(_mm_cmplt_epi32(gradV, gradH),
+										_mm_srai_epi32(_mm_add_epi32(gV, _mm_set1_epi32(2)), 2),
+										_mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(gH, gV), _mm_set1_epi32(4)), 3)));
+				__m128i	axial2 = _mm_add_epi32(gH2, gV2);
+				__m128i	chromaD = _mm_add_epi32(_mm_add_epi32(_mm_slli_epi32(center, 3), _mm_slli_epi32(center, 2)),
+									_mm_slli_epi32(diag, 2));		// 12 * center + 4 * diag
+				chromaD = _mm_sub_epi32(chromaD, _mm_add_epi32(_mm_slli_epi32(axial2, 1), axial2));
+				chromaD = _mm_srai_epi32(_mm_add_epi32(chromaD, _mm_set1_epi32(8)), 4);
+
+				// green site
+				__m128i	base = _mm_add_epi32(_mm_slli_epi32(center, 3), _mm_slli_epi32(center, 1));	// 10 * center
+				base = _mm_add_epi32(_mm_sub_epi32(base, _mm_slli_epi32(diag, 1)), _mm_set1_epi32(8));
+				__m128i	greenC = _mm_add_epi32(_mm_slli_epi32(_mm_add_epi32(w, e), 3), _mm_sub_epi32(gV2, _mm_slli_epi32(gH2, 1)));
+				__m128i	greenD = _mm_add_epi32(_mm_slli_epi32(_mm_add_epi32(n, s), 3), _mm_sub_epi32(gH2, _mm_slli_epi32(gV2, 1)));
+				greenC = _mm_srai_epi32(_mm_add_epi32(base, greenC), 4);
+				greenD = _mm_srai_epi32(_mm_add_epi32(base, greenD), 4);
+
+				__m128i	c = selectLanes(siteMask, center, greenC);
+				__m128i	g = selectLanes(siteMask, chromaG, center);
+				__m128i	d = selectLanes(siteMask, chromaD, greenD);
+				_mm_storeu_si128((__m128i *)cBuf, clampEpi32(c, maxValue));
+				_mm_storeu_si128((__m128i *)gBuf, clampEpi32(g, maxValue));
+				_mm_storeu_si128((__m128i *)dBuf, clampEpi32(d, maxValue));
+				storeLanes(cBuf, gBuf, dBuf, LANES, inIsRedRow, inLut, inLutSize, outDst + x * 3);
+			}
+			return x;
+		}
+		// ---------------------------------------------------------------------
+		// absEpi16
+		// ---------------------------------------------------------------------
+		static __m128i	absEpi16(__m128i inV)
+		{
+			return _mm_max_epi16(inV, _mm_sub_epi16(_mm_setzero_si128(), inV));
+		}
+		// ---------------------------------------------------------------------
+		// absEpi32
+		// ---------------------------------------------------------------------
+		static __m128i	absEpi32(__m128i inV)
+		{
+			__m128i	sign = _mm_srai_epi32(inV, 31);
+			return _mm_sub_epi32(_mm_xor_si128(inV, sign), sign);
+		}
+		// ---------------------------------------------------------------------
+		// clampEpi32
+		// ---------------------------------------------------------------------
+		//	[0, inMax] per 32bit lane
+		static __m128i	clampEpi32(__m128i inV, __m128i inMax)
+		{
+			inV = _mm_andnot_si128(_mm_srai_epi32(inV, 31), inV);
+			return selectLanes(_mm_cmpgt_epi32(inV, inMax), inMax, inV);
+		}
+		// ---------------------------------------------------------------------
+		// selectLanes
+		// ---------------------------------------------------------------------
+		//	inA where inMask is set, inB elsewhere
+		static __m128i	selectLanes(__m128i inMask, __m128i inA, __m128i inB)
+		{
+			return _mm_or_si128(_mm_and_si128(inMask, inA), _mm_andnot_si128(inMask, inB));
+		}
+		// ---------------------------------------------------------------------
+		// average4
+		// ---------------------------------------------------------------------
+		//	(a + b + c + d + 2) >> 2 per 8bit lane, rounded as computePixel()
+		//	does (nested _mm_avg_epu8 would round up twice)
+		static __m128i	average4(__m128i inA, __m128i inB, __m128i inC, __m128i inD)
+		{
+			__m128i	zero = _mm_setzero_si128();
+			__m128i	two = _mm_set1_epi16(2);
+			__m128i	lo = _mm_add_epi16(_mm_add_epi16(_mm_unpacklo_epi8(inA, zero), _mm_unpacklo_epi8(inB, zero)),
+							_mm_add_epi16(_mm_unpacklo_epi8(inC, zero), _mm_unpacklo_epi8(inD, zero)));
+			__m128i	hi = _mm_add_epi16(_mm_add_epi16(_mm_unpackhi_epi8(inA, zero), _mm_unpackhi_epi8(inB, zero)),
+							_mm_add_epi16(_mm_unpackhi_epi8(inC, zero), _mm_unpackhi_epi8(inD, zero)));
+			lo = _mm_srli_epi16(_mm_add_epi16(lo, two), 2);
+			hi = _mm_srli_epi16(_mm_add_epi16(hi, two), 2);
+			return _mm_packus_epi16(lo, hi);
+		}
+		// ---------------------------------------------------------------------
+		// average4Epu16
+		// ---------------------------------------------------------------------
+		//	The same per 16bit lane, summed in 32bit
+		static __m128i	average4Epu16(__m128i inA, __m128i inB, __m128i inC, __m128i inD)
+		{
+			__m128i	zero = _mm_setzero_si128();
+			__m128i	two = _mm_set1_epi32(2);
+			__m128i	lo = _mm_add_epi32(_mm_add_epi32(_mm_unpacklo_epi16(inA, zero), _mm_unpacklo_epi16(inB, zero)),
+							_mm_add_epi32(_mm_unpacklo_epi16(inC, zero), _mm_unpacklo_epi16(inD, zero)));
+			__m128i	hi = _mm_add_epi32(_mm_add_epi32(_mm_unpackhi_epi16(inA, zero), _mm_unpackhi_epi16(inB, zero)),
+							_mm_add_epi32(_mm_unpackhi_epi16(inC, zero), _mm_unpackhi_epi16(inD, zero)));
+			lo = _mm_srli_epi32(_mm_add_epi32(lo, two), 2);
+			hi = _mm_srli_epi32(_mm_add_epi32(hi, two), 2);
+
+			// SSE2 has no unsigned 32 to 16bit pack, bias into the signed range
+			__m128i	bias = _mm_set1_epi32(0x8000);
+			__m128i	packed = _mm_packs_epi32(_mm_sub_epi32(lo, bias), _mm_sub_epi32(hi, bias));
+			return _mm_xor_si128(packed, _mm_set1_epi16((short )0x8000));
+		}
+		// ---------------------------------------------------------------------
+		// storeSelected
+		// ---------------------------------------------------------------------
+		template <typename LaneType>
+		static void	storeSelected(LaneType *outBuf, __m128i inMask, __m128i inSite, __m128i inOther)
+		{
+			__m128i	v = _mm_or_si128(_mm_and_si128(inMask, inSite), _mm_andnot_si128(inMask, inOther));
+			_mm_storeu_si128((__m128i *)outBuf, v);
+		}
+		// ---------------------------------------------------------------------
+		// storeLanes
+		// ---------------------------------------------------------------------
+		template <typename LaneType>
+		static void	storeLanes(const LaneType *inC, const LaneType *inG, const LaneType *inD, int inNum,
+								bool inIsRedRow, const unsigned char *inLut, int inLutSize,
+								unsigned char *outDst)
+		{
+			const LaneType	*rPtr = inIsRedRow ? inC : inD;
+			const LaneType	*bPtr = inIsRedRow ? inD : inC;
+			const unsigned char	*lutB = inLut;
+			const unsigned char	*lutG = inLut + inLutSize;
+			const unsigned char	*lutR = inLut + inLutSize * 2;
+
+			for (int i = 0; i < inNum; i++, outDst += 3)
+			{
+				outDst[0] = lutB[bPtr[i]];
+				outDst[1] = lutG[inG[i]];
+				outDst[2] = lutR[rPtr[i]];
+			}
+		}
+	#endif
+	};
+ };
+};
+
+#endif	// #ifdef VIW_UTIL_DEMOSAIC_H
@@ -0,0 +1,401 @@
+// =============================================================================
+//  Dither.hpp
+//
+//  Written in 2014 by Dairoku Sekiguchi (sekiguchi at acm dot org)
+//
+//  To the extent possible under law, the author(s) have dedicated all copyright
+//  and related and neighboring rights to this software to the public domain worldwide.
+//  This software is distributed without any warranty.
+//
+//  You should have received a copy of the CC0 Public Domain Dedication along with
+//  this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+// =============================================================================
+/*!
+	\file		viw/utils/Dither.h
+	\author		Dairoku Sekiguchi
+	\version	1.0.0
+	\date		2026/10/19
+	\brief		Header file for viw library types
+
+	This file defines the dithered value mapping kernels for viw library
+*/
+
+#ifndef VIW_UTIL_DITHER_H
+#define VIW_UTIL_DITHER_H
+
+// Includes --------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include "viw/Exception.hpp"
+#include "viw/utils/CpuFeatures.hpp"
+
+// Macros ----------------------------------------------------------------------
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define	VIW_DITHER_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+
+// Namespace -------------------------------------------------------------------
+namespace viw
+{
+ namespace utils
+ {
+	// -------------------------------------------------------------------------
+	// Dither class
+	// -------------------------------------------------------------------------
+	//	Maps high bit depth lines to 8bit as floor((v - min) * scale + t), where
+	//	t comes from a threshold tile indexed by the buffer position. Without
+	//	dithering t is 0.5 (rounding), so both cases run the same kernel and
+	//	dithering costs only the threshold loads. The tiles are fixed, so the
+	//	same input always gives the same output (no temporal shimmer).
+	class	Dither
+	{
+	public:
+		// Constatns -----------------------------------------------------------
+		enum DitherMode
+		{
+			DITHER_NONE				= 0,
+			DITHER_ORDERED,			// 8x8 Bayer matrix
+			DITHER_BLUE_NOISE		// 32x32 void-and-cluster tile
+		};
+		const static int	THRESHOLD_ROW_SIZE		= 32;
+
+		// Static Functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// obtainThresholdRow
+		// ---------------------------------------------------------------------
+		//	Fills THRESHOLD_ROW_SIZE thresholds in [0, 1) for line inY
+		static void	obtainThresholdRow(DitherMode inMode, int inY, float *outRow)
+		{
+			switch (inMode)
+			{
+				case DITHER_ORDERED:
+				{
+					const unsigned char	*row = obtainBayerMatrix() + (inY & 7) * 8;
+					for (int i = 0; i < THRESHOLD_ROW_SIZE; i++)
+						outRow[i] = (row[i & 7] + 0.5f) / 64.0f;
+					break;
+				}
+				case DITHER_BLUE_NOISE:
+				{
+					const unsigned char	*row = obtainBlueNoiseTable() + (inY & 31) * 32;
+					for (int i = 0; i < THRESHOLD_ROW_SIZE; i++)
+						outRow[i] = (row[i] + 0.5f) / 256.0f;
+					break;
+				}
+				default:	// DITHER_NONE
+					for (int i = 0; i < THRESHOLD_ROW_SIZE; i++)
+						outRow[i] = 0.5f;
+					break;
+			}
+		}
+		// ---------------------------------------------------------------------
+		// mapLineLinear
+		// ---------------------------------------------------------------------
+		//	inThresholdRow is indexed by the element position in the line
+		template <typename ImageBufferType>
+		static void	mapLineLinear(const ImageBufferType *inSrc, int inCount,
+								float inMin, float inScale,
+								const float *inThresholdRow, unsigned char *outDst)
+		{
+			mapLineLinearScalar(inSrc, 0, inCount, inMin, inScale, inThresholdRow, outDst);
+		}
+		// ---------------------------------------------------------------------
+		// mapLineLinear (16bit)
+		// ---------------------------------------------------------------------
+		static void	mapLineLinear(const unsigned short *inSrc, int inCount,
+								float inMin, float inScale,
+								const float *inThresholdRow, unsigned char *outDst)
+		{
+			static const MapLine16Func	mapLineFunc = selectMapLine16Func();
+
+			int	x = mapLineFunc(inSrc, inCount, inMin, inScale, inThresholdRow, outDst);
+			mapLineLinearScalar(inSrc, x, inCount, inMin, inScale, inThresholdRow, outDst);
+		}
+		// ---------------------------------------------------------------------
+		// mapLineLinear (float)
+		// ---------------------------------------------------------------------
+		static void	mapLineLinear(const float *inSrc, int inCount,
+								float inMin, float inScale,
+								const float *inThresholdRow, unsigned char *outDst)
+		{
+			static const MapLineFloatFunc	mapLineFunc = selectMapLineFloatFunc();
+
+			int	x = mapLineFunc(inSrc, inCount, inMin, inScale, inThresholdRow, outDst);
+			mapLineLinearScalar(inSrc, x, inCount, inMin, inScale, inThresholdRow, outDst);
+		}
+
+	private:
+		// Typedefs ------------------------------------------------------------
+		//	The vector variants return the first x left for the scalar loop.
+		//	All variants compute the same float expression, so they give
+		//	exactly the same output.
+		typedef int	(*MapLine16Func)(const unsigned short *inSrc, int inCount,
+								float inMin, float inScale,
+								const float *inThresholdRow, unsigned char *outDst);
+		typedef int	(*MapLineFloatFunc)(const float *inSrc, int inCount,
+								float inMin, float inScale,
+								const float *inThresholdRow, unsigned char *outDst);
+
+		// Static Functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// selectMapLine16Func
+		// ---------------------------------------------------------------------
+		static MapLine16Func	selectMapLine16Func()
+		{
+		#ifdef VIW_CPU_X86_DISPATCH
+			if (CpuFeatures::isEnabled(CpuFeatures::ISA_AVX2))
+				return mapLine16AVX2;
+		#endif
+		#ifdef VIW_DITHER_USE_SSE2
+			if (CpuFeatures::isEnabled(CpuFeatures::ISA_SSE2))
+				return mapLine16SSE2;
+		#endif
+			return mapLineNone;
+		}
+		// ---------------------------------------------------------------------
+		// selectMapLineFloatFunc
+		// ---------------------------------------------------------------------
+		static MapLineFloatFunc	selectMapLineFloatFunc()
+		{
+		#ifdef VIW_CPU_X86_DISPATCH
+			if (CpuFeatures::isEnabled(CpuFeatures::ISA_AVX2))
+				return mapLineFloatAVX2;
+		#endif
+		#ifdef VIW_DITHER_USE_SSE2
+			if (CpuFeatures::isEnabled(CpuFeatures::ISA_SSE2))
+				return mapLineFloatSSE2;
+		#endif
+			return mapLineNone;
+		}
+		// ---------------------------------------------------------------------
+		// mapLineNone
+		// ---------------------------------------------------------------------
+		template <typename ImageBufferType>
+		static int	mapLineNone(const ImageBufferType *, int, float, float,
+								const float *, unsigned char *)
+		{
+			return 0;
+		}
+		// ---------------------------------------------------------------------
+		// mapLineLinearScalar
+		// ---------------------------------------------------------------------
+		template <typename ImageBufferType>
+		static void	mapLineLinearScalar(const ImageBufferType *inSrc, int inStartX, int inEndX,
+								float inMin, float inScale,
+								const float *inThresholdRow, unsigned char *outDst)
+		{
+			for (int x = inStartX; x < inEndX; x++)
+			{
+				float	v = ((float )inSrc[x] - inMin) * inScale +
+								inThresholdRow[x & (THRESHOLD_ROW_SIZE - 1)];
+				if (!(v > 0))		// also catches NaN
+					outDst[x] = 0;
+				else if (v >= 255.0f)
+					outDst[x] = 255;
+				else
+					outDst[x] = (unsigned char )v;
+			}
+		}
+	#ifdef VIW_DITHER_USE_SSE2
+		// ---------------------------------------------------------------------
+		// mapLine16SSE2
+		// ---------------------------------------------------------------------
+		static int	mapLine16SSE2(const unsigned short *inSrc, int inCount,
+								float inMin, float inScale,
+								const float *inThresholdRow, unsigned char *outDst)
+		{
+			const __m128i	zero = _mm_setzero_si128();
+			int	x = 0;
+
+			for (; x + 16 <= inCount; x += 16)
+			{
+				__m128i	a = _mm_loadu_si128((const __m128i *)(inSrc + x));
+				__m128i	b = _mm_loadu_si128((const __m128i *)(inSrc + x + 8));
+				__m128	f[4];
+				f[0] = _mm_cvtepi32_ps(_mm_unpacklo_epi16(a, zero));
+				f[1] = _mm_cvtepi32_ps(_mm_unpackhi_epi16(a, zero));
+				f[2] = _mm_cvtepi32_ps(_mm_unpacklo_epi16(b, zero));
+				f[3] = _mm_cvtepi32_ps(_mm_unpackhi_epi16(b, zero));
+				storeMapped16(f, x, inMin, inScale, inThresholdRow, outDst);
+			}
+			return x;
+		}
+		// ---------------------------------------------------------------------
+		// mapLineFloatSSE2
+		// ---------------------------------------------------------------------
+		static int	mapLineFloatSSE2(const float *inSrc, int inCount,
+								float inMin, float inScale,
+								const float *inThresholdRow, unsigned char *outDst)
+		{
+			int	x = 0;
+
+			for (; x + 16 <= inCount; x += 16)
+			{
+				__m128	f[4];
+				f[0] = _mm_loadu_ps(inSrc + x);
+				f[1] = _mm_loadu_ps(inSrc + x + 4);
+				f[2] = _mm_loadu_ps(inSrc + x + 8);
+				f[3] = _mm_loadu_ps(inSrc + x + 12);
+				storeMapped16(f, x, inMin, inScale, inThresholdRow, outDst);
+			}
+			return x;
+		}
+		// ---------------------------------------------------------------------
+		// storeMapped16
+		// ---------------------------------------------------------------------
+		static void	storeMapped16(__m128 *ioValues, int inX, float inMin, float inScale,
+								const float *inThresholdRow, unsigned char *outDst)
+		{
+			const __m128	minValue = _mm_set1_ps(inMin);
+			const __m128	scale = _mm_set1_ps(inScale);
+			const __m128	zero = _mm_setzero_ps();
+			const __m128	maxValue = _mm_set1_ps(255.0f);
+			const float		*thr = inThresholdRow + (inX & (THRESHOLD_ROW_SIZE - 1));
+			__m128i			n[4];
+
+			for (int i = 0; i < 4; i++)
+			{
+				__m128	v = _mm_mul_ps(_mm_sub_ps(ioValues[i], minValue), scale);
+				v = _mm_add_ps(v, _mm_loadu_ps(thr + i * 4));
+				v = _mm_min_ps(_mm_max_ps(v, zero), maxValue);	// NaN -> 0
+				n[i] = _mm_cvttps_epi32(v);
+			}
+			__m128i	lo = _mm_packs_epi32(n[0], n[1]);
+			__m128i	hi = _mm_packs_epi32(n[2], n[3]);
+			_mm_storeu_si128((__m128i *)(outDst + inX), _mm_packus_epi16(lo, hi));
+		}
+	#endif
+	#ifdef VIW_CPU_X86_DISPATCH
+		// ---------------------------------------------------------------------
+		// mapLine16AVX2
+		// ---------------------------------------------------------------------
+		VIW_TARGET_AVX2
+		static int	mapLine16AVX2(const unsigned short *inSrc, int inCount,
+								float inMin, float inScale,
+								const float *inThresholdRow, unsigned char *outDst)
+		{
+			int	x = 0;
+
+			for (; x + 32 <= inCount; x += 32)
+			{
+				__m256	f[4];
+				for (int i = 0; i < 4; i++)
+					f[i] = _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(
+								_mm_loadu_si128((const __m128i *)(inSrc + x + i * 8))));
+				storeMapped32AVX2(f, x, inMin, inScale, inThresholdRow, outDst);
+			}
+			return x;
+		}
+		// ---------------------------------------------------------------------
+		// mapLineFloatAVX2
+		// ---------------------------------------------------------------------
+		VIW_TARGET_AVX2
+		static int	mapLineFloatAVX2(const float *inSrc, int inCount,
+								float inMin, float inScale,
+								const float *inThresholdRow, unsigned char *outDst)
+		{
+			int	x = 0;
+
+			for (; x + 32 <= inCount; x += 32)
+			{
+				__m256	f[4];
+				for (int i = 0; i < 4; i++)
+					f[i] = _mm256_loadu_ps(inSrc + x + i * 8);
+				storeMapped32AVX2(f, x, inMin, inScale, inThresholdRow, outDst);
+			}
+			return x;
+		}
+		// ---------------------------------------------------------------------
+		// storeMapped32AVX2
+		// ---------------------------------------------------------------------
+		//	inX is a multiple of THRESHOLD_ROW_SIZE (32)
+		VIW_TARGET_AVX2
+		static void	storeMapped32AVX2(__m256 *ioValues, int inX, float inMin, float inScale,
+								const float *inThresholdRow, unsigned char *outDst)
+		{
+			const __m256	minValue = _mm256_set1_ps(inMin);
+			const __m256	scale = _mm256_set1_ps(inScale);
+			const __m256	zero = _mm256_setzero_ps();
+			const __m256	maxValue = _mm256_set1_ps(255.0f);
+			__m256i			n[4];
+
+			for (int i = 0; i < 4; i++)
+			{
+				// no FMA, so the result matches the SSE2 and scalar code
+				__m256	v = _mm256_mul_ps(_mm256_sub_ps(ioValues[i], minValue), scale);
+				v = _mm256_add_ps(v, _mm256_loadu_ps(inThresholdRow + i * 8));
+				v = _mm256_min_ps(_mm256_max_ps(v, zero), maxValue);	// NaN -> 0
+				n[i] = _mm256_cvttps_epi32(v);
+			}
+			// the packs work per 128bit lane, a dword permute restores the order
+			__m256i	packed = _mm256_packus_epi16(_mm256_packs_epi32(n[0], n[1]),
+												 _mm256_packs_epi32(n[2], n[3]));
+			packed = _mm256_permutevar8x32_epi32(packed, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+			_mm256_storeu_si256((__m256i *)(outDst + inX), packed);
+		}
+	#endif
+		// ---------------------------------------------------------------------
+		// obtainBayerMatrix
+		// ---------------------------------------------------------------------
+		static const unsigned char	*obtainBayerMatrix()
+		{
+			static const unsigned char	matrix[64] = {
+				 0, 32,  8, 40,  2, 34, 10, 42,
+				48, 16, 56, 24, 50, 18, 58, 26,
+				12, 44,  4, 36, 14, 46,  6, 38,
+				60, 28, 52, 20, 62, 30, 54, 22,
+				 3, 35, 11, 43,  1, 33,  9, 41,
+				51, 19, 59, 27, 49, 17, 57, 25,
+				15, 47,  7, 39, 13, 45,  5, 37,
+				63, 31, 55, 23, 61, 29, 53, 21 };
+			return matrix;
+		}
+		// ---------------------------------------------------------------------
+		// obtainBlueNoiseTable
+		// ---------------------------------------------------------------------
+		//	32x32 tile made with the void-and-cluster method (sigma = 1.5),
+		//	ranks scaled to 0 - 255
+		static const unsigned char	*obtainBlueNoiseTable()
+		{
+			static const unsigned char	table[32 * 32] = {
+				147, 106, 178, 251, 129,  96,  35,  11, 108,  44,  91,   6, 192, 140, 249,  22, 129,  58, 215, 151, 240,  88, 225, 146, 198,  33,  58, 230, 162,  89, 131,   9,
+				 31, 233,  81,   7,  57, 167, 243, 205, 134, 224, 174, 242, 115,  32,  97, 154, 179, 235, 113,  70,  24, 185,  47,  66, 115, 176, 149,   7, 184,  43, 250, 197,
+				118,  50, 194, 143, 210, 112,  68, 151,  83,  21,  58, 150,  74, 218,  51, 225,   2,  95,  38, 167, 206, 100, 137, 215,  16, 255, 101,  76, 223, 111,  61, 173,
+				217, 133,  19,  90, 236,  23, 179,  49, 232, 192, 102, 207,  12, 135, 188, 118,  77, 201, 142, 252, 125,   8, 237, 161,  86, 193,  46, 208, 135,  22, 155,  92,
+				 70, 247, 181, 160,  42, 131, 202,   0, 116, 142,  37, 168, 254,  88, 162,  40, 241, 172,  19,  55,  82, 182,  37,  62, 130,  30, 119, 163,  67, 188, 235,   2,
+				149,  31, 107, 228,  71,  99, 252, 166,  87, 239,  70, 121,  29,  62, 198,  14, 131,  67, 220, 116, 157, 231, 106, 200, 243, 172, 226,  12, 247,  39, 122, 200,
+				 83, 209,  59,   7, 196, 144,  28,  60, 213,  16, 176, 222, 145, 214,  96, 226, 156,  99, 190,  41, 212,  18,  69, 147,   0,  55, 104,  78, 142,  94, 171,  49,
+				239, 128, 154, 175, 114, 223,  82, 153, 122, 195,  52, 104,   4, 180, 124,  56,  31, 249,   5, 138,  90, 169, 124, 216,  86, 185, 154, 195, 216,  24, 223, 110,
+				180,  26,  92, 248,  18,  49, 185, 243,  40,  92, 159, 245,  78,  44, 240, 168,  81, 179, 111, 235, 196,  52, 253,  39, 113, 234,  18,  43, 123,  63, 155,  10,
+				204,  47, 219,  71, 135, 211, 105,   6, 139, 231,  26, 132, 206, 152,  20, 116, 208, 148,  64,  24,  77, 151,  13, 177, 203,  73, 136, 244,  97, 187, 254,  76,
+				137, 166, 117, 186,  32, 161,  61, 177, 208,  74, 182,  61, 109, 190,  91, 234,  11,  46, 226, 186, 119, 238,  99, 132,  27, 162,  53, 208,   4, 144,  41, 104,
+				237,  60,   2, 244,  98, 228,  84, 127,  22, 113, 224,  10, 250,  34, 140,  65, 193, 130,  88, 164,  38, 200,  65, 218,  87, 236, 106, 170,  83, 222, 175,  27,
+				 84, 152, 206,  75, 143,  15, 202, 254,  53, 170, 143,  87, 163,  54, 212, 169, 107, 255,  17, 215, 141,   3, 171,  46, 145,  10, 199,  34, 127,  59, 114, 213,
+				130,  21, 173,  45, 181, 112,  38, 141, 101, 213,  40, 194, 125, 228,   1,  82,  33, 156,  54, 103,  74, 227, 114, 250, 190, 122,  66, 247, 148, 233,  11, 191,
+				252,  96, 121, 239, 218,  63, 165, 191,   4,  75, 240,  18,  69,  98, 183, 240, 138, 199, 229, 175, 127,  41, 157,  76,  29, 217,  93, 184,  20,  79, 158,  47,
+				 67, 212,  32,  84,   8, 132, 246,  87, 225, 159, 109, 136, 203, 149,  43, 110,  68,   9,  91,  25, 242, 204,  13, 103, 169, 139,  43, 161, 112, 205, 101, 177,
+				  5, 186, 138, 160, 192, 101,  23,  52, 125,  34, 183,  57, 251,  28, 220, 162, 210, 121, 186, 149,  57,  85, 187, 230,  58, 243,   1, 223,  54, 244,  34, 142,
+				238, 111,  51, 232,  69, 213, 152, 180, 209,  73, 229,   8, 166,  89, 130,  16,  55, 248,  37, 216, 109, 166, 132,  26, 118, 196,  90, 128, 193,  72, 123, 218,
+				 29,  78, 170,  19, 122,  36, 241, 108,  13, 146,  94, 199, 119,  64, 237, 194,  83, 171, 135,  72,   4, 253,  45, 210, 153,  71, 176,  28, 151,  14, 168,  89,
+				157, 203, 253,  95, 196, 141,  60,  82, 164, 248,  48, 139, 217,  37, 178, 103, 146,  22,  98, 227, 195, 148,  80,  99,   9, 219,  45, 251, 102, 232, 189,  53,
+				129,  12, 143,  44, 225,   0, 188, 215,  31, 115, 191,  20,  80, 156,   2, 221,  46, 244, 180,  50, 117,  28, 183, 239, 167, 112, 134, 201,  81,  42, 113, 214,
+				 96,  66, 183, 119,  76, 172,  98, 131, 227,  69, 174, 232, 111, 253, 128,  73, 205, 120,  10, 156,  66, 222, 126,  59,  35, 234,  65,  17, 173, 144,   3, 246,
+				 33, 209, 231,  17, 152, 245,  23,  52, 147,   6,  95,  42, 205,  57, 171,  30, 160,  86, 192, 234,  93, 207,  14, 145, 195,  94, 154, 216, 117, 227,  75, 165,
+				126, 159,  54, 100, 198,  63, 123, 207, 178, 246, 160, 133,  15,  86, 197, 108, 236,  60,  25, 125,  36, 167, 106, 247,  73,   5, 179,  51,  29, 184,  56, 198,
+				 19,  85, 248, 140,  35, 164, 228,  90,  39,  74, 114, 224, 182, 145, 242,   7, 136, 214, 150, 251, 182,  81,  49, 159, 123, 220, 105, 255, 133,  93, 241, 108,
+				226, 189,   6, 115, 221,  80,   9, 109, 189,  20, 200,  59,  30, 103,  48,  71, 181,  95,  47, 107,   0, 203, 231,  21, 199,  41, 146,  77, 202,  12, 153,  42,
+				176,  67, 150, 204,  50, 181, 255, 157, 126, 237,  88, 150, 233, 206, 168, 124, 222,  17, 164, 209,  62, 120, 141,  97, 175,  65, 229,  25, 163,  61, 214, 137,
+				 30, 104, 230,  23,  92, 138,  32,  64, 219,  48, 170,   1, 121,  80,  21, 254,  40, 194,  79, 136, 242, 173,  38,  75, 245,   8, 128, 187, 102, 238, 118,  79,
+				252, 161,  56, 127, 174, 212, 100, 193,  15, 139, 102, 246,  63, 188, 158,  91, 147, 116, 230,  27,  93,  14, 191, 221, 148, 110, 211,  85,  36, 174,   1, 201,
+				133,  13, 190, 241,  72,   3, 235, 120,  84, 178, 202,  35, 217, 134,  45, 211,   5,  64, 177,  50, 219, 153, 107,  55,  26, 165,  48, 249, 144, 220,  53,  97,
+				 39, 224,  89, 117,  44, 163, 140,  51, 249,  24,  72, 155, 105,  16, 233, 110, 165, 245, 137, 100, 201,  68, 250, 129, 207,  77, 185,  15,  68, 120, 158, 184,
+				210,  62, 155,  25, 197, 221,  79, 187, 158, 211, 126, 229,  56, 172,  70, 197,  85,  33, 189,  11, 124,  36, 169,   3,  94, 238, 134, 105, 204,  27, 236,  78 };
+			return table;
+		}
+	};
+ };
+};
+
+#endif	// #ifdef VIW_UTIL_DITHER_H
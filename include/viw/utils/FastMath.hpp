@@ -0,0 +1,258 @@
+// =============================================================================
+//  FastMath.hpp
+//
+//  Written in 2014 by Dairoku Sekiguchi (sekiguchi at acm dot org)
+//
+//  To the extent possible under law, the author(s) have dedicated all copyright
+//  and related and neighboring rights to this software to the public domain worldwide.
+//  This software is distributed without any warranty.
+//
+//  You should have received a copy of the CC0 Public Domain Dedication along with
+//  this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+// =============================================================================
+/*!
+	\file		viw/utils/FastMath.h
+	\author		Dairoku Sekiguchi
+	\version	1.0.0
+	\date		2026/10/19
+	\brief		Header file for viw library types
+
+	This file defines the approximated math functions for viw library
+*/
+
+#ifndef VIW_UTIL_FASTMATH_H
+#define VIW_UTIL_FASTMATH_H
+
+// Includes --------------------------------------------------------------------
+#include <string.h>
+#include <math.h>
+
+// Macros ----------------------------------------------------------------------
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define	VIW_FASTMATH_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+
+// Namespace -------------------------------------------------------------------
+namespace viw
+{
+ namespace utils
+ {
+	// -------------------------------------------------------------------------
+	// FastMath class
+	// -------------------------------------------------------------------------
+	//	Polynomial approximations that are good enough for 8bit display values
+	//	(log2 : 2e-5, exp2 : 3e-7 relative, atan2 : 7e-5 rad). The scalar and
+	//	the SSE2 versions use the same polynomials, so both give the same
+	//	display values.
+	class	FastMath
+	{
+	public:
+		// Constatns -----------------------------------------------------------
+		static float	pi()	{ return 3.14159265358979f; }
+
+		// Static Functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// log2
+		// ---------------------------------------------------------------------
+		//	inValue must be a positive normal number
+		static float	log2(float inValue)
+		{
+			int	bits;
+			::memcpy(&bits, &inValue, sizeof(bits));
+			int	exponent = ((bits >> 23) & 0xFF) - 127;
+			bits = (bits & 0x007FFFFF) | 0x3F800000;
+			float	m;
+			::memcpy(&m, &bits, sizeof(m));
+			m -= 1.0f;
+			return (float )exponent + m * log2Poly(m);
+		}
+		// ---------------------------------------------------------------------
+		// exp2
+		// ---------------------------------------------------------------------
+		static float	exp2(float inValue)
+		{
+			if (inValue < -126.0f)
+				inValue = -126.0f;
+			if (inValue > 127.0f)
+				inValue = 127.0f;
+			float	fi = (float )(int )inValue;
+			if (fi > inValue)
+				fi -= 1.0f;
+			float	f = inValue - fi;
+			int		bits = ((int )fi + 127) << 23;
+			float	scale;
+			::memcpy(&scale, &bits, sizeof(scale));
+			return exp2Poly(f) * scale;
+		}
+		// ---------------------------------------------------------------------
+		// pow
+		// ---------------------------------------------------------------------
+		//	inValue must be positive
+		static float	pow(float inValue, float inExponent)
+		{
+			return exp2(inExponent * log2(inValue));
+		}
+		// ---------------------------------------------------------------------
+		// atan2
+		// ---------------------------------------------------------------------
+		static float	atan2(float inY, float inX)
+		{
+			float	ax = fabsf(inX);
+			float	ay = fabsf(inY);
+			float	maxValue = (ax > ay) ? ax : ay;
+			float	minValue = (ax > ay) ? ay : ax;
+			if (maxValue < 1e-30f)
+				maxValue = 1e-30f;
+			float	z = minValue / maxValue;
+			float	a = z * atanPoly(z * z);
+			if (ay > ax)
+				a = pi() * 0.5f - a;
+			if (inX < 0)
+				a = pi() - a;
+			if (inY < 0)
+				a = -a;
+			return a;
+		}
+
+	#ifdef VIW_FASTMATH_USE_SSE2
+		// ---------------------------------------------------------------------
+		// log2_ps
+		// ---------------------------------------------------------------------
+		static __m128	log2_ps(__m128 inValue)
+		{
+			__m128i	bits = _mm_castps_si128(inValue);
+			__m128i	exponent = _mm_sub_epi32(
+								_mm_and_si128(_mm_srli_epi32(bits, 23), _mm_set1_epi32(0xFF)),
+								_mm_set1_epi32(127));
+			__m128	m = _mm_castsi128_ps(_mm_or_si128(
+								_mm_and_si128(bits, _mm_set1_epi32(0x007FFFFF)),
+								_mm_set1_epi32(0x3F800000)));
+			m = _mm_sub_ps(m, _mm_set1_ps(1.0f));
+			const float	*c = obtainLog2Coefficients();
+			__m128	p = _mm_set1_ps(c[5]);
+			p = _mm_add_ps(_mm_mul_ps(p, m), _mm_set1_ps(c[4]));
+			p = _mm_add_ps(_mm_mul_ps(p, m), _mm_set1_ps(c[3]));
+			p = _mm_add_ps(_mm_mul_ps(p, m), _mm_set1_ps(c[2]));
+			p = _mm_add_ps(_mm_mul_ps(p, m), _mm_set1_ps(c[1]));
+			p = _mm_add_ps(_mm_mul_ps(p, m), _mm_set1_ps(c[0]));
+			return _mm_add_ps(_mm_cvtepi32_ps(exponent), _mm_mul_ps(m, p));
+		}
+		// ---------------------------------------------------------------------
+		// exp2_ps
+		// ---------------------------------------------------------------------
+		static __m128	exp2_ps(__m128 inValue)
+		{
+			__m128	x = _mm_min_ps(_mm_max_ps(inValue, _mm_set1_ps(-126.0f)), _mm_set1_ps(127.0f));
+			__m128	fi = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+			fi = _mm_sub_ps(fi, _mm_and_ps(_mm_cmpgt_ps(fi, x), _mm_set1_ps(1.0f)));	// floor
+			__m128	f = _mm_sub_ps(x, fi);
+			const float	*c = obtainExp2Coefficients();
+			__m128i	bits = _mm_slli_epi32(_mm_add_epi32(_mm_cvttps_epi32(fi), _mm_set1_epi32(127)), 23);
+			__m128	p = _mm_set1_ps(c[5]);
+			p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(c[4]));
+			p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(c[3]));
+			p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(c[2]));
+			p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(c[1]));
+			p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(c[0]));
+			return _mm_mul_ps(p, _mm_castsi128_ps(bits));
+		}
+		// ---------------------------------------------------------------------
+		// atan2_ps
+		// ---------------------------------------------------------------------
+		static __m128	atan2_ps(__m128 inY, __m128 inX)
+		{
+			const __m128	signMask = _mm_castsi128_ps(_mm_set1_epi32(0x80000000));
+			__m128	ax = _mm_andnot_ps(signMask, inX);
+			__m128	ay = _mm_andnot_ps(signMask, inY);
+			__m128	maxValue = _mm_max_ps(_mm_max_ps(ax, ay), _mm_set1_ps(1e-30f));
+			__m128	z = _mm_div_ps(_mm_min_ps(ax, ay), maxValue);
+			__m128	z2 = _mm_mul_ps(z, z);
+			const float	*c = obtainAtanCoefficients();
+			__m128	p = _mm_set1_ps(c[4]);
+			p = _mm_add_ps(_mm_mul_ps(p, z2), _mm_set1_ps(c[3]));
+			p = _mm_add_ps(_mm_mul_ps(p, z2), _mm_set1_ps(c[2]));
+			p = _mm_add_ps(_mm_mul_ps(p, z2), _mm_set1_ps(c[1]));
+			p = _mm_add_ps(_mm_mul_ps(p, z2), _mm_set1_ps(c[0]));
+			__m128	a = _mm_mul_ps(z, p);
+			__m128	swapMask = _mm_cmpgt_ps(ay, ax);
+			a = select(swapMask, _mm_sub_ps(_mm_set1_ps(pi() * 0.5f), a), a);
+			__m128	negXMask = _mm_cmplt_ps(inX, _mm_setzero_ps());
+			a = select(negXMask, _mm_sub_ps(_mm_set1_ps(pi()), a), a);
+			__m128	negYMask = _mm_and_ps(_mm_cmplt_ps(inY, _mm_setzero_ps()), signMask);
+			return _mm_xor_ps(a, negYMask);
+		}
+		// ---------------------------------------------------------------------
+		// select
+		// ---------------------------------------------------------------------
+		static __m128	select(__m128 inMask, __m128 inTrue, __m128 inFalse)
+		{
+			return _mm_or_ps(_mm_and_ps(inMask, inTrue), _mm_andnot_ps(inMask, inFalse));
+		}
+	#endif
+
+	private:
+		// Static Functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// log2Poly
+		// ---------------------------------------------------------------------
+		static float	log2Poly(float inM)
+		{
+			const float	*c = obtainLog2Coefficients();
+			return ((((c[5] * inM + c[4]) * inM + c[3]) * inM + c[2]) * inM + c[1]) * inM + c[0];
+		}
+		// ---------------------------------------------------------------------
+		// exp2Poly
+		// ---------------------------------------------------------------------
+		static float	exp2Poly(float inF)
+		{
+			const float	*c = obtainExp2Coefficients();
+			return ((((c[5] * inF + c[4]) * inF + c[3]) * inF + c[2]) * inF + c[1]) * inF + c[0];
+		}
+		// ---------------------------------------------------------------------
+		// atanPoly
+		// ---------------------------------------------------------------------
+		static float	atanPoly(float inZ2)
+		{
+			const float	*c = obtainAtanCoefficients();
+			return (((c[4] * inZ2 + c[3]) * inZ2 + c[2]) * inZ2 + c[1]) * inZ2 + c[0];
+		}
+		// ---------------------------------------------------------------------
+		// obtainLog2Coefficients
+		// ---------------------------------------------------------------------
+		//	log2(1 + m) = m * P(m), 0 <= m < 1 (least squares fit)
+		static const float	*obtainLog2Coefficients()
+		{
+			static const float	c[6] = {
+				1.44266899f, -0.720177369f, 0.468034186f,
+				-0.301059255f, 0.144693519f, -0.0341788478f };
+			return c;
+		}
+		// ---------------------------------------------------------------------
+		// obtainExp2Coefficients
+		// ---------------------------------------------------------------------
+		//	2^f = P(f), 0 <= f < 1
+		static const float	*obtainExp2Coefficients()
+		{
+			static const float	c[6] = {
+				0.99999977f, 0.693156767f, 0.240131728f,
+				0.0558765068f, 0.00894060183f, 0.0018943836f };
+			return c;
+		}
+		// ---------------------------------------------------------------------
+		// obtainAtanCoefficients
+		// ---------------------------------------------------------------------
+		//	atan(z) = z * P(z^2), 0 <= z <= 1
+		static const float	*obtainAtanCoefficients()
+		{
+			static const float	c[5] = {
+				0.999976966f, -0.331971683f, 0.186800537f,
+				-0.0948120496f, 0.0254728888f };
+			return c;
+		}
+	};
+ };
+};
+
+#endif	// #ifdef VIW_UTIL_FASTMATH_H
@@ -0,0 +1,224 @@
+// =============================================================================
+//  FrameTiming.hpp
+//
+//  Written in 2014 by Dairoku Sekiguchi (sekiguchi at acm dot org)
+//
+//  To the extent possible under law, the author(s) have dedicated all copyright
+//  and related and neighboring rights to this software to the public domain worldwide.
+//  This software is distributed without any warranty.
+//
+//  You should have received a copy of the CC0 Public Domain Dedication along with
+//  this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+// =============================================================================
+/*!
+	\file		viw/utils/FrameTiming.h
+	\author		Dairoku Sekiguchi
+	\version	1.0.0
+	\date		2026/10/19
+	\brief		Header file for viw library types
+
+	This file defines the frame interval statistics for viw library
+*/
+
+#ifndef VIW_UTIL_FRAMETIMING_H
+#define VIW_UTIL_FRAMETIMING_H
+
+// Includes --------------------------------------------------------------------
+#include <math.h>
+#include <vector>
+#include <mutex>
+#include <chrono>
+#include <algorithm>
+
+
+// Namespace -------------------------------------------------------------------
+namespace viw
+{
+ namespace utils
+ {
+	// -------------------------------------------------------------------------
+	// FrameTiming class
+	// -------------------------------------------------------------------------
+	//	Keeps the last inWindowSize frame intervals in a ring. addFrame() is
+	//	O(1) (the mean comes from a running sum), the order statistics are
+	//	computed when getStats() is called. The object may be polled from
+	//	another thread than the one adding the frames.
+	class	FrameTiming
+	{
+	public:
+		// Constatns -----------------------------------------------------------
+		const static int	DEFAULT_WINDOW_SIZE		= 120;
+
+		// Structs -------------------------------------------------------------
+		struct	Stats
+		{
+			long long	frameCount;			// since reset()
+			int			intervalCount;		// in the window
+			double		fps;				// of the last interval
+			double		averageFPS;			// over the window
+			double		meanIntervalMs;
+			double		minIntervalMs;
+			double		maxIntervalMs;
+			double		p50IntervalMs;
+			double		p95IntervalMs;
+			double		p99IntervalMs;
+			double		jitterMs;			// standard deviation of the interval
+		};
+
+		// Constructors and Destructor -----------------------------------------
+		// ---------------------------------------------------------------------
+		// FrameTiming
+		// ---------------------------------------------------------------------
+		FrameTiming(int inWindowSize = DEFAULT_WINDOW_SIZE)
+		{
+			if (inWindowSize < 1)
+				inWindowSize = 1;
+			mIntervals.resize(inWindowSize);
+			reset();
+		}
+
+		// Member functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// reset
+		// ---------------------------------------------------------------------
+		void	reset()
+		{
+			std::lock_guard<std::mutex>	lock(mMutex);
+			mFrameCount = 0;
+			mIntervalCount = 0;
+			mNextIndex = 0;
+			mIntervalSum = 0;
+			mLastInterval = 0;
+		}
+		// ---------------------------------------------------------------------
+		// addFrame
+		// ---------------------------------------------------------------------
+		void	addFrame()
+		{
+			addFrame(std::chrono::steady_clock::now());
+		}
+		// ---------------------------------------------------------------------
+		// addFrame
+		// ---------------------------------------------------------------------
+		void	addFrame(std::chrono::steady_clock::time_point inTime)
+		{
+			std::lock_guard<std::mutex>	lock(mMutex);
+			if (mFrameCount++ == 0)
+			{
+				mPrevTime = inTime;
+				return;
+			}
+			long long	interval = (long long )std::chrono::duration_cast<std::chrono::nanoseconds>(
+										inTime - mPrevTime).count();
+			mPrevTime = inTime;
+
+			int	windowSize = (int )mIntervals.size();
+			if (mIntervalCount < windowSize)
+				mIntervalCount++;
+			else
+				mIntervalSum -= mIntervals[mNextIndex];
+			mIntervals[mNextIndex] = interval;
+			mIntervalSum += interval;
+			mLastInterval = interval;
+			mNextIndex = (mNextIndex + 1) % windowSize;
+		}
+		// ---------------------------------------------------------------------
+		// getFPS
+		// ---------------------------------------------------------------------
+		double	getFPS()
+		{
+			std::lock_guard<std::mutex>	lock(mMutex);
+			if (mIntervalCount == 0 || mLastInterval <= 0)
+				return 0;
+			return 1e9 / (double )mLastInterval;
+		}
+		// ---------------------------------------------------------------------
+		// getAverageFPS
+		// ---------------------------------------------------------------------
+		double	getAverageFPS()
+		{
+			std::lock_guard<std::mutex>	lock(mMutex);
+			if (mIntervalSum <= 0)
+				return 0;
+			return 1e9 * (double )mIntervalCount / (double )mIntervalSum;
+		}
+		// ---------------------------------------------------------------------
+		// getStats
+		// ---------------------------------------------------------------------
+		//	Returns false (all zero) until two frames were added
+		bool	getStats(Stats *outStats)
+		{
+			std::vector<long long>	intervals;
+			long long	last;
+			Stats	stats;
+			{
+				std::lock_guard<std::mutex>	lock(mMutex);
+				stats.frameCount = mFrameCount;
+				stats.intervalCount = mIntervalCount;
+				intervals.assign(mIntervals.begin(), mIntervals.begin() + mIntervalCount);
+				last = mLastInterval;
+			}
+			if (intervals.empty())
+			{
+				*outStats = Stats();
+				outStats->frameCount = stats.frameCount;
+				return false;
+			}
+
+			long long	sum = 0;
+			for (size_t i = 0; i < intervals.size(); i++)
+				sum += intervals[i];
+			double	mean = (double )sum / (double )intervals.size();
+			double	variance = 0;
+			for (size_t i = 0; i < intervals.size(); i++)
+				variance += ((double )intervals[i] - mean) * ((double )intervals[i] - mean);
+			variance /= (double )intervals.size();
+
+			std::sort(intervals.begin(), intervals.end());
+
+			stats.fps = (last > 0) ? 1e9 / (double )last : 0;
+			stats.averageFPS = (mean > 0) ? 1e9 / mean : 0;
+			stats.meanIntervalMs = mean * 1e-6;
+			stats.minIntervalMs = (double )intervals.front() * 1e-6;
+			stats.maxIntervalMs = (double )intervals.back() * 1e-6;
+			stats.p50IntervalMs = getPercentile(intervals, 0.50) * 1e-6;
+			stats.p95IntervalMs = getPercentile(intervals, 0.95) * 1e-6;
+			stats.p99IntervalMs = getPercentile(intervals, 0.99) * 1e-6;
+			stats.jitterMs = sqrt(variance) * 1e-6;
+			*outStats = stats;
+			return true;
+		}
+
+	private:
+		// Member variables ----------------------------------------------------
+		std::mutex								mMutex;
+		std::vector<long long>					mIntervals;		// ns
+		long long								mFrameCount;
+		int										mIntervalCount;
+		int										mNextIndex;
+		long long								mIntervalSum;
+		long long								mLastInterval;
+		std::chrono::steady_clock::time_point	mPrevTime;
+
+		// Static Functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// getPercentile
+		// ---------------------------------------------------------------------
+		//	Nearest rank of sorted values
+		static double	getPercentile(const std::vector<long long> &inSorted, double inRatio)
+		{
+			size_t	index = (size_t )ceil(inRatio * (double )inSorted.size());
+			if (index > 0)
+				index--;
+			if (index >= inSorted.size())
+				index = inSorted.size() - 1;
+			return (double )inSorted[index];
+		}
+
+		FrameTiming(const FrameTiming &);
+		FrameTiming	&operator=(const FrameTiming &);
+	};
+ };
+};
+
+#endif	// #ifdef VIW_UTIL_FRAMETIMING_H
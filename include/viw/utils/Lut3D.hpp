@@ -0,0 +1,656 @@
+// =============================================================================
+//  Lut3D.hpp
+//
+//  Written in 2014 by Dairoku Sekiguchi (sekiguchi at acm dot org)
+//
+//  To the extent possible under law, the author(s) have dedicated all copyright
+//  and related and neighboring rights to this software to the public domain worldwide.
+//  This software is distributed without any warranty.
+//
+//  You should have received a copy of the CC0 Public Domain Dedication along with
+//  this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+// =============================================================================
+/*!
+	\file		viw/utils/Lut3D.h
+	\author		Dairoku Sekiguchi
+	\version	1.0.0
+	\date		2026/10/19
+	\brief		Header file for viw library types
+
+	This file defines the 3D LUT (colour grading) class for viw library
+*/
+
+#ifndef VIW_UTIL_LUT3D_H
+#define VIW_UTIL_LUT3D_H
+
+// Includes --------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+#include "viw/Exception.hpp"
+#include "viw/utils/CpuFeatures.hpp"
+
+// Macros ----------------------------------------------------------------------
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define	VIW_LUT3D_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+
+// Namespace -------------------------------------------------------------------
+namespace viw
+{
+ namespace utils
+ {
+	// -------------------------------------------------------------------------
+	// Lut3D class
+	// -------------------------------------------------------------------------
+	//	A 3D LUT for 8bit BGR / BGRA pixels with tetrahedral interpolation in
+	//	fixed point. The lattice holds 16bit B, G, R, 0 entries scaled by
+	//	255 * 128 so that two vertices can be blended with one _mm_madd_epi16.
+	//	The per-channel lattice index and 8bit fraction for every input code
+	//	are precomputed, which also folds the .cube DOMAIN_MIN / DOMAIN_MAX
+	//	(or LUT_3D_INPUT_RANGE).
+	//
+	//	applyToLines() works on 4 pixels at a time with SSE2: the tetrahedron
+	//	selection (a 3 element sorting network on the fractions), the vertex
+	//	offsets, the weights and the final packing are done across the 4
+	//	pixels. SSE2 has no gather, so the 4 vertices of each pixel are
+	//	still fetched with scalar loads and blended with one _mm_madd_epi16
+	//	pair per pixel. The result is identical to the scalar path.
+	class	Lut3D
+	{
+	public:
+		// Constatns -----------------------------------------------------------
+		const static int	MAX_LUT_SIZE		= 256;
+		const static int	CUBE_LINE_BUF_LEN	= 1024;
+
+		// Constructors and Destructor -----------------------------------------
+		// ---------------------------------------------------------------------
+		// Lut3D
+		// ---------------------------------------------------------------------
+		Lut3D(bool inThrowsEx = false)
+		{
+			mThrowsEx = inThrowsEx;
+			mSize = 0;
+			mTable = NULL;
+			::memset(mIndex, 0, sizeof(mIndex));
+			::memset(mFraction, 0, sizeof(mFraction));
+		}
+		// ---------------------------------------------------------------------
+		// Lut3D
+		// ---------------------------------------------------------------------
+		Lut3D(const Lut3D &inLut)
+		{
+			mTable = NULL;
+			copyFrom(inLut);
+		}
+		// ---------------------------------------------------------------------
+		// ~Lut3D
+		// ---------------------------------------------------------------------
+		virtual ~Lut3D()
+		{
+			if (mTable != NULL)
+				delete [] mTable;
+		}
+
+		// Member functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// operator=
+		// ---------------------------------------------------------------------
+		Lut3D	&operator=(const Lut3D &inLut)
+		{
+			if (this != &inLut)
+				copyFrom(inLut);
+			return *this;
+		}
+		// ---------------------------------------------------------------------
+		// getSize
+		// ---------------------------------------------------------------------
+		int	getSize() const
+		{
+			return mSize;
+		}
+		// ---------------------------------------------------------------------
+		// isValid
+		// ---------------------------------------------------------------------
+		bool	isValid() const
+		{
+			return (mTable != NULL);
+		}
+		// ---------------------------------------------------------------------
+		// setTable
+		// ---------------------------------------------------------------------
+		//	inRGB holds inSize^3 R, G, B triplets in [0, 1], red changing fastest
+		//	(the .cube order). inDomainMin / inDomainMax are R, G, B (or NULL).
+		bool	setTable(int inSize, const float *inRGB,
+						const float *inDomainMin = NULL, const float *inDomainMax = NULL)
+		{
+			if (inSize < 2 || inSize > MAX_LUT_SIZE || inRGB == NULL)
+			{
+				if (mThrowsEx == false)
+					return false;
+				else
+					throw ViwException(ViwException::PARAM_ERROR,
+						"Invalid LUT size", VIW_EXCEPTION_LOCATION_MACRO, 0);
+			}
+
+			size_t	entryNum = (size_t )inSize * inSize * inSize;
+			short	*table = new(std::nothrow) short[entryNum * 4];
+			if (table == NULL)
+			{
+				if (mThrowsEx == false)
+					return false;
+				else
+					throw ViwException(ViwException::MEMORY_ERROR,
+						"table == NULL", VIW_EXCEPTION_LOCATION_MACRO, 0);
+			}
+
+			for (size_t i = 0; i < entryNum; i++, inRGB += 3)
+			{
+				table[i * 4 + 0] = toFixed(inRGB[2]);
+				table[i * 4 + 1] = toFixed(inRGB[1]);
+				table[i * 4 + 2] = toFixed(inRGB[0]);
+				table[i * 4 + 3] = 0;
+			}
+
+			if (mTable != NULL)
+				delete [] mTable;
+			mTable = table;
+			mSize = inSize;
+
+			for (int c = 0; c < 3; c++)
+			{
+				float	domainMin = (inDomainMin != NULL) ? inDomainMin[c] : 0.0f;
+				float	domainMax = (inDomainMax != NULL) ? inDomainMax[c] : 1.0f;
+				buildIndexTable(2 - c, domainMin, domainMax);	// stored in B, G, R order
+			}
+			return true;
+		}
+		// ---------------------------------------------------------------------
+		// loadCubeFile
+		// ---------------------------------------------------------------------
+		//	Reads an Adobe / Resolve .cube 3D LUT
+		bool	loadCubeFile(const char *inFileName)
+		{
+			FILE	*fp = fopen(inFileName, "r");
+			if (fp == NULL)
+			{
+				if (mThrowsEx == false)
+					return false;
+				else
+					throw ViwException(ViwException::OS_ERROR,
+						"Can't open the file", VIW_EXCEPTION_LOCATION_MACRO, 0);
+			}
+
+			char	buf[CUBE_LINE_BUF_LEN];
+			int		size = 0;
+			size_t	entryNum = 0, count = 0;
+			float	domainMin[3] = {0, 0, 0};
+			float	domainMax[3] = {1, 1, 1};
+			float	*rgb = NULL;
+			bool	result = true;
+			const char	*errorDesc = "Invalid .cube file";
+			int			errorCode = ViwException::FILE_FORMAT_ERROR;
+
+			while (fgets(buf, CUBE_LINE_BUF_LEN, fp) != NULL)
+			{
+				char	*p = buf;
+				while (*p == ' ' || *p == '\t')
+					p++;
+				if (*p == '#' || *p == '\r' || *p == '\n' || *p == 0)
+					continue;
+
+				if (strncmp(p, "TITLE", 5) == 0)
+					continue;
+				if (strncmp(p, "LUT_3D_SIZE", 11) == 0)
+				{
+					size = atoi(p + 11);
+					if (size < 2 || size > MAX_LUT_SIZE || rgb != NULL)
+					{
+						result = false;
+						break;
+					}
+					entryNum = (size_t )size * size * size;
+					rgb = new(std::nothrow) float[entryNum * 3];
+					if (rgb == NULL)
+					{
+						result = false;
+						errorDesc = "rgb == NULL";
+						errorCode = ViwException::MEMORY_ERROR;
+						break;
+					}
+					continue;
+				}
+				if (strncmp(p, "DOMAIN_MIN", 10) == 0)
+				{
+					result = parseFloats(p + 10, domainMin, 3);
+					if (result == false)
+						break;
+					continue;
+				}
+				if (strncmp(p, "DOMAIN_MAX", 10) == 0)
+				{
+					result = parseFloats(p + 10, domainMax, 3);
+					if (result == false)
+						break;
+					continue;
+				}
+				if (strncmp(p, "LUT_3D_INPUT_RANGE", 18) == 0)
+				{
+					// Resolve's form of DOMAIN_MIN / DOMAIN_MAX, one range for all channels
+					float	range[2];
+					result = parseFloats(p + 18, range, 2);
+					if (result == false)
+						break;
+					for (int c = 0; c < 3; c++)
+					{
+						domainMin[c] = range[0];
+						domainMax[c] = range[1];
+					}
+					continue;
+				}
+				if (strncmp(p, "LUT_1D", 6) == 0)
+				{
+					result = false;
+					errorDesc = "1D LUTs are not supported";
+					break;
+				}
+				if (rgb == NULL || count >= entryNum)
+				{
+					result = false;		// unknown keywords, data before LUT_3D_SIZE or too many entries
+					break;
+				}
+
+				result = parseFloats(p, rgb + count * 3, 3);
+				if (result == false)
+					break;
+				count++;
+			}
+			fclose(fp);
+
+			if (result && (rgb == NULL || count != entryNum))
+				result = false;
+			for (int c = 0; c < 3 && result; c++)
+				if (!(domainMin[c] < domainMax[c]))
+				{
+					result = false;
+					errorDesc = "The input range (DOMAIN_MIN / DOMAIN_MAX) is empty";
+				}
+			if (result)
+				result = setTable(size, rgb, domainMin, domainMax);
+			if (rgb != NULL)
+				delete [] rgb;
+
+			if (result == false)
+			{
+				if (mThrowsEx == false)
+					return false;
+				else
+					throw ViwException(errorCode,
+						errorDesc, VIW_EXCEPTION_LOCATION_MACRO, 0);
+			}
+			return true;
+		}
+		// ---------------------------------------------------------------------
+		// applyToLines
+		// ---------------------------------------------------------------------
+		//	Applies the LUT to lines [inStartY, inEndY) of a BGR (inPixelSize 3)
+		//	or BGRA (inPixelSize 4, alpha is copied) image. Bands are
+		//	independent, so callers may process them in parallel.
+		void	applyToLines(const unsigned char *inSrc, size_t inSrcLineOffset,
+						unsigned char *outDst, size_t inDstLineOffset,
+						int inWidth, int inPixelSize, int inStartY, int inEndY) const
+		{
+			static const ApplyToLineFunc	applyToLineFunc = selectApplyToLineFunc();
+			static const ApplyToPixelFunc	applyToPixelFunc = selectApplyToPixelFunc();
+
+			for (int y = inStartY; y < inEndY; y++)
+			{
+				const unsigned char	*srcPtr = inSrc + inSrcLineOffset * y;
+				unsigned char		*dstPtr = outDst + inDstLineOffset * y;
+
+				int	x = (this->*applyToLineFunc)(srcPtr, dstPtr, inWidth, inPixelSize);
+				srcPtr += x * inPixelSize;
+				dstPtr += x * inPixelSize;
+				for (; x < inWidth; x++, srcPtr += inPixelSize, dstPtr += inPixelSize)
+				{
+					(this->*applyToPixelFunc)(srcPtr, dstPtr);
+					if (inPixelSize == 4)
+						dstPtr[3] = srcPtr[3];
+				}
+			}
+		}
+		// ---------------------------------------------------------------------
+		// applyToPixel
+		// ---------------------------------------------------------------------
+		//	inBGR / outBGR : B, G, R
+		void	applyToPixel(const unsigned char *inBGR, unsigned char *outBGR) const
+		{
+			static const ApplyToPixelFunc	applyToPixelFunc = selectApplyToPixelFunc();
+
+			(this->*applyToPixelFunc)(inBGR, outBGR);
+		}
+
+	protected:
+		// Typedefs ------------------------------------------------------------
+		//	The vector line variants return the first x left for the pixel loop
+		typedef int		(Lut3D::*ApplyToLineFunc)(const unsigned char *inSrc, unsigned char *outDst,
+								int inWidth, int inPixelSize) const;
+		typedef void	(Lut3D::*ApplyToPixelFunc)(const unsigned char *inBGR, unsigned char *outBGR) const;
+
+		// Member variables ----------------------------------------------------
+		bool				mThrowsEx;
+		int					mSize;
+		short				*mTable;				// B, G, R, 0 * mSize^3
+		unsigned char		mIndex[3][256];			// B, G, R : lattice index
+		short				mFraction[3][256];		// B, G, R : 0 - 256
+
+		// Member functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// applyToPixelScalar
+		// ---------------------------------------------------------------------
+		void	applyToPixelScalar(const unsigned char *inBGR, unsigned char *outBGR) const
+		{
+			applyToPixel(inBGR, outBGR, false);
+		}
+	#ifdef VIW_LUT3D_USE_SSE2
+		// ---------------------------------------------------------------------
+		// applyToPixelSSE2
+		// ---------------------------------------------------------------------
+		void	applyToPixelSSE2(const unsigned char *inBGR, unsigned char *outBGR) const
+		{
+			applyToPixel(inBGR, outBGR, true);
+		}
+	#endif
+		// ---------------------------------------------------------------------
+		// applyToLineNone
+		// ---------------------------------------------------------------------
+		int	applyToLineNone(const unsigned char *, unsigned char *, int, int) const
+		{
+			return 0;
+		}
+		// ---------------------------------------------------------------------
+		// applyToPixel
+		// ---------------------------------------------------------------------
+		//	Both variants share this body, inUseSSE2 is a constant at every
+		//	call site, so each one is inlined without the branch.
+		void	applyToPixel(const unsigned char *inBGR, unsigned char *outBGR, bool inUseSSE2) const
+		{
+			int	fb = mFraction[0][inBGR[0]];
+			int	fg = mFraction[1][inBGR[1]];
+			int	fr = mFraction[2][inBGR[2]];
+			int	sr = 4;
+			int	sg = mSize * 4;
+			int	sb = mSize * mSize * 4;
+			const short	*c000 = mTable + obtainBaseOffset(inBGR);
+
+			// Sort the fractions, the walk along the largest one first
+			// selects one of the 6 tetrahedra
+			int	f1, f2, f3, s1, s2, s3;
+			if (fr >= fg)
+			{
+				if (fg >= fb)		{ f1 = fr; s1 = sr; f2 = fg; s2 = sg; f3 = fb; s3 = sb; }
+				else if (fr >= fb)	{ f1 = fr; s1 = sr; f2 = fb; s2 = sb; f3 = fg; s3 = sg; }
+				else				{ f1 = fb; s1 = sb; f2 = fr; s2 = sr; f3 = fg; s3 = sg; }
+			}
+			else
+			{
+				if (fr >= fb)		{ f1 = fg; s1 = sg; f2 = fr; s2 = sr; f3 = fb; s3 = sb; }
+				else if (fg >= fb)	{ f1 = fg; s1 = sg; f2 = fb; s2 = sb; f3 = fr; s3 = sr; }
+				else				{ f1 = fb; s1 = sb; f2 = fg; s2 = sg; f3 = fr; s3 = sr; }
+			}
+			const short	*c1 = c000 + s1;
+			const short	*c2 = c1 + s2;
+			const short	*c3 = c2 + s3;
+			int	w0 = 256 - f1;
+			int	w1 = f1 - f2;
+			int	w2 = f2 - f3;
+			int	w3 = f3;
+
+		#ifdef VIW_LUT3D_USE_SSE2
+			if (inUseSSE2)
+			{
+				__m128i	v01 = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *)c000),
+												 _mm_loadl_epi64((const __m128i *)c1));
+				__m128i	v23 = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *)c2),
+												 _mm_loadl_epi64((const __m128i *)c3));
+				__m128i	sum = _mm_add_epi32(_mm_madd_epi16(v01, _mm_set1_epi32((w1 << 16) | w0)),
+											_mm_madd_epi16(v23, _mm_set1_epi32((w3 << 16) | w2)));
+				sum = _mm_srai_epi32(_mm_add_epi32(sum, _mm_set1_epi32(1 << 14)), 15);
+				sum = _mm_packus_epi16(_mm_packs_epi32(sum, sum), sum);
+				int	packed = _mm_cvtsi128_si32(sum);
+				outBGR[0] = (unsigned char )packed;
+				outBGR[1] = (unsigned char )(packed >> 8);
+				outBGR[2] = (unsigned char )(packed >> 16);
+				return;
+			}
+		#else
+			(void )inUseSSE2;
+		#endif
+			for (int c = 0; c < 3; c++)
+			{
+				int	v = (c000[c] * w0 + c1[c] * w1 + c2[c] * w2 + c3[c] * w3 + (1 << 14)) >> 15;
+				outBGR[c] = (unsigned char )(v < 0 ? 0 : (v > 255 ? 255 : v));
+			}
+		}
+	#ifdef VIW_LUT3D_USE_SSE2
+		// ---------------------------------------------------------------------
+		// applyToLineSSE2
+		// ---------------------------------------------------------------------
+		//	4 pixels per iteration, returns the first x left for the scalar loop
+		int	applyToLineSSE2(const unsigned char *inSrc, unsigned char *outDst,
+						int inWidth, int inPixelSize) const
+		{
+			const int		LANES = 4;
+			const __m128i	sr = _mm_set1_epi32(4);
+			const __m128i	sg = _mm_set1_epi32(mSize * 4);
+			const __m128i	sb = _mm_set1_epi32(mSize * mSize * 4);
+			const __m128i	farOffset = _mm_set1_epi32(4 + mSize * 4 + mSize * mSize * 4);
+			const __m128i	one = _mm_set1_epi32(256);
+			const __m128i	rounding = _mm_set1_epi32(1 << 14);
+			const __m128i	alphaMask = _mm_set1_epi32((int )0xFF000000);
+			int				o0[LANES], o1[LANES], o2[LANES], o3[LANES];
+			unsigned char	bgr0[LANES * 4];
+			int	x = 0;
+
+			for (; x + LANES <= inWidth; x += LANES)
+			{
+				const unsigned char	*p0 = inSrc + x * inPixelSize;
+				const unsigned char	*p1 = p0 + inPixelSize;
+				const unsigned char	*p2 = p1 + inPixelSize;
+				const unsigned char	*p3 = p2 + inPixelSize;
+				__m128i	fb = _mm_setr_epi32(mFraction[0][p0[0]], mFraction[0][p1[0]],
+											mFraction[0][p2[0]], mFraction[0][p3[0]]);
+				__m128i	fg = _mm_setr_epi32(mFraction[1][p0[1]], mFraction[1][p1[1]],
+											mFraction[1][p2[1]], mFraction[1][p3[1]]);
+				__m128i	fr = _mm_setr_epi32(mFraction[2][p0[2]], mFraction[2][p1[2]],
+											mFraction[2][p2[2]], mFraction[2][p3[2]]);
+				__m128i	base = _mm_setr_epi32(obtainBaseOffset(p0), obtainBaseOffset(p1),
+											obtainBaseOffset(p2), obtainBaseOffset(p3));
+
+				// Sort the fractions (with their lattice steps) in descending
+				// order. Ties select the same vertices whichever way they go.
+				__m128i	f1 = fr, s1 = sr, f2 = fg, s2 = sg, f3 = fb, s3 = sb;
+				compareSwap(&f1, &s1, &f2, &s2);
+				compareSwap(&f2, &s2, &f3, &s3);
+				compareSwap(&f1, &s1, &f2, &s2);
+
+				__m128i	w01 = _mm_or_si128(_mm_sub_epi32(one, f1), _mm_slli_epi32(_mm_sub_epi32(f1, f2), 16));
+				__m128i	w23 = _mm_or_si128(_mm_sub_epi32(f2, f3), _mm_slli_epi32(f3, 16));
+				__m128i	off1 = _mm_add_epi32(base, s1);
+				_mm_storeu_si128((__m128i *)o0, base);
+				_mm_storeu_si128((__m128i *)o1, off1);
+				_mm_storeu_si128((__m128i *)o2, _mm_add_epi32(off1, s2));
+				_mm_storeu_si128((__m128i *)o3, _mm_add_epi32(base, farOffset));	// c111
+
+				__m128i	v0 = blendVertices(o0[0], o1[0], o2[0], o3[0],
+							_mm_shuffle_epi32(w01, _MM_SHUFFLE(0, 0, 0, 0)), _mm_shuffle_epi32(w23, _MM_SHUFFLE(0, 0, 0, 0)));
+				__m128i	v1 = blendVertices(o0[1], o1[1], o2[1], o3[1],
+							_mm_shuffle_epi32(w01, _MM_SHUFFLE(1, 1, 1, 1)), _mm_shuffle_epi32(w23, _MM_SHUFFLE(1, 1, 1, 1)));
+				__m128i	v2 = blendVertices(o0[2], o1[2], o2[2], o3[2],
+							_mm_shuffle_epi32(w01, _MM_SHUFFLE(2, 2, 2, 2)), _mm_shuffle_epi32(w23, _MM_SHUFFLE(2, 2, 2, 2)));
+				__m128i	v3 = blendVertices(o0[3], o1[3], o2[3], o3[3],
+							_mm_shuffle_epi32(w01, _MM_SHUFFLE(3, 3, 3, 3)), _mm_shuffle_epi32(w23, _MM_SHUFFLE(3, 3, 3, 3)));
+				v0 = _mm_srai_epi32(_mm_add_epi32(v0, rounding), 15);
+				v1 = _mm_srai_epi32(_mm_add_epi32(v1, rounding), 15);
+				v2 = _mm_srai_epi32(_mm_add_epi32(v2, rounding), 15);
+				v3 = _mm_srai_epi32(_mm_add_epi32(v3, rounding), 15);
+				__m128i	packed = _mm_packus_epi16(_mm_packs_epi32(v0, v1), _mm_packs_epi32(v2, v3));
+
+				if (inPixelSize == 4)
+				{
+					// B, G, R, 0 per pixel, the alpha comes from the source
+					__m128i	src = _mm_loadu_si128((const __m128i *)p0);
+					packed = _mm_or_si128(packed, _mm_and_si128(src, alphaMask));
+					_mm_storeu_si128((__m128i *)(outDst + x * 4), packed);
+				}
+				else
+				{
+					unsigned char	*dstPtr = outDst + x * 3;
+					_mm_storeu_si128((__m128i *)bgr0, packed);
+					for (int i = 0; i < LANES; i++, dstPtr += 3)
+					{
+						dstPtr[0] = bgr0[i * 4 + 0];
+						dstPtr[1] = bgr0[i * 4 + 1];
+						dstPtr[2] = bgr0[i * 4 + 2];
+					}
+				}
+			}
+			return x;
+		}
+		// ---------------------------------------------------------------------
+		// blendVertices
+		// ---------------------------------------------------------------------
+		//	B, G, R, 0 sums of the 4 weighted vertices of one pixel, inW01 /
+		//	inW23 hold (w1 << 16) | w0 and (w3 << 16) | w2 in every lane
+		__m128i	blendVertices(int inO0, int inO1, int inO2, int inO3, __m128i inW01, __m128i inW23) const
+		{
+			__m128i	v01 = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *)(mTable + inO0)),
+											 _mm_loadl_epi64((const __m128i *)(mTable + inO1)));
+			__m128i	v23 = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *)(mTable + inO2)),
+											 _mm_loadl_epi64((const __m128i *)(mTable + inO3)));
+			return _mm_add_epi32(_mm_madd_epi16(v01, inW01), _mm_madd_epi16(v23, inW23));
+		}
+		// ---------------------------------------------------------------------
+		// compareSwap
+		// ---------------------------------------------------------------------
+		//	Moves the larger fraction (and its step) to ioFa / ioSa
+		static void	compareSwap(__m128i *ioFa, __m128i *ioSa, __m128i *ioFb, __m128i *ioSb)
+		{
+			__m128i	mask = _mm_cmpgt_epi32(*ioFb, *ioFa);
+			__m128i	fa = _mm_or_si128(_mm_and_si128(mask, *ioFb), _mm_andnot_si128(mask, *ioFa));
+			__m128i	fb = _mm_or_si128(_mm_and_si128(mask, *ioFa), _mm_andnot_si128(mask, *ioFb));
+			__m128i	sa = _mm_or_si128(_mm_and_si128(mask, *ioSb), _mm_andnot_si128(mask, *ioSa));
+			__m128i	sb = _mm_or_si128(_mm_and_si128(mask, *ioSa), _mm_andnot_si128(mask, *ioSb));
+			*ioFa = fa;
+			*ioFb = fb;
+			*ioSa = sa;
+			*ioSb = sb;
+		}
+	#endif
+		// ---------------------------------------------------------------------
+		// obtainBaseOffset
+		// ---------------------------------------------------------------------
+		//	Offset of the c000 vertex of a B, G, R pixel in mTable
+		int	obtainBaseOffset(const unsigned char *inBGR) const
+		{
+			return ((mIndex[0][inBGR[0]] * mSize + mIndex[1][inBGR[1]]) * mSize + mIndex[2][inBGR[2]]) * 4;
+		}
+		// ---------------------------------------------------------------------
+		// copyFrom
+		// ---------------------------------------------------------------------
+		void	copyFrom(const Lut3D &inLut)
+		{
+			if (mTable != NULL)
+				delete [] mTable;
+			mTable = NULL;
+
+			mThrowsEx = inLut.mThrowsEx;
+			mSize = inLut.mSize;
+			::memcpy(mIndex, inLut.mIndex, sizeof(mIndex));
+			::memcpy(mFraction, inLut.mFraction, sizeof(mFraction));
+			if (inLut.mTable != NULL)
+			{
+				size_t	num = (size_t )mSize * mSize * mSize * 4;
+				mTable = new(std::nothrow) short[num];
+				if (mTable != NULL)		// the copy is left invalid (isValid() == false) on failure
+					::memcpy(mTable, inLut.mTable, num * sizeof(short));
+			}
+		}
+		// ---------------------------------------------------------------------
+		// buildIndexTable
+		// ---------------------------------------------------------------------
+		void	buildIndexTable(int inChannel, float inDomainMin, float inDomainMax)
+		{
+			for (int i = 0; i < 256; i++)
+			{
+				double	p = (i / 255.0 - inDomainMin) / (inDomainMax - inDomainMin) * (mSize - 1);
+				if (!(p > 0))
+					p = 0;
+				if (p > mSize - 1)
+					p = mSize - 1;
+
+				int	index = (int )p;
+				if (index > mSize - 2)
+					index = mSize - 2;
+				mIndex[inChannel][i] = (unsigned char )index;
+				mFraction[inChannel][i] = (short )((p - index) * 256.0 + 0.5);
+			}
+		}
+
+		// Static Functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// selectApplyToLineFunc
+		// ---------------------------------------------------------------------
+		static ApplyToLineFunc	selectApplyToLineFunc()
+		{
+		#ifdef VIW_LUT3D_USE_SSE2
+			if (CpuFeatures::isEnabled(CpuFeatures::ISA_SSE2))
+				return &Lut3D::applyToLineSSE2;
+		#endif
+			return &Lut3D::applyToLineNone;
+		}
+		// ---------------------------------------------------------------------
+		// selectApplyToPixelFunc
+		// ---------------------------------------------------------------------
+		static ApplyToPixelFunc	selectApplyToPixelFunc()
+		{
+		#ifdef VIW_LUT3D_USE_SSE2
+			if (CpuFeatures::isEnabled(CpuFeatures::ISA_SSE2))
+				return &Lut3D::applyToPixelSSE2;
+		#endif
+			return &Lut3D::applyToPixelScalar;
+		}
+		// ---------------------------------------------------------------------
+		// toFixed
+		// ---------------------------------------------------------------------
+		static short	toFixed(float inValue)
+		{
+			if (!(inValue > 0))
+				return 0;
+			if (inValue >= 1.0f)
+				return 255 * 128;
+			return (short )(inValue * (255 * 128) + 0.5f);
+		}
+		// ---------------------------------------------------------------------
+		// parseFloats
+		// ---------------------------------------------------------------------
+		static bool	parseFloats(const char *inStr, float *outValues, int inNum)
+		{
+			char	*endPtr;
+			for (int i = 0; i < inNum; i++)
+			{
+				outValues[i] = (float )strtod(inStr, &endPtr);
+				if (endPtr == inStr)
+					return false;
+				inStr = endPtr;
+			}
+			return true;
+		}
+	};
+ };
+};
+
+#endif	// #ifdef VIW_UTIL_LUT3D_H
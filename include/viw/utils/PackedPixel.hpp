@@ -0,0 +1,255 @@
+// =============================================================================
+//  PackedPixel.hpp
+//
+//  Written in 2014 by Dairoku Sekiguchi (sekiguchi at acm dot org)
+//
+//  To the extent possible under law, the author(s) have dedicated all copyright
+//  and related and neighboring rights to this software to the public domain worldwide.
+//  This software is distributed without any warranty.
+//
+//  You should have received a copy of the CC0 Public Domain Dedication along with
+//  this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+// =============================================================================
+/*!
+	\file		viw/utils/PackedPixel.h
+	\author		Dairoku Sekiguchi
+	\version	1.0.0
+	\date		2026/10/19
+	\brief		Header file for viw library types
+
+	This file defines the bit packed pixel unpackers for viw library
+*/
+
+#ifndef VIW_UTIL_PACKEDPIXEL_H
+#define VIW_UTIL_PACKEDPIXEL_H
+
+// Includes --------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include "viw/Exception.hpp"
+#include "viw/utils/CpuFeatures.hpp"
+
+
+// Namespace -------------------------------------------------------------------
+namespace viw
+{
+ namespace utils
+ {
+	// -------------------------------------------------------------------------
+	// PackedPixel class
+	// -------------------------------------------------------------------------
+	//	Unpacks the GenICam (PFNC) bit packed mono formats one line at a time.
+	//	Each line starts on a byte boundary.
+	//
+	//	Mono10p      : 4 pixels in 5 bytes, LSB first
+	//	Mono12p      : 2 pixels in 3 bytes, LSB first
+	//	Mono12Packed : 2 pixels in 3 bytes, byte0 = p0[11:4],
+	//	               byte1 = p1[3:0] << 4 | p0[3:0], byte2 = p1[11:4]
+	class	PackedPixel
+	{
+	public:
+		// Constatns -----------------------------------------------------------
+		enum PackingType
+		{
+			PACKING_NOT_SPECIFIED	= 0,
+			PACKING_MONO10P,
+			PACKING_MONO12P,
+			PACKING_MONO12_PACKED
+		};
+
+		// Static Functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// obtainBitCount
+		// ---------------------------------------------------------------------
+		static int	obtainBitCount(PackingType inType)
+		{
+			switch (inType)
+			{
+				case PACKING_MONO10P:
+					return 10;
+				case PACKING_MONO12P:
+				case PACKING_MONO12_PACKED:
+					return 12;
+				default:
+					return 0;
+			}
+		}
+		// ---------------------------------------------------------------------
+		// obtainLineByteSize
+		// ---------------------------------------------------------------------
+		static size_t	obtainLineByteSize(PackingType inType, int inWidth)
+		{
+			return ((size_t )inWidth * obtainBitCount(inType) + 7) / 8;
+		}
+		// ---------------------------------------------------------------------
+		// unpackLine
+		// ---------------------------------------------------------------------
+		//	Unpacks one line into 16bit values (10 or 12 significant bits)
+		static void	unpackLine(PackingType inType, const unsigned char *inSrc, int inWidth,
+								unsigned short *outDst)
+		{
+			static const UnpackLineFunc	unpackLineFunc = selectUnpackLineFunc();
+
+			int	x = unpackLineFunc(inType, inSrc, inWidth, outDst);
+			unpackLineScalar(inType, inSrc, x, inWidth, outDst);
+		}
+		// ---------------------------------------------------------------------
+		// unpackLineWithLut
+		// ---------------------------------------------------------------------
+		//	Unpacks one line and maps it to 8bit through inLut, which must hold
+		//	(1 << obtainBitCount(inType)) entries. The line is unpacked in
+		//	small chunks that stay in L1, so no full frame 16bit copy is made.
+		static void	unpackLineWithLut(PackingType inType, const unsigned char *inSrc, int inWidth,
+								const unsigned char *inLut, unsigned char *outDst)
+		{
+			const int		CHUNK_PIXELS = 256;		// multiple of 8
+			unsigned short	chunk[CHUNK_PIXELS];
+			int	bitCount = obtainBitCount(inType);
+
+			for (int x = 0; x < inWidth; x += CHUNK_PIXELS)
+			{
+				int	count = inWidth - x;
+				if (count > CHUNK_PIXELS)
+					count = CHUNK_PIXELS;
+
+				unpackLine(inType, inSrc + (size_t )x * bitCount / 8, count, chunk);
+				for (int i = 0; i < count; i++)
+					outDst[x + i] = inLut[chunk[i]];
+			}
+		}
+
+	private:
+		// Typedefs ------------------------------------------------------------
+		//	The vector variants return the first x left for the scalar loop
+		typedef int	(*UnpackLineFunc)(PackingType inType, const unsigned char *inSrc, int inWidth,
+								unsigned short *outDst);
+
+		// Static Functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// selectUnpackLineFunc
+		// ---------------------------------------------------------------------
+		static UnpackLineFunc	selectUnpackLineFunc()
+		{
+		#ifdef VIW_CPU_X86_DISPATCH
+			if (CpuFeatures::isEnabled(CpuFeatures::ISA_SSSE3))
+				return unpackLineSSSE3;
+		#endif
+			return unpackLineNone;
+		}
+		// ---------------------------------------------------------------------
+		// unpackLineNone
+		// ---------------------------------------------------------------------
+		static int	unpackLineNone(PackingType, const unsigned char *, int, unsigned short *)
+		{
+			return 0;
+		}
+		// ---------------------------------------------------------------------
+		// unpackLineScalar
+		// ---------------------------------------------------------------------
+		static void	unpackLineScalar(PackingType inType, const unsigned char *inSrc,
+								int inStartX, int inEndX, unsigned short *outDst)
+		{
+			int	x = inStartX;
+
+			switch (inType)
+			{
+				case PACKING_MONO10P:
+					for (; x < inEndX; x++)
+					{
+						size_t	bitPos = (size_t )x * 10;
+						const unsigned char	*p = inSrc + bitPos / 8;
+						unsigned int	v = p[0] | ((unsigned int )p[1] << 8);
+						outDst[x] = (unsigned short )((v >> (bitPos % 8)) & 0x3FF);
+					}
+					break;
+				case PACKING_MONO12P:
+					for (; x < inEndX; x++)
+					{
+						const unsigned char	*p = inSrc + (size_t )(x / 2) * 3;
+						if ((x & 1) == 0)
+							outDst[x] = (unsigned short )(p[0] | ((p[1] & 0x0F) << 8));
+						else
+							outDst[x] = (unsigned short )((p[1] >> 4) | (p[2] << 4));
+					}
+					break;
+				case PACKING_MONO12_PACKED:
+					for (; x < inEndX; x++)
+					{
+						const unsigned char	*p = inSrc + (size_t )(x / 2) * 3;
+						if ((x & 1) == 0)
+							outDst[x] = (unsigned short )((p[0] << 4) | (p[1] & 0x0F));
+						else
+							outDst[x] = (unsigned short )((p[2] << 4) | (p[1] >> 4));
+					}
+					break;
+				default:
+					break;
+			}
+		}
+
+	#ifdef VIW_CPU_X86_DISPATCH
+		// ---------------------------------------------------------------------
+		// unpackLineSSSE3
+		// ---------------------------------------------------------------------
+		//	Produces 8 pixels per iteration. A byte shuffle gathers the two
+		//	bytes each pixel straddles into a 16bit lane, then the per-lane bit
+		//	offset is removed with a multiply (left shift) and a fixed right
+		//	shift. Returns the first x that is left for the scalar loop.
+		VIW_TARGET_SSSE3
+		static int	unpackLineSSSE3(PackingType inType, const unsigned char *inSrc, int inWidth,
+								unsigned short *outDst)
+		{
+			int		x = 0;
+			size_t	lineBytes = obtainLineByteSize(inType, inWidth);
+
+			if (inType == PACKING_MONO10P)
+			{
+				const __m128i	shuffle = _mm_setr_epi8(0, 1, 1, 2, 2, 3, 3, 4,
+														5, 6, 6, 7, 7, 8, 8, 9);
+				const __m128i	scale = _mm_setr_epi16(64, 16, 4, 1, 64, 16, 4, 1);
+				for (; x + 8 <= inWidth && (size_t )x * 10 / 8 + 16 <= lineBytes; x += 8)
+				{
+					__m128i	v = _mm_loadu_si128((const __m128i *)(inSrc + (size_t )x * 10 / 8));
+					v = _mm_shuffle_epi8(v, shuffle);
+					v = _mm_srli_epi16(_mm_mullo_epi16(v, scale), 6);
+					_mm_storeu_si128((__m128i *)(outDst + x), v);
+				}
+			}
+			else if (inType == PACKING_MONO12P)
+			{
+				const __m128i	shuffle = _mm_setr_epi8(0, 1, 1, 2, 3, 4, 4, 5,
+														6, 7, 7, 8, 9, 10, 10, 11);
+				const __m128i	scale = _mm_setr_epi16(16, 1, 16, 1, 16, 1, 16, 1);
+				for (; x + 8 <= inWidth && (size_t )x * 3 / 2 + 16 <= lineBytes; x += 8)
+				{
+					__m128i	v = _mm_loadu_si128((const __m128i *)(inSrc + (size_t )x * 3 / 2));
+					v = _mm_shuffle_epi8(v, shuffle);
+					v = _mm_srli_epi16(_mm_mullo_epi16(v, scale), 4);
+					_mm_storeu_si128((__m128i *)(outDst + x), v);
+				}
+			}
+			else if (inType == PACKING_MONO12_PACKED)
+			{
+				// even lanes hold (byte1 | byte0 << 8), odd lanes (byte1 | byte2 << 8)
+				const __m128i	shuffle = _mm_setr_epi8(1, 0, 1, 2, 4, 3, 4, 5,
+														7, 6, 7, 8, 10, 9, 10, 11);
+				const __m128i	highMask = _mm_setr_epi16(0x0FF0, -1, 0x0FF0, -1, 0x0FF0, -1, 0x0FF0, -1);
+				const __m128i	lowMask = _mm_setr_epi16(0x000F, 0, 0x000F, 0, 0x000F, 0, 0x000F, 0);
+				for (; x + 8 <= inWidth && (size_t )x * 3 / 2 + 16 <= lineBytes; x += 8)
+				{
+					__m128i	v = _mm_loadu_si128((const __m128i *)(inSrc + (size_t )x * 3 / 2));
+					v = _mm_shuffle_epi8(v, shuffle);
+					v = _mm_or_si128(_mm_and_si128(_mm_srli_epi16(v, 4), highMask),
+									 _mm_and_si128(v, lowMask));
+					_mm_storeu_si128((__m128i *)(outDst + x), v);
+				}
+			}
+
+			return x;
+		}
+	#endif
+	};
+ };
+};
+
+#endif	// #ifdef VIW_UTIL_PACKEDPIXEL_H
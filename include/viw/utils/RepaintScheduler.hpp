@@ -0,0 +1,161 @@
+// =============================================================================
+//  RepaintScheduler.hpp
+//
+//  Written in 2014 by Dairoku Sekiguchi (sekiguchi at acm dot org)
+//
+//  To the extent possible under law, the author(s) have dedicated all copyright
+//  and related and neighboring rights to this software to the public domain worldwide.
+//  This software is distributed without any warranty.
+//
+//  You should have received a copy of the CC0 Public Domain Dedication along with
+//  this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+// =============================================================================
+/*!
+	\file		viw/utils/RepaintScheduler.h
+	\author		Dairoku Sekiguchi
+	\version	1.0.0
+	\date		2026/10/19
+	\brief		Header file for viw library types
+
+	This file defines the repaint rate limiter for viw library
+*/
+
+#ifndef VIW_UTIL_REPAINTSCHEDULER_H
+#define VIW_UTIL_REPAINTSCHEDULER_H
+
+// Includes --------------------------------------------------------------------
+#include <atomic>
+#include <chrono>
+
+
+// Namespace -------------------------------------------------------------------
+namespace viw
+{
+ namespace utils
+ {
+	// -------------------------------------------------------------------------
+	// RepaintScheduler class
+	// -------------------------------------------------------------------------
+	//	Coalesces frame updates to at most one repaint per period. The
+	//	producer calls submitFrame() for every frame and repaints only when
+	//	it returns true; the frames in between are never mapped, the next
+	//	repaint shows the newest one. A periodic call of flushPending() on
+	//	the UI thread repaints the frame left pending when the producer
+	//	stops or slows down.
+	class	RepaintScheduler
+	{
+	public:
+		// Constatns -----------------------------------------------------------
+		const static int	DEFAULT_RATE	= 60;
+
+		// Constructors and Destructor -----------------------------------------
+		// ---------------------------------------------------------------------
+		// RepaintScheduler
+		// ---------------------------------------------------------------------
+		RepaintScheduler(double inRate = DEFAULT_RATE)
+			: mPeriodNs(0), mLastRepaintNs(0), mIsPending(false)
+		{
+			setRate(inRate);
+		}
+
+		// Member functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// setRate
+		// ---------------------------------------------------------------------
+		//	Repaints per second, <= 0 repaints every frame
+		void	setRate(double inRate)
+		{
+			long long	periodNs = 0;
+			if (inRate > 0)
+				periodNs = (long long )(1e9 / inRate);
+			mPeriodNs.store(periodNs, std::memory_order_relaxed);
+		}
+		// ---------------------------------------------------------------------
+		// getRate
+		// ---------------------------------------------------------------------
+		double	getRate() const
+		{
+			long long	periodNs = mPeriodNs.load(std::memory_order_relaxed);
+			if (periodNs <= 0)
+				return 0;
+			return 1e9 / (double )periodNs;
+		}
+		// ---------------------------------------------------------------------
+		// getPeriodMs
+		// ---------------------------------------------------------------------
+		int	getPeriodMs() const
+		{
+			return (int )(mPeriodNs.load(std::memory_order_relaxed) / 1000000);
+		}
+		// ---------------------------------------------------------------------
+		// submitFrame
+		// ---------------------------------------------------------------------
+		//	true : the caller repaints now
+		bool	submitFrame()
+		{
+			mIsPending.store(true, std::memory_order_release);
+			return tryRepaint(getNowNs());
+		}
+		// ---------------------------------------------------------------------
+		// markPending
+		// ---------------------------------------------------------------------
+		//	A frame that is not shown now (e.g. the window is minimized) but
+		//	has to be repainted when flushPending() is called next
+		void	markPending()
+		{
+			mIsPending.store(true, std::memory_order_release);
+		}
+		// ---------------------------------------------------------------------
+		// flushPending
+		// ---------------------------------------------------------------------
+		//	true : a frame is pending and its period has come
+		bool	flushPending()
+		{
+			if (mIsPending.load(std::memory_order_acquire) == false)
+				return false;
+			return tryRepaint(getNowNs());
+		}
+		// ---------------------------------------------------------------------
+		// isPending
+		// ---------------------------------------------------------------------
+		bool	isPending() const
+		{
+			return mIsPending.load(std::memory_order_acquire);
+		}
+
+	private:
+		// Member variables ----------------------------------------------------
+		std::atomic<long long>	mPeriodNs;
+		std::atomic<long long>	mLastRepaintNs;
+		std::atomic<bool>		mIsPending;
+
+		// Member functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// tryRepaint
+		// ---------------------------------------------------------------------
+		//	Only one of the callers racing for a period wins it
+		bool	tryRepaint(long long inNowNs)
+		{
+			long long	last = mLastRepaintNs.load(std::memory_order_relaxed);
+			if (inNowNs - last < mPeriodNs.load(std::memory_order_relaxed))
+				return false;
+			if (mLastRepaintNs.compare_exchange_strong(last, inNowNs, std::memory_order_relaxed) == false)
+				return false;
+			mIsPending.store(false, std::memory_order_release);
+			return true;
+		}
+
+		// Static Functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// getNowNs
+		// ---------------------------------------------------------------------
+		static long long	getNowNs()
+		{
+			return (long long )std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now().time_since_epoch()).count();
+		}
+	};
+ };
+};
+
+#endif	// #ifdef VIW_UTIL_REPAINTSCHEDULER_H
@@ -0,0 +1,675 @@
+// =============================================================================
+//  SharedFrameRing.hpp
+//
+//  Written in 2014 by Dairoku Sekiguchi (sekiguchi at acm dot org)
+//
+//  To the extent possible under law, the author(s) have dedicated all copyright
+//  and related and neighboring rights to this software to the public domain worldwide.
+//  This software is distributed without any warranty.
+//
+//  You should have received a copy of the CC0 Public Domain Dedication along with
+//  this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+// =============================================================================
+/*!
+	\file		viw/utils/SharedFrameRing.h
+	\author		Dairoku Sekiguchi
+	\version	1.0.0
+	\date		2026/10/19
+	\brief		Header file for viw library types
+
+	This file defines the shared memory frame ring for viw library
+*/
+
+#ifndef VIW_UTIL_SHAREDFRAMERING_H
+#define VIW_UTIL_SHAREDFRAMERING_H
+
+// Includes --------------------------------------------------------------------
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+#include <stdio.h>
+#include <string.h>
+#include "viw/Exception.hpp"
+
+
+// Namespace -------------------------------------------------------------------
+namespace viw
+{
+ namespace utils
+ {
+	// -------------------------------------------------------------------------
+	// SharedFrameRing class
+	// -------------------------------------------------------------------------
+	//	A ring of frame slots in a named shared memory object (POSIX shm_open
+	//	or a Win32 file mapping). One producer process writes frames, any
+	//	number of viewer processes attach and read them in place, e.g.
+	//
+	//		const void	*ptr = ring.acquireLatestFrame(&info);
+	//		buffer.setImageBufferPtr(info.width, info.height,
+	//			(unsigned short *)ptr, (BufferFormat )info.format);
+	//
+	//	format is an ImageBuffer::BufferFormat value, lineByteSize must be
+	//	what ImageBuffer expects for the format (no line padding).
+	//
+	//	Slot ownership uses sequence numbers only. A slot state is WRITING or
+	//	the published frame number + 1. A reader pins a slot by incrementing
+	//	its reader count and then re-checks the state; the producer marks a
+	//	slot WRITING and then re-checks the reader count. Both sides use
+	//	sequentially consistent operations, so one of them always backs off.
+	//	A frame the producer can't place (every slot pinned) is dropped and
+	//	counted. Viewers always pick the newest frame and count the frames
+	//	they skipped. A viewer that dies while holding a frame keeps that
+	//	slot pinned, so use at least (viewer count + 2) slots.
+	class	SharedFrameRing
+	{
+	public:
+		// Constatns -----------------------------------------------------------
+		const static unsigned int	RING_MAGIC			= 0x474E5256;	// "VRNG"
+		const static unsigned int	RING_VERSION		= 1;
+		const static int			SLOT_ALIGNMENT		= 4096;
+		const static int			MAX_NAME_LEN		= 256;
+		const static int			ACQUIRE_RETRY_NUM	= 16;
+
+		// Structs -------------------------------------------------------------
+		struct FrameInfo
+		{
+			int			format;			// ImageBuffer::BufferFormat
+			int			width;
+			int			height;
+			int			elementSize;	// sizeof(ImageBufferType)
+			size_t		lineByteSize;
+			long long	frameNumber;
+			long long	timestamp;		// given by the producer
+		};
+
+		// Constructors and Destructor -----------------------------------------
+		// ---------------------------------------------------------------------
+		// SharedFrameRing
+		// ---------------------------------------------------------------------
+		SharedFrameRing(bool inThrowsEx = false)
+		{
+			mThrowsEx = inThrowsEx;
+			mIsProducer = false;
+			mMappedPtr = NULL;
+			mMappedSize = 0;
+			mName[0] = 0;
+		#ifdef _WIN32
+			mMappingHandle = NULL;
+		#endif
+			resetState();
+		}
+		// ---------------------------------------------------------------------
+		// ~SharedFrameRing
+		// ---------------------------------------------------------------------
+		virtual ~SharedFrameRing()
+		{
+			close();
+		}
+
+		// Member functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// create
+		// ---------------------------------------------------------------------
+		//	Creates the ring as the producer. It fails when the name is taken,
+		//	inReplace unlinks the existing object first (e.g. the stale ring of
+		//	a crashed producer, viewers still attached to it keep the old
+		//	one). A Win32 mapping only lives while a process holds it, so
+		//	there it always fails.
+		bool	create(const char *inName, int inSlotCount, int inFormat,
+						int inWidth, int inHeight, int inElementSize, size_t inLineByteSize,
+						bool inReplace = false)
+		{
+			close();
+
+			if (inName == NULL || inSlotCount < 2 || inWidth <= 0 || inHeight <= 0 ||
+				inElementSize <= 0 || inLineByteSize == 0)
+				return error(ViwException::PARAM_ERROR, "Invalid parameter", 0);
+
+			size_t	frameByteSize = inLineByteSize * inHeight;
+			size_t	slotByteSize = alignSize(frameByteSize, SLOT_ALIGNMENT);
+			size_t	dataOffset = alignSize(sizeof(RingHeader) + sizeof(SlotHeader) * inSlotCount, SLOT_ALIGNMENT);
+			size_t	totalSize = dataOffset + slotByteSize * inSlotCount;
+
+			if (mapSharedMemory(inName, totalSize, true, inReplace) == false)
+				return false;
+			mIsProducer = true;
+
+			RingHeader	*header = getHeader();
+			::memset(header, 0, dataOffset);
+			header->version = RING_VERSION;
+			header->format = inFormat;
+			header->width = inWidth;
+			header->height = inHeight;
+			header->elementSize = inElementSize;
+			header->slotCount = inSlotCount;
+			header->lineByteSize = inLineByteSize;
+			header->frameByteSize = frameByteSize;
+			header->slotByteSize = slotByteSize;
+			header->dataOffset = dataOffset;
+			header->totalSize = totalSize;
+			atomicStore((volatile long long *)&header->magic, RING_MAGIC);	// publish the layout last
+			return true;
+		}
+		// ---------------------------------------------------------------------
+		// open
+		// ---------------------------------------------------------------------
+		//	Attaches to an existing ring as a viewer
+		bool	open(const char *inName)
+		{
+			close();
+
+			if (inName == NULL)
+				return error(ViwException::PARAM_ERROR, "inName == NULL", 0);
+
+			if (mapSharedMemory(inName, 0, false, false) == false)
+				return false;
+
+			RingHeader	*header = getHeader();
+			if (mMappedSize < sizeof(RingHeader) ||
+				atomicLoad((volatile long long *)&header->magic) != RING_MAGIC ||
+				header->version != RING_VERSION || (size_t )header->totalSize > mMappedSize)
+			{
+				close();
+				return error(ViwException::INVALID_OPERATION_ERROR, "Not a valid frame ring", 0);
+			}
+			return true;
+		}
+		// ---------------------------------------------------------------------
+		// close
+		// ---------------------------------------------------------------------
+		void	close()
+		{
+			if (mMappedPtr == NULL)
+				return;
+
+			if (mIsProducer == false)
+				releaseFrame();
+
+		#ifdef _WIN32
+			UnmapViewOfFile(mMappedPtr);
+			CloseHandle(mMappingHandle);
+			mMappingHandle = NULL;
+		#else
+			munmap(mMappedPtr, mMappedSize);
+			if (mIsProducer)
+				shm_unlink(mName);
+		#endif
+			mMappedPtr = NULL;
+			mMappedSize = 0;
+			mIsProducer = false;
+			mName[0] = 0;
+			resetState();
+		}
+		// ---------------------------------------------------------------------
+		// isOpened
+		// ---------------------------------------------------------------------
+		bool	isOpened() const
+		{
+			return (mMappedPtr != NULL);
+		}
+		// ---------------------------------------------------------------------
+		// getFrameInfo
+		// ---------------------------------------------------------------------
+		bool	getFrameInfo(FrameInfo *outInfo) const
+		{
+			if (mMappedPtr == NULL)
+				return false;
+
+			const RingHeader	*header = getHeader();
+			outInfo->format = (int )header->format;
+			outInfo->width = (int )header->width;
+			outInfo->height = (int )header->height;
+			outInfo->elementSize = (int )header->elementSize;
+			outInfo->lineByteSize = (size_t )header->lineByteSize;
+			outInfo->frameNumber = -1;
+			outInfo->timestamp = 0;
+			return true;
+		}
+
+		// Producer ------------------------------------------------------------
+		// ---------------------------------------------------------------------
+		// beginWrite
+		// ---------------------------------------------------------------------
+		//	Returns the slot to fill, or NULL when every slot is held by a
+		//	viewer (the frame is counted as dropped)
+		void	*beginWrite()
+		{
+			if (mMappedPtr == NULL || mIsProducer == false || mWriteSlot >= 0)
+				return NULL;
+
+			RingHeader	*header = getHeader();
+			int	slotCount = header->slotCount;
+
+			// Start after the newest frame, so it is the last one reused
+			for (int i = 1; i <= slotCount; i++)
+			{
+				int			index = (mLastSlot + i) % slotCount;
+				SlotHeader	*slot = getSlotHeader(index);
+
+				if (atomicLoad(&slot->readerCount) != 0)
+					continue;
+				long long	prevState = atomicLoad(&slot->state);
+				atomicStore(&slot->state, SLOT_STATE_WRITING);
+				if (atomicLoad(&slot->readerCount) != 0)
+				{
+					atomicStore(&slot->state, prevState);	// a viewer won the race
+					continue;
+				}
+
+				mWriteSlot = index;
+				return getSlotData(index);
+			}
+
+			atomicAdd(&header->producerDropCount, 1);
+			return NULL;
+		}
+		// ---------------------------------------------------------------------
+		// endWrite
+		// ---------------------------------------------------------------------
+		//	Publishes the slot returned by beginWrite()
+		bool	endWrite(long long inTimestamp = 0)
+		{
+			if (mMappedPtr == NULL || mWriteSlot < 0)
+				return false;
+
+			RingHeader	*header = getHeader();
+			SlotHeader	*slot = getSlotHeader(mWriteSlot);
+			long long	frameNumber = atomicLoad(&header->publishedCount);
+
+			slot->frameNumber = frameNumber;
+			slot->timestamp = inTimestamp;
+			atomicStore(&slot->state, frameNumber + 1);
+			atomicStore(&header->publishedCount, frameNumber + 1);
+
+			mLastSlot = mWriteSlot;
+			mWriteSlot = -1;
+			return true;
+		}
+		// ---------------------------------------------------------------------
+		// writeFrame
+		// ---------------------------------------------------------------------
+		//	Copies one frame with the given source line stride into the ring
+		bool	writeFrame(const void *inData, size_t inSrcLineByteSize, long long inTimestamp = 0)
+		{
+			unsigned char	*dstPtr = (unsigned char *)beginWrite();
+			if (dstPtr == NULL)
+				return false;
+
+			const RingHeader	*header = getHeader();
+			const unsigned char	*srcPtr = (const unsigned char *)inData;
+			size_t	lineByteSize = (size_t )header->lineByteSize;
+			if (inSrcLineByteSize == lineByteSize)
+				::memcpy(dstPtr, srcPtr, (size_t )header->frameByteSize);
+			else
+			{
+				for (int y = 0; y < header->height; y++)
+					::memcpy(dstPtr + lineByteSize * y, srcPtr + inSrcLineByteSize * y,
+						lineByteSize < inSrcLineByteSize ? lineByteSize : inSrcLineByteSize);
+			}
+			return endWrite(inTimestamp);
+		}
+		// ---------------------------------------------------------------------
+		// getProducerDropCount
+		// ---------------------------------------------------------------------
+		//	Frames the producer dropped because no slot was free
+		long long	getProducerDropCount() const
+		{
+			if (mMappedPtr == NULL)
+				return 0;
+			return atomicLoad(&getHeader()->producerDropCount);
+		}
+		// ---------------------------------------------------------------------
+		// getPublishedCount
+		// ---------------------------------------------------------------------
+		long long	getPublishedCount() const
+		{
+			if (mMappedPtr == NULL)
+				return 0;
+			return atomicLoad(&getHeader()->publishedCount);
+		}
+
+		// Viewer --------------------------------------------------------------
+		// ---------------------------------------------------------------------
+		// acquireLatestFrame
+		// ---------------------------------------------------------------------
+		//	Returns the newest published frame and keeps it pinned until the
+		//	next acquireLatestFrame() or releaseFrame(). Returns NULL when no
+		//	frame has been published yet. outIsNew is false when the newest
+		//	frame is the one that is already held.
+		const void	*acquireLatestFrame(FrameInfo *outInfo, bool *outIsNew = NULL)
+		{
+			if (outIsNew != NULL)
+				*outIsNew = false;
+			if (mMappedPtr == NULL || mIsProducer)
+				return NULL;
+
+			RingHeader	*header = getHeader();
+			int	slotCount = header->slotCount;
+
+			for (int retry = 0; retry < ACQUIRE_RETRY_NUM; retry++)
+			{
+				long long	published = atomicLoad(&header->publishedCount);
+				if (published == 0)
+					return NULL;
+				if (mHeldSlot >= 0 && mHeldFrameNumber == published - 1)
+					return fillHeldFrameInfo(outInfo);
+
+				int	index = -1;
+				for (int i = 0; i < slotCount; i++)
+					if (atomicLoad(&getSlotHeader(i)->state) == published)
+					{
+						index = i;
+						break;
+					}
+				if (index < 0)
+					continue;	// published again (or being rewritten) meanwhile
+
+				SlotHeader	*slot = getSlotHeader(index);
+				atomicAdd(&slot->readerCount, 1);
+				if (atomicLoad(&slot->state) != published)
+				{
+					atomicAdd(&slot->readerCount, -1);
+					continue;
+				}
+
+				releaseFrame();
+				if (mLastFrameNumber >= 0 && published - 1 > mLastFrameNumber + 1)
+					mSkipCount += published - 1 - mLastFrameNumber - 1;
+				mHeldSlot = index;
+				mHeldFrameNumber = published - 1;
+				mLastFrameNumber = mHeldFrameNumber;
+				mAcquireCount++;
+				if (outIsNew != NULL)
+					*outIsNew = true;
+				return fillHeldFrameInfo(outInfo);
+			}
+
+			// The producer kept overtaking us, keep showing the held frame
+			if (mHeldSlot >= 0)
+				return fillHeldFrameInfo(outInfo);
+			return NULL;
+		}
+		// ---------------------------------------------------------------------
+		// releaseFrame
+		// ---------------------------------------------------------------------
+		void	releaseFrame()
+		{
+			if (mMappedPtr == NULL || mHeldSlot < 0)
+				return;
+
+			atomicAdd(&getSlotHeader(mHeldSlot)->readerCount, -1);
+			mHeldSlot = -1;
+			mHeldFrameNumber = -1;
+		}
+		// ---------------------------------------------------------------------
+		// getLag
+		// ---------------------------------------------------------------------
+		//	Frames published after the one this viewer holds (or last held)
+		long long	getLag() const
+		{
+			if (mMappedPtr == NULL || mLastFrameNumber < 0)
+				return 0;
+			return atomicLoad(&getHeader()->publishedCount) - 1 - mLastFrameNumber;
+		}
+		// ---------------------------------------------------------------------
+		// getSkipCount
+		// ---------------------------------------------------------------------
+		//	Frames this viewer never acquired because a newer one was there
+		long long	getSkipCount() const
+		{
+			return mSkipCount;
+		}
+		// ---------------------------------------------------------------------
+		// getAcquireCount
+		// ---------------------------------------------------------------------
+		long long	getAcquireCount() const
+		{
+			return mAcquireCount;
+		}
+
+	protected:
+		// Constatns -----------------------------------------------------------
+		const static long long	SLOT_STATE_WRITING	= -1;
+
+		// Structs -------------------------------------------------------------
+		//	Shared memory layout, 64bit fields only so 32 and 64bit processes
+		//	agree on it
+		struct RingHeader
+		{
+			long long	magic;				// written last by create()
+			long long	version;
+			long long	format;
+			long long	width;
+			long long	height;
+			long long	elementSize;
+			long long	slotCount;
+			long long	lineByteSize;
+			long long	frameByteSize;
+			long long	slotByteSize;
+			long long	dataOffset;
+			long long	totalSize;
+			long long	reserved[4];
+			volatile long long	publishedCount;
+			char		padding0[56];		// keep the counters on their own lines
+			volatile long long	producerDropCount;
+			char		padding1[56];
+		};
+		struct SlotHeader
+		{
+			volatile long long	state;		// SLOT_STATE_WRITING or frame number + 1
+			volatile long long	readerCount;
+			long long	frameNumber;
+			long long	timestamp;
+			char		padding[32];
+		};
+
+		// Member variables ----------------------------------------------------
+		bool				mThrowsEx;
+		bool				mIsProducer;
+		char				mName[MAX_NAME_LEN];
+		void				*mMappedPtr;
+		size_t				mMappedSize;
+	#ifdef _WIN32
+		HANDLE				mMappingHandle;
+	#endif
+		int					mWriteSlot;
+		int					mLastSlot;
+		int					mHeldSlot;
+		long long			mHeldFrameNumber;
+		long long			mLastFrameNumber;
+		long long			mSkipCount;
+		long long			mAcquireCount;
+
+		// Member functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// resetState
+		// ---------------------------------------------------------------------
+		void	resetState()
+		{
+			mWriteSlot = -1;
+			mLastSlot = -1;
+			mHeldSlot = -1;
+			mHeldFrameNumber = -1;
+			mLastFrameNumber = -1;
+			mSkipCount = 0;
+			mAcquireCount = 0;
+		}
+		// ---------------------------------------------------------------------
+		// getHeader
+		// ---------------------------------------------------------------------
+		RingHeader	*getHeader() const
+		{
+			return (RingHeader *)mMappedPtr;
+		}
+		// ---------------------------------------------------------------------
+		// getSlotHeader
+		// ---------------------------------------------------------------------
+		SlotHeader	*getSlotHeader(int inIndex) const
+		{
+			return (SlotHeader *)((unsigned char *)mMappedPtr + sizeof(RingHeader)) + inIndex;
+		}
+		// ---------------------------------------------------------------------
+		// getSlotData
+		// ---------------------------------------------------------------------
+		unsigned char	*getSlotData(int inIndex) const
+		{
+			const RingHeader	*header = getHeader();
+			return (unsigned char *)mMappedPtr + (size_t )header->dataOffset +
+					(size_t )header->slotByteSize * inIndex;
+		}
+		// ---------------------------------------------------------------------
+		// fillHeldFrameInfo
+		// ---------------------------------------------------------------------
+		const void	*fillHeldFrameInfo(FrameInfo *outInfo)
+		{
+			if (outInfo != NULL)
+			{
+				getFrameInfo(outInfo);
+				outInfo->frameNumber = mHeldFrameNumber;
+				outInfo->timestamp = getSlotHeader(mHeldSlot)->timestamp;
+			}
+			return getSlotData(mHeldSlot);
+		}
+		// ---------------------------------------------------------------------
+		// mapSharedMemory
+		// ---------------------------------------------------------------------
+		//	inSize is ignored (the existing size is used) when inCreate is false
+		bool	mapSharedMemory(const char *inName, size_t inSize, bool inCreate, bool inReplace)
+		{
+		#ifdef _WIN32
+			(void )inReplace;
+			sprintf_s(mName, MAX_NAME_LEN, "%s", inName);
+			if (inCreate)
+				mMappingHandle = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+									(DWORD )((unsigned long long )inSize >> 32), (DWORD )inSize, mName);
+			else
+				mMappingHandle = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, mName);
+			if (mMappingHandle == NULL)
+				return error(ViwException::OS_ERROR, "Can't open the file mapping", GetLastError());
+			if (inCreate && GetLastError() == ERROR_ALREADY_EXISTS)
+			{
+				CloseHandle(mMappingHandle);
+				mMappingHandle = NULL;
+				return error(ViwException::INVALID_OPERATION_ERROR, "The ring name is in use", ERROR_ALREADY_EXISTS);
+			}
+
+			mMappedPtr = MapViewOfFile(mMappingHandle, FILE_MAP_ALL_ACCESS, 0, 0, inSize);
+			if (mMappedPtr == NULL)
+			{
+				DWORD	errorCode = GetLastError();
+				CloseHandle(mMappingHandle);
+				mMappingHandle = NULL;
+				return error(ViwException::OS_ERROR, "MapViewOfFile failed", errorCode);
+			}
+			if (inCreate == false)
+			{
+				MEMORY_BASIC_INFORMATION	info;
+				VirtualQuery(mMappedPtr, &info, sizeof(info));
+				inSize = info.RegionSize;
+			}
+		#else
+			// POSIX names are "/name"
+			snprintf(mName, MAX_NAME_LEN, "%s%s", (inName[0] == '/') ? "" : "/", inName);
+			int	fd;
+			if (inCreate)
+			{
+				if (inReplace)
+					shm_unlink(mName);
+				fd = shm_open(mName, O_CREAT | O_EXCL | O_RDWR, 0600);
+				if (fd < 0 && errno == EEXIST)
+					return error(ViwException::INVALID_OPERATION_ERROR, "The ring name is in use", EEXIST);
+				if (fd >= 0 && ftruncate(fd, (off_t )inSize) != 0)
+				{
+					int	errorCode = errno;
+					::close(fd);
+					shm_unlink(mName);
+					return error(ViwException::OS_ERROR, "ftruncate failed", errorCode);
+				}
+			}
+			else
+			{
+				fd = shm_open(mName, O_RDWR, 0);
+				struct stat	st;
+				if (fd >= 0 && fstat(fd, &st) == 0)
+					inSize = (size_t )st.st_size;
+			}
+			if (fd < 0)
+				return error(ViwException::OS_ERROR, "shm_open failed", errno);
+
+			void	*ptr = (inSize != 0) ? mmap(NULL, inSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+			int	errorCode = errno;
+			::close(fd);
+			if (ptr == MAP_FAILED)
+			{
+				if (inCreate)
+					shm_unlink(mName);
+				return error(ViwException::OS_ERROR, "mmap failed", errorCode);
+			}
+			mMappedPtr = ptr;
+		#endif
+			mMappedSize = inSize;
+			return true;
+		}
+		// ---------------------------------------------------------------------
+		// error
+		// ---------------------------------------------------------------------
+		bool	error(int inCode, const char *inDescription, int inOSErrorCode)
+		{
+			if (mThrowsEx == false)
+				return false;
+			else
+				throw ViwException(inCode, inDescription, VIW_EXCEPTION_LOCATION_MACRO, inOSErrorCode);
+		}
+
+		// Static Functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// alignSize
+		// ---------------------------------------------------------------------
+		static size_t	alignSize(size_t inSize, size_t inAlignment)
+		{
+			return (inSize + inAlignment - 1) / inAlignment * inAlignment;
+		}
+		// ---------------------------------------------------------------------
+		// atomicLoad
+		// ---------------------------------------------------------------------
+		static long long	atomicLoad(const volatile long long *inPtr)
+		{
+		#ifdef _WIN32
+			return InterlockedCompareExchange64((volatile LONGLONG *)inPtr, 0, 0);
+		#else
+			return __atomic_load_n(inPtr, __ATOMIC_SEQ_CST);
+		#endif
+		}
+		// ---------------------------------------------------------------------
+		// atomicStore
+		// ---------------------------------------------------------------------
+		static void	atomicStore(volatile long long *inPtr, long long inValue)
+		{
+		#ifdef _WIN32
+			InterlockedExchange64((volatile LONGLONG *)inPtr, inValue);
+		#else
+			__atomic_store_n(inPtr, inValue, __ATOMIC_SEQ_CST);
+		#endif
+		}
+		// ---------------------------------------------------------------------
+		// atomicAdd
+		// ---------------------------------------------------------------------
+		static long long	atomicAdd(volatile long long *inPtr, long long inValue)
+		{
+		#ifdef _WIN32
+			return InterlockedExchangeAdd64((volatile LONGLONG *)inPtr, inValue) + inValue;
+		#else
+			return __atomic_add_fetch(inPtr, inValue, __ATOMIC_SEQ_CST);
+		#endif
+		}
+	};
+ };
+};
+
+#endif	// #ifdef VIW_UTIL_SHAREDFRAMERING_H
@@ -0,0 +1,245 @@
+// =============================================================================
+//  Swizzle.hpp
+//
+//  Written in 2014 by Dairoku Sekiguchi (sekiguchi at acm dot org)
+//
+//  To the extent possible under law, the author(s) have dedicated all copyright
+//  and related and neighboring rights to this software to the public domain worldwide.
+//  This software is distributed without any warranty.
+//
+//  You should have received a copy of the CC0 Public Domain Dedication along with
+//  this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+// =============================================================================
+/*!
+	\file		viw/utils/Swizzle.h
+	\author		Dairoku Sekiguchi
+	\version	1.0.0
+	\date		2026/10/19
+	\brief		Header file for viw library types
+
+	This file defines the colour channel swizzle for viw library
+*/
+
+#ifndef VIW_UTIL_SWIZZLE_H
+#define VIW_UTIL_SWIZZLE_H
+
+// Includes --------------------------------------------------------------------
+#include <stdio.h>
+#include "viw/utils/CpuFeatures.hpp"
+
+// Macros ----------------------------------------------------------------------
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define	VIW_SWIZZLE_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+
+// Namespace -------------------------------------------------------------------
+namespace viw
+{
+ namespace utils
+ {
+	// -------------------------------------------------------------------------
+	// Swizzle class
+	// -------------------------------------------------------------------------
+	//	Swaps the first and the third channel of 3 (RGB <-> BGR) or 4
+	//	(RGBA <-> BGRA) channel pixels. inSrc and outDst may be the same
+	//	line, so a mapped display line can be fixed up while it is in cache.
+	class	Swizzle
+	{
+	public:
+		// Static Functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// swapRedBlueLine
+		// ---------------------------------------------------------------------
+		static void	swapRedBlueLine(const unsigned char *inSrc, int inWidth, int inPixelSize,
+								unsigned char *outDst)
+		{
+			static const SwapLineFunc	swapLineFunc = selectSwapLineFunc();
+
+			int	x = swapLineFunc(inSrc, inWidth, inPixelSize, outDst);
+			swapRedBlueLineScalar(inSrc, x, inWidth, inPixelSize, outDst);
+		}
+		// ---------------------------------------------------------------------
+		// swapRedBlueLine
+		// ---------------------------------------------------------------------
+		//	Direct (cast) mapping of a high bit depth line fused with the swap
+		template <typename ImageBufferType>
+		static void	swapRedBlueLine(const ImageBufferType *inSrc, int inWidth, int inPixelSize,
+								unsigned char *outDst)
+		{
+			for (int x = 0; x < inWidth; x++, inSrc += inPixelSize, outDst += inPixelSize)
+			{
+				unsigned char	c0 = obtainDirectValue(inSrc[0]);
+				outDst[0] = obtainDirectValue(inSrc[2]);
+				outDst[1] = obtainDirectValue(inSrc[1]);
+				outDst[2] = c0;
+				if (inPixelSize == 4)
+					outDst[3] = obtainDirectValue(inSrc[3]);
+			}
+		}
+		// ---------------------------------------------------------------------
+		// obtainDirectValue
+		// ---------------------------------------------------------------------
+		//	The direct mapping of one element. Integer types keep the plain
+		//	cast, floating point ones are clamped to [0, 255] first (NaN is 0)
+		//	because casting an out of range value is undefined.
+		template <typename ImageBufferType>
+		static unsigned char	obtainDirectValue(ImageBufferType inValue)
+		{
+			return (unsigned char )inValue;
+		}
+		static unsigned char	obtainDirectValue(float inValue)
+		{
+			if (!(inValue > 0))
+				return 0;
+			if (inValue >= 255)
+				return 255;
+			return (unsigned char )inValue;
+		}
+		static unsigned char	obtainDirectValue(double inValue)
+		{
+			if (!(inValue > 0))
+				return 0;
+			if (inValue >= 255)
+				return 255;
+			return (unsigned char )inValue;
+		}
+
+	private:
+		// Typedefs ------------------------------------------------------------
+		//	The vector variants return the first x left for the scalar loop
+		typedef int	(*SwapLineFunc)(const unsigned char *inSrc, int inWidth, int inPixelSize,
+								unsigned char *outDst);
+
+		// Static Functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// selectSwapLineFunc
+		// ---------------------------------------------------------------------
+		static SwapLineFunc	selectSwapLineFunc()
+		{
+		#ifdef VIW_CPU_X86_DISPATCH
+			if (CpuFeatures::isEnabled(CpuFeatures::ISA_AVX2))
+				return swapRedBlueLineAVX2;
+			if (CpuFeatures::isEnabled(CpuFeatures::ISA_SSSE3))
+				return swapRedBlueLineSSSE3;
+		#endif
+		#ifdef VIW_SWIZZLE_USE_SSE2
+			if (CpuFeatures::isEnabled(CpuFeatures::ISA_SSE2))
+				return swapRedBlueLineSSE2;
+		#endif
+			return swapRedBlueLineNone;
+		}
+		// ---------------------------------------------------------------------
+		// swapRedBlueLineNone
+		// ---------------------------------------------------------------------
+		static int	swapRedBlueLineNone(const unsigned char *, int, int, unsigned char *)
+		{
+			return 0;
+		}
+		// ---------------------------------------------------------------------
+		// swapRedBlueLineScalar
+		// ---------------------------------------------------------------------
+		static void	swapRedBlueLineScalar(const unsigned char *inSrc, int inStartX, int inEndX,
+								int inPixelSize, unsigned char *outDst)
+		{
+			inSrc += inStartX * inPixelSize;
+			outDst += inStartX * inPixelSize;
+			for (int x = inStartX; x < inEndX; x++, inSrc += inPixelSize, outDst += inPixelSize)
+			{
+				unsigned char	c0 = inSrc[0];
+				outDst[0] = inSrc[2];
+				outDst[1] = inSrc[1];
+				outDst[2] = c0;
+				if (inPixelSize == 4)
+					outDst[3] = inSrc[3];
+			}
+		}
+	#ifdef VIW_SWIZZLE_USE_SSE2
+		// ---------------------------------------------------------------------
+		// swapRedBlueLineSSE2
+		// ---------------------------------------------------------------------
+		//	4 channels only, with shifts and masks
+		static int	swapRedBlueLineSSE2(const unsigned char *inSrc, int inWidth, int inPixelSize,
+								unsigned char *outDst)
+		{
+			int	x = 0;
+			if (inPixelSize != 4)
+				return x;
+
+			const __m128i	keepMask = _mm_set1_epi32(0xFF00FF00);
+			const __m128i	lowMask = _mm_set1_epi32(0x000000FF);
+			for (; x + 4 <= inWidth; x += 4)
+			{
+				__m128i	v = _mm_loadu_si128((const __m128i *)(inSrc + x * 4));
+				__m128i	r = _mm_or_si128(_mm_and_si128(v, keepMask),
+										 _mm_and_si128(_mm_srli_epi32(v, 16), lowMask));
+				r = _mm_or_si128(r, _mm_slli_epi32(_mm_and_si128(v, lowMask), 16));
+				_mm_storeu_si128((__m128i *)(outDst + x * 4), r);
+			}
+			return x;
+		}
+	#endif
+	#ifdef VIW_CPU_X86_DISPATCH
+		// ---------------------------------------------------------------------
+		// swapRedBlueLineSSSE3
+		// ---------------------------------------------------------------------
+		VIW_TARGET_SSSE3
+		static int	swapRedBlueLineSSSE3(const unsigned char *inSrc, int inWidth, int inPixelSize,
+								unsigned char *outDst)
+		{
+			int	x = 0;
+
+			if (inPixelSize == 4)
+			{
+				const __m128i	shuffle = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7,
+														10, 9, 8, 11, 14, 13, 12, 15);
+				for (; x + 4 <= inWidth; x += 4)
+				{
+					__m128i	v = _mm_loadu_si128((const __m128i *)(inSrc + x * 4));
+					_mm_storeu_si128((__m128i *)(outDst + x * 4), _mm_shuffle_epi8(v, shuffle));
+				}
+			}
+			else if (inPixelSize == 3)
+			{
+				// 5 pixels (15 bytes) per step, the 16th byte is written back
+				// unchanged and it is the first byte of the next step
+				const __m128i	shuffle = _mm_setr_epi8(2, 1, 0, 5, 4, 3, 8, 7,
+														6, 11, 10, 9, 14, 13, 12, 15);
+				for (; x + 6 <= inWidth; x += 5)
+				{
+					__m128i	v = _mm_loadu_si128((const __m128i *)(inSrc + x * 3));
+					_mm_storeu_si128((__m128i *)(outDst + x * 3), _mm_shuffle_epi8(v, shuffle));
+				}
+			}
+			return x;
+		}
+		// ---------------------------------------------------------------------
+		// swapRedBlueLineAVX2
+		// ---------------------------------------------------------------------
+		//	8 pixels per step for 4 channels, 3 channels use the SSSE3 code
+		VIW_TARGET_AVX2
+		static int	swapRedBlueLineAVX2(const unsigned char *inSrc, int inWidth, int inPixelSize,
+								unsigned char *outDst)
+		{
+			if (inPixelSize != 4)
+				return swapRedBlueLineSSSE3(inSrc, inWidth, inPixelSize, outDst);
+
+			const __m256i	shuffle = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7,
+													10, 9, 8, 11, 14, 13, 12, 15,
+													2, 1, 0, 3, 6, 5, 4, 7,
+													10, 9, 8, 11, 14, 13, 12, 15);
+			int	x = 0;
+			for (; x + 8 <= inWidth; x += 8)
+			{
+				__m256i	v = _mm256_loadu_si256((const __m256i *)(inSrc + x * 4));
+				_mm256_storeu_si256((__m256i *)(outDst + x * 4), _mm256_shuffle_epi8(v, shuffle));
+			}
+			return x;
+		}
+	#endif
+	};
+ };
+};
+
+#endif	// #ifdef VIW_UTIL_SWIZZLE_H
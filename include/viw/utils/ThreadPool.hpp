@@ -0,0 +1,530 @@
+// =============================================================================
+//  ThreadPool.hpp
+//
+//  Written in 2014 by Dairoku Sekiguchi (sekiguchi at acm dot org)
+//
+//  To the extent possible under law, the author(s) have dedicated all copyright
+//  and related and neighboring rights to this software to the public domain worldwide.
+//  This software is distributed without any warranty.
+//
+//  You should have received a copy of the CC0 Public Domain Dedication along with
+//  this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+// =============================================================================
+/*!
+	\file		viw/utils/ThreadPool.h
+	\author		Dairoku Sekiguchi
+	\version	1.0.0
+	\date		2026/10/19
+	\brief		Header file for viw library types
+
+	This file defines the shared worker thread pool for viw library
+*/
+
+#ifndef VIW_UTIL_THREADPOOL_H
+#define VIW_UTIL_THREADPOOL_H
+
+// Includes --------------------------------------------------------------------
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+
+
+// Namespace -------------------------------------------------------------------
+namespace viw
+{
+ namespace utils
+ {
+	// -------------------------------------------------------------------------
+	// ThreadPool class
+	// -------------------------------------------------------------------------
+	//	One process wide pool shared by every window and kernel, so several
+	//	windows never start more workers than there are cores. The workers
+	//	are started by the first parallelFor() that has more than one chunk.
+	//
+	//	parallelFor() splits [inBegin, inEnd) into one contiguous partition
+	//	per participant (the workers plus the calling thread). Each one takes
+	//	chunks of inGrain items from its own partition through an atomic
+	//	cursor and then steals chunks from the other partitions, so uneven
+	//	rows balance out without a shared queue. A parallelFor() issued from
+	//	a worker runs inline.
+	class	ThreadPool
+	{
+	public:
+		// Constatns -----------------------------------------------------------
+		const static int	MAX_THREAD_NUM		= 64;
+		const static int	MAX_TASK_TYPE_NUM	= 32;
+
+		// Structs -------------------------------------------------------------
+		struct TaskStats
+		{
+			const char	*name;
+			long long	callCount;
+			long long	itemCount;
+			long long	totalNanoseconds;
+		};
+
+		// Static Functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// getInstance
+		// ---------------------------------------------------------------------
+		static ThreadPool	&getInstance()
+		{
+			static ThreadPool	pool;
+			return pool;
+		}
+		// ---------------------------------------------------------------------
+		// parallelFor
+		// ---------------------------------------------------------------------
+		//	Calls inFunc(begin, end) for sub ranges of [inBegin, inEnd) and
+		//	returns when all of them are done. inTaskName (a string literal)
+		//	selects the timing counter, NULL skips the timing.
+		template <typename Func>
+		static void	parallelFor(const char *inTaskName, int inBegin, int inEnd, int inGrain, Func inFunc)
+		{
+			getInstance().run(inTaskName, inBegin, inEnd, inGrain, &invokeFunc<Func>, &inFunc);
+		}
+
+		// Member functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// setThreadCount
+		// ---------------------------------------------------------------------
+		//	Total number of threads that work on a parallelFor(), including
+		//	the caller. 0 selects the number of logical processors, 1 runs
+		//	everything on the caller. Waits for the running parallelFor()
+		//	calls, so it must not be called from inside one.
+		void	setThreadCount(int inCount)
+		{
+			if (inCount < 0)
+				inCount = 0;
+			if (inCount > MAX_THREAD_NUM)
+				inCount = MAX_THREAD_NUM;
+
+			std::lock_guard<std::mutex>	startLock(mStartMutex);
+			waitForJobs();
+			stopWorkers();
+			mRequestedThreadCount = inCount;
+		}
+		// ---------------------------------------------------------------------
+		// getThreadCount
+		// ---------------------------------------------------------------------
+		int	getThreadCount()
+		{
+			return obtainThreadCount(mRequestedThreadCount);
+		}
+		// ---------------------------------------------------------------------
+		// setAffinityEnabled
+		// ---------------------------------------------------------------------
+		//	Pins worker n to logical processor n + 1 (the caller keeps the
+		//	others). Takes effect when the workers are (re)started. Like
+		//	setThreadCount(), it waits for the running parallelFor() calls.
+		void	setAffinityEnabled(bool inEnabled)
+		{
+			std::lock_guard<std::mutex>	startLock(mStartMutex);
+			waitForJobs();
+			stopWorkers();
+			mIsAffinityEnabled = inEnabled;
+		}
+		// ---------------------------------------------------------------------
+		// isAffinityEnabled
+		// ---------------------------------------------------------------------
+		bool	isAffinityEnabled()
+		{
+			return mIsAffinityEnabled;
+		}
+		// ---------------------------------------------------------------------
+		// getTaskStats
+		// ---------------------------------------------------------------------
+		//	Returns the number of task types, fills up to inMaxNum entries
+		int	getTaskStats(TaskStats *outStats, int inMaxNum)
+		{
+			std::lock_guard<std::mutex>	lock(mStatsMutex);
+			for (int i = 0; i < mTaskTypeNum && i < inMaxNum; i++)
+				outStats[i] = mTaskStats[i];
+			return mTaskTypeNum;
+		}
+		// ---------------------------------------------------------------------
+		// resetTaskStats
+		// ---------------------------------------------------------------------
+		void	resetTaskStats()
+		{
+			std::lock_guard<std::mutex>	lock(mStatsMutex);
+			for (int i = 0; i < mTaskTypeNum; i++)
+			{
+				mTaskStats[i].callCount = 0;
+				mTaskStats[i].itemCount = 0;
+				mTaskStats[i].totalNanoseconds = 0;
+			}
+		}
+		// ---------------------------------------------------------------------
+		// dumpTaskStats
+		// ---------------------------------------------------------------------
+		void	dumpTaskStats()
+		{
+			std::lock_guard<std::mutex>	lock(mStatsMutex);
+			for (int i = 0; i < mTaskTypeNum; i++)
+			{
+				const TaskStats	&stats = mTaskStats[i];
+				printf("%-24s calls=%lld items=%lld total=%.3f ms avg=%.3f ms\n",
+					stats.name, stats.callCount, stats.itemCount,
+					stats.totalNanoseconds / 1e6,
+					stats.callCount ? stats.totalNanoseconds / 1e6 / stats.callCount : 0.0);
+			}
+		}
+
+	protected:
+		// Typedefs ------------------------------------------------------------
+		typedef void	(*InvokeFunc)(void *inContext, int inBegin, int inEnd);
+
+		// Structs -------------------------------------------------------------
+		struct Partition
+		{
+			std::atomic<int>	next;
+			int					end;
+			char				padding[56];	// one cache line each
+		};
+		struct Job
+		{
+			InvokeFunc			invoke;
+			void				*context;
+			int					grain;
+			int					partitionNum;
+			Partition			partitions[MAX_THREAD_NUM];
+			std::atomic<int>	remainingItems;
+			int					workerRefCount;		// guarded by mJobMutex
+		};
+
+		// Constructors and Destructor -----------------------------------------
+		// ---------------------------------------------------------------------
+		// ThreadPool
+		// ---------------------------------------------------------------------
+		ThreadPool()
+		{
+			mRequestedThreadCount = 0;
+			mIsAffinityEnabled = false;
+			mIsStopRequested = false;
+			mJobCursor = 0;
+			mTaskTypeNum = 0;
+		}
+		// ---------------------------------------------------------------------
+		// ~ThreadPool
+		// ---------------------------------------------------------------------
+		virtual ~ThreadPool()
+		{
+			std::lock_guard<std::mutex>	startLock(mStartMutex);
+			stopWorkers();
+		}
+
+		// Member variables ----------------------------------------------------
+		std::atomic<int>			mRequestedThreadCount;
+		std::atomic<bool>			mIsAffinityEnabled;
+		std::mutex					mStartMutex;		// start / stop of the workers and job entry
+		std::vector<std::thread>	mWorkers;
+
+		std::mutex					mJobMutex;
+		std::condition_variable		mJobCond;
+		std::condition_variable		mDoneCond;
+		std::vector<Job *>			mJobs;
+		unsigned int				mJobCursor;
+		bool						mIsStopRequested;
+
+		std::mutex					mStatsMutex;
+		TaskStats					mTaskStats[MAX_TASK_TYPE_NUM];
+		int							mTaskTypeNum;
+
+		// Member functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// run
+		// ---------------------------------------------------------------------
+		void	run(const char *inTaskName, int inBegin, int inEnd, int inGrain,
+					InvokeFunc inInvoke, void *inContext)
+		{
+			if (inEnd <= inBegin)
+				return;
+			if (inGrain < 1)
+				inGrain = 1;
+
+			std::chrono::steady_clock::time_point	startTime = std::chrono::steady_clock::now();
+			int	threadCount = getThreadCount();
+			int	chunkNum = (inEnd - inBegin + inGrain - 1) / inGrain;
+
+			if (threadCount <= 1 || chunkNum <= 1 || isWorkerThread())
+				inInvoke(inContext, inBegin, inEnd);
+			else
+			{
+				Job	job;
+				job.invoke = inInvoke;
+				job.context = inContext;
+				job.grain = inGrain;
+				job.partitionNum = (chunkNum < threadCount) ? chunkNum : threadCount;
+				job.remainingItems = inEnd - inBegin;
+				job.workerRefCount = 0;
+				for (int i = 0; i < job.partitionNum; i++)
+				{
+					// partition boundaries on chunk boundaries
+					int	beginChunk = (int )((long long )chunkNum * i / job.partitionNum);
+					int	endChunk = (int )((long long )chunkNum * (i + 1) / job.partitionNum);
+					job.partitions[i].next = inBegin + beginChunk * inGrain;
+					job.partitions[i].end = (i == job.partitionNum - 1) ? inEnd : inBegin + endChunk * inGrain;
+				}
+
+				// The job is queued under mStartMutex, so a restart either
+				// happens before the workers are started for it or waits
+				// until it is done
+				bool	isStarted;
+				{
+					std::lock_guard<std::mutex>	startLock(mStartMutex);
+					isStarted = startWorkers();
+					if (isStarted)
+					{
+						std::lock_guard<std::mutex>	lock(mJobMutex);
+						mJobs.push_back(&job);
+					}
+				}
+
+				if (isStarted == false)
+					inInvoke(inContext, inBegin, inEnd);
+				else
+				{
+					mJobCond.notify_all();
+
+					workOnJob(&job, 0);
+
+					std::unique_lock<std::mutex>	lock(mJobMutex);
+					while (job.remainingItems.load() != 0 || job.workerRefCount != 0)
+						mDoneCond.wait(lock);
+					for (size_t i = 0; i < mJobs.size(); i++)
+						if (mJobs[i] == &job)
+						{
+							mJobs.erase(mJobs.begin() + i);
+							break;
+						}
+					mDoneCond.notify_all();		// for waitForJobs()
+				}
+			}
+
+			if (inTaskName != NULL)
+				addTaskTime(inTaskName, inEnd - inBegin, (long long )
+					std::chrono::duration_cast<std::chrono::nanoseconds>(
+						std::chrono::steady_clock::now() - startTime).count());
+		}
+		// ---------------------------------------------------------------------
+		// workOnJob
+		// ---------------------------------------------------------------------
+		//	Runs chunks of inJob, own partition first, then steals from the
+		//	following ones. Returns true when this call finished the job.
+		bool	workOnJob(Job *inJob, int inPartition)
+		{
+			int	doneItems = 0;
+
+			for (int i = 0; i < inJob->partitionNum; i++)
+			{
+				Partition	&part = inJob->partitions[(inPartition + i) % inJob->partitionNum];
+				for (;;)
+				{
+					int	begin = part.next.fetch_add(inJob->grain);
+					if (begin >= part.end)
+						break;
+					int	end = begin + inJob->grain;
+					if (end > part.end)
+						end = part.end;
+					inJob->invoke(inJob->context, begin, end);
+					doneItems += end - begin;
+				}
+			}
+
+			if (doneItems == 0)
+				return false;
+			return (inJob->remainingItems.fetch_sub(doneItems) == doneItems);
+		}
+		// ---------------------------------------------------------------------
+		// workerMain
+		// ---------------------------------------------------------------------
+		void	workerMain(int inIndex)
+		{
+			isWorkerThread() = true;
+			std::unique_lock<std::mutex>	lock(mJobMutex);
+
+			for (;;)
+			{
+				Job	*job = NULL;
+				while (mIsStopRequested == false && (job = findJob()) == NULL)
+					mJobCond.wait(lock);
+				if (mIsStopRequested)
+					break;
+
+				job->workerRefCount++;
+				lock.unlock();
+				bool	isFinished = workOnJob(job, (inIndex + 1) % job->partitionNum);
+				lock.lock();
+				job->workerRefCount--;
+				if (isFinished || (job->workerRefCount == 0 && job->remainingItems.load() == 0))
+					mDoneCond.notify_all();
+			}
+		}
+		// ---------------------------------------------------------------------
+		// findJob
+		// ---------------------------------------------------------------------
+		//	Picks a job that still has chunks, round robin over the callers
+		Job	*findJob()
+		{
+			size_t	num = mJobs.size();
+			for (size_t i = 0; i < num; i++)
+			{
+				Job	*job = mJobs[(mJobCursor + i) % num];
+				for (int p = 0; p < job->partitionNum; p++)
+					if (job->partitions[p].next.load() < job->partitions[p].end)
+					{
+						mJobCursor = (unsigned int )((mJobCursor + i + 1) % num);
+						return job;
+					}
+			}
+			return NULL;
+		}
+		// ---------------------------------------------------------------------
+		// startWorkers
+		// ---------------------------------------------------------------------
+		//	mStartMutex must be held
+		bool	startWorkers()
+		{
+			int	workerNum = getThreadCount() - 1;
+			if ((int )mWorkers.size() == workerNum)
+				return true;
+
+			stopWorkers();
+			mIsStopRequested = false;
+			mJobCursor = 0;
+			try
+			{
+				for (int i = 0; i < workerNum; i++)
+				{
+					mWorkers.push_back(std::thread(&ThreadPool::workerMain, this, i));
+					if (mIsAffinityEnabled)
+						setThreadAffinity(mWorkers.back(), i + 1);
+				}
+			}
+			catch (...)
+			{
+				stopWorkers();
+				return false;
+			}
+			return true;
+		}
+		// ---------------------------------------------------------------------
+		// stopWorkers
+		// ---------------------------------------------------------------------
+		//	mStartMutex must be held, and no parallelFor() may be running
+		void	stopWorkers()
+		{
+			{
+				std::lock_guard<std::mutex>	lock(mJobMutex);
+				mIsStopRequested = true;
+			}
+			mJobCond.notify_all();
+			for (size_t i = 0; i < mWorkers.size(); i++)
+				mWorkers[i].join();
+			mWorkers.clear();
+		}
+		// ---------------------------------------------------------------------
+		// waitForJobs
+		// ---------------------------------------------------------------------
+		//	mStartMutex must be held, so no new job can be queued meanwhile
+		void	waitForJobs()
+		{
+			std::unique_lock<std::mutex>	lock(mJobMutex);
+			while (mJobs.empty() == false)
+				mDoneCond.wait(lock);
+		}
+		// ---------------------------------------------------------------------
+		// isWorkerThread
+		// ---------------------------------------------------------------------
+		static bool	&isWorkerThread()
+		{
+			static thread_local bool	isWorker = false;
+			return isWorker;
+		}
+		// ---------------------------------------------------------------------
+		// addTaskTime
+		// ---------------------------------------------------------------------
+		void	addTaskTime(const char *inTaskName, int inItemCount, long long inNanoseconds)
+		{
+			std::lock_guard<std::mutex>	lock(mStatsMutex);
+			int	i;
+			for (i = 0; i < mTaskTypeNum; i++)
+				if (mTaskStats[i].name == inTaskName || strcmp(mTaskStats[i].name, inTaskName) == 0)
+					break;
+			if (i == mTaskTypeNum)
+			{
+				if (mTaskTypeNum == MAX_TASK_TYPE_NUM)
+					return;
+				mTaskStats[i].name = inTaskName;
+				mTaskStats[i].callCount = 0;
+				mTaskStats[i].itemCount = 0;
+				mTaskStats[i].totalNanoseconds = 0;
+				mTaskTypeNum++;
+			}
+			mTaskStats[i].callCount++;
+			mTaskStats[i].itemCount += inItemCount;
+			mTaskStats[i].totalNanoseconds += inNanoseconds;
+		}
+
+		// Static Functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// invokeFunc
+		// ---------------------------------------------------------------------
+		template <typename Func>
+		static void	invokeFunc(void *inContext, int inBegin, int inEnd)
+		{
+			(*(Func *)inContext)(inBegin, inEnd);
+		}
+		// ---------------------------------------------------------------------
+		// obtainThreadCount
+		// ---------------------------------------------------------------------
+		static int	obtainThreadCount(int inRequested)
+		{
+			if (inRequested > 0)
+				return inRequested;
+
+			int	count = (int )std::thread::hardware_concurrency();
+			if (count < 1)
+				count = 1;
+			if (count > MAX_THREAD_NUM)
+				count = MAX_THREAD_NUM;
+			return count;
+		}
+		// ---------------------------------------------------------------------
+		// setThreadAffinity
+		// ---------------------------------------------------------------------
+		static void	setThreadAffinity(std::thread &inThread, int inProcessor)
+		{
+			int	processorNum = (int )std::thread::hardware_concurrency();
+			if (processorNum <= 0)
+				return;
+			inProcessor %= processorNum;
+		#ifdef _WIN32
+			if (inProcessor < (int )sizeof(DWORD_PTR) * 8)
+				::SetThreadAffinityMask((HANDLE )inThread.native_handle(), (DWORD_PTR )1 << inProcessor);
+		#elif defined(__linux__)
+			cpu_set_t	cpuSet;
+			CPU_ZERO(&cpuSet);
+			CPU_SET(inProcessor, &cpuSet);
+			pthread_setaffinity_np(inThread.native_handle(), sizeof(cpuSet), &cpuSet);
+		#else
+			(void )inThread;
+		#endif
+		}
+	};
+ };
+};
+
+#endif	// #ifdef VIW_UTIL_THREADPOOL_H
@@ -0,0 +1,543 @@
+// =============================================================================
+//  ToneMap.hpp
+//
+//  Written in 2014 by Dairoku Sekiguchi (sekiguchi at acm dot org)
+//
+//  To the extent possible under law, the author(s) have dedicated all copyright
+//  and related and neighboring rights to this software to the public domain worldwide.
+//  This software is distributed without any warranty.
+//
+//  You should have received a copy of the CC0 Public Domain Dedication along with
+//  this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+// =============================================================================
+/*!
+	\file		viw/utils/ToneMap.h
+	\author		Dairoku Sekiguchi
+	\version	1.0.0
+	\date		2026/10/19
+	\brief		Header file for viw library types
+
+	This file defines the non-linear value mapping kernels for viw library
+*/
+
+#ifndef VIW_UTIL_TONEMAP_H
+#define VIW_UTIL_TONEMAP_H
+
+// Includes --------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include "viw/utils/FastMath.hpp"
+#include "viw/utils/Dither.hpp"
+#include "viw/utils/CpuFeatures.hpp"
+
+// Namespace -------------------------------------------------------------------
+namespace viw
+{
+ namespace utils
+ {
+	// -------------------------------------------------------------------------
+	// ToneMap class
+	// -------------------------------------------------------------------------
+	//	Maps lines to 8bit through a transfer curve. With d = v - min and
+	//	n = d / (max - min) the curves are
+	//
+	//	TONE_CURVE_LINEAR : n
+	//	TONE_CURVE_LOG    : log(1 + d) / log(1 + max - min)
+	//	TONE_CURVE_SQRT   : sqrt(n)
+	//	TONE_CURVE_GAMMA  : n ^ (1 / gamma)
+	//
+	//	and the output is floor(255 * curve + t), t from a Dither threshold row.
+	//
+	//	When isNonFiniteMarked is set, finite values use the levels
+	//	[0, FINITE_LEVEL_MAX] and NaN, +Inf and -Inf get their own indices, so
+	//	a palette can show them in dedicated colours.
+	class	ToneMap
+	{
+	public:
+		// Constatns -----------------------------------------------------------
+		enum ToneCurve
+		{
+			TONE_CURVE_LINEAR		= 0,
+			TONE_CURVE_LOG,
+			TONE_CURVE_SQRT,
+			TONE_CURVE_GAMMA
+		};
+		enum ComplexComponent
+		{
+			COMPLEX_MAGNITUDE		= 0,
+			COMPLEX_PHASE			// mapped from [-pi, pi]
+		};
+		const static int	FINITE_LEVEL_MAX	= 252;
+		const static int	NAN_INDEX			= 253;
+		const static int	POS_INF_INDEX		= 254;
+		const static int	NEG_INF_INDEX		= 255;
+
+		// Typedefs ------------------------------------------------------------
+		struct Parameters
+		{
+			ToneCurve	curve;
+			float		minValue;
+			float		invRange;		// 1 / (max - min)
+			float		logScale;		// 1 / log2(1 + max - min)
+			float		gammaExponent;	// 1 / gamma
+			float		outputMax;		// 255 or FINITE_LEVEL_MAX
+			bool		isNonFiniteMarked;
+		};
+
+		// Static Functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// obtainParameters
+		// ---------------------------------------------------------------------
+		static Parameters	obtainParameters(ToneCurve inCurve, double inMin, double inMax, double inGamma,
+								bool inIsNonFiniteMarked = false)
+		{
+			Parameters	param;
+			double	range = inMax - inMin;
+
+			param.curve = inCurve;
+			param.minValue = (float )inMin;
+			param.invRange = (float )(1.0 / range);
+			param.logScale = (float )(1.0 / (log(1.0 + range) / log(2.0)));
+			param.gammaExponent = (float )(1.0 / inGamma);
+			param.isNonFiniteMarked = inIsNonFiniteMarked;
+			param.outputMax = inIsNonFiniteMarked ? (float )FINITE_LEVEL_MAX : 255.0f;
+			return param;
+		}
+		// ---------------------------------------------------------------------
+		// mapLine
+		// ---------------------------------------------------------------------
+		//	inThresholdRow is indexed by the element position in the line
+		template <typename ImageBufferType>
+		static void	mapLine(const ImageBufferType *inSrc, int inCount, const Parameters &inParam,
+								const float *inThresholdRow, unsigned char *outDst)
+		{
+			mapLineScalar(inSrc, 0, inCount, inParam, inThresholdRow, outDst);
+		}
+	#ifdef VIW_FASTMATH_USE_SSE2
+		// ---------------------------------------------------------------------
+		// mapLine (float)
+		// ---------------------------------------------------------------------
+		static void	mapLine(const float *inSrc, int inCount, const Parameters &inParam,
+								const float *inThresholdRow, unsigned char *outDst)
+		{
+			static const MapLineFloatFunc	mapLineFunc = selectMapLineFloatFunc();
+
+			int	x = mapLineFunc(inSrc, inCount, inParam, inThresholdRow, outDst);
+			mapLineScalar(inSrc, x, inCount, inParam, inThresholdRow, outDst);
+		}
+	#endif
+		// ---------------------------------------------------------------------
+		// mapComplexLine
+		// ---------------------------------------------------------------------
+		//	inSrc holds inWidth interleaved (re, im) pairs. The magnitude or the
+		//	phase is computed into an L1 sized chunk and mapped from there.
+		template <typename ImageBufferType>
+		static void	mapComplexLine(const ImageBufferType *inSrc, int inWidth,
+								ComplexComponent inComponent, const Parameters &inParam,
+								const float *inThresholdRow, unsigned char *outDst)
+		{
+			const int	CHUNK_PIXELS = 256;		// multiple of Dither::THRESHOLD_ROW_SIZE
+			float		chunk[CHUNK_PIXELS];
+			Parameters	param = inParam;
+
+			if (inComponent == COMPLEX_PHASE)
+				param = obtainParameters(TONE_CURVE_LINEAR, -FastMath::pi(), FastMath::pi(), 1.0,
+										inParam.isNonFiniteMarked);
+
+			for (int x = 0; x < inWidth; x += CHUNK_PIXELS)
+			{
+				int	count = inWidth - x;
+				if (count > CHUNK_PIXELS)
+					count = CHUNK_PIXELS;
+
+				if (inComponent == COMPLEX_PHASE)
+					computePhase(inSrc + x * 2, count, chunk);
+				else
+					computeMagnitude(inSrc + x * 2, count, chunk);
+				mapLine((const float *)chunk, count, param, inThresholdRow, outDst + x);
+			}
+		}
+		// ---------------------------------------------------------------------
+		// findFiniteRange
+		// ---------------------------------------------------------------------
+		//	Min and max of the finite values (false if there are none)
+		template <typename ImageBufferType>
+		static bool	findFiniteRange(const ImageBufferType *inSrc, size_t inCount,
+								double *outMin, double *outMax)
+		{
+			bool	isFound = false;
+			double	minValue = 0, maxValue = 0;
+
+			for (size_t i = 0; i < inCount; i++)
+			{
+				double	v = (double )inSrc[i];
+				if (v - v != 0)		// NaN or Inf
+					continue;
+				if (isFound == false || v < minValue)
+					minValue = v;
+				if (isFound == false || v > maxValue)
+					maxValue = v;
+				isFound = true;
+			}
+			*outMin = minValue;
+			*outMax = maxValue;
+			return isFound;
+		}
+	#ifdef VIW_FASTMATH_USE_SSE2
+		// ---------------------------------------------------------------------
+		// findFiniteRange (float)
+		// ---------------------------------------------------------------------
+		static bool	findFiniteRange(const float *inSrc, size_t inCount,
+								double *outMin, double *outMax)
+		{
+			static const FindFiniteRangeFloatFunc	findFiniteRangeFunc = selectFindFiniteRangeFloatFunc();
+
+			return findFiniteRangeFunc(inSrc, inCount, outMin, outMax);
+		}
+	#endif
+
+	private:
+	#ifdef VIW_FASTMATH_USE_SSE2
+		// Typedefs ------------------------------------------------------------
+		//	The vector variants of the line functions return the first x
+		//	(or i) left for the scalar loop
+		typedef int	(*MapLineFloatFunc)(const float *inSrc, int inCount, const Parameters &inParam,
+								const float *inThresholdRow, unsigned char *outDst);
+		typedef bool	(*FindFiniteRangeFloatFunc)(const float *inSrc, size_t inCount,
+								double *outMin, double *outMax);
+		typedef int	(*ComputeFloatFunc)(const float *inSrc, int inCount, float *outDst);
+	#endif
+		// Static Functions ----------------------------------------------------
+	#ifdef VIW_FASTMATH_USE_SSE2
+		// ---------------------------------------------------------------------
+		// selectMapLineFloatFunc
+		// ---------------------------------------------------------------------
+		static MapLineFloatFunc	selectMapLineFloatFunc()
+		{
+			if (CpuFeatures::isEnabled(CpuFeatures::ISA_SSE2))
+				return mapLineFloatSSE2;
+			return mapLineFloatNone;
+		}
+		// ---------------------------------------------------------------------
+		// selectFindFiniteRangeFloatFunc
+		// ---------------------------------------------------------------------
+		static FindFiniteRangeFloatFunc	selectFindFiniteRangeFloatFunc()
+		{
+			if (CpuFeatures::isEnabled(CpuFeatures::ISA_SSE2))
+				return findFiniteRangeSSE2;
+			return findFiniteRange<float>;
+		}
+		// ---------------------------------------------------------------------
+		// selectComputeMagnitudeFunc
+		// ---------------------------------------------------------------------
+		static ComputeFloatFunc	selectComputeMagnitudeFunc()
+		{
+			if (CpuFeatures::isEnabled(CpuFeatures::ISA_SSE2))
+				return computeMagnitudeSSE2;
+			return computeNone;
+		}
+		// ---------------------------------------------------------------------
+		// selectComputePhaseFunc
+		// ---------------------------------------------------------------------
+		static ComputeFloatFunc	selectComputePhaseFunc()
+		{
+			if (CpuFeatures::isEnabled(CpuFeatures::ISA_SSE2))
+				return computePhaseSSE2;
+			return computeNone;
+		}
+		// ---------------------------------------------------------------------
+		// mapLineFloatNone
+		// ---------------------------------------------------------------------
+		static int	mapLineFloatNone(const float *, int, const Parameters &,
+								const float *, unsigned char *)
+		{
+			return 0;
+		}
+		// ---------------------------------------------------------------------
+		// computeNone
+		// ---------------------------------------------------------------------
+		static int	computeNone(const float *, int, float *)
+		{
+			return 0;
+		}
+		// ---------------------------------------------------------------------
+		// findFiniteRangeSSE2
+		// ---------------------------------------------------------------------
+		static bool	findFiniteRangeSSE2(const float *inSrc, size_t inCount,
+								double *outMin, double *outMax)
+		{
+			const __m128i	expMask = _mm_set1_epi32(0x7F800000);
+			__m128	minValue = _mm_set1_ps(3.4e38f);
+			__m128	maxValue = _mm_set1_ps(-3.4e38f);
+			__m128	foundMask = _mm_setzero_ps();
+			size_t	i = 0;
+
+			for (; i + 4 <= inCount; i += 4)
+			{
+				__m128	v = _mm_loadu_ps(inSrc + i);
+				__m128i	e = _mm_and_si128(_mm_castps_si128(v), expMask);
+				__m128	finite = _mm_castsi128_ps(_mm_xor_si128(_mm_cmpeq_epi32(e, expMask), _mm_set1_epi32(-1)));
+				minValue = _mm_min_ps(minValue, FastMath::select(finite, v, minValue));
+				maxValue = _mm_max_ps(maxValue, FastMath::select(finite, v, maxValue));
+				foundMask = _mm_or_ps(foundMask, finite);
+			}
+
+			float	minLanes[4], maxLanes[4];
+			_mm_storeu_ps(minLanes, minValue);
+			_mm_storeu_ps(maxLanes, maxValue);
+			bool	isFound = (_mm_movemask_ps(foundMask) != 0);
+			double	tailMin, tailMax;
+			bool	isTailFound = findFiniteRange<float>(inSrc + i, inCount - i, &tailMin, &tailMax);
+
+			*outMin = isTailFound ? tailMin : minLanes[0];
+			*outMax = isTailFound ? tailMax : maxLanes[0];
+			if (isFound)
+			{
+				for (int k = 0; k < 4; k++)
+				{
+					if (minLanes[k] < *outMin)
+						*outMin = minLanes[k];
+					if (maxLanes[k] > *outMax)
+						*outMax = maxLanes[k];
+				}
+			}
+			return (isFound || isTailFound);
+		}
+	#endif
+		// ---------------------------------------------------------------------
+		// obtainNonFiniteIndex
+		// ---------------------------------------------------------------------
+		template <typename ImageBufferType>
+		static unsigned char	obtainNonFiniteIndex(ImageBufferType inValue)
+		{
+			if (inValue != inValue)
+				return NAN_INDEX;
+			return (inValue > 0) ? POS_INF_INDEX : NEG_INF_INDEX;
+		}
+		// ---------------------------------------------------------------------
+		// applyCurve
+		// ---------------------------------------------------------------------
+		static float	applyCurve(float inValue, const Parameters &inParam)
+		{
+			float	d = inValue - inParam.minValue;
+			if (!(d > 0))		// also catches NaN
+				return 0;
+
+			switch (inParam.curve)
+			{
+				case TONE_CURVE_LOG:
+					return FastMath::log2(1.0f + d) * inParam.logScale;
+				case TONE_CURVE_SQRT:
+					return sqrtf(d * inParam.invRange);
+				case TONE_CURVE_GAMMA:
+				{
+					float	n = d * inParam.invRange;
+					if (n >= 1.0f)
+						return 1.0f;
+					if (n < 1e-30f)
+						return 0;
+					return FastMath::pow(n, inParam.gammaExponent);
+				}
+				case TONE_CURVE_LINEAR:
+				default:
+					return d * inParam.invRange;
+			}
+		}
+		// ---------------------------------------------------------------------
+		// mapLineScalar
+		// ---------------------------------------------------------------------
+		template <typename ImageBufferType>
+		static void	mapLineScalar(const ImageBufferType *inSrc, int inStartX, int inEndX,
+								const Parameters &inParam,
+								const float *inThresholdRow, unsigned char *outDst)
+		{
+			for (int x = inStartX; x < inEndX; x++)
+			{
+				if (inParam.isNonFiniteMarked && inSrc[x] - inSrc[x] != 0)
+				{
+					outDst[x] = obtainNonFiniteIndex(inSrc[x]);
+					continue;
+				}
+				float	v = applyCurve((float )inSrc[x], inParam) * inParam.outputMax +
+								inThresholdRow[x & (Dither::THRESHOLD_ROW_SIZE - 1)];
+				if (v >= inParam.outputMax)
+					outDst[x] = (unsigned char )inParam.outputMax;
+				else
+					outDst[x] = (unsigned char )v;
+			}
+		}
+		// ---------------------------------------------------------------------
+		// computeMagnitude
+		// ---------------------------------------------------------------------
+		template <typename ImageBufferType>
+		static void	computeMagnitude(const ImageBufferType *inSrc, int inCount, float *outDst)
+		{
+			for (int i = 0; i < inCount; i++)
+			{
+				float	re = (float )inSrc[i * 2];
+				float	im = (float )inSrc[i * 2 + 1];
+				outDst[i] = sqrtf(re * re + im * im);
+			}
+		}
+		// ---------------------------------------------------------------------
+		// computePhase
+		// ---------------------------------------------------------------------
+		template <typename ImageBufferType>
+		static void	computePhase(const ImageBufferType *inSrc, int inCount, float *outDst)
+		{
+			for (int i = 0; i < inCount; i++)
+				outDst[i] = FastMath::atan2((float )inSrc[i * 2 + 1], (float )inSrc[i * 2]);
+		}
+	#ifdef VIW_FASTMATH_USE_SSE2
+		// ---------------------------------------------------------------------
+		// computeMagnitude (float)
+		// ---------------------------------------------------------------------
+		static void	computeMagnitude(const float *inSrc, int inCount, float *outDst)
+		{
+			static const ComputeFloatFunc	computeFunc = selectComputeMagnitudeFunc();
+
+			int	i = computeFunc(inSrc, inCount, outDst);
+			for (; i < inCount; i++)
+				outDst[i] = sqrtf(inSrc[i * 2] * inSrc[i * 2] + inSrc[i * 2 + 1] * inSrc[i * 2 + 1]);
+		}
+		// ---------------------------------------------------------------------
+		// computePhase (float)
+		// ---------------------------------------------------------------------
+		static void	computePhase(const float *inSrc, int inCount, float *outDst)
+		{
+			static const ComputeFloatFunc	computeFunc = selectComputePhaseFunc();
+
+			int	i = computeFunc(inSrc, inCount, outDst);
+			for (; i < inCount; i++)
+				outDst[i] = FastMath::atan2(inSrc[i * 2 + 1], inSrc[i * 2]);
+		}
+		// ---------------------------------------------------------------------
+		// computeMagnitudeSSE2
+		// ---------------------------------------------------------------------
+		static int	computeMagnitudeSSE2(const float *inSrc, int inCount, float *outDst)
+		{
+			int	i = 0;
+			for (; i + 4 <= inCount; i += 4)
+			{
+				__m128	re, im;
+				loadComplex4(inSrc + i * 2, &re, &im);
+				_mm_storeu_ps(outDst + i, _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(re, re), _mm_mul_ps(im, im))));
+			}
+			return i;
+		}
+		// ---------------------------------------------------------------------
+		// computePhaseSSE2
+		// ---------------------------------------------------------------------
+		static int	computePhaseSSE2(const float *inSrc, int inCount, float *outDst)
+		{
+			int	i = 0;
+			for (; i + 4 <= inCount; i += 4)
+			{
+				__m128	re, im;
+				loadComplex4(inSrc + i * 2, &re, &im);
+				_mm_storeu_ps(outDst + i, FastMath::atan2_ps(im, re));
+			}
+			return i;
+		}
+		// ---------------------------------------------------------------------
+		// loadComplex4
+		// ---------------------------------------------------------------------
+		static void	loadComplex4(const float *inSrc, __m128 *outRe, __m128 *outIm)
+		{
+			__m128	a = _mm_loadu_ps(inSrc);
+			__m128	b = _mm_loadu_ps(inSrc + 4);
+			*outRe = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+			*outIm = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+		}
+		// ---------------------------------------------------------------------
+		// applyCurveSSE2
+		// ---------------------------------------------------------------------
+		template <int Curve>
+		static __m128	applyCurveSSE2(__m128 inValue, const Parameters &inParam)
+		{
+			const __m128	zero = _mm_setzero_ps();
+			__m128	d = _mm_max_ps(_mm_sub_ps(inValue, _mm_set1_ps(inParam.minValue)), zero);	// NaN -> 0
+
+			switch (Curve)
+			{
+				case TONE_CURVE_LOG:
+					return _mm_mul_ps(FastMath::log2_ps(_mm_add_ps(d, _mm_set1_ps(1.0f))),
+									_mm_set1_ps(inParam.logScale));
+				case TONE_CURVE_SQRT:
+					return _mm_sqrt_ps(_mm_mul_ps(d, _mm_set1_ps(inParam.invRange)));
+				case TONE_CURVE_GAMMA:
+				{
+					__m128	n = _mm_min_ps(_mm_mul_ps(d, _mm_set1_ps(inParam.invRange)), _mm_set1_ps(1.0f));
+					__m128	valid = _mm_cmpge_ps(n, _mm_set1_ps(1e-30f));
+					n = _mm_max_ps(n, _mm_set1_ps(1e-30f));
+					__m128	y = FastMath::exp2_ps(_mm_mul_ps(FastMath::log2_ps(n),
+												_mm_set1_ps(inParam.gammaExponent)));
+					return _mm_and_ps(y, valid);
+				}
+			}
+			return _mm_mul_ps(d, _mm_set1_ps(inParam.invRange));
+		}
+		// ---------------------------------------------------------------------
+		// mapLineFloatSSE2
+		// ---------------------------------------------------------------------
+		static int	mapLineFloatSSE2(const float *inSrc, int inCount, const Parameters &inParam,
+								const float *inThresholdRow, unsigned char *outDst)
+		{
+			switch (inParam.curve)
+			{
+				case TONE_CURVE_LOG:
+					return mapLineSSE2<TONE_CURVE_LOG>(inSrc, inCount, inParam, inThresholdRow, outDst);
+				case TONE_CURVE_SQRT:
+					return mapLineSSE2<TONE_CURVE_SQRT>(inSrc, inCount, inParam, inThresholdRow, outDst);
+				case TONE_CURVE_GAMMA:
+					return mapLineSSE2<TONE_CURVE_GAMMA>(inSrc, inCount, inParam, inThresholdRow, outDst);
+				default:
+					return mapLineSSE2<TONE_CURVE_LINEAR>(inSrc, inCount, inParam, inThresholdRow, outDst);
+			}
+		}
+		// ---------------------------------------------------------------------
+		// mapLineSSE2
+		// ---------------------------------------------------------------------
+		template <int Curve>
+		static int	mapLineSSE2(const float *inSrc, int inCount, const Parameters &inParam,
+								const float *inThresholdRow, unsigned char *outDst)
+		{
+			const __m128	scale = _mm_set1_ps(inParam.outputMax);
+			const __m128	zero = _mm_setzero_ps();
+			const __m128i	expMask = _mm_set1_epi32(0x7F800000);
+			int	x = 0;
+
+			for (; x + 16 <= inCount; x += 16)
+			{
+				const float	*thr = inThresholdRow + (x & (Dither::THRESHOLD_ROW_SIZE - 1));
+				__m128i		n[4];
+				__m128i		nonFinite = _mm_setzero_si128();
+				for (int i = 0; i < 4; i++)
+				{
+					__m128	src = _mm_loadu_ps(inSrc + x + i * 4);
+					__m128	v = applyCurveSSE2<Curve>(src, inParam);
+					v = _mm_add_ps(_mm_mul_ps(v, scale), _mm_loadu_ps(thr + i * 4));
+					n[i] = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(v, zero), scale));
+					nonFinite = _mm_or_si128(nonFinite,
+						_mm_cmpeq_epi32(_mm_and_si128(_mm_castps_si128(src), expMask), expMask));
+				}
+				__m128i	lo = _mm_packs_epi32(n[0], n[1]);
+				__m128i	hi = _mm_packs_epi32(n[2], n[3]);
+				_mm_storeu_si128((__m128i *)(outDst + x), _mm_packus_epi16(lo, hi));
+
+				// rare, so fixed up in scalar
+				if (inParam.isNonFiniteMarked && _mm_movemask_epi8(nonFinite) != 0)
+				{
+					for (int i = 0; i < 16; i++)
+						if (inSrc[x + i] - inSrc[x + i] != 0)
+							outDst[x + i] = obtainNonFiniteIndex(inSrc[x + i]);
+				}
+			}
+			return x;
+		}
+	#endif
+	};
+ };
+};
+
+#endif	// #ifdef VIW_UTIL_TONEMAP_H
@@ -0,0 +1,444 @@
+// =============================================================================
+//  Trace.hpp
+//
+//  Written in 2014 by Dairoku Sekiguchi (sekiguchi at acm dot org)
+//
+//  To the extent possible under law, the author(s) have dedicated all copyright
+//  and related and neighboring rights to this software to the public domain worldwide.
+//  This software is distributed without any warranty.
+//
+//  You should have received a copy of the CC0 Public Domain Dedication along with
+//  this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+// =============================================================================
+/*!
+	\file		viw/utils/Trace.h
+	\author		Dairoku Sekiguchi
+	\version	1.0.0
+	\date		2026/10/19
+	\brief		Header file for viw library types
+
+	This file defines the pipeline stage tracing for viw library
+*/
+
+#ifndef VIW_UTIL_TRACE_H
+#define VIW_UTIL_TRACE_H
+
+// Includes --------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define	VIW_TRACE_USE_RDTSC
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define	VIW_TRACE_USE_RDTSC
+#endif
+
+// Macros ----------------------------------------------------------------------
+//	The stages are traced only when VIW_TRACE is defined, otherwise the
+//	macros expand to nothing. When compiled in, recording still has to be
+//	switched on with Trace::setEnabled(true) or VIW_TRACE=1 in the
+//	environment.
+#define	VIW_TRACE_CONCAT_(inA, inB)		inA##inB
+#define	VIW_TRACE_CONCAT(inA, inB)		VIW_TRACE_CONCAT_(inA, inB)
+#ifdef VIW_TRACE
+#define	VIW_TRACE_SCOPE(inName, inContext)	\
+	viw::utils::TraceScope	VIW_TRACE_CONCAT(viwTraceScope, __LINE__)(inName, inContext)
+#else
+#define	VIW_TRACE_SCOPE(inName, inContext)
+#endif
+
+#ifndef VIW_TRACE_BUFFER_SIZE
+#define	VIW_TRACE_BUFFER_SIZE	16384		// events per thread, power of 2
+#endif
+
+
+// Namespace -------------------------------------------------------------------
+namespace viw
+{
+ namespace utils
+ {
+	// -------------------------------------------------------------------------
+	// Trace class
+	// -------------------------------------------------------------------------
+	//	Every thread records into its own ring of the last
+	//	VIW_TRACE_BUFFER_SIZE events, so recording takes no lock. A slot
+	//	carries a sequence number that is odd while it is written, which
+	//	lets an export running at the same time skip torn slots.
+	class	Trace
+	{
+	public:
+		// Constatns -----------------------------------------------------------
+		const static int	HISTOGRAM_BUCKET_NUM	= 32;
+
+		// Structs -------------------------------------------------------------
+		struct	Event
+		{
+			const char			*name;			// string literal
+			const void			*context;		// window / buffer, may be NULL
+			int					threadIndex;
+			double				startUs;		// from the first traced event
+			double				durationUs;
+		};
+		struct	Histogram
+		{
+			const char			*name;
+			long long			count;
+			double				totalUs;
+			double				minUs;
+			double				maxUs;
+			long long			buckets[HISTOGRAM_BUCKET_NUM];	// [2^(i-1), 2^i) us, 0 : < 1 us
+		};
+
+		// Static Functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// isEnabled
+		// ---------------------------------------------------------------------
+		static bool	isEnabled()
+		{
+			return getEnabledFlag().load(std::memory_order_relaxed);
+		}
+		// ---------------------------------------------------------------------
+		// setEnabled
+		// ---------------------------------------------------------------------
+		static void	setEnabled(bool inEnabled)
+		{
+			getClock();
+			getEnabledFlag().store(inEnabled, std::memory_order_relaxed);
+		}
+		// ---------------------------------------------------------------------
+		// getTick
+		// ---------------------------------------------------------------------
+		static unsigned long long	getTick()
+		{
+		#ifdef VIW_TRACE_USE_RDTSC
+			return __rdtsc();
+		#else
+			return (unsigned long long )std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now().time_since_epoch()).count();
+		#endif
+		}
+		// ---------------------------------------------------------------------
+		// record
+		// ---------------------------------------------------------------------
+		static void	record(const char *inName, const void *inContext,
+						unsigned long long inStartTick, unsigned long long inEndTick)
+		{
+			ThreadBuffer	*buffer = getThreadBuffer();
+			unsigned long long	index = buffer->writeIndex++;
+			Slot	&slot = buffer->slots[index & (VIW_TRACE_BUFFER_SIZE - 1)];
+
+			slot.seq.store(index * 2 + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			slot.name.store(inName, std::memory_order_relaxed);
+			slot.context.store(inContext, std::memory_order_relaxed);
+			slot.startTick.store(inStartTick, std::memory_order_relaxed);
+			slot.endTick.store(inEndTick, std::memory_order_relaxed);
+			slot.seq.store(index * 2 + 2, std::memory_order_release);
+		}
+		// ---------------------------------------------------------------------
+		// getEvents
+		// ---------------------------------------------------------------------
+		//	Events of all threads, optionally only those of inContext, in
+		//	start order
+		static void	getEvents(std::vector<Event> *outEvents, const void *inContext = NULL)
+		{
+			outEvents->clear();
+			std::vector<ThreadBuffer *>	buffers = getBuffers();
+			double	usPerTick = getMicrosecondsPerTick();
+			unsigned long long	baseTick = getClock().baseTick;
+
+			for (size_t i = 0; i < buffers.size(); i++)
+			{
+				ThreadBuffer	*buffer = buffers[i];
+				for (int j = 0; j < VIW_TRACE_BUFFER_SIZE; j++)
+				{
+					Slot	&slot = buffer->slots[j];
+					unsigned long long	seq = slot.seq.load(std::memory_order_acquire);
+					if (seq == 0 || (seq & 1) != 0)
+						continue;
+
+					Event	event;
+					event.name = slot.name.load(std::memory_order_relaxed);
+					event.context = slot.context.load(std::memory_order_relaxed);
+					unsigned long long	startTick = slot.startTick.load(std::memory_order_relaxed);
+					unsigned long long	endTick = slot.endTick.load(std::memory_order_relaxed);
+					std::atomic_thread_fence(std::memory_order_acquire);
+					if (slot.seq.load(std::memory_order_relaxed) != seq)
+						continue;
+					if (inContext != NULL && event.context != inContext)
+						continue;
+
+					event.threadIndex = buffer->threadIndex;
+					event.startUs = (double )(long long )(startTick - baseTick) * usPerTick;
+					event.durationUs = (double )(endTick - startTick) * usPerTick;
+					outEvents->push_back(event);
+				}
+			}
+			std::sort(outEvents->begin(), outEvents->end(), isEarlier);
+		}
+		// ---------------------------------------------------------------------
+		// getHistograms
+		// ---------------------------------------------------------------------
+		//	One histogram per stage name over the events still held in the
+		//	rings
+		static void	getHistograms(std::vector<Histogram> *outHistograms, const void *inContext = NULL)
+		{
+			std::vector<Event>	events;
+			getEvents(&events, inContext);
+
+			outHistograms->clear();
+			for (size_t i = 0; i < events.size(); i++)
+			{
+				const Event	&event = events[i];
+				Histogram	*histogram = NULL;
+				for (size_t j = 0; j < outHistograms->size(); j++)
+					if (strcmp((*outHistograms)[j].name, event.name) == 0)
+						histogram = &(*outHistograms)[j];
+				if (histogram == NULL)
+				{
+					Histogram	newHistogram;
+					memset(&newHistogram, 0, sizeof(newHistogram));
+					newHistogram.name = event.name;
+					newHistogram.minUs = event.durationUs;
+					outHistograms->push_back(newHistogram);
+					histogram = &outHistograms->back();
+				}
+
+				histogram->count++;
+				histogram->totalUs += event.durationUs;
+				if (event.durationUs < histogram->minUs)
+					histogram->minUs = event.durationUs;
+				if (event.durationUs > histogram->maxUs)
+					histogram->maxUs = event.durationUs;
+				int	bucket = 0;
+				for (double limit = 1.0; event.durationUs >= limit && bucket < HISTOGRAM_BUCKET_NUM - 1; limit *= 2)
+					bucket++;
+				histogram->buckets[bucket]++;
+			}
+		}
+		// ---------------------------------------------------------------------
+		// dumpHistograms
+		// ---------------------------------------------------------------------
+		static void	dumpHistograms(FILE *inFile = stdout, const void *inContext = NULL)
+		{
+			std::vector<Histogram>	histograms;
+			getHistograms(&histograms, inContext);
+
+			fprintf(inFile, "%-24s %8s %10s %10s %10s\n", "stage", "count", "mean us", "min us", "max us");
+			for (size_t i = 0; i < histograms.size(); i++)
+			{
+				const Histogram	&h = histograms[i];
+				fprintf(inFile, "%-24s %8lld %10.2f %10.2f %10.2f\n",
+					h.name, h.count, h.totalUs / (double )h.count, h.minUs, h.maxUs);
+				for (int j = 0; j < HISTOGRAM_BUCKET_NUM; j++)
+				{
+					if (h.buckets[j] == 0)
+						continue;
+					fprintf(inFile, "    %10.0f - %-10.0f us %8lld\n",
+						(j == 0) ? 0.0 : (double )(1LL << (j - 1)), (double )(1LL << j), h.buckets[j]);
+				}
+			}
+		}
+		// ---------------------------------------------------------------------
+		// writeChromeTrace
+		// ---------------------------------------------------------------------
+		//	Trace event format ("X" complete events), loads in
+		//	chrome://tracing and Perfetto. pid is 1, tid the thread index and
+		//	the context pointer is in args.
+		static bool	writeChromeTrace(const char *inFileName, const void *inContext = NULL)
+		{
+			FILE	*fp = fopen(inFileName, "w");
+			if (fp == NULL)
+				return false;
+
+			std::vector<Event>	events;
+			getEvents(&events, inContext);
+
+			fprintf(fp, "{\"traceEvents\":[\n");
+			for (size_t i = 0; i < events.size(); i++)
+			{
+				const Event	&e = events[i];
+				fprintf(fp, "{\"name\":\"%s\",\"cat\":\"viw\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,"
+					"\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"context\":\"%p\"}}%s\n",
+					e.name, e.threadIndex, e.startUs, e.durationUs, e.context,
+					(i + 1 < events.size()) ? "," : "");
+			}
+			fprintf(fp, "],\"displayTimeUnit\":\"ns\"}\n");
+			return (fclose(fp) == 0);
+		}
+		// ---------------------------------------------------------------------
+		// clear
+		// ---------------------------------------------------------------------
+		//	Only while no thread is recording
+		static void	clear()
+		{
+			std::vector<ThreadBuffer *>	buffers = getBuffers();
+			for (size_t i = 0; i < buffers.size(); i++)
+				for (int j = 0; j < VIW_TRACE_BUFFER_SIZE; j++)
+					buffers[i]->slots[j].seq.store(0, std::memory_order_relaxed);
+		}
+
+	private:
+		// Structs -------------------------------------------------------------
+		struct	Slot
+		{
+			std::atomic<unsigned long long>	seq;
+			std::atomic<const char *>		name;
+			std::atomic<const void *>		context;
+			std::atomic<unsigned long long>	startTick;
+			std::atomic<unsigned long long>	endTick;
+		};
+		struct	ThreadBuffer
+		{
+			int					threadIndex;
+			unsigned long long	writeIndex;		// owner thread only
+			Slot				slots[VIW_TRACE_BUFFER_SIZE];
+		};
+		struct	Clock
+		{
+			unsigned long long						baseTick;
+			std::chrono::steady_clock::time_point	baseTime;
+		};
+		struct	Registry
+		{
+			std::mutex					mutex;
+			std::vector<ThreadBuffer *>	buffers;
+		};
+
+		// Static Functions ----------------------------------------------------
+		// ---------------------------------------------------------------------
+		// getEnabledFlag
+		// ---------------------------------------------------------------------
+		static std::atomic<bool>	&getEnabledFlag()
+		{
+			static std::atomic<bool>	flag(obtainDefaultEnabled());
+			return flag;
+		}
+		// ---------------------------------------------------------------------
+		// obtainDefaultEnabled
+		// ---------------------------------------------------------------------
+		static bool	obtainDefaultEnabled()
+		{
+			const char	*value = getenv("VIW_TRACE");
+			if (value == NULL || value[0] == 0 || strcmp(value, "0") == 0)
+				return false;
+			getClock();
+			return true;
+		}
+		// ---------------------------------------------------------------------
+		// getClock
+		// ---------------------------------------------------------------------
+		static const Clock	&getClock()
+		{
+			static const Clock	clock = {getTick(), std::chrono::steady_clock::now()};
+			return clock;
+		}
+		// ---------------------------------------------------------------------
+		// getMicrosecondsPerTick
+		// ---------------------------------------------------------------------
+		//	The tick rate is measured against the steady clock since the
+		//	first use, so it gets more accurate the longer the trace runs
+		static double	getMicrosecondsPerTick()
+		{
+		#ifdef VIW_TRACE_USE_RDTSC
+			const Clock	&clock = getClock();
+			unsigned long long	tick = getTick();
+			double	us = std::chrono::duration<double, std::micro>(
+								std::chrono::steady_clock::now() - clock.baseTime).count();
+			if (tick <= clock.baseTick || us <= 0)
+				return 0;
+			return us / (double )(tick - clock.baseTick);
+		#else
+			return 1e-3;
+		#endif
+		}
+		// ---------------------------------------------------------------------
+		// getRegistry
+		// ---------------------------------------------------------------------
+		static Registry	&getRegistry()
+		{
+			static Registry	registry;
+			return registry;
+		}
+		// ---------------------------------------------------------------------
+		// getBuffers
+		// ---------------------------------------------------------------------
+		static std::vector<ThreadBuffer *>	getBuffers()
+		{
+			Registry	&registry = getRegistry();
+			std::lock_guard<std::mutex>	lock(registry.mutex);
+			return registry.buffers;
+		}
+		// ---------------------------------------------------------------------
+		// getThreadBuffer
+		// ---------------------------------------------------------------------
+		//	Buffers are kept after their thread exits, so its events can
+		//	still be exported
+		static ThreadBuffer	*getThreadBuffer()
+		{
+			static thread_local ThreadBuffer	*sBuffer = NULL;
+			if (sBuffer != NULL)
+				return sBuffer;
+
+			ThreadBuffer	*buffer = new ThreadBuffer;
+			buffer->writeIndex = 0;
+			for (int i = 0; i < VIW_TRACE_BUFFER_SIZE; i++)
+				buffer->slots[i].seq.store(0, std::memory_order_relaxed);
+
+			Registry	&registry = getRegistry();
+			std::lock_guard<std::mutex>	lock(registry.mutex);
+			buffer->threadIndex = (int )registry.buffers.size();
+			registry.buffers.push_back(buffer);
+			sBuffer = buffer;
+			return buffer;
+		}
+		// ---------------------------------------------------------------------
+		// isEarlier
+		// ---------------------------------------------------------------------
+		static bool	isEarlier(const Event &inA, const Event &inB)
+		{
+			return inA.startUs < inB.startUs;
+		}
+	};
+
+	// -------------------------------------------------------------------------
+	// TraceScope class
+	// -------------------------------------------------------------------------
+	//	Records the lifetime of the object as one event (use VIW_TRACE_SCOPE)
+	class	TraceScope
+	{
+	public:
+		TraceScope(const char *inName, const void *inContext)
+		{
+			mName = NULL;
+			if (Trace::isEnabled() == false)
+				return;
+			mName = inName;
+			mContext = inContext;
+			mStartTick = Trace::getTick();
+		}
+		~TraceScope()
+		{
+			if (mName != NULL)
+				Trace::record(mName, mContext, mStartTick, Trace::getTick());
+		}
+
+	private:
+		const char			*mName;
+		const void			*mContext;
+		unsigned long long	mStartTick;
+
+		TraceScope(const TraceScope &);
+		TraceScope	&operator=(const TraceScope &);
+	};
+ };
+};
+
+#endif	// #ifdef VIW_UTIL_TRACE_H